@@ -1,7 +1,36 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <signal.h>
+#include <stddef.h>
+#include <time.h>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_SYS_WAIT_H
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_SELECT_H
+#include <sys/select.h>
+#endif
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
 char *clear = "cls";
@@ -13,12 +42,13 @@ char *clear = "clear";
 /*                                     STRUCTS                               */
 /*
  * int id : L'identifiant unique de la personne
- * char nom[25] : Le nom de la personne (25 caracteres maximum)
- * char prenom[25] : Le prenom de la personne (25 caracteres maximum)
+ * const char *nom : Le nom de la personne, interne (voir interner)
+ * const char *prenom : Le prenom de la personne, interne
  * int formateur : 1 si la personne est un formateur, 0 si la personne est un etudiant
  * int nb_formations : Le nombre de formations auquel la personne participera
  * int formations[30] : Vecteur qui stockera les identifiants des differentes formations auquel la personne participera
- * (On suppose dans une annee, une personne ne peut participer qu'a 30 formations maximum)
+ * (Une base de donnees contient une annee d'un campus, voir PARTITIONS. On suppose que dans une annee, une personne
+ * ne peut participer qu'a 30 formations maximum)
  * int nb_jours_indisponible : Si la personne est un formateur, il se peut qu'il/elle ait des jours d'indisponibile,
  * cette variable va stocker le nombre de jours ou cette personne est indisponile (maximum 7)
  * int jours_indisponibles[7] : Le vecteur qui stockera les jours auquel le formateur ne sera pas disponible
@@ -30,8 +60,8 @@ char *clear = "clear";
 typedef struct personne
 {
     int id;
-    char nom[25];
-    char prenom[25];
+    const char *nom;
+    const char *prenom;
     int formateur;
     int nb_formations;
     int formations[30];
@@ -42,1793 +72,14972 @@ typedef struct personne
 } personne;
 
 /*
- * Cette structure sert a devenir les differents noeuds qui seront stockes dans la base de donnee,
- * soit la structure db_personne.
- * Voici ce qui represent chaque partie de la structure:
- * personne *p : Le pointeur de la personne qui sera stocke dans ce nud lors de sa creation.
- * struct noeud_db_personne *next : qui contiendra le tete lors qu'on creera un nouveau nud, sinon NULL.
+ * Cette structure sert a attribuer les identifiants des personnes ou des formations.
+ * int haut : Le plus grand identifiant deja attribue, il est sauvegarde dans CaculliTyranowskiId.dat
+ * afin qu'un identifiant supprime ne soit jamais reattribue par erreur apres un redemarrage.
+ * int recycler : 1 si les identifiants liberes peuvent etre reattribues, 0 si pas (par defaut).
+ * unsigned int *libres : Vecteur de bits, le bit i vaut 1 si l'identifiant i est libre (seulement si recycler).
+ * int nb_mots : La taille du vecteur libres.
+ * int nb_libres : Le nombre de bits a 1 dans libres.
+ * int premier_mot : Aucun mot avant celui-ci ne contient de bit a 1.
  */
-typedef struct noeud_db_personne
+typedef struct allocateur_id
 {
-    personne *p;
-    struct noeud_db_personne *next;
-} noeud_db_personne;
+    int haut;
+    int recycler;
+    unsigned int *libres;
+    int nb_mots;
+    int nb_libres;
+    int premier_mot;
+} allocateur_id;
+
+/*
+ * Les personnes et les formations sont stockees dans des pages de TAILLE_PAGE enregistrements contigus.
+ * La page numero k contient les identifiants de k * TAILLE_PAGE a (k + 1) * TAILLE_PAGE - 1, on retrouve donc
+ * un enregistrement directement a partir de son identifiant. Une page n'est jamais deplacee en memoire une fois
+ * allouee, les pointeurs vers ses enregistrements restent valables tant que l'enregistrement existe.
+ */
+#define DECALAGE_PAGE 10
+#define TAILLE_PAGE ( 1 << DECALAGE_PAGE )
+
+/*
+ * Cette structure est une page de la base de donnees des personnes.
+ * personne enregistrements[TAILLE_PAGE] : Les personnes, a l'indice (id % TAILLE_PAGE).
+ * int position[TAILLE_PAGE] : La position de chaque personne dans le vecteur ordre de db_personne.
+ * unsigned char vivant[TAILLE_PAGE] : 1 si l'emplacement contient une personne, 0 s'il est vide ou si la personne
+ * a ete supprimee (pierre tombale).
+ * int nb_vivants : Le nombre d'emplacements occupes dans la page.
+ */
+typedef struct page_personne
+{
+    personne enregistrements[ TAILLE_PAGE ];
+    int position[ TAILLE_PAGE ];
+    unsigned char vivant[ TAILLE_PAGE ];
+    int nb_vivants;
+} page_personne;
 
 /*
- * Cette structure sert a contenir tous les differentes noeuds noeud_db_personne.
- * C'est a partir de cette structure que l'on stockera les differentes noeuds qui eux-memes stockeront
- * leurs personnes respectives.
- * noeud_db_personne *head : La tete de la liste chainee qui stockera toutes les personnes.
+ * Cette structure sert a contenir toutes les personnes de la base de donnees.
+ * page_personne **pages : Les pages de personnes, pages[k] vaut NULL si aucune personne n'a d'identifiant
+ * dans cette page.
+ * int nb_pages : La taille du vecteur pages.
+ * int *ordre : Les identifiants des personnes dans leur ordre d'ajout, 0 pour une personne supprimee.
+ * int taille_ordre : Le nombre de cases utilisees dans ordre (pierres tombales comprises).
+ * int capacite_ordre : La taille allouee pour ordre.
+ * int nb_tombes : Le nombre de pierres tombales dans ordre, le vecteur est compacte quand elles
+ * representent plus de la moitie de taille_ordre.
+ * int nb : Le nombre de personnes dans la base de donnees.
+ * personne **par_nom : L'index trie par nom, construit a la demande par les curseurs
+ * (voir debut_curseur_personne).
+ * int capacite_index : La taille allouee pour l'index.
+ * int index_a_jour : 1 si l'index correspond au contenu de la base de donnees, 0 s'il faut le reconstruire.
+ * allocateur_id ids : L'allocateur des identifiants des nouvelles personnes.
  */
 typedef struct db_personne
 {
-    noeud_db_personne *head;
+    page_personne **pages;
+    int nb_pages;
+    int *ordre;
+    int taille_ordre;
+    int capacite_ordre;
+    int nb_tombes;
+    int nb;
+    personne **par_nom;
+    int capacite_index;
+    int index_a_jour;
+    allocateur_id ids;
 } db_personne;
 
 /*
- * Cette structure va stocker les differentes personnes qui participeront a une formation specifique.
- * personne *p : La personne qui participera a la formation.
- * struct noeud_formation *next : Le noeud de pour la prochaine personne qui sera stockee.
+ * Une demande d'inscription en liste d'attente.
+ * personne *p : La personne qui attend.
+ * int formation : L'identifiant de la formation demandee.
+ * int rang : La priorite de la demande, la plus petite passe en premier (voir rang_attente).
+ * int numero : Le numero d'arrivee de la demande, il departage les demandes de meme rang.
+ * int position : La case de la demande dans le tas de la liste d'attente.
  */
-typedef struct noeud_formation
+typedef struct demande_attente
 {
     personne *p;
-    struct noeud_formation *next;
-} noeud_formation;
+    int formation;
+    int rang;
+    int numero;
+    int position;
+} demande_attente;
+
+/*
+ * La liste d'attente d'une formation: un tas binaire de demandes, la demande prioritaire dans la case 0.
+ */
+typedef struct file_attente
+{
+    demande_attente **tas;
+    int nb;
+    int capacite;
+} file_attente;
+
+/*
+ * Cette structure sert a retrouver une demande d'attente par formation et par personne, pour la retirer en
+ * O(log n). C'est une table de hachage a adressage ouvert, une case vaut NULL si elle est vide.
+ * int capacite : Le nombre de cases (une puissance de 2).
+ * int nb : Le nombre de demandes.
+ * int nb_tombes : Le nombre de cases qui ont contenu une demande retiree.
+ */
+typedef struct table_attente
+{
+    demande_attente **cases;
+    int capacite;
+    int nb;
+    int nb_tombes;
+} table_attente;
 
 /*
  * Cette structure sert a stocker toutes les informations qui composent une formations.
  * Voici ce que chaque partie represente:
  * int id : L'identifiant unique de la formation.
- * char nom[40] : Le nom de la formation (40 caracteres maximum).
- * float prix : Le cout de la formation.
+ * const char *nom : Le nom de la formation, interne (voir interner).
+ * int prix : Le cout de la formation, en centimes.
  * int nb_jours : Le nombre de jours par semaine ou cette formation a cours.
  * int jours[7] : Vecteur contenant les jours ou la formation a cours.
- * float heures[24] : Le nombre d'heures du debut de la formation.
- * float durees[10] : Les differentes durees du cours lors de la semaine.
+ * int heures[24] : L'heure du debut de chaque seance, en minutes depuis minuit (870 pour 14.30).
+ * int durees[10] : La duree de chaque seance, en minutes.
  * int nb_prerequis : Le nombre de prerequis pour avoir acces a cette formation.
  * int prerequis[10] : Vecteur contenant les identifiants des formations qui seraient des prerequis.
- * noeud_formation *head : Etant donne qu'une formation stocke des personnes,
- * elle-meme est une liste chainee qui stockera un nombre indetermine de participants.
+ * personne **inscrits : Les participants de la formation, dans leur ordre d'inscription.
+ * Une case a NULL est un participant desinscrit (pierre tombale).
+ * int nb_inscrits : Le nombre de cases utilisees dans inscrits (pierres tombales comprises).
+ * int nb_desinscrits : Le nombre de pierres tombales dans inscrits.
+ * int nb_apprenants : Le nombre d'inscrits qui ne sont pas formateurs, ceux qui occupent les places (voir
+ * place_libre).
+ * int capacite_inscrits : La taille allouee pour inscrits.
+ * int salles[7] : L'identifiant de la salle de chaque seance (meme indice que jours), 0 si aucune salle ne lui
+ * est attribuee.
+ * file_attente *attente : La liste d'attente de la formation quand elle est complete, NULL si personne n'attend.
  */
 typedef struct formation
 {
     int id;
-    char nom[40];
-    float prix;
+    const char *nom;
+    int prix;
     int nb_jours;
     int jours[7];
-    float heures[24];
-    float durees[10];
+    int heures[24];
+    int durees[10];
     int nb_prerequis;
     int prerequis[10];
-    noeud_formation *head;
+    personne **inscrits;
+    int nb_inscrits;
+    int nb_desinscrits;
+    int nb_apprenants;
+    int capacite_inscrits;
+    int salles[7];
+    file_attente *attente;
 } formation;
 
 /*
- * Cette structure suit la meme logique que la structure noeud_db_personne.
- * Elle sert a stocker les differentes formations, qui eux-memes stockeront les personnes a leurs tour.
- * formation *f : La formation qui sera stockee dans la base de donnees.
- * struct noeud_db_formation *next : La prochaine formation qui sera stockee dans la base de donnees.
- * NULL si pas de prochaine formation.
+ * Cette structure suit la meme logique que la structure page_personne, pour les formations.
  */
-typedef struct noeud_db_formation
+typedef struct page_formation
 {
-    formation *f;
-    struct noeud_db_formation *next;
-} noeud_db_formation;
+    formation enregistrements[ TAILLE_PAGE ];
+    int position[ TAILLE_PAGE ];
+    unsigned char vivant[ TAILLE_PAGE ];
+    int nb_vivants;
+} page_formation;
+
+/*
+ * Une entree de l'index des seances: le creneau creneau (indice dans jours, heures et durees) de la formation
+ * d'identifiant formation, de debut a fin (en minutes). formation vaut 0 pour une seance retiree (pierre tombale).
+ */
+typedef struct seance
+{
+    int formation;
+    int creneau;
+    int debut;
+    int fin;
+} seance;
+
+/*
+ * Les seances d'un jour qui occupent une tranche d'une heure. Chaque seance est rangee dans toutes les tranches
+ * qu'elle touche, de l'heure de son debut a celle de sa fin (la tranche 23 recoit aussi ce qui depasse minuit).
+ * int nb_tombes : Le nombre de pierres tombales dans seances, le vecteur est compacte quand elles en
+ * representent plus de la moitie.
+ */
+typedef struct tranche_horaire
+{
+    seance *seances;
+    int nb;
+    int capacite;
+    int nb_tombes;
+} tranche_horaire;
+
+/*
+ * Cette structure represente une salle de cours.
+ * int id : L'identifiant unique de la salle.
+ * int capacite : Le nombre de places de la salle.
+ * char nom[40] : Le nom de la salle (40 caracteres maximum).
+ */
+typedef struct salle
+{
+    int id;
+    int capacite;
+    char nom[40];
+} salle;
 
 /*
- * Cette structure aussi suit la meme logique que la structure db_formation.
- * Elle sert de tete pour la la liste chainee et c'est a partir de cette structure-ci que l'on demarrera
- * les differentes interactions avec la base de donnees des formations.
- * noeud_db_formation *head : La tete de la liste chainee qui stockera les differentes formations.
+ * Cette structure aussi suit la meme logique que la structure db_personne.
+ * C'est a partir de cette structure-ci que l'on demarrera les differentes interactions avec la base de donnees
+ * des formations.
+ * tranche_horaire horaire[7][24] : L'index des seances par jour (lundi = 0) et par heure, tenu a jour par
+ * ranger_db_formation et supprimer_db_formation.
+ * salle *salles : Les salles de cours, par identifiant croissant.
+ * int nb_salles : Le nombre de salles.
+ * int capacite_salles : La taille allouee pour salles.
+ * table_attente attentes : Toutes les demandes des listes d'attente, par formation et par personne.
+ * int numero_attente : Le dernier numero d'arrivee attribue a une demande.
+ * int politique_attente : La politique de priorite des listes d'attente (ATTENTE_PREREQUIS par defaut).
  */
 typedef struct db_formation
 {
-    noeud_db_formation *head;
+    page_formation **pages;
+    int nb_pages;
+    int *ordre;
+    int taille_ordre;
+    int capacite_ordre;
+    int nb_tombes;
+    int nb;
+    formation **par_nom;
+    int capacite_index;
+    int index_a_jour;
+    allocateur_id ids;
+    tranche_horaire horaire[7][24];
+    salle *salles;
+    int nb_salles;
+    int capacite_salles;
+    table_attente attentes;
+    int numero_attente;
+    int politique_attente;
 } db_formation;
 
+/*
+ * Les differents ordres dans lesquels un curseur peut parcourir une base de donnees.
+ * ORDRE_INSERTION : De la premiere a la derniere personne/formation ajoutee (ordre des fichiers .dat).
+ * ORDRE_RECENT : De la derniere a la premiere ajoutee.
+ * ORDRE_ID : Par identifiant croissant, soit dans l'ordre des pages en memoire.
+ * ORDRE_NOM : Par nom (puis prenom pour les personnes), puis par identifiant.
+ */
+#define ORDRE_INSERTION 0
+#define ORDRE_RECENT 1
+#define ORDRE_ID 2
+#define ORDRE_NOM 3
+
+/*
+ * Un curseur sert a parcourir une base de donnees dans un ordre choisi sans la copier.
+ * Les ordres ORDRE_INSERTION et ORDRE_RECENT avancent dans le vecteur ordre, l'ordre ORDRE_ID avance dans
+ * les pages et l'ordre ORDRE_NOM avance dans l'index trie par nom.
+ * int position : La position actuelle dans ordre, l'identifiant actuel ou la position dans l'index.
+ * Un curseur n'est plus valable si la base de donnees est modifiee pendant le parcours.
+ */
+typedef struct curseur_personne
+{
+    db_personne *db;
+    int ordre;
+    int position;
+} curseur_personne;
+
+typedef struct curseur_formation
+{
+    db_formation *db;
+    int ordre;
+    int position;
+} curseur_formation;
+
 /*                                    FIN STRUCTS                            */
 /*****************************************************************************/
 
 /*****************************************************************************/
-/*                                    PERSONNE                               */
+/*                                     OUTILS                                */
 /*
- * Cette fonction sert a creer un pointeur qui permettra d'initialiser les differentes informations presentes
- * dans la structure personne.
- * Lors de l'initialisation d'une personne, on n'aura besoin que du nom de famille de la personne,
- * son prenom et s'il/elle est un formateur ou pas.
- * Le reste des informations est manipule par la suite lors des differentes interactions.
+ * Le suivi des allocations sert a retrouver les fuites de memoire: chaque bloc alloue par ALLOUER ou REALLOUER
+ * est precede d'un entete qui note son type, la ligne du programme qui l'a alloue et sa taille, et les blocs
+ * vivants sont chaines entre eux. A la fin du programme, les blocs encore vivants sont regroupes par type et
+ * par ligne (voir rapporter_allocations).
+ * Le suivi n'est actif que si la variable d'environnement CACULLITYRANOWSKI_ALLOCATIONS vaut 1, il doit etre
+ * choisi avant la premiere allocation. Sinon ALLOUER, REALLOUER et LIBERER appellent directement calloc,
+ * realloc et free.
  */
-personne *creer_personne( char nom[], char prenom[], int formateur )
+#define ALLOUER( nb, taille, type ) allouer_suivi( ( nb ), ( taille ), ( type ), __LINE__ )
+#define REALLOUER( ptr, taille, type ) reallouer_suivi( ( ptr ), ( taille ), ( type ), __LINE__ )
+#define LIBERER( ptr ) liberer_suivi( ptr )
+
+/*
+ * bloc_suivi *precedent, *suivant : Les blocs vivants voisins dans la chaine.
+ * const char *type : Le type de ce qui est stocke dans le bloc.
+ * int ligne : La ligne du programme qui a alloue le bloc.
+ * size_t taille : La taille du bloc, entete non compris.
+ */
+typedef struct bloc_suivi
 {
-    personne *e = ( personne * ) calloc( sizeof( personne ), sizeof( personne ) );
-    strcpy( e->nom, nom );
-    strcpy( e->prenom, prenom );
-    e->formateur = formateur;
-    return e;
-}
+    struct bloc_suivi *precedent;
+    struct bloc_suivi *suivant;
+    const char *type;
+    int ligne;
+    size_t taille;
+} bloc_suivi;
 
 /*
- * Cette fonction sert a afficher les informations de base qui caracterisent une personne.
- * De maniere generale, son identifiant, son nom de famille, son prenom et s'il est formateur ou etudiant.
+ * L'entete est une union afin que le bloc qui le suit soit aligne comme le serait un bloc de malloc.
  */
-void afficher_personne( personne *p )
+typedef union entete_suivi
 {
-    personne *tmp = p;
-    printf( "* %2d %-25s %-25s %-10s            *\n",
-            tmp->id, tmp->nom, tmp->prenom, tmp->formateur ? "Formateur" : "Etudiant" );
-}
+    bloc_suivi bloc;
+    long double alignement_reel;
+    void *alignement_pointeur;
+    long alignement_entier;
+} entete_suivi;
 
 /*
- * Cette fonction sert a initialiser le pointer noeud_db_personne *head dans la structure db_personne a NULL,
- * afin que l'on puisse commencer a faire des manipulations avec cette structure.
+ * int actif : 1 si le suivi est actif.
+ * entete_suivi *premier : Le premier bloc vivant de la chaine.
+ * unsigned long nb_blocs : Le nombre de blocs vivants.
+ * size_t octets : La taille des blocs vivants.
+ * size_t pic : La plus grande valeur atteinte par octets.
+ * unsigned long nb_allocations : Le nombre total d'allocations depuis le debut du programme.
  */
-db_personne *creer_db_personne()
+typedef struct suivi_allocations
 {
-    db_personne *db = ( db_personne * ) calloc( sizeof( db_personne ), sizeof( db_personne ) );
-    db->head = NULL;
-    return db;
-}
+    int actif;
+    entete_suivi *premier;
+    unsigned long nb_blocs;
+    size_t octets;
+    size_t pic;
+    unsigned long nb_allocations;
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_t verrou;
+#endif
+} suivi_allocations;
+
+suivi_allocations suivi =
+{
+    0, NULL, 0, 0, 0, 0
+#ifdef HAVE_PTHREAD_H
+    , PTHREAD_MUTEX_INITIALIZER
+#endif
+};
 
 /*
- * Cette fonction sert a initialiser un pointeur noeud_db_personne *ndb qui stockera personne *p
- * dans la base de donnees db_personne *db.
- * Ici, l'ajout dans la liste chainee a lieu par le mecanisme suivant:
- * On initialise le noeud temporaire que l'on ajoutera a la base de donnees.
- * On associe p au pointeur p present dans la structure noeud_db_personne.
- * On initialise le prochain noeud de la liste *next a NULL.
- * Si la tete *head de la base de donnee est NULL, alors la tete devient le nouveau noeud.
- * On arrete la fonction d'ajout la.
- * Sinon, on fait une copie de la tete dans le noeud *next que l'on avait initialise a NULL.
- * On declare la tete comme etant le noeud temporaire que l'on a initialise.
+ * Ces fonctions servent a ajouter le bloc e a la chaine des blocs vivants ou a l'en retirer.
+ * Les tampons du planning sont alloues par les ouvriers du pool, la chaine est donc protegee par un verrou.
  */
-void ajouter_db_personne( db_personne *db, personne *p )
+void chainer_bloc( entete_suivi *e )
 {
-    noeud_db_personne *ndb = ( noeud_db_personne * ) calloc( sizeof( noeud_db_personne ), sizeof( noeud_db_personne ) );
-    ndb->p = p;
-    ndb->next = NULL;
-    if( db->head == NULL )
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock( &suivi.verrou );
+#endif
+    e->bloc.precedent = NULL;
+    e->bloc.suivant = suivi.premier ? &suivi.premier->bloc : NULL;
+    if( suivi.premier != NULL )
     {
-        db->head = ndb;
-        return;
+        suivi.premier->bloc.precedent = &e->bloc;
     }
-    ndb->next = db->head;
-    db->head = ndb;
+    suivi.premier = e;
+    suivi.nb_blocs += 1;
+    suivi.nb_allocations += 1;
+    suivi.octets += e->bloc.taille;
+    if( suivi.octets > suivi.pic )
+    {
+        suivi.pic = suivi.octets;
+    }
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock( &suivi.verrou );
+#endif
 }
 
-/*
- * Cette fonction sert a supprimer une personne de la base de donnees a partir de son identifiant.
- * La demarche faite dans cette fonction est la suivant:
- * On verife que la tete de la base de donnees dbp->head ne soit pas NULL, si oui, on arrete la fonction.
- * On verifie si le premier element de la liste correspond a l'id de la personne que l'on souhaite supprimer.
- * Si oui:
- * On cree un noeud temporaire qui stockera la personne suivante dans la liste.
- * On libere l'espace memoire occupe par head avec la fonction free(dbp->head).
- * On attribue a dbp->head le noeud temporaire que l'on avait cree.
- * On arrete la fonction.
- * Sinon, on parcourt l'entierete de la liste jusqu'au moment ou l'on trouve la personne qui a le meme id que
- * l'id en parametre.
- * Si on le trouve, on pivote l'element qui suit vers l'element que l'on vient de supprimer.
- * On arrete la fonction, si reussite, on obtient 1, si pas, on obtient 0.
- */
-int supprimer_db_personne( db_personne *dbp, int id )
+void dechainer_bloc( entete_suivi *e )
 {
-    noeud_db_personne *ndbp = dbp->head;
-    if( ndbp == NULL )
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock( &suivi.verrou );
+#endif
+    if( e->bloc.precedent != NULL )
     {
-        return 0;
+        e->bloc.precedent->suivant = e->bloc.suivant;
     }
-    noeud_db_personne *tmp = NULL;
-    if( ndbp->p->id == id )
+    else
     {
-        tmp = dbp->head->next;
-        free( dbp->head );
-        dbp->head = tmp;
-        return 1;
+        suivi.premier = ( entete_suivi * ) e->bloc.suivant;
     }
-    while( ndbp != NULL )
+    if( e->bloc.suivant != NULL )
     {
-        if( ndbp->next == NULL )
-        {
-            if( ndbp->p->id == id )
-            {
-                return 1;
-            }
-            return 0;
-        }
-        if( ndbp->next->p->id == id )
-        {
-            tmp = ndbp->next;
-            ndbp->next = tmp->next;
-            free( tmp );
-            return 1;
-        }
-        ndbp = ndbp->next;
+        e->bloc.suivant->precedent = e->bloc.precedent;
     }
-    return 0;
+    suivi.nb_blocs -= 1;
+    suivi.octets -= e->bloc.taille;
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock( &suivi.verrou );
+#endif
 }
 
 /*
- * Cette fonction parcourt l'entierete de la base de donnees db_personne *db.Tant que la tete n'est pas NULL,
- * on affichera les informations que l'on souhaite afficher de chaque personne presente dans la base de donnees.
+ * Cette fonction remplace calloc: elle alloue nb elements de taille octets mis a zero.
  */
-void afficher_db_personne( db_personne *db )
+void *allouer_suivi( size_t nb, size_t taille, const char *type, int ligne )
 {
-    db_personne *tmpdb = db;
-    noeud_db_personne *tmpndb = tmpdb->head;
-    printf( "* %2s %-25s %-25s %-9s             *\n", "ID", "Nom", "Prenom", "Statut" );
-    printf( "* ---------------------------------------------------------------------------- *\n" );
-    while( tmpndb != NULL )
+    entete_suivi *e;
+    if( !suivi.actif )
+    {
+        return calloc( nb, taille );
+    }
+    e = ( entete_suivi * ) calloc( 1, sizeof( entete_suivi ) + nb * taille );
+    if( e == NULL )
     {
-        afficher_personne( tmpndb->p );
-        tmpndb = tmpndb->next;
+        return NULL;
     }
+    e->bloc.type = type;
+    e->bloc.ligne = ligne;
+    e->bloc.taille = nb * taille;
+    chainer_bloc( e );
+    return e + 1;
 }
 
 /*
- * Cette fonction renvoie NULL si une formation avec un nom specifique n'existe pas dans
- * la base de donnees db_formation *dbf.
- * Sinon, la fonction retourne la formation trouvee.
+ * Cette fonction remplace realloc. Le bloc garde le type et la ligne de sa nouvelle allocation.
  */
-personne *get_personne( db_personne *db, char nom[], char prenom[], int formateur )
+void *reallouer_suivi( void *ptr, size_t taille, const char *type, int ligne )
 {
-    db_personne *tmpdb = db;
-    noeud_db_personne *tmpndb = tmpdb->head;
-    while( tmpndb != NULL )
+    entete_suivi *e;
+    if( !suivi.actif )
     {
-        if( strcmp( tmpndb->p->nom, nom ) == 0 &&
-            strcmp( tmpndb->p->prenom, prenom ) == 0 &&
-            tmpndb->p->formateur == formateur )
-        {
-            return tmpndb->p;
-        }
-        tmpndb = tmpndb->next;
+        return realloc( ptr, taille );
     }
-    return NULL;
+    if( ptr == NULL )
+    {
+        return allouer_suivi( 1, taille, type, ligne );
+    }
+    e = ( entete_suivi * ) ptr - 1;
+    dechainer_bloc( e );
+    e = ( entete_suivi * ) realloc( e, sizeof( entete_suivi ) + taille );
+    if( e == NULL )
+    {
+        return NULL;
+    }
+    e->bloc.type = type;
+    e->bloc.ligne = ligne;
+    e->bloc.taille = taille;
+    chainer_bloc( e );
+    return e + 1;
 }
 
-/*                                 FIN PERSONNE                              */
-/*****************************************************************************/
-
-/*****************************************************************************/
-/*                                     FORMATION                             */
 /*
- * Cette fonction sert a creer un pointeur qui permettra d'initialiser les differentes informations presentes dans
- * la structure formation.
- * Lors de l'initialisation d'une formation, on n'aura besoin que du nom de la formation et de son prix.
- * Le reste des informations est manipule par la suite lors des differentes interactions.
+ * Cette fonction remplace free.
  */
-formation *creer_formation( char nom[], float prix )
+void liberer_suivi( void *ptr )
 {
-    formation *tmp = ( formation * ) calloc( sizeof( formation), sizeof( formation ) );
-    strcpy( tmp->nom, nom );
-    tmp->prix = prix;
-    tmp->head = NULL;
-    return tmp;
+    entete_suivi *e;
+    if( !suivi.actif || ptr == NULL )
+    {
+        free( ptr );
+        return;
+    }
+    e = ( entete_suivi * ) ptr - 1;
+    dechainer_bloc( e );
+    free( e );
 }
+
 /*
- * Cette fonction sert a initialiser un pointeur noeud_formation *nf qui stockera personne *p qui participera
- * dans formation *f. Ici,
- * l'ajout dans la liste chainee a lieu par le mecanisme suivant:
- * On initialise le noeud temporaire que l'on ajoutera dans la formation.
- * On associe p au pointeur p present dans la structure noeud_formation.
- * On initialise le prochain noeud de la liste *next a NULL.
- * Si la tete *head de la formation est NULL, alors la tete devient le nouveau noeud. On arrete la fonction d'ajout la.
- * Sinon, on fait une copie de la tete dans le noeud *next que l'on avait initialise a NULL.
- * On declare la tete comme etant le noeud temporaire que l'on a initialise.
+ * Cette structure regroupe les blocs vivants alloues a la meme ligne, pour rapporter_allocations.
  */
-int ajouter_formation( formation *f, personne *p )
+typedef struct site_allocation
 {
-    noeud_formation *nf = ( noeud_formation * ) calloc( sizeof( noeud_formation ), sizeof( noeud_formation) );
-    nf->p = p;
-    nf->next = NULL;
-    if( f->head == NULL )
-    {
-        f->head = nf;
-        return 1;
-    }
-    noeud_formation *tmpnf = f->head;
-    while( tmpnf != NULL )
+    const char *type;
+    int ligne;
+    unsigned long nb_blocs;
+    size_t octets;
+} site_allocation;
+
+int comparer_site_allocation( const void *a, const void *b )
+{
+    const site_allocation *sa = ( const site_allocation * ) a;
+    const site_allocation *sb = ( const site_allocation * ) b;
+    if( sa->octets != sb->octets )
     {
-        if( tmpnf->p->id == p->id )
-        {
-            return 0;
-        }
-        tmpnf = tmpnf->next;
+        return sa->octets < sb->octets ? 1 : -1;
     }
-    nf->next = f->head;
-    f->head = nf;
-    return 1;
+    return sa->ligne - sb->ligne;
 }
 
 /*
- * Cette fonction sert a supprimer une personne de la fonction a partir de son identifiant.
- * La demarche faite dans cette fonction est la suivant:
- * On verife que la tete de la fonction f->head ne soit pas NULL, si oui, on arrete la fonction.
- * On verifie si le premier element de la liste correspond a l'id de la personne que l'on souhaite supprimer.
- * Si oui:
- * On cree un noeud temporaire qui stockera la personne suivante dans la liste.
- * On libere l'espace memoire occupe par head avec la fonction free(f->head).
- * On attribue a f->head le noeud temporaire que l'on avait cree.
- * On arrete la fonction.
- * Sinon, on parcourt l'entierete de la liste jusqu'au moment ou l'on trouve la personne
- * qui a le meme id que l'id en parametre.
- * Si on le trouve, on pivote l'element qui suit vers l'element que l'on vient de supprimer.
- * On arrete la fonction, si reussite, on obtient 1, si pas, on obtient 0.
+ * Cette fonction sert a ecrire dans sortie le bilan du suivi des allocations: les blocs encore vivants,
+ * regroupes par type et par ligne d'allocation, du site qui occupe le plus de memoire au site qui en occupe
+ * le moins.
  */
-int supprimer_personne_de_formation( formation *f, int id )
+void rapporter_allocations( FILE *sortie )
 {
-    formation *tmpf = f;
-    noeud_formation *tmp = NULL;
-    if( f == NULL )
-    {
-        printf( "Formation pas trouvee\n" );
-        return 0;
-    }
-    noeud_formation *headf = tmpf->head;
-    if( headf == NULL )
-    {
-        return 0;
-    }
-    if( f->head->p->id == id )
+    site_allocation *sites;
+    bloc_suivi *b;
+    int nb_sites = 0, capacite = 16, i;
+    if( !suivi.actif )
     {
-        tmp = f->head->next;
-        free( f->head );
-        f->head = tmp;
-        return 1;
+        return;
     }
-    while( headf != NULL )
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock( &suivi.verrou );
+#endif
+    sites = ( site_allocation * ) malloc( capacite * sizeof( site_allocation ) );
+    for( b = suivi.premier ? &suivi.premier->bloc : NULL; b != NULL && sites != NULL; b = b->suivant )
     {
-        if( headf->next == NULL )
+        for( i = 0; i < nb_sites && ( sites[i].ligne != b->ligne || strcmp( sites[i].type, b->type ) != 0 ); i++ )
         {
-            if( headf->p->id == id )
-            {
-                return 1;
-            }
-            return 0;
         }
-        if( headf->next->p->id == id )
+        if( i == nb_sites )
         {
-            tmp = headf->next;
-            headf->next = tmp->next;
-            free( tmp );
-            return 1;
+            if( nb_sites == capacite )
+            {
+                capacite *= 2;
+                sites = ( site_allocation * ) realloc( sites, capacite * sizeof( site_allocation ) );
+            }
+            sites[i].type = b->type;
+            sites[i].ligne = b->ligne;
+            sites[i].nb_blocs = 0;
+            sites[i].octets = 0;
+            nb_sites += 1;
         }
-        headf = headf->next;
+        sites[i].nb_blocs += 1;
+        sites[i].octets += b->taille;
     }
-    return 0;
+    fprintf( sortie, "Allocations: %lu au total, pic de %lu octets, %lu blocs vivants (%lu octets)\n",
+             suivi.nb_allocations, ( unsigned long ) suivi.pic, suivi.nb_blocs, ( unsigned long ) suivi.octets );
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock( &suivi.verrou );
+#endif
+    if( sites == NULL )
+    {
+        return;
+    }
+    qsort( sites, nb_sites, sizeof( site_allocation ), comparer_site_allocation );
+    for( i = 0; i < nb_sites; i++ )
+    {
+        fprintf( sortie, "  %-20s ligne %5d: %8lu blocs %12lu octets\n",
+                 sites[i].type, sites[i].ligne, sites[i].nb_blocs, ( unsigned long ) sites[i].octets );
+    }
+    free( sites );
 }
 
 /*
- * Cette fonction sert a afficher les informations de base qui caracterisent une formation.
- * De maniere generale, son identifiant, son nom, son prix, ainsi que les personnes qui y participent.
+ * Cette fonction est enregistree avec atexit quand le suivi est actif: elle ecrit le bilan des allocations
+ * sur la sortie d'erreur a la fin du programme.
  */
-void afficher_formation( formation *f )
+void rapporter_allocations_a_la_sortie()
 {
-    formation *tmp = f;
-    noeud_formation *tmpnf = tmp->head;
-    printf( "ID: %d - Nom formation: %s\n", tmp->id, tmp->nom );
-    printf( "Participants dans la formation:\n" );
-    printf( "Formateurs:\n" );
-    while( tmpnf != NULL )
-    {
-        if( tmpnf->p->formateur == 1 )
-        {
-            printf( "%2d %s %s", tmpnf->p->id, tmpnf->p->nom, tmpnf->p->prenom );
-            if( tmpnf != NULL ) printf( "\n" );
-        }
-        tmpnf = tmpnf->next;
-    }
-    tmpnf = tmp->head;
-    printf( "Etudiants:\n" );
-    while( tmpnf != NULL )
-    {
-        if( tmpnf->p->formateur == 0 )
-        {
-            printf( "%2d %s %s", tmpnf->p->id, tmpnf->p->nom, tmpnf->p->prenom );
-            if( tmpnf != NULL ) printf( "\n" );
-        }
-        tmpnf = tmpnf->next;
-    }
-    printf( "\n" );
+    rapporter_allocations( stderr );
 }
 
 /*
- * Cette fonction sert a initialiser le pointer noeud_db_formation *head dans la structure db_formation a NULL,
- * afin que l'on puisse commencer a faire des manipulations avec cette structure.
+ * Cette structure sert de tampon de texte extensible, utilise pour construire une sortie en memoire
+ * avant de l'ecrire d'un seul coup dans un fichier.
+ * char *donnees : Le texte accumule (il n'est pas forcement termine par '\0').
+ * size_t taille : Le nombre d'octets utilises dans donnees.
+ * size_t capacite : Le nombre d'octets alloues pour donnees.
  */
-db_formation *creer_db_formation()
+typedef struct tampon
 {
-    db_formation *db = ( db_formation * ) calloc( sizeof( db_formation ), sizeof( db_formation ) );
-    db->head = NULL;
-    return db;
+    char *donnees;
+    size_t taille;
+    size_t capacite;
+} tampon;
+
+/*
+ * Cette fonction sert a initialiser un tampon vide. Aucune memoire n'est allouee avant la premiere ecriture.
+ */
+void initialiser_tampon( tampon *t )
+{
+    t->donnees = NULL;
+    t->taille = 0;
+    t->capacite = 0;
 }
 
 /*
- * Cette fonction sert a initialiser un pointeur noeud_db_formation *ndb qui stockera formation *f dans
- * la base de donnees db_formation *db.
- * Ici, l'ajout dans la liste chainee a lieu par le mecanisme suivant:
- * On initialise le noeud temporaire que l'on ajoutera a la base de donnees.
- * On associe f au pointeur f present dans la structure noeud_db_formation.
- * On initialise le prochain noeud de la liste *next a NULL.
- * Si la tete *head de la base de donnee est NULL, alors la tete devient le nouveau noeud.
- * On arrete la fonction d'ajout la.
- * Sinon, on fait une copie de la tete dans le noeud *next que l'on avait initialise a NULL.
- * On declare la tete comme etant le noeud temporaire que l'on a initialise.
+ * Cette fonction sert a liberer la memoire occupee par un tampon et a le remettre a vide.
  */
-void ajouter_db_formation( db_formation *db, formation *f )
+void liberer_tampon( tampon *t )
 {
-    noeud_db_formation *ndb = ( noeud_db_formation * ) calloc( sizeof( noeud_db_formation ), sizeof( noeud_db_formation ) );
-    ndb->f = f;
-    ndb->next = NULL;
-    if( db->head == NULL )
-    {
-        db->head = ndb;
-        return;
-    }
-    ndb->next = db->head;
-    db->head = ndb;
+    LIBERER( t->donnees );
+    initialiser_tampon( t );
 }
 
 /*
- * Cette fonction sert a supprimer une formation de la base de donnees a partir de son identifiant.
- * La demarche faite dans cette fonction est la suivant:
- * On verife que la tete de la base de donnees dbf->head ne soit pas NULL, si oui, on arrete la fonction.
- * On verifie si le premier element de la liste correspond a l'id de la formation que l'on souhaite supprimer.
- * Si oui:
- * On cree un noeud temporaire qui stockera la formation suivante dans la liste.
- * On libere l'espace memoire occupe par head avec la fonction free(dbf->head).
- * On attribue a dbf->head le noeud temporaire que l'on avait cree.
- * On arrete la fonction.
- * Sinon, on parcourt l'entierete de la liste jusqu'au moment ou l'on trouve la formation qui
- * a le meme id que l'id en parametre.
- * Si on le trouve, on pivote l'element qui suit vers l'element que l'on vient de supprimer.
- * On arrete la fonction, si reussite, on obtient 1, si pas, on obtient 0.
+ * Cette fonction sert a garantir qu'il reste au moins besoin octets libres a la fin du tampon.
+ * La capacite est doublee a chaque agrandissement afin que les ecritures successives restent en temps
+ * constant amorti.
  */
-int supprimer_db_formation( db_formation *dbf, int id )
+void agrandir_tampon( tampon *t, size_t besoin )
 {
-    noeud_db_formation *tmp = NULL;
-    if( dbf->head == NULL )
+    size_t capacite = t->capacite ? t->capacite : 256;
+    if( t->taille + besoin <= t->capacite )
     {
-        return 0;
-    }
-    if( dbf->head->f->id == id )
-    {
-        tmp = dbf->head->next;
-        free( dbf->head );
-        dbf->head = tmp;
-        return 1;
+        return;
     }
-    noeud_db_formation *tmpndbf = dbf->head;
-    while( tmpndbf != NULL )
+    while( capacite < t->taille + besoin )
     {
-        if( tmpndbf->next == NULL )
-        {
-            if( tmpndbf->f->id == id )
-            {
-                return 1;
-            }
-            return 0;
-        }
-        if( tmpndbf->next->f->id == id )
-        {
-            tmp = tmpndbf->next;
-            tmpndbf->next = tmpndbf->next->next;
-            free( tmp );
-            return 1;
-        }
-        tmpndbf = tmpndbf->next;
+        capacite *= 2;
     }
-    return 0;
+    t->donnees = ( char * ) REALLOUER( t->donnees, capacite, "tampon" );
+    t->capacite = capacite;
 }
 
 /*
- * Cette fonction renvoie NULL si une formation avec un nom specifique n'existe pas dans
- * la base de donnees db_formation *dbf.
- * Sinon, la fonction retourne la formation trouvee.
+ * Cette fonction sert a ecrire du texte formate a la fin du tampon, comme fprintf le ferait dans un fichier.
+ * On tente d'abord l'ecriture dans la place restante, si le texte ne rentre pas, on agrandit le tampon
+ * et on recommence.
  */
-formation *get_formation( db_formation *dbf, char nom_formation[] )
+void tampon_printf( tampon *t, const char *format, ... )
 {
-    db_formation *tmpdbf = dbf;
-    noeud_db_formation *tmpndbf = tmpdbf->head;
-    while( tmpndbf != NULL )
+    va_list args;
+    int n;
+    agrandir_tampon( t, 64 );
+    va_start( args, format );
+    n = vsnprintf( t->donnees + t->taille, t->capacite - t->taille, format, args );
+    va_end( args );
+    if( n < 0 )
     {
-        if( strcmp( tmpndbf->f->nom, nom_formation ) == 0 )
-        {
-            return tmpndbf->f;
-        }
-        tmpndbf = tmpndbf->next;
+        return;
     }
-    return NULL;
+    if( ( size_t ) n >= t->capacite - t->taille )
+    {
+        agrandir_tampon( t, ( size_t ) n + 1 );
+        va_start( args, format );
+        vsnprintf( t->donnees + t->taille, t->capacite - t->taille, format, args );
+        va_end( args );
+    }
+    t->taille += ( size_t ) n;
 }
 
 /*
- * Cette fonction sert a initialiser un pointeur noeud_db_formation *ndb qui stockera formation *f dans
- * la base de donnees db_formation *db.
- * Ici, l'ajout dans la liste chainee a lieu par le mecanisme suivant:
- * On initialise le noeud temporaire que l'on ajoutera a la base de donnees.
- * On associe f au pointeur f present dans la structure noeud_db_formation.
- * On initialise le prochain noeud de la liste *next a NULL.
- * Si la tete *head de la base de donnee est NULL, alors la tete devient le nouveau noeud.
- * On arrete la fonction d'ajout la.
- * Sinon, on fait une copie de la tete dans le noeud *next que l'on avait initialise a NULL.
- * On declare la tete comme etant le noeud temporaire que l'on a initialise.
+ * Cette fonction renvoie un instant en secondes, pour mesurer des durees.
+ * L'horloge monotone est utilisee si elle existe, sinon le temps processeur.
  */
-void afficher_db_formation( db_formation *dbf )
+double maintenant()
 {
-    int i;
-    db_formation *tmpdbf = dbf;
-    noeud_db_formation *tmpndbf = tmpdbf->head;
-    char jour[7][9] = { "Lundi", "Mardi", "Mercredi", "Jeudi", "Vendredi", "Samedi", "Dimanche" };
-    for( i = 1; i <= 7; i++ )
-    {
-        tmpndbf = tmpdbf->head;
-        printf( "********************************************************************************\n" );
-        printf( "Cours du: %s\n", jour[i - 1] );
-        printf( "********************************************************************************\n" );
-        while( tmpndbf != NULL )
-        {
-            formation *tmp = tmpndbf->f;
-            int j;
-            for( j = 0; j < tmp->nb_jours; j++ )
-            {
-                if( tmp->jours[j] == i )
-                {
-                    afficher_formation( tmp );
-                    printf( "De: %.2f - A %.2f\n", tmp->heures[j], tmp->heures[j] + tmp->durees[j] );
-                    printf( "Prerequis: " );
-                    if( tmp->nb_prerequis > 0 )
-                    {
-                        db_formation *tmpdb = dbf;
-                        noeud_db_formation *tmp_prereq_ndbf = tmpdb->head;
-                        while( tmp_prereq_ndbf != NULL )
-                        {
-                            formation *tmp_prereq = tmp_prereq_ndbf->f;
-                            int k;
-                            for( k = 0; k < tmp->nb_prerequis; k++ )
-                            {
-                                if( tmp->prerequis[k] == tmp_prereq->id )
-                                {
-                                    printf( "%s ", tmp_prereq->nom );
-                                }
-                            }
-                            tmp_prereq_ndbf = tmp_prereq_ndbf->next;
-                        }
-                        printf( "\n\n" );
-                    }
-                    else
-                    {
-                        printf( "Aucun\n\n" );
-                    }
-                }
-            }
-            tmpndbf = tmpndbf->next;
-        }
-    }
+#ifdef HAVE_CLOCK_GETTIME
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ( double ) ts.tv_sec + ( double ) ts.tv_nsec / 1e9;
+#else
+    return ( double ) clock() / CLOCKS_PER_SEC;
+#endif
 }
 
-/*                             FIN FORMATION                                 */
-/*****************************************************************************/
+/*
+ * Les compteurs de l'instrumentation des chemins critiques du programme.
+ * Chaque compteur cumule pour une fonction (ou une etape) son nombre d'appels, le nombre d'elements parcourus
+ * (lignes lues, personnes, formations ou cases d'un vecteur), le nombre d'octets alloues et le temps passe,
+ * mesure avec maintenant(). Le temps d'un compteur comprend celui des fonctions instrumentees qu'il appelle.
+ */
+#define CPT_CHARGEMENT_PERSONNES 0
+#define CPT_CHARGEMENT_FORMATIONS 1
+#define CPT_LIAISON 2
+#define CPT_AJOUTER_FORMATION 3
+#define CPT_SUPPRIMER_PERSONNE_DE_FORMATION 4
+#define CPT_SUPPRIMER_DB_PERSONNE 5
+#define CPT_SUPPRIMER_DB_FORMATION 6
+#define CPT_SUPPRIMER_PERSONNE_PARTOUT 7
+#define CPT_SUPPRIMER_FORMATION_PARTOUT 8
+#define CPT_GET_PERSONNE 9
+#define CPT_GET_FORMATION 10
+#define CPT_SAUVEGARDE 11
+#define CPT_ECRIRE_PLANNING 12
+#define CPT_REQUETE 13
+#define CPT_CHERCHER_SEANCES 14
+#define CPT_EMPLOIS_DU_TEMPS 15
+#define CPT_INDEXER_FORMATEURS 16
+#define CPT_FORMATEURS_LIBRES 17
+#define CPT_ATTRIBUER_SALLES 18
+#define CPT_RECHERCHE_APPROCHEE 19
+#define NB_COMPTEURS 20
 
-/*****************************************************************************/
-/*                           FONCTIONS GENERALES                             */
+/*
+ * const char *nom : Le nom du compteur, tel qu'il apparait dans les statistiques.
+ * unsigned long appels : Le nombre d'appels.
+ * unsigned long visites : Le nombre d'elements parcourus.
+ * unsigned long octets : Le nombre d'octets alloues.
+ * double temps : Le temps cumule, en secondes.
+ */
+typedef struct compteur
+{
+    const char *nom;
+    unsigned long appels;
+    unsigned long visites;
+    unsigned long octets;
+    double temps;
+} compteur;
 
-void menu_creer_formation( db_formation *f )
+/*
+ * Cette structure sert a mesurer un appel d'une fonction instrumentee, voir demarrer_compteur.
+ */
+typedef struct chrono
 {
-    db_formation *tmpdbf = f;
+    int compteur;
+    int precedent;
+    double debut;
+} chrono;
+
+compteur compteurs[ NB_COMPTEURS ] =
+{
+    { "chargement_personnes", 0, 0, 0, 0 },
+    { "chargement_formations", 0, 0, 0, 0 },
+    { "liaison", 0, 0, 0, 0 },
+    { "ajouter_formation", 0, 0, 0, 0 },
+    { "supprimer_personne_de_formation", 0, 0, 0, 0 },
+    { "supprimer_db_personne", 0, 0, 0, 0 },
+    { "supprimer_db_formation", 0, 0, 0, 0 },
+    { "supprimer_personne_partout", 0, 0, 0, 0 },
+    { "supprimer_formation_partout", 0, 0, 0, 0 },
+    { "get_personne", 0, 0, 0, 0 },
+    { "get_formation", 0, 0, 0, 0 },
+    { "sauvegarde", 0, 0, 0, 0 },
+    { "ecrire_planning", 0, 0, 0, 0 },
+    { "requete", 0, 0, 0, 0 },
+    { "chercher_seances", 0, 0, 0, 0 },
+    { "emplois_du_temps", 0, 0, 0, 0 },
+    { "indexer_formateurs", 0, 0, 0, 0 },
+    { "formateurs_libres", 0, 0, 0, 0 },
+    { "attribuer_salles", 0, 0, 0, 0 },
+    { "recherche_approchee", 0, 0, 0, 0 }
+};
+
+/*
+ * 1 si l'instrumentation est active. Quand elle ne l'est pas, chaque fonction instrumentee ne paie qu'un test.
+ * Les compteurs ne sont mis a jour que par le fil principal.
+ */
+int instrumentation = 0;
+
+/*
+ * Le compteur de la fonction instrumentee en cours, -1 si aucune. Les elements parcourus et les octets alloues
+ * sont attribues a ce compteur.
+ */
+int compteur_courant = -1;
+
+/*
+ * Cette fonction sert a commencer la mesure d'un appel de la fonction du compteur c.
+ * Chaque appel a demarrer_compteur doit etre suivi d'un appel a arreter_compteur avec le meme chrono.
+ */
+void demarrer_compteur( chrono *ch, int c )
+{
+    if( !instrumentation )
+    {
+        return;
+    }
+    ch->compteur = c;
+    ch->precedent = compteur_courant;
+    compteurs[c].appels += 1;
+    compteur_courant = c;
+    ch->debut = maintenant();
+}
+
+void arreter_compteur( chrono *ch )
+{
+    if( !instrumentation )
+    {
+        return;
+    }
+    compteurs[ ch->compteur ].temps += maintenant() - ch->debut;
+    compteur_courant = ch->precedent;
+}
+
+/*
+ * Ces fonctions servent a ajouter n elements parcourus ou n octets alloues au compteur en cours.
+ */
+void compter_visites( unsigned long n )
+{
+    if( instrumentation && compteur_courant >= 0 )
+    {
+        compteurs[ compteur_courant ].visites += n;
+    }
+}
+
+void compter_octets( unsigned long n )
+{
+    if( instrumentation && compteur_courant >= 0 )
+    {
+        compteurs[ compteur_courant ].octets += n;
+    }
+}
+
+/*
+ * Cette fonction sert a remettre tous les compteurs a zero.
+ */
+void reinitialiser_compteurs()
+{
+    int i;
+    for( i = 0; i < NB_COMPTEURS; i++ )
+    {
+        compteurs[i].appels = 0;
+        compteurs[i].visites = 0;
+        compteurs[i].octets = 0;
+        compteurs[i].temps = 0;
+    }
+    compteur_courant = -1;
+}
+
+/*
+ * Cette fonction renvoie le nombre de processeurs disponibles sur la machine, ou 1 si on ne peut pas le savoir.
+ */
+int nombre_processeurs()
+{
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf( _SC_NPROCESSORS_ONLN );
+    if( n > 0 )
+    {
+        return ( int ) n;
+    }
+#endif
+    return 1;
+}
+
+/*
+ * Le plus grand identifiant accepte dans les pages des bases de donnees.
+ */
+#define ID_MAX 16777215
+
+#define BITS_PAR_MOT ( ( int ) ( sizeof( unsigned int ) * 8 ) )
+
+/*
+ * Cette fonction sert a agrandir le vecteur de bits de l'allocateur a pour qu'il contienne le bit id.
+ */
+void agrandir_allocateur_id( allocateur_id *a, int id )
+{
+    int nb_mots = a->nb_mots ? a->nb_mots : 4;
+    unsigned int *libres;
+    if( id / BITS_PAR_MOT < a->nb_mots )
+    {
+        return;
+    }
+    while( nb_mots <= id / BITS_PAR_MOT )
+    {
+        nb_mots *= 2;
+    }
+    libres = ( unsigned int * ) ALLOUER( nb_mots, sizeof( unsigned int ), "allocateur_id" );
+    if( a->nb_mots > 0 )
+    {
+        memcpy( libres, a->libres, a->nb_mots * sizeof( unsigned int ) );
+    }
+    LIBERER( a->libres );
+    a->libres = libres;
+    a->nb_mots = nb_mots;
+}
+
+/*
+ * Cette fonction sert a signaler a l'allocateur a que l'identifiant id est utilise, par exemple lors
+ * du chargement d'un fichier. Le plus grand identifiant attribue est mis a jour si necessaire.
+ */
+void reserver_id( allocateur_id *a, int id )
+{
+    if( id > a->haut )
+    {
+        a->haut = id;
+    }
+    if( id > 0 && id / BITS_PAR_MOT < a->nb_mots &&
+        ( a->libres[ id / BITS_PAR_MOT ] & ( 1u << ( id % BITS_PAR_MOT ) ) ) )
+    {
+        a->libres[ id / BITS_PAR_MOT ] &= ~( 1u << ( id % BITS_PAR_MOT ) );
+        a->nb_libres -= 1;
+    }
+}
+
+/*
+ * Cette fonction sert a rendre l'identifiant id a l'allocateur a lorsque la personne ou la formation qui le
+ * portait est supprimee. L'identifiant n'est garde pour etre reattribue que si le recyclage est active.
+ */
+void liberer_id( allocateur_id *a, int id )
+{
+    if( !a->recycler || id <= 0 || id > a->haut || id > ID_MAX )
+    {
+        return;
+    }
+    agrandir_allocateur_id( a, id );
+    if( !( a->libres[ id / BITS_PAR_MOT ] & ( 1u << ( id % BITS_PAR_MOT ) ) ) )
+    {
+        a->libres[ id / BITS_PAR_MOT ] |= 1u << ( id % BITS_PAR_MOT );
+        a->nb_libres += 1;
+        if( id / BITS_PAR_MOT < a->premier_mot )
+        {
+            a->premier_mot = id / BITS_PAR_MOT;
+        }
+    }
+}
+
+/*
+ * Cette fonction renvoie un nouvel identifiant.
+ * Si le recyclage est active et qu'un identifiant a ete libere, on renvoie le plus petit identifiant libre,
+ * sinon on renvoie le plus grand identifiant deja attribue + 1. Les identifiants restent ainsi denses et
+ * peuvent servir d'indices dans les tables directes.
+ * On renvoie 0 quand ID_MAX est deja attribue et qu'aucun identifiant n'est libre: ranger_db_personne et
+ * ranger_db_formation refusent alors l'enregistrement.
+ */
+int allouer_id( allocateur_id *a )
+{
+    if( a->recycler && a->nb_libres > 0 )
+    {
+        int m;
+        for( m = a->premier_mot; m < a->nb_mots; m++ )
+        {
+            if( a->libres[m] != 0 )
+            {
+                int b = 0;
+                while( !( a->libres[m] & ( 1u << b ) ) )
+                {
+                    b++;
+                }
+                a->libres[m] &= ~( 1u << b );
+                a->nb_libres -= 1;
+                a->premier_mot = m;
+                return m * BITS_PAR_MOT + b;
+            }
+        }
+    }
+    if( a->haut >= ID_MAX )
+    {
+        return 0;
+    }
+    a->haut += 1;
+    return a->haut;
+}
+
+/*
+ * Cette fonction sert a liberer la memoire occupee par l'allocateur a.
+ */
+void vider_allocateur_id( allocateur_id *a )
+{
+    LIBERER( a->libres );
+    a->libres = NULL;
+    a->nb_mots = 0;
+    a->nb_libres = 0;
+    a->premier_mot = 0;
+}
+
+/*
+ * Une tache est une fonction a executer avec son argument.
+ * fonction_tache fonction : La fonction qui sera appelee par un des ouvriers du pool.
+ * void *arg : L'argument passe a la fonction.
+ */
+typedef void ( *fonction_tache )( void *arg );
+
+typedef struct tache
+{
+    fonction_tache fonction;
+    void *arg;
+} tache;
+
+#ifdef HAVE_PTHREAD_H
+/*
+ * Cette structure est la file de taches propre a chaque ouvrier du pool.
+ * L'ouvrier proprietaire prend ses taches par la fin (fin - 1), les autres ouvriers volent par le debut,
+ * ce qui limite les conflits entre le proprietaire et les voleurs.
+ * tache *taches : Le vecteur circulaire qui stocke les taches.
+ * int debut : L'indice de la plus ancienne tache.
+ * int nb : Le nombre de taches presentes dans la file.
+ * int capacite : La taille du vecteur taches.
+ * pthread_mutex_t verrou : Le verrou qui protege la file.
+ */
+typedef struct file_taches
+{
+    tache *taches;
+    int debut;
+    int nb;
+    int capacite;
+    pthread_mutex_t verrou;
+} file_taches;
+#endif
+
+/*
+ * Cette structure represente un pool d'ouvriers avec vol de taches.
+ * Chaque ouvrier possede sa propre file, les taches soumises sont reparties a tour de role entre les files,
+ * et un ouvrier dont la file est vide vole les taches des autres.
+ * int nb_ouvriers : Le nombre de threads du pool (0 si les taches sont executees directement).
+ * int prochaine : La file qui recevra la prochaine tache soumise.
+ * int nb_en_file : Le nombre de taches qui n'ont pas encore ete prises par un ouvrier.
+ * int en_attente : Le nombre de taches soumises qui ne sont pas encore terminees.
+ * int arret : 1 lorsque le pool doit s'arreter.
+ */
+typedef struct pool_taches
+{
+    int nb_ouvriers;
+    int prochaine;
+    int nb_en_file;
+    int en_attente;
+    int arret;
+#ifdef HAVE_PTHREAD_H
+    file_taches *files;
+    pthread_t *threads;
+    pthread_mutex_t verrou;
+    pthread_cond_t travail;
+    pthread_cond_t termine;
+#endif
+} pool_taches;
+
+#ifdef HAVE_PTHREAD_H
+/*
+ * Argument transmis a chaque thread du pool: le pool lui-meme et l'indice de la file de l'ouvrier.
+ */
+typedef struct ouvrier_pool
+{
+    pool_taches *pool;
+    int indice;
+} ouvrier_pool;
+
+/*
+ * Cette fonction sert a prendre une tache pour l'ouvrier indice.
+ * On essaie d'abord sa propre file par la fin, puis on vole par le debut les files des autres ouvriers.
+ * On renvoie 1 si une tache a ete trouvee, 0 sinon.
+ */
+int prendre_tache( pool_taches *pool, int indice, tache *t )
+{
+    int i;
+    for( i = 0; i < pool->nb_ouvriers; i++ )
+    {
+        file_taches *file = &pool->files[ ( indice + i ) % pool->nb_ouvriers ];
+        int trouve = 0;
+        pthread_mutex_lock( &file->verrou );
+        if( file->nb > 0 )
+        {
+            if( i == 0 )
+            {
+                *t = file->taches[ ( file->debut + file->nb - 1 ) % file->capacite ];
+            }
+            else
+            {
+                *t = file->taches[ file->debut ];
+                file->debut = ( file->debut + 1 ) % file->capacite;
+            }
+            file->nb -= 1;
+            trouve = 1;
+        }
+        pthread_mutex_unlock( &file->verrou );
+        if( trouve )
+        {
+            pthread_mutex_lock( &pool->verrou );
+            pool->nb_en_file -= 1;
+            pthread_mutex_unlock( &pool->verrou );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Boucle principale d'un ouvrier: il execute des taches tant qu'il en trouve, puis s'endort jusqu'a ce que
+ * de nouvelles taches soient soumises ou que le pool soit arrete.
+ */
+void *boucle_ouvrier( void *arg )
+{
+    ouvrier_pool *ouvrier = ( ouvrier_pool * ) arg;
+    pool_taches *pool = ouvrier->pool;
+    tache t;
+    for( ;; )
+    {
+        if( prendre_tache( pool, ouvrier->indice, &t ) )
+        {
+            t.fonction( t.arg );
+            pthread_mutex_lock( &pool->verrou );
+            pool->en_attente -= 1;
+            if( pool->en_attente == 0 )
+            {
+                pthread_cond_broadcast( &pool->termine );
+            }
+            pthread_mutex_unlock( &pool->verrou );
+            continue;
+        }
+        pthread_mutex_lock( &pool->verrou );
+        while( pool->nb_en_file == 0 && !pool->arret )
+        {
+            pthread_cond_wait( &pool->travail, &pool->verrou );
+        }
+        if( pool->arret && pool->nb_en_file == 0 )
+        {
+            pthread_mutex_unlock( &pool->verrou );
+            break;
+        }
+        pthread_mutex_unlock( &pool->verrou );
+    }
+    LIBERER( ouvrier );
+    return NULL;
+}
+#endif
+
+/*
+ * Cette fonction sert a creer un pool de nb_ouvriers threads.
+ * Si nb_ouvriers vaut 0, ou si le programme est compile sans pthread, les taches seront executees
+ * directement par le thread qui les soumet.
+ */
+pool_taches *creer_pool_taches( int nb_ouvriers )
+{
+    pool_taches *pool = ( pool_taches * ) ALLOUER( 1, sizeof( pool_taches ), "pool_taches" );
+#ifdef HAVE_PTHREAD_H
+    int i;
+    pthread_mutex_init( &pool->verrou, NULL );
+    pthread_cond_init( &pool->travail, NULL );
+    pthread_cond_init( &pool->termine, NULL );
+    if( nb_ouvriers > 0 )
+    {
+        pool->files = ( file_taches * ) ALLOUER( nb_ouvriers, sizeof( file_taches ), "file_taches" );
+        pool->threads = ( pthread_t * ) ALLOUER( nb_ouvriers, sizeof( pthread_t ), "pthread_t" );
+    }
+    for( i = 0; i < nb_ouvriers; i++ )
+    {
+        pthread_mutex_init( &pool->files[i].verrou, NULL );
+    }
+    pool->nb_ouvriers = nb_ouvriers;
+    for( i = 0; i < nb_ouvriers; i++ )
+    {
+        ouvrier_pool *ouvrier = ( ouvrier_pool * ) ALLOUER( 1, sizeof( ouvrier_pool ), "ouvrier_pool" );
+        ouvrier->pool = pool;
+        ouvrier->indice = i;
+        if( pthread_create( &pool->threads[i], NULL, boucle_ouvrier, ouvrier ) != 0 )
+        {
+            LIBERER( ouvrier );
+            pool->nb_ouvriers = i;
+            break;
+        }
+    }
+#else
+    ( void ) nb_ouvriers;
+    pool->nb_ouvriers = 0;
+#endif
+    return pool;
+}
+
+/*
+ * Cette fonction sert a soumettre une tache au pool. La tache est placee dans la file de l'ouvrier suivant,
+ * a tour de role, et un ouvrier endormi est reveille.
+ */
+void soumettre_tache( pool_taches *pool, fonction_tache fonction, void *arg )
+{
+#ifdef HAVE_PTHREAD_H
+    file_taches *file;
+    if( pool->nb_ouvriers == 0 )
+    {
+        fonction( arg );
+        return;
+    }
+    file = &pool->files[ pool->prochaine ];
+    pool->prochaine = ( pool->prochaine + 1 ) % pool->nb_ouvriers;
+    pthread_mutex_lock( &file->verrou );
+    if( file->nb == file->capacite )
+    {
+        int capacite = file->capacite ? file->capacite * 2 : 16;
+        tache *taches = ( tache * ) ALLOUER( capacite, sizeof( tache ), "tache" );
+        int i;
+        for( i = 0; i < file->nb; i++ )
+        {
+            taches[i] = file->taches[ ( file->debut + i ) % file->capacite ];
+        }
+        LIBERER( file->taches );
+        file->taches = taches;
+        file->debut = 0;
+        file->capacite = capacite;
+    }
+    file->taches[ ( file->debut + file->nb ) % file->capacite ].fonction = fonction;
+    file->taches[ ( file->debut + file->nb ) % file->capacite ].arg = arg;
+    file->nb += 1;
+    pthread_mutex_unlock( &file->verrou );
+    pthread_mutex_lock( &pool->verrou );
+    pool->nb_en_file += 1;
+    pool->en_attente += 1;
+    pthread_cond_signal( &pool->travail );
+    pthread_mutex_unlock( &pool->verrou );
+#else
+    ( void ) pool;
+    fonction( arg );
+#endif
+}
+
+/*
+ * Cette fonction bloque jusqu'a ce que toutes les taches soumises au pool soient terminees.
+ */
+void attendre_pool_taches( pool_taches *pool )
+{
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock( &pool->verrou );
+    while( pool->en_attente > 0 )
+    {
+        pthread_cond_wait( &pool->termine, &pool->verrou );
+    }
+    pthread_mutex_unlock( &pool->verrou );
+#else
+    ( void ) pool;
+#endif
+}
+
+/*
+ * Cette fonction sert a arreter les ouvriers du pool, une fois leurs taches terminees,
+ * puis a liberer la memoire qu'il occupait.
+ */
+void detruire_pool_taches( pool_taches *pool )
+{
+#ifdef HAVE_PTHREAD_H
+    int i;
+    pthread_mutex_lock( &pool->verrou );
+    pool->arret = 1;
+    pthread_cond_broadcast( &pool->travail );
+    pthread_mutex_unlock( &pool->verrou );
+    for( i = 0; i < pool->nb_ouvriers; i++ )
+    {
+        pthread_join( pool->threads[i], NULL );
+    }
+    for( i = 0; i < pool->nb_ouvriers; i++ )
+    {
+        pthread_mutex_destroy( &pool->files[i].verrou );
+        LIBERER( pool->files[i].taches );
+    }
+    pthread_cond_destroy( &pool->termine );
+    pthread_cond_destroy( &pool->travail );
+    pthread_mutex_destroy( &pool->verrou );
+    LIBERER( pool->files );
+    LIBERER( pool->threads );
+#endif
+    LIBERER( pool );
+}
+
+/*
+ * Les noms sont ecrits en UTF-8. Leur cle de recherche est le nom plie: les lettres ASCII en minuscules, les
+ * lettres accentuees latines (U+00C0 a U+017F) remplacees par leur lettre de base et les ligatures (ae, oe, ij,
+ * ss, th) ecrites en deux lettres. Les autres caracteres sont gardes tels quels, une cle n'est donc jamais plus
+ * longue que son nom. Dans ces tables, '.' marque un caractere garde ou une ligature.
+ */
+const char lettres_latin1[] = "aaaaaa.ceeeeiiiidnooooo.ouuuuy..aaaaaa.ceeeeiiiidnooooo.ouuuuy.y";
+const char lettres_latin_etendu[] = "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiii..jjkkklllllll"
+                                    "lllnnnnnnnnnoooooo..rrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+
+/*
+ * Cette fonction renvoie la longueur (de 1 a 4 octets) du caractere UTF-8 qui commence en c et ecrit son code
+ * dans *code. On renvoie 0 si la sequence est invalide ou coupee (octet de suite manquant, forme trop longue,
+ * code hors limites).
+ */
+int decoder_utf8( const char *c, unsigned long *code )
+{
+    const unsigned char *o = ( const unsigned char * ) c;
+    unsigned long minimum;
+    int n, i;
+    if( o[0] < 0x80 )
+    {
+        *code = o[0];
+        return 1;
+    }
+    if( ( o[0] & 0xE0 ) == 0xC0 )
+    {
+        n = 2;
+        *code = o[0] & 0x1F;
+        minimum = 0x80;
+    }
+    else if( ( o[0] & 0xF0 ) == 0xE0 )
+    {
+        n = 3;
+        *code = o[0] & 0x0F;
+        minimum = 0x800;
+    }
+    else if( ( o[0] & 0xF8 ) == 0xF0 )
+    {
+        n = 4;
+        *code = o[0] & 0x07;
+        minimum = 0x10000;
+    }
+    else
+    {
+        return 0;
+    }
+    for( i = 1; i < n; i++ )
+    {
+        if( ( o[i] & 0xC0 ) != 0x80 )
+        {
+            return 0;
+        }
+        *code = ( *code << 6 ) | ( o[i] & 0x3F );
+    }
+    if( *code < minimum || *code > 0x10FFFF || ( *code >= 0xD800 && *code <= 0xDFFF ) )
+    {
+        return 0;
+    }
+    return n;
+}
+
+/*
+ * Cette fonction renvoie 1 si texte est de l'UTF-8 valide, 0 si pas.
+ */
+int utf8_valide( const char *texte )
+{
+    unsigned long code;
+    int n;
+    for( ; *texte != '\0'; texte += n )
+    {
+        n = decoder_utf8( texte, &code );
+        if( n == 0 )
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Cette fonction sert a retirer de la fin de texte un caractere UTF-8 coupe, par exemple par une saisie limitee
+ * en octets. Le reste du texte n'est pas touche.
+ */
+void couper_utf8( char *texte )
+{
+    size_t n = strlen( texte ), debut = n;
+    unsigned long code;
+    while( debut > 0 && n - debut < 3 && ( ( unsigned char ) texte[ debut - 1 ] & 0xC0 ) == 0x80 )
+    {
+        debut--;
+    }
+    if( debut > 0 && ( unsigned char ) texte[ debut - 1 ] >= 0xC0 && decoder_utf8( texte + debut - 1, &code ) == 0 )
+    {
+        texte[ debut - 1 ] = '\0';
+    }
+}
+
+/*
+ * Cette fonction sert a lire au clavier un mot (jusqu'au prochain espace) dans mot, qui peut contenir taille
+ * octets. Un mot trop long est coupe sans couper de caractere UTF-8 et la fin du mot est ignoree, pour qu'elle ne
+ * soit pas lue comme la reponse suivante. On renvoie 0 a la fin de l'entree.
+ */
+int lire_mot( char *mot, size_t taille )
+{
+    size_t n = 0;
+    int c = getchar();
+    while( c != EOF && isspace( c ) )
+    {
+        c = getchar();
+    }
+    while( c != EOF && !isspace( c ) )
+    {
+        if( n + 1 < taille )
+        {
+            mot[ n++ ] = ( char ) c;
+        }
+        c = getchar();
+    }
+    if( c != EOF )
+    {
+        ungetc( c, stdin );
+    }
+    mot[n] = '\0';
+    couper_utf8( mot );
+    return n > 0;
+}
+
+/*
+ * Cette fonction renvoie la largeur a donner a printf ("%-*s") pour que texte occupe colonnes caracteres: printf
+ * compte des octets, un caractere UTF-8 de plusieurs octets demande donc autant de place en plus.
+ */
+int largeur_utf8( const char *texte, int colonnes )
+{
+    for( ; *texte != '\0'; texte++ )
+    {
+        colonnes += ( ( unsigned char ) *texte & 0xC0 ) == 0x80;
+    }
+    return colonnes;
+}
+
+/*
+ * Cette fonction sert a ecrire dans cle la cle pliee de texte. cle doit pouvoir contenir strlen( texte ) + 1
+ * octets.
+ */
+void plier_nom( const char *texte, char *cle )
+{
+    unsigned long code;
+    int n;
+    while( *texte != '\0' )
+    {
+        const char *ligature = NULL;
+        char lettre = '.';
+        n = decoder_utf8( texte, &code );
+        if( n <= 1 )
+        {
+            *cle++ = ( char ) tolower( ( unsigned char ) *texte++ );
+            continue;
+        }
+        switch( code )
+        {
+            case 0xC6:
+            case 0xE6:
+                ligature = "ae";
+                break;
+            case 0xDE:
+            case 0xFE:
+                ligature = "th";
+                break;
+            case 0xDF:
+                ligature = "ss";
+                break;
+            case 0x132:
+            case 0x133:
+                ligature = "ij";
+                break;
+            case 0x152:
+            case 0x153:
+                ligature = "oe";
+                break;
+            default:
+                if( code >= 0xC0 && code < 0x100 )
+                {
+                    lettre = lettres_latin1[ code - 0xC0 ];
+                }
+                else if( code >= 0x100 && code < 0x180 )
+                {
+                    lettre = lettres_latin_etendu[ code - 0x100 ];
+                }
+                break;
+        }
+        if( ligature != NULL )
+        {
+            *cle++ = ligature[0];
+            *cle++ = ligature[1];
+        }
+        else if( lettre != '.' )
+        {
+            *cle++ = lettre;
+        }
+        else
+        {
+            memcpy( cle, texte, n );
+            cle += n;
+        }
+        texte += n;
+    }
+    *cle = '\0';
+}
+
+/*
+ * Les noms et les prenoms des personnes et les noms des formations sont internes: chaque texte distinct n'est
+ * stocke qu'une fois, dans une chaine_internee qui garde aussi son hachage et sa longueur, et les enregistrements
+ * pointent sur son texte. Deux textes internes sont egaux si et seulement si leurs pointeurs sont egaux.
+ * unsigned long hachage : Le hachage FNV-1a du texte.
+ * int longueur : La longueur du texte.
+ * int references : Le nombre d'enregistrements qui pointent sur le texte, il est libere quand il n'y en a plus.
+ * const char *pliee : La cle pliee du texte (voir plier_nom), internee elle aussi: deux noms sont egaux sans
+ * tenir compte des majuscules et des accents si et seulement si leurs cles sont egales. C'est le texte lui-meme
+ * s'il est deja plie.
+ * int nb_trigrammes, int *places : Pour une cle pliee, le nombre de ses trigrammes distincts et sa position dans
+ * la liste de chacun d'eux (voir index_trigrammes), allouees a la suite du texte. NULL pour les autres textes.
+ * unsigned long epoque, int communs : Le nombre de trigrammes partages avec la cle cherchee par la derniere
+ * recherche approchee qui a rencontre la cle, et le numero de cette recherche.
+ * char texte[1] : Le texte, alloue a sa longueur.
+ * Les chaines sont rangees dans une table de hachage a adressage ouvert. Seul le fil principal interne ou relache
+ * des chaines, les taches du pool ne font que lire les noms.
+ * LONGUEUR_NOM_MAX est la longueur maximale d'un nom lu au clavier ou dans un fichier.
+ */
+#define LONGUEUR_NOM_MAX 255
+#define TEXTE( x ) #x
+#define EN_TEXTE( x ) TEXTE( x )
+
+typedef struct chaine_internee
+{
+    unsigned long hachage;
+    int longueur;
+    int references;
+    const char *pliee;
+    int nb_trigrammes;
+    int *places;
+    unsigned long epoque;
+    int communs;
+    char texte[1];
+} chaine_internee;
+
+typedef struct table_chaines
+{
+    chaine_internee **cases;
+    int capacite;
+    int nb;
+    int nb_tombes;
+} table_chaines;
+
+table_chaines chaines_internees;
+
+/*
+ * Une case de la table des chaines qui a contenu une chaine liberee (pierre tombale).
+ */
+chaine_internee case_chaine_retiree;
+
+/*
+ * Cette fonction renvoie le hachage FNV-1a du texte et ecrit sa longueur dans *longueur.
+ */
+unsigned long hacher_chaine( const char *texte, int *longueur )
+{
+    unsigned long h = 2166136261UL;
+    const char *c;
+    for( c = texte; *c; c++ )
+    {
+        h = ( ( h ^ ( unsigned char ) *c ) * 16777619UL ) & 0xFFFFFFFFUL;
+    }
+    *longueur = ( int ) ( c - texte );
+    return h;
+}
+
+/*
+ * Cette fonction renvoie la chaine internee dont texte est le texte.
+ */
+chaine_internee *chaine_de_texte( const char *texte )
+{
+    return ( chaine_internee * ) ( texte - offsetof( chaine_internee, texte ) );
+}
+
+/*
+ * Cette fonction renvoie la case de la table des chaines ou se trouve le texte, ou la case ou il devrait etre
+ * ajoute. Le hachage et la longueur sont compares avant le texte.
+ */
+int chercher_case_chaine( table_chaines *t, const char *texte, unsigned long h, int longueur )
+{
+    int i = ( int ) ( h & ( unsigned long ) ( t->capacite - 1 ) ), tombe = -1;
+    for( ;; )
+    {
+        chaine_internee *ch = t->cases[i];
+        if( ch == NULL )
+        {
+            return tombe >= 0 ? tombe : i;
+        }
+        if( ch == &case_chaine_retiree )
+        {
+            if( tombe < 0 )
+            {
+                tombe = i;
+            }
+        }
+        else if( ch->hachage == h && ch->longueur == longueur && memcmp( ch->texte, texte, longueur ) == 0 )
+        {
+            return i;
+        }
+        i = ( i + 1 ) & ( t->capacite - 1 );
+    }
+}
+
+/*
+ * Cette fonction sert a agrandir (ou a nettoyer de ses pierres tombales) la table des chaines quand elle est
+ * remplie aux trois quarts.
+ */
+void agrandir_table_chaines( table_chaines *t )
+{
+    chaine_internee **anciennes = t->cases;
+    int ancienne_capacite = t->capacite, i;
+    if( t->capacite > 0 && ( t->nb + t->nb_tombes + 1 ) * 4 < t->capacite * 3 )
+    {
+        return;
+    }
+    while( t->capacite == 0 || ( t->nb + 1 ) * 2 > t->capacite )
+    {
+        t->capacite = t->capacite ? t->capacite * 2 : 256;
+    }
+    t->cases = ( chaine_internee ** ) ALLOUER( t->capacite, sizeof( chaine_internee * ), "table_chaines" );
+    t->nb_tombes = 0;
+    for( i = 0; i < ancienne_capacite; i++ )
+    {
+        if( anciennes[i] != NULL && anciennes[i] != &case_chaine_retiree )
+        {
+            chaine_internee *ch = anciennes[i];
+            t->cases[ chercher_case_chaine( t, ch->texte, ch->hachage, ch->longueur ) ] = ch;
+        }
+    }
+    LIBERER( anciennes );
+}
+
+/*
+ * L'index des trigrammes sert a la recherche approchee des noms (voir chercher_cles_proches). Chaque cle pliee
+ * internee y est rangee sous chacun de ses trigrammes distincts: les suites de trois octets de la cle precedee
+ * de deux espaces et suivie d'un espace ("  d", " du", "dup", ..., "nt " pour dupont). Il est tenu a jour par
+ * interner et relacher.
+ * unsigned long code : Les trois octets du trigramme, 0 pour une case vide.
+ * chaine_internee **chaines, unsigned short *rangs : Les cles qui contiennent le trigramme, nb sur capacite, et
+ * le rang du trigramme parmi ceux de chacune. Une cle retiree est remplacee par la derniere de la liste, dont la
+ * position est corrigee dans ses places.
+ * Les trigrammes sont ranges dans une table de hachage a adressage ouvert, ils n'en sont jamais retires (leur
+ * liste peut etre vide) tant qu'il reste des chaines internees.
+ */
+typedef struct trigramme
+{
+    unsigned long code;
+    chaine_internee **chaines;
+    unsigned short *rangs;
+    int nb;
+    int capacite;
+} trigramme;
+
+typedef struct index_trigrammes
+{
+    trigramme *cases;
+    int capacite;
+    int nb;
+    unsigned long epoque;
+} index_trigrammes;
+
+index_trigrammes trigrammes;
+
+/*
+ * Cette fonction ecrit dans codes les trigrammes distincts de la cle de longueur longueur, dans l'ordre ou ils
+ * apparaissent, et renvoie leur nombre. codes doit pouvoir en recevoir longueur + 1.
+ */
+int trigrammes_cle( const char *cle, int longueur, unsigned long codes[] )
+{
+    int i, x, k, nb = 0;
+    for( i = 0; i <= longueur; i++ )
+    {
+        unsigned long code = 0;
+        for( x = i; x < i + 3; x++ )
+        {
+            code = ( code << 8 ) | ( x < 2 || x - 2 >= longueur ? ' ' : ( unsigned char ) cle[ x - 2 ] );
+        }
+        for( k = 0; k < nb && codes[k] != code; k++ )
+        {
+        }
+        if( k == nb )
+        {
+            codes[ nb++ ] = code;
+        }
+    }
+    return nb;
+}
+
+/*
+ * Cette fonction renvoie la case de l'index ou se trouve le trigramme code, ou la case vide ou il devrait etre
+ * ajoute.
+ */
+int case_trigramme( index_trigrammes *index, unsigned long code )
+{
+    unsigned long h = ( code * 2654435761UL ) & 0xFFFFFFFFUL;
+    int i = ( int ) ( ( h ^ ( h >> 16 ) ) & ( unsigned long ) ( index->capacite - 1 ) );
+    while( index->cases[i].code != 0 && index->cases[i].code != code )
+    {
+        i = ( i + 1 ) & ( index->capacite - 1 );
+    }
+    return i;
+}
+
+/*
+ * Cette fonction renvoie le trigramme code de l'index, en l'ajoutant si creer vaut 1, l'index est agrandi quand
+ * il est rempli aux deux tiers. Elle renvoie NULL s'il n'y est pas et que creer vaut 0. Le pointeur renvoye
+ * n'est valable que jusqu'au prochain ajout.
+ */
+trigramme *trouver_trigramme( unsigned long code, int creer )
+{
+    index_trigrammes *index = &trigrammes;
+    int i;
+    if( creer && ( index->nb + 1 ) * 3 > index->capacite * 2 )
+    {
+        trigramme *anciens = index->cases;
+        int ancienne_capacite = index->capacite;
+        index->capacite = index->capacite ? index->capacite * 2 : 1024;
+        index->cases = ( trigramme * ) ALLOUER( index->capacite, sizeof( trigramme ), "index_trigrammes" );
+        for( i = 0; i < ancienne_capacite; i++ )
+        {
+            if( anciens[i].code != 0 )
+            {
+                index->cases[ case_trigramme( index, anciens[i].code ) ] = anciens[i];
+            }
+        }
+        LIBERER( anciens );
+    }
+    if( index->capacite == 0 )
+    {
+        return NULL;
+    }
+    i = case_trigramme( index, code );
+    if( index->cases[i].code == 0 )
+    {
+        if( !creer )
+        {
+            return NULL;
+        }
+        index->cases[i].code = code;
+        index->nb += 1;
+    }
+    return &index->cases[i];
+}
+
+/*
+ * Cette fonction sert a ranger la cle pliee ch sous chacun de ses nb_trigrammes trigrammes codes, ch->places
+ * doit pouvoir recevoir leurs positions.
+ */
+void indexer_trigrammes( chaine_internee *ch, const unsigned long codes[] )
+{
+    int j;
+    for( j = 0; j < ch->nb_trigrammes; j++ )
+    {
+        trigramme *t = trouver_trigramme( codes[j], 1 );
+        if( t->nb == t->capacite )
+        {
+            t->capacite = t->capacite ? t->capacite * 2 : 4;
+            t->chaines = ( chaine_internee ** ) REALLOUER( t->chaines, t->capacite * sizeof( chaine_internee * ),
+                                                           "trigramme" );
+            t->rangs = ( unsigned short * ) REALLOUER( t->rangs, t->capacite * sizeof( unsigned short ), "trigramme" );
+        }
+        ch->places[j] = t->nb;
+        t->chaines[ t->nb ] = ch;
+        t->rangs[ t->nb++ ] = ( unsigned short ) j;
+    }
+}
+
+/*
+ * Cette fonction sert a retirer la cle pliee ch de l'index des trigrammes, avant qu'elle soit liberee.
+ */
+void desindexer_trigrammes( chaine_internee *ch )
+{
+    unsigned long codes[ LONGUEUR_NOM_MAX + 1 ];
+    int j;
+    trigrammes_cle( ch->texte, ch->longueur, codes );
+    for( j = 0; j < ch->nb_trigrammes; j++ )
+    {
+        trigramme *t = trouver_trigramme( codes[j], 0 );
+        t->nb -= 1;
+        t->chaines[ ch->places[j] ] = t->chaines[ t->nb ];
+        t->rangs[ ch->places[j] ] = t->rangs[ t->nb ];
+        t->chaines[ t->nb ]->places[ t->rangs[ t->nb ] ] = ch->places[j];
+    }
+    ch->places = NULL;
+}
+
+/*
+ * Cette fonction sert a liberer l'index des trigrammes, quand il n'y a plus de chaine internee.
+ */
+void vider_index_trigrammes( void )
+{
+    int i;
+    for( i = 0; i < trigrammes.capacite; i++ )
+    {
+        LIBERER( trigrammes.cases[i].chaines );
+        LIBERER( trigrammes.cases[i].rangs );
+    }
+    LIBERER( trigrammes.cases );
+    memset( &trigrammes, 0, sizeof( index_trigrammes ) );
+}
+
+/*
+ * Cette fonction renvoie le texte interne egal a texte, en l'ajoutant a la table s'il n'y est pas encore (et a
+ * l'index des trigrammes si c'est une cle pliee). Chaque appel prend une reference, qui doit etre rendue par
+ * relacher.
+ * Les saisies et les fichiers n'acceptent pas de nom de plus de LONGUEUR_NOM_MAX octets. Un texte plus long
+ * serait garde tel quel, comme sa propre cle, sans etre range dans l'index des trigrammes.
+ */
+const char *interner( const char *texte )
+{
+    table_chaines *t = &chaines_internees;
+    chaine_internee *ch;
+    int longueur, i;
+    unsigned long h = hacher_chaine( texte, &longueur );
+    agrandir_table_chaines( t );
+    i = chercher_case_chaine( t, texte, h, longueur );
+    ch = t->cases[i];
+    if( ch == NULL || ch == &case_chaine_retiree )
+    {
+        char cle[ LONGUEUR_NOM_MAX + 1 ];
+        unsigned long codes[ LONGUEUR_NOM_MAX + 1 ];
+        const char *pliee = NULL;
+        size_t taille = offsetof( chaine_internee, texte ) + longueur + 1, places = 0;
+        int nb_codes = 0, indexee = longueur <= LONGUEUR_NOM_MAX;
+        if( indexee )
+        {
+            plier_nom( texte, cle );
+        }
+        if( indexee && strcmp( cle, texte ) != 0 )
+        {
+            pliee = interner( cle );
+            agrandir_table_chaines( t );
+            i = chercher_case_chaine( t, texte, h, longueur );
+            indexee = 0;
+        }
+        else if( indexee )
+        {
+            /*
+             * Une cle pliee garde les positions de ses trigrammes a la suite de son texte.
+             */
+            nb_codes = trigrammes_cle( texte, longueur, codes );
+            places = ( taille + sizeof( int ) - 1 ) / sizeof( int );
+            taille = ( places + nb_codes ) * sizeof( int );
+        }
+        ch = t->cases[i];
+        t->nb_tombes -= ch == &case_chaine_retiree;
+        taille = taille > sizeof( chaine_internee ) ? taille : sizeof( chaine_internee );
+        ch = ( chaine_internee * ) ALLOUER( 1, taille, "chaine_internee" );
+        compter_octets( taille );
+        ch->hachage = h;
+        ch->longueur = longueur;
+        memcpy( ch->texte, texte, longueur + 1 );
+        ch->pliee = pliee != NULL ? pliee : ch->texte;
+        t->cases[i] = ch;
+        t->nb += 1;
+        if( indexee )
+        {
+            ch->places = ( int * ) ch + places;
+            ch->nb_trigrammes = nb_codes;
+            indexer_trigrammes( ch, codes );
+        }
+    }
+    ch->references += 1;
+    return ch->texte;
+}
+
+/*
+ * Cette fonction renvoie le texte interne egal a texte sans prendre de reference, NULL si aucun enregistrement
+ * ne porte ce texte.
+ */
+const char *chaine_existante( const char *texte )
+{
+    table_chaines *t = &chaines_internees;
+    chaine_internee *ch;
+    int longueur;
+    unsigned long h;
+    if( t->nb == 0 )
+    {
+        return NULL;
+    }
+    h = hacher_chaine( texte, &longueur );
+    ch = t->cases[ chercher_case_chaine( t, texte, h, longueur ) ];
+    return ch == NULL || ch == &case_chaine_retiree ? NULL : ch->texte;
+}
+
+/*
+ * Cette fonction sert a rendre une reference prise par interner sur texte (rien si texte vaut NULL). La chaine
+ * est liberee quand sa derniere reference est rendue, avec sa reference sur sa cle pliee, et la table quand elle
+ * n'a plus de chaine.
+ */
+void relacher( const char *texte )
+{
+    table_chaines *t = &chaines_internees;
+    chaine_internee *ch;
+    const char *pliee;
+    if( texte == NULL )
+    {
+        return;
+    }
+    ch = chaine_de_texte( texte );
+    ch->references -= 1;
+    if( ch->references > 0 )
+    {
+        return;
+    }
+    t->cases[ chercher_case_chaine( t, ch->texte, ch->hachage, ch->longueur ) ] = &case_chaine_retiree;
+    t->nb -= 1;
+    t->nb_tombes += 1;
+    pliee = ch->pliee != ch->texte ? ch->pliee : NULL;
+    if( ch->places != NULL )
+    {
+        desindexer_trigrammes( ch );
+    }
+    LIBERER( ch );
+    if( t->nb == 0 )
+    {
+        LIBERER( t->cases );
+        memset( t, 0, sizeof( table_chaines ) );
+        vider_index_trigrammes();
+    }
+    relacher( pliee );
+}
+
+/*
+ * Cette fonction renvoie la longueur d'un texte interne, sans le parcourir.
+ */
+int longueur_chaine( const char *texte )
+{
+    return chaine_de_texte( texte )->longueur;
+}
+
+/*
+ * Cette fonction renvoie une estimation de la memoire occupee par les chaines internees, leur table et l'index
+ * des trigrammes. Une cle pliee occupe aussi les positions de ses trigrammes, a la suite de son texte.
+ */
+unsigned long estimer_octets_chaines( void )
+{
+    unsigned long octets;
+    int i;
+    octets = ( unsigned long ) chaines_internees.capacite * sizeof( chaine_internee * );
+    for( i = 0; i < chaines_internees.capacite; i++ )
+    {
+        chaine_internee *ch = chaines_internees.cases[i];
+        unsigned long taille;
+        if( ch == NULL || ch == &case_chaine_retiree )
+        {
+            continue;
+        }
+        if( ch->places != NULL )
+        {
+            taille = ( unsigned long ) ( ( char * ) ( ch->places + ch->nb_trigrammes ) - ( char * ) ch );
+        }
+        else
+        {
+            taille = ( unsigned long ) ( offsetof( chaine_internee, texte ) + ch->longueur + 1 );
+        }
+        octets += taille > sizeof( chaine_internee ) ? taille : sizeof( chaine_internee );
+    }
+    octets += ( unsigned long ) trigrammes.capacite * sizeof( trigramme );
+    for( i = 0; i < trigrammes.capacite; i++ )
+    {
+        octets += ( unsigned long ) trigrammes.cases[i].capacite *
+                  ( sizeof( chaine_internee * ) + sizeof( unsigned short ) );
+    }
+    return octets;
+}
+
+/*
+ * Cette fonction renvoie la cle pliee d'un texte interne.
+ */
+const char *cle_pliee( const char *texte )
+{
+    return chaine_de_texte( texte )->pliee;
+}
+
+/*
+ * Cette fonction compare deux textes internes dans l'ordre des noms: d'abord par leurs cles pliees, puis, a cles
+ * egales, octet par octet. Les noms qui ne different que par les majuscules ou les accents se suivent donc.
+ */
+int comparer_noms( const char *a, const char *b )
+{
+    const char *ca, *cb;
+    int res;
+    if( a == b )
+    {
+        return 0;
+    }
+    ca = cle_pliee( a );
+    cb = cle_pliee( b );
+    res = ca == cb ? 0 : strcmp( ca, cb );
+    return res != 0 ? res : strcmp( a, b );
+}
+
+/*
+ * Cette fonction renvoie la distance d'edition entre les textes a et b, octet par octet: le nombre minimal
+ * d'insertions, de suppressions, de remplacements et d'echanges de deux octets voisins pour passer de l'un a
+ * l'autre (dupont et dupnot sont a distance 1). Les textes comptent au plus LONGUEUR_NOM_MAX octets, sinon on
+ * renvoie la longueur du plus long, qui majore leur distance.
+ */
+int distance_edition( const char *a, const char *b )
+{
+    int la = ( int ) strlen( a ), lb = ( int ) strlen( b ), i, j;
+    int lignes[3][ LONGUEUR_NOM_MAX + 1 ];
+    int *avant = lignes[0], *precedente = lignes[1], *courante = lignes[2], *tmp;
+    if( la > LONGUEUR_NOM_MAX || lb > LONGUEUR_NOM_MAX )
+    {
+        return la > lb ? la : lb;
+    }
+    for( j = 0; j <= lb; j++ )
+    {
+        precedente[j] = j;
+    }
+    for( i = 1; i <= la; i++ )
+    {
+        courante[0] = i;
+        for( j = 1; j <= lb; j++ )
+        {
+            int d = precedente[ j - 1 ] + ( a[ i - 1 ] != b[ j - 1 ] );
+            if( precedente[j] + 1 < d )
+            {
+                d = precedente[j] + 1;
+            }
+            if( courante[ j - 1 ] + 1 < d )
+            {
+                d = courante[ j - 1 ] + 1;
+            }
+            if( i > 1 && j > 1 && a[ i - 1 ] == b[ j - 2 ] && a[ i - 2 ] == b[ j - 1 ] && avant[ j - 2 ] + 1 < d )
+            {
+                d = avant[ j - 2 ] + 1;
+            }
+            courante[j] = d;
+        }
+        tmp = avant;
+        avant = precedente;
+        precedente = courante;
+        courante = tmp;
+    }
+    return precedente[ lb ];
+}
+
+/*
+ * Une cle pliee trouvee par chercher_cles_proches.
+ * const char *cle : La cle, internee.
+ * int distance : Sa distance d'edition a la cle cherchee.
+ * int nb : Le nombre d'enregistrements qui la portent.
+ */
+typedef struct cle_proche
+{
+    const char *cle;
+    int distance;
+    int nb;
+} cle_proche;
+
+/*
+ * Cette fonction sert a chercher les cles pliees les plus proches de la cle de texte, au sens de
+ * distance_edition, parmi celles qui partagent au moins un trigramme avec elle. compter( contexte, cle ) donne
+ * le nombre d'enregistrements qui portent une cle, celles qu'aucun ne porte sont ignorees. On garde les cles les
+ * plus proches jusqu'a ce qu'elles portent ensemble au moins k enregistrements, avec toutes celles a la meme
+ * distance que la derniere, triees par distance puis par cle. Elles sont mises dans *proches (a liberer par
+ * LIBERER) et on renvoie leur nombre.
+ * Les trigrammes donnent a chaque cle rencontree une borne inferieure de sa distance: une modification detruit
+ * ou cree au plus quatre trigrammes, et ne change la longueur que d'un octet. Les cles sont rangees par borne
+ * croissante et la distance exacte n'est calculee que tant que la borne ne depasse pas la distance de la
+ * derniere cle gardee. Un texte de plus de LONGUEUR_NOM_MAX octets n'a aucune cle proche.
+ */
+int chercher_cles_proches( const char *texte, int k, int ( *compter )( void *, const char * ), void *contexte,
+                           cle_proche **proches )
+{
+    index_trigrammes *index = &trigrammes;
+    int longueur = ( int ) strlen( texte );
+    char cle[ LONGUEUR_NOM_MAX + 1 ];
+    unsigned long codes[ LONGUEUR_NOM_MAX + 1 ];
+    int fins[ LONGUEUR_NOM_MAX + 3 ];
+    chaine_internee **touchees = NULL, **ordre;
+    cle_proche *liste = NULL;
+    chrono chr;
+    int *bornes;
+    int nb_touchees = 0, capacite = 0, nb_codes, nb = 0, capacite_proches = 0, total = 0, limite = 0, i, j, b;
+    if( longueur > LONGUEUR_NOM_MAX )
+    {
+        *proches = NULL;
+        return 0;
+    }
+    demarrer_compteur( &chr, CPT_RECHERCHE_APPROCHEE );
+    plier_nom( texte, cle );
+    longueur = ( int ) strlen( cle );
+    nb_codes = trigrammes_cle( cle, longueur, codes );
+    index->epoque += 1;
+    for( j = 0; j < nb_codes; j++ )
+    {
+        trigramme *t = trouver_trigramme( codes[j], 0 );
+        for( i = 0; t != NULL && i < t->nb; i++ )
+        {
+            chaine_internee *ch = t->chaines[i];
+            if( ch->epoque != index->epoque )
+            {
+                if( nb_touchees == capacite )
+                {
+                    capacite = capacite ? capacite * 2 : 64;
+                    touchees = ( chaine_internee ** ) REALLOUER( touchees, capacite * sizeof( chaine_internee * ),
+                                                                 "cles_touchees" );
+                }
+                ch->epoque = index->epoque;
+                ch->communs = 0;
+                touchees[ nb_touchees++ ] = ch;
+            }
+            ch->communs += 1;
+        }
+    }
+    /*
+     * Tri des cles rencontrees par borne croissante (tri par denombrement, les bornes sont petites): fins[b]
+     * devient la fin des cles de borne b dans ordre.
+     */
+    bornes = ( int * ) ALLOUER( nb_touchees + 1, sizeof( int ), "bornes_proches" );
+    ordre = ( chaine_internee ** ) ALLOUER( nb_touchees + 1, sizeof( chaine_internee * ), "ordre_proches" );
+    memset( fins, 0, sizeof( fins ) );
+    for( i = 0; i < nb_touchees; i++ )
+    {
+        chaine_internee *ch = touchees[i];
+        b = ch->longueur > longueur ? ch->longueur - longueur : longueur - ch->longueur;
+        b = ( nb_codes - ch->communs + 3 ) / 4 > b ? ( nb_codes - ch->communs + 3 ) / 4 : b;
+        b = ( ch->nb_trigrammes - ch->communs + 3 ) / 4 > b ? ( ch->nb_trigrammes - ch->communs + 3 ) / 4 : b;
+        bornes[i] = b > LONGUEUR_NOM_MAX + 1 ? LONGUEUR_NOM_MAX + 1 : b;
+        fins[ bornes[i] + 1 ] += 1;
+    }
+    for( b = 0; b <= LONGUEUR_NOM_MAX + 1; b++ )
+    {
+        fins[ b + 1 ] += fins[b];
+    }
+    for( i = 0; i < nb_touchees; i++ )
+    {
+        ordre[ fins[ bornes[i] ]++ ] = touchees[i];
+    }
+    for( b = 0, i = 0; b <= LONGUEUR_NOM_MAX + 1 && ( total < k || b <= limite ); b++ )
+    {
+        for( ; i < fins[b]; i++ )
+        {
+            chaine_internee *ch = ordre[i];
+            int d = distance_edition( cle, ch->texte ), n, cumul;
+            if( total >= k && d > limite )
+            {
+                continue;
+            }
+            n = compter( contexte, ch->texte );
+            if( n == 0 )
+            {
+                continue;
+            }
+            if( nb == capacite_proches )
+            {
+                capacite_proches = capacite_proches ? capacite_proches * 2 : 16;
+                liste = ( cle_proche * ) REALLOUER( liste, capacite_proches * sizeof( cle_proche ), "cles_proches" );
+            }
+            for( j = nb; j > 0 && ( liste[ j - 1 ].distance > d ||
+                                    ( liste[ j - 1 ].distance == d && strcmp( liste[ j - 1 ].cle, ch->texte ) > 0 ) );
+                 j-- )
+            {
+                liste[j] = liste[ j - 1 ];
+            }
+            liste[j].cle = ch->texte;
+            liste[j].distance = d;
+            liste[j].nb = n;
+            nb += 1;
+            /*
+             * On ne garde que les cles necessaires pour atteindre k enregistrements, et leurs ex aequo.
+             */
+            for( j = 0, cumul = 0; j < nb && ( cumul < k || liste[j].distance == liste[ j - 1 ].distance ); j++ )
+            {
+                cumul += liste[j].nb;
+            }
+            nb = j;
+            total = cumul;
+            limite = liste[ nb - 1 ].distance;
+        }
+    }
+    LIBERER( touchees );
+    LIBERER( bornes );
+    LIBERER( ordre );
+    compter_visites( nb_touchees );
+    arreter_compteur( &chr );
+    *proches = liste;
+    return nb;
+}
+
+/*
+ * L'historique des modifications sert a annuler et a retablir les modifications faites dans le programme
+ * interactif. Chaque fonction qui modifie la base de donnees y note une modification elementaire qui sait se
+ * defaire et se refaire en O(1): l'ajout ou la suppression d'une personne, d'une formation ou d'une salle, d'un
+ * participant dans les inscrits d'une formation, d'une formation dans la liste d'une personne, d'une demande
+ * d'attente, ou le changement des salles d'une formation.
+ * Les modifications sont regroupees en etapes (voir commencer_etape): annuler defait la derniere etape en entier,
+ * retablir refait la derniere etape annulee. Une nouvelle modification efface les etapes annulees.
+ * L'historique garde au plus TAILLE_HISTORIQUE modifications, les etapes les plus anciennes sont oubliees pour
+ * faire de la place. Une etape qui ne tient pas en entier dans l'historique ne peut pas etre annulee, et les
+ * etapes precedentes non plus.
+ * L'historique n'est actif que dans le programme interactif (voir menu). Quand il ne l'est pas, chaque fonction
+ * de la base de donnees ne paie qu'un test.
+ */
+#define TAILLE_HISTORIQUE 4096
+
+/*
+ * Les types de modifications elementaires.
+ * MODIF_PERSONNE, MODIF_FORMATION, MODIF_SALLE : Un enregistrement de la base de donnees.
+ * MODIF_INSCRIT : La personne idp dans la case position des inscrits de la formation idf.
+ * MODIF_LISTE : La formation idf dans la case position de la liste formations de la personne idp.
+ * MODIF_ATTENTE : La demande d'attente de la personne idp pour la formation idf.
+ * MODIF_SALLES : Les salles des seances de la formation idf, echangees avec celles de la copie.
+ */
+#define MODIF_PERSONNE 0
+#define MODIF_FORMATION 1
+#define MODIF_SALLE 2
+#define MODIF_INSCRIT 3
+#define MODIF_LISTE 4
+#define MODIF_ATTENTE 5
+#define MODIF_SALLES 6
+
+/*
+ * Une modification elementaire.
+ * int type : Un des types MODIF_*.
+ * int ajout : 1 si la modification a ajoute quelque chose (l'annuler le retire), 0 si elle a retire quelque
+ * chose (l'annuler le remet).
+ * int debut : 1 si c'est la premiere modification de son etape.
+ * int idf, idp : La formation et la personne concernees.
+ * int position : La position de l'enregistrement dans le vecteur ordre de sa base de donnees, ou sa case dans
+ * les inscrits ou dans la liste formations.
+ * int rang, numero : Le rang et le numero d'arrivee d'une demande d'attente.
+ * int noms : 1 si l'historique garde une reference sur les noms internes de la copie, c'est le cas quand
+ * l'enregistrement n'est pas dans la base de donnees.
+ * copie : L'enregistrement retire, pour pouvoir le remettre (ses inscrits et sa liste d'attente sont notes a
+ * part), ou les salles d'une formation.
+ */
+typedef struct modification
+{
+    int type;
+    int ajout;
+    int debut;
+    int idf;
+    int idp;
+    int position;
+    int rang;
+    int numero;
+    int noms;
+    union
+    {
+        personne p;
+        formation f;
+        salle s;
+    } copie;
+} modification;
+
+/*
+ * L'historique est un tampon circulaire de modifications.
+ * modification *modifications : Les TAILLE_HISTORIQUE cases du tampon, NULL si l'historique n'est pas actif.
+ * int premiere : La case de la plus ancienne modification.
+ * int nb : Le nombre de modifications gardees.
+ * int courante : Les modifications d'indice 0 a courante - 1 (depuis premiere) sont faites et peuvent etre
+ * annulees, celles de courante a nb - 1 ont ete annulees et peuvent etre retablies.
+ * int actif : 1 si les modifications sont notees, 0 pendant qu'on annule ou retablit.
+ * int nouvelle_etape : 1 si la prochaine modification commence une nouvelle etape.
+ * int etape_perdue : 1 si l'etape en cours n'a pas tenu dans l'historique, ses modifications ne sont plus notees.
+ */
+typedef struct historique_modifications
+{
+    modification *modifications;
+    int premiere;
+    int nb;
+    int courante;
+    int actif;
+    int nouvelle_etape;
+    int etape_perdue;
+} historique_modifications;
+
+historique_modifications historique;
+
+/*
+ * Une transaction regroupe les modifications d'une operation qui touche plusieurs enregistrements (une formation,
+ * ses inscrits, la liste formations de ses participants, les listes d'attente): elles sont toutes gardees (voir
+ * valider_transaction) ou toutes defaites (voir annuler_transaction).
+ * Pendant une transaction, les modifications elementaires sont notees dans son propre tampon, qui grandit a la
+ * demande: une transaction peut toujours etre annulee, meme si l'historique n'est pas actif ou si elle n'y tient
+ * pas. Une fois validee, ses modifications passent dans l'etape en cours de l'historique.
+ * modification *modifications : Les modifications de la transaction, dans l'ordre ou elles ont ete faites.
+ * int nb : Le nombre de modifications notees.
+ * int capacite : La taille allouee pour modifications.
+ * int profondeur : Le nombre de transactions commencees et pas encore terminees. Une transaction commencee dans
+ * une autre en fait partie, seule la plus externe est vraiment validee ou annulee.
+ * int echec : 1 si une transaction interne a ete annulee, la transaction externe le sera aussi.
+ */
+typedef struct transaction
+{
+    modification *modifications;
+    int nb;
+    int capacite;
+    int profondeur;
+    int echec;
+} transaction;
+
+transaction transaction_en_cours;
+
+/*
+ * Cette fonction renvoie la modification d'indice i de l'historique, depuis la plus ancienne.
+ */
+modification *modification_historique( int i )
+{
+    return &historique.modifications[ ( historique.premiere + i ) % TAILLE_HISTORIQUE ];
+}
+
+/*
+ * Cette fonction sert a oublier la modification m: les noms de sa copie sont relaches.
+ */
+void oublier_modification( modification *m )
+{
+    if( m->noms && m->type == MODIF_PERSONNE )
+    {
+        relacher( m->copie.p.nom );
+        relacher( m->copie.p.prenom );
+    }
+    else if( m->noms && m->type == MODIF_FORMATION )
+    {
+        relacher( m->copie.f.nom );
+    }
+    m->noms = 0;
+}
+
+/*
+ * Cette fonction sert a oublier toutes les modifications de l'historique.
+ */
+void vider_historique()
+{
+    int i;
+    for( i = 0; historique.modifications != NULL && i < historique.nb; i++ )
+    {
+        oublier_modification( modification_historique( i ) );
+    }
+    historique.premiere = 0;
+    historique.nb = 0;
+    historique.courante = 0;
+}
+
+/*
+ * Ces fonctions servent a activer l'historique, vide, et a le desactiver en liberant sa memoire.
+ */
+void activer_historique()
+{
+    historique.modifications = ( modification * ) ALLOUER( TAILLE_HISTORIQUE, sizeof( modification ), "historique" );
+    vider_historique();
+    historique.actif = 1;
+    historique.nouvelle_etape = 1;
+    historique.etape_perdue = 0;
+}
+
+void desactiver_historique()
+{
+    vider_historique();
+    LIBERER( historique.modifications );
+    historique.modifications = NULL;
+    historique.actif = 0;
+}
+
+/*
+ * Cette fonction sert a commencer une nouvelle etape: les modifications notees ensuite seront annulees ensemble.
+ */
+void commencer_etape()
+{
+    historique.nouvelle_etape = 1;
+    historique.etape_perdue = 0;
+}
+
+/*
+ * Cette fonction sert a preparer la case m pour une modification du type type. Seule la copie, qui n'est remplie
+ * que pour certains types, n'est pas remise a zero.
+ */
+void preparer_modification( modification *m, int type, int ajout, int debut )
+{
+    m->type = type;
+    m->ajout = ajout;
+    m->debut = debut;
+    m->idf = 0;
+    m->idp = 0;
+    m->position = 0;
+    m->rang = 0;
+    m->numero = 0;
+    m->noms = 0;
+}
+
+/*
+ * Cette fonction sert a commencer une transaction (voir valider_transaction et annuler_transaction).
+ */
+void commencer_transaction()
+{
+    if( transaction_en_cours.profondeur == 0 )
+    {
+        transaction_en_cours.nb = 0;
+        transaction_en_cours.echec = 0;
+    }
+    transaction_en_cours.profondeur += 1;
+}
+
+/*
+ * Cette fonction est enregistree avec atexit a la premiere transaction: elle libere le tampon des transactions,
+ * qui est garde d'une transaction a l'autre.
+ */
+void liberer_transaction_a_la_sortie()
+{
+    LIBERER( transaction_en_cours.modifications );
+    transaction_en_cours.modifications = NULL;
+    transaction_en_cours.capacite = 0;
+}
+
+/*
+ * Cette fonction renvoie une case libre, a la fin du tampon de la transaction en cours, pour noter une nouvelle
+ * modification du type type. Le tampon est agrandi si necessaire.
+ */
+modification *modification_transaction( int type, int ajout )
+{
+    modification *m;
+    if( transaction_en_cours.nb == transaction_en_cours.capacite )
+    {
+        int capacite = transaction_en_cours.capacite ? transaction_en_cours.capacite * 2 : 16;
+        if( transaction_en_cours.capacite == 0 )
+        {
+            atexit( liberer_transaction_a_la_sortie );
+        }
+        transaction_en_cours.modifications = ( modification * ) REALLOUER( transaction_en_cours.modifications,
+                                                                           capacite * sizeof( modification ),
+                                                                           "transaction" );
+        transaction_en_cours.capacite = capacite;
+    }
+    m = &transaction_en_cours.modifications[ transaction_en_cours.nb ];
+    preparer_modification( m, type, ajout, transaction_en_cours.nb == 0 );
+    transaction_en_cours.nb += 1;
+    return m;
+}
+
+/*
+ * Cette fonction renvoie une case libre pour noter une nouvelle modification du type type, NULL si la modification
+ * ne doit pas etre notee. Pendant une transaction, la case est prise dans son tampon. Sinon, les modifications
+ * annulees sont oubliees. Si l'historique est plein, l'etape la plus ancienne est oubliee; si c'est l'etape en
+ * cours, tout l'historique est vide et l'etape est perdue.
+ */
+modification *nouvelle_modification( int type, int ajout )
+{
+    modification *m;
+    if( transaction_en_cours.profondeur > 0 )
+    {
+        return modification_transaction( type, ajout );
+    }
+    if( !historique.actif || historique.etape_perdue )
+    {
+        return NULL;
+    }
+    while( historique.nb > historique.courante )
+    {
+        oublier_modification( modification_historique( --historique.nb ) );
+    }
+    if( historique.nb == TAILLE_HISTORIQUE )
+    {
+        do
+        {
+            oublier_modification( modification_historique( 0 ) );
+            historique.premiere = ( historique.premiere + 1 ) % TAILLE_HISTORIQUE;
+            historique.nb -= 1;
+        } while( historique.nb > 0 && !modification_historique( 0 )->debut );
+        historique.courante = historique.nb;
+        if( historique.nb == 0 && !historique.nouvelle_etape )
+        {
+            historique.etape_perdue = 1;
+            return NULL;
+        }
+    }
+    m = modification_historique( historique.nb );
+    preparer_modification( m, type, ajout, historique.nouvelle_etape );
+    historique.nouvelle_etape = 0;
+    historique.nb += 1;
+    historique.courante = historique.nb;
+    return m;
+}
+
+/*
+ * Ces fonctions servent a garder dans la modification m une copie de la personne *p ou de la formation *f, avec
+ * une reference sur ses noms. La copie d'une formation n'a ni inscrits ni liste d'attente.
+ */
+void copier_personne_modification( modification *m, personne *p )
+{
+    m->copie.p = *p;
+    interner( p->nom );
+    interner( p->prenom );
+    m->noms = 1;
+}
+
+void copier_formation_modification( modification *m, formation *f )
+{
+    m->copie.f = *f;
+    m->copie.f.inscrits = NULL;
+    m->copie.f.nb_inscrits = 0;
+    m->copie.f.nb_desinscrits = 0;
+    m->copie.f.nb_apprenants = 0;
+    m->copie.f.capacite_inscrits = 0;
+    m->copie.f.attente = NULL;
+    interner( f->nom );
+    m->noms = 1;
+}
+
+/*
+ * Cette fonction sert a noter l'ajout de la personne *p en position position du vecteur ordre, ou sa suppression
+ * (avant qu'elle ait lieu).
+ */
+void noter_personne( personne *p, int position, int ajout )
+{
+    modification *m = nouvelle_modification( MODIF_PERSONNE, ajout );
+    if( m == NULL )
+    {
+        return;
+    }
+    m->idp = p->id;
+    m->position = position;
+    if( !ajout )
+    {
+        copier_personne_modification( m, p );
+    }
+}
+
+void noter_inscrit( formation *f, personne *p, int position, int ajout );
+
+/*
+ * Cette fonction sert a noter l'ajout de la formation *f en position position du vecteur ordre, ou sa suppression
+ * (avant qu'elle ait lieu, apres avoir vide sa liste d'attente): ses participants sont d'abord notes comme
+ * desinscrits, du dernier au premier.
+ */
+void noter_formation( formation *f, int position, int ajout )
+{
+    modification *m;
+    int i;
+    if( !historique.actif && transaction_en_cours.profondeur == 0 )
+    {
+        return;
+    }
+    for( i = f->nb_inscrits - 1; !ajout && i >= 0; i-- )
+    {
+        if( f->inscrits[i] != NULL )
+        {
+            noter_inscrit( f, f->inscrits[i], i, 0 );
+        }
+    }
+    m = nouvelle_modification( MODIF_FORMATION, ajout );
+    if( m == NULL )
+    {
+        return;
+    }
+    m->idf = f->id;
+    m->position = position;
+    if( !ajout )
+    {
+        copier_formation_modification( m, f );
+    }
+}
+
+/*
+ * Cette fonction sert a noter l'ajout de la salle *s. Les salles ne sont pas supprimees dans le programme
+ * interactif.
+ */
+void noter_salle( salle *s )
+{
+    modification *m = nouvelle_modification( MODIF_SALLE, 1 );
+    if( m != NULL )
+    {
+        m->copie.s = *s;
+    }
+}
+
+/*
+ * Cette fonction sert a noter l'ajout de la personne *p dans la case position des inscrits de la formation *f, ou
+ * son retrait de cette case.
+ */
+void noter_inscrit( formation *f, personne *p, int position, int ajout )
+{
+    modification *m = nouvelle_modification( MODIF_INSCRIT, ajout );
+    if( m != NULL )
+    {
+        m->idf = f->id;
+        m->idp = p->id;
+        m->position = position;
+    }
+}
+
+/*
+ * Cette fonction sert a noter l'ajout de la formation de la case position de la liste formations de la personne
+ * *p, ou son retrait (avant qu'il ait lieu).
+ */
+void noter_liste( personne *p, int position, int ajout )
+{
+    modification *m = nouvelle_modification( MODIF_LISTE, ajout );
+    if( m != NULL )
+    {
+        m->idf = p->formations[ position ];
+        m->idp = p->id;
+        m->position = position;
+    }
+}
+
+/*
+ * Cette fonction sert a noter l'ajout ou le retrait de la demande d'attente *d.
+ */
+void noter_attente( demande_attente *d, int ajout )
+{
+    modification *m = nouvelle_modification( MODIF_ATTENTE, ajout );
+    if( m != NULL )
+    {
+        m->idf = d->formation;
+        m->idp = d->p->id;
+        m->rang = d->rang;
+        m->numero = d->numero;
+    }
+}
+
+/*
+ * Cette fonction sert a noter les salles de la formation *f avant qu'elles soient changees.
+ */
+void noter_salles( formation *f )
+{
+    modification *m = nouvelle_modification( MODIF_SALLES, 1 );
+    if( m != NULL )
+    {
+        m->idf = f->id;
+        memcpy( m->copie.f.salles, f->salles, sizeof( f->salles ) );
+    }
+}
+
+/*                                   FIN OUTILS                              */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                    PERSONNE                               */
+/*
+ * Cette fonction sert a creer un pointeur qui permettra d'initialiser les differentes informations presentes
+ * dans la structure personne.
+ * Lors de l'initialisation d'une personne, on n'aura besoin que du nom de famille de la personne,
+ * son prenom et s'il/elle est un formateur ou pas.
+ * Le reste des informations est manipule par la suite lors des differentes interactions.
+ */
+personne *creer_personne( const char nom[], const char prenom[], int formateur )
+{
+    personne *e = ( personne * ) ALLOUER( 1, sizeof( personne ), "personne" );
+    compter_octets( sizeof( personne ) );
+    e->nom = interner( nom );
+    e->prenom = interner( prenom );
+    e->formateur = formateur;
+    return e;
+}
+
+/*
+ * Cette fonction sert a liberer une personne creee par creer_personne qui n'a pas ete ajoutee a une base de
+ * donnees, avec ses references sur son nom et son prenom.
+ */
+void liberer_personne( personne *p )
+{
+    relacher( p->nom );
+    relacher( p->prenom );
+    LIBERER( p );
+}
+
+/*
+ * Cette fonction sert a afficher les informations de base qui caracterisent une personne.
+ * De maniere generale, son identifiant, son nom de famille, son prenom et s'il est formateur ou etudiant.
+ */
+void afficher_personne( personne *p )
+{
+    personne *tmp = p;
+    printf( "* %2d %-*s %-*s %-10s            *\n", tmp->id, largeur_utf8( tmp->nom, 25 ), tmp->nom,
+            largeur_utf8( tmp->prenom, 25 ), tmp->prenom, tmp->formateur ? "Formateur" : "Etudiant" );
+}
+
+/*
+ * Cette fonction sert a creer une base de donnees de personnes vide, afin que l'on puisse commencer a faire des
+ * manipulations avec cette structure. Aucune page n'est allouee avant le premier ajout.
+ */
+db_personne *creer_db_personne()
+{
+    db_personne *db = ( db_personne * ) ALLOUER( 1, sizeof( db_personne ), "db_personne" );
+    return db;
+}
+
+/*
+ * Cette fonction sert a agrandir un vecteur de pages pour qu'il contienne la page numero k.
+ * Seul le vecteur de pointeurs est deplace, les pages elles-memes ne bougent pas.
+ */
+void agrandir_pages( void ***pages, int *nb_pages, int k )
+{
+    int nouvelle = *nb_pages ? *nb_pages : 4;
+    void **tmp;
+    if( k < *nb_pages )
+    {
+        return;
+    }
+    while( nouvelle <= k )
+    {
+        nouvelle *= 2;
+    }
+    tmp = ( void ** ) ALLOUER( nouvelle, sizeof( void * ), "pages" );
+    compter_octets( ( nouvelle - *nb_pages ) * sizeof( void * ) );
+    if( *nb_pages > 0 )
+    {
+        memcpy( tmp, *pages, *nb_pages * sizeof( void * ) );
+    }
+    LIBERER( *pages );
+    *pages = tmp;
+    *nb_pages = nouvelle;
+}
+
+/*
+ * Cette fonction sert a garantir qu'un vecteur ordre de taille taille peut recevoir un identifiant de plus.
+ */
+void agrandir_ordre( int **ordre, int *capacite, int taille )
+{
+    int nouvelle;
+    if( taille < *capacite )
+    {
+        return;
+    }
+    nouvelle = *capacite ? *capacite * 2 : 64;
+    *ordre = ( int * ) REALLOUER( *ordre, nouvelle * sizeof( int ), "ordre" );
+    compter_octets( ( nouvelle - *capacite ) * sizeof( int ) );
+    *capacite = nouvelle;
+}
+
+/*
+ * Cette fonction renvoie la personne qui a l'identifiant id, NULL si elle n'existe pas.
+ * La personne est retrouvee directement dans sa page, sans aucun parcours.
+ */
+personne *get_personne_par_id( db_personne *db, int id )
+{
+    page_personne *page;
+    if( id <= 0 || ( id >> DECALAGE_PAGE ) >= db->nb_pages )
+    {
+        return NULL;
+    }
+    page = db->pages[ id >> DECALAGE_PAGE ];
+    if( page == NULL || !page->vivant[ id & ( TAILLE_PAGE - 1 ) ] )
+    {
+        return NULL;
+    }
+    return &page->enregistrements[ id & ( TAILLE_PAGE - 1 ) ];
+}
+
+/*
+ * Cette fonction sert a ranger la personne *p, creee par creer_personne, dans la base de donnees db_personne *db.
+ * Les personnes ne sont pas chainees mais copiees dans leur page, p est donc toujours consommee:
+ * On retrouve la page qui correspond a l'identifiant de p, on l'alloue si elle n'existe pas encore.
+ * On copie p dans son emplacement de la page et on libere p.
+ * On ajoute l'identifiant a la fin du vecteur ordre, afin de garder l'ordre d'ajout.
+ * On renvoie l'adresse de la personne dans la base de donnees, que l'appelant doit utiliser a la place de p.
+ * Si l'identifiant est invalide ou deja utilise, rien n'est ajoute, p est liberee par liberer_personne et on
+ * renvoie NULL.
+ */
+personne *ranger_db_personne( db_personne *db, personne *p )
+{
+    page_personne *page;
+    int k = p->id >> DECALAGE_PAGE, i = p->id & ( TAILLE_PAGE - 1 );
+    if( p->id <= 0 || p->id > ID_MAX || get_personne_par_id( db, p->id ) != NULL )
+    {
+        liberer_personne( p );
+        return NULL;
+    }
+    agrandir_pages( ( void *** ) &db->pages, &db->nb_pages, k );
+    if( db->pages[k] == NULL )
+    {
+        db->pages[k] = ( page_personne * ) ALLOUER( 1, sizeof( page_personne ), "page_personne" );
+        compter_octets( sizeof( page_personne ) );
+    }
+    page = db->pages[k];
+    page->enregistrements[i] = *p;
+    page->vivant[i] = 1;
+    page->nb_vivants += 1;
+    agrandir_ordre( &db->ordre, &db->capacite_ordre, db->taille_ordre );
+    page->position[i] = db->taille_ordre;
+    db->ordre[ db->taille_ordre ] = p->id;
+    db->taille_ordre += 1;
+    db->nb += 1;
+    db->index_a_jour = 0;
+    reserver_id( &db->ids, p->id );
+    noter_personne( &page->enregistrements[i], page->position[i], 1 );
+    LIBERER( p );
+    return &page->enregistrements[i];
+}
+
+/*
+ * Cette fonction sert a compacter la base de donnees: les pierres tombales sont retirees du vecteur ordre
+ * (les positions des personnes sont mises a jour) et les pages devenues vides sont liberees.
+ */
+void compacter_db_personne( db_personne *dbp )
+{
+    int i, j = 0;
+    for( i = 0; i < dbp->taille_ordre; i++ )
+    {
+        int id = dbp->ordre[i];
+        if( id != 0 )
+        {
+            dbp->pages[ id >> DECALAGE_PAGE ]->position[ id & ( TAILLE_PAGE - 1 ) ] = j;
+            dbp->ordre[ j++ ] = id;
+        }
+    }
+    dbp->taille_ordre = j;
+    dbp->nb_tombes = 0;
+    for( i = 0; i < dbp->nb_pages; i++ )
+    {
+        if( dbp->pages[i] != NULL && dbp->pages[i]->nb_vivants == 0 )
+        {
+            LIBERER( dbp->pages[i] );
+            dbp->pages[i] = NULL;
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a supprimer une personne de la base de donnees a partir de son identifiant.
+ * La demarche faite dans cette fonction est la suivant:
+ * On retrouve la personne dans sa page, si elle n'existe pas, on arrete la fonction.
+ * On remplace son identifiant dans le vecteur ordre par une pierre tombale (0) et on vide son emplacement.
+ * Quand les pierres tombales representent plus de la moitie du vecteur ordre, on compacte la base de donnees.
+ * La personne ne doit plus etre inscrite dans aucune formation.
+ * On arrete la fonction, si reussite, on obtient 1, si pas, on obtient 0.
+ */
+int supprimer_db_personne( db_personne *dbp, int id )
+{
+    personne *p = get_personne_par_id( dbp, id );
+    page_personne *page;
+    chrono ch;
+    int i;
+    if( p == NULL )
+    {
+        return 0;
+    }
+    demarrer_compteur( &ch, CPT_SUPPRIMER_DB_PERSONNE );
+    compter_visites( 1 );
+    page = dbp->pages[ id >> DECALAGE_PAGE ];
+    i = id & ( TAILLE_PAGE - 1 );
+    noter_personne( p, page->position[i], 0 );
+    dbp->ordre[ page->position[i] ] = 0;
+    dbp->nb_tombes += 1;
+    relacher( p->nom );
+    relacher( p->prenom );
+    memset( p, 0, sizeof( personne ) );
+    page->vivant[i] = 0;
+    page->nb_vivants -= 1;
+    dbp->nb -= 1;
+    dbp->index_a_jour = 0;
+    liberer_id( &dbp->ids, id );
+    if( dbp->nb_tombes > 32 && dbp->nb_tombes * 2 > dbp->taille_ordre )
+    {
+        compter_visites( dbp->taille_ordre );
+        compacter_db_personne( dbp );
+    }
+    arreter_compteur( &ch );
+    return 1;
+}
+
+/*
+ * Cette fonction sert a liberer toute la memoire occupee par la base de donnees dbp, dbp compris.
+ */
+void liberer_db_personne( db_personne *dbp )
+{
+    int k, i;
+    for( k = 0; k < dbp->nb_pages; k++ )
+    {
+        for( i = 0; dbp->pages[k] != NULL && i < TAILLE_PAGE; i++ )
+        {
+            relacher( dbp->pages[k]->enregistrements[i].nom );
+            relacher( dbp->pages[k]->enregistrements[i].prenom );
+        }
+        LIBERER( dbp->pages[k] );
+    }
+    LIBERER( dbp->pages );
+    LIBERER( dbp->ordre );
+    LIBERER( dbp->par_nom );
+    vider_allocateur_id( &dbp->ids );
+    LIBERER( dbp );
+}
+
+/*
+ * Fonction de comparaison utilisee par qsort pour construire l'index par nom de db_personne: par nom puis par
+ * prenom dans l'ordre de comparer_noms, puis par identifiant.
+ */
+int comparer_personne_nom( const void *a, const void *b )
+{
+    const personne *pa = *( personne * const * ) a;
+    const personne *pb = *( personne * const * ) b;
+    int res = comparer_noms( pa->nom, pb->nom );
+    if( res == 0 )
+    {
+        res = comparer_noms( pa->prenom, pb->prenom );
+    }
+    if( res == 0 )
+    {
+        res = pa->id < pb->id ? -1 : pa->id > pb->id;
+    }
+    return res;
+}
+
+personne *suivant_curseur_personne( curseur_personne *c );
+void indexer_db_personne( db_personne *db );
+
+/*
+ * Cette fonction sert a placer le curseur c sur la premiere personne de db dans l'ordre choisi
+ * (ORDRE_INSERTION, ORDRE_RECENT, ORDRE_ID ou ORDRE_NOM) et renvoie cette personne, NULL si db est vide.
+ */
+personne *debut_curseur_personne( curseur_personne *c, db_personne *db, int ordre )
+{
+    c->db = db;
+    c->ordre = ordre;
+    c->position = -1;
+    if( ordre == ORDRE_RECENT )
+    {
+        c->position = db->taille_ordre;
+    }
+    else if( ordre == ORDRE_ID )
+    {
+        c->position = 0;
+    }
+    else if( ordre == ORDRE_NOM )
+    {
+        indexer_db_personne( db );
+    }
+    return suivant_curseur_personne( c );
+}
+
+/*
+ * Cette fonction sert a avancer le curseur c et renvoie la personne suivante, NULL a la fin du parcours.
+ * Les pierres tombales et les pages absentes sont sautees.
+ */
+personne *suivant_curseur_personne( curseur_personne *c )
+{
+    db_personne *db = c->db;
+    if( c->ordre == ORDRE_INSERTION )
+    {
+        while( ++c->position < db->taille_ordre )
+        {
+            if( db->ordre[ c->position ] != 0 )
+            {
+                return get_personne_par_id( db, db->ordre[ c->position ] );
+            }
+        }
+        return NULL;
+    }
+    if( c->ordre == ORDRE_RECENT )
+    {
+        while( --c->position >= 0 )
+        {
+            if( db->ordre[ c->position ] != 0 )
+            {
+                return get_personne_par_id( db, db->ordre[ c->position ] );
+            }
+        }
+        return NULL;
+    }
+    if( c->ordre == ORDRE_ID )
+    {
+        while( ++c->position < db->nb_pages * TAILLE_PAGE )
+        {
+            page_personne *page = db->pages[ c->position >> DECALAGE_PAGE ];
+            if( page == NULL )
+            {
+                c->position |= TAILLE_PAGE - 1;
+                continue;
+            }
+            if( page->vivant[ c->position & ( TAILLE_PAGE - 1 ) ] )
+            {
+                return &page->enregistrements[ c->position & ( TAILLE_PAGE - 1 ) ];
+            }
+        }
+        return NULL;
+    }
+    if( ++c->position < db->nb )
+    {
+        return db->par_nom[ c->position ];
+    }
+    return NULL;
+}
+
+/*
+ * Cette fonction sert a reconstruire l'index par nom de la base de donnees db, si elle a ete modifiee depuis
+ * sa derniere construction. La memoire de l'index est reutilisee tant que le nombre de personnes ne depasse
+ * pas sa capacite.
+ */
+void indexer_db_personne( db_personne *db )
+{
+    curseur_personne c;
+    personne *tmpp;
+    int i = 0;
+    if( db->index_a_jour )
+    {
+        return;
+    }
+    if( db->nb > db->capacite_index )
+    {
+        int capacite = db->capacite_index ? db->capacite_index : 16;
+        while( capacite < db->nb )
+        {
+            capacite *= 2;
+        }
+        LIBERER( db->par_nom );
+        db->par_nom = ( personne ** ) ALLOUER( capacite, sizeof( personne * ), "index_nom" );
+        db->capacite_index = capacite;
+    }
+    for( tmpp = debut_curseur_personne( &c, db, ORDRE_ID ); tmpp != NULL; tmpp = suivant_curseur_personne( &c ) )
+    {
+        db->par_nom[ i++ ] = tmpp;
+    }
+    qsort( db->par_nom, db->nb, sizeof( personne * ), comparer_personne_nom );
+    db->index_a_jour = 1;
+}
+
+personne **plage_nom_personnes( db_personne *db, const char *cle, const char *texte, int *nb );
+
+/*
+ * Cette fonction renvoie NULL si une personne avec un nom, un prenom et un statut specifiques n'existe pas dans
+ * la base de donnees db_personne *db.
+ * Sinon, la fonction retourne la personne trouvee, celle qui a le plus petit identifiant s'il y en a plusieurs.
+ * Le nom et le prenom sont d'abord cherches dans la table des chaines: s'ils n'y sont pas, aucune personne ne
+ * les porte. Sinon, les personnes qui portent ce nom sont trouvees par dichotomie dans l'index par nom, ou elles
+ * se suivent par prenom puis par identifiant, et les prenoms se comparent par leurs pointeurs.
+ */
+personne *get_personne( db_personne *db, const char nom[], const char prenom[], int formateur )
+{
+    personne **plage, *tmpp = NULL;
+    chrono ch;
+    int nb, i = 0;
+    const char *nom_interne = chaine_existante( nom ), *prenom_interne = chaine_existante( prenom );
+    demarrer_compteur( &ch, CPT_GET_PERSONNE );
+    if( nom_interne != NULL && prenom_interne != NULL )
+    {
+        plage = plage_nom_personnes( db, cle_pliee( nom_interne ), nom_interne, &nb );
+        for( i = 0; i < nb && tmpp == NULL; i++ )
+        {
+            if( plage[i]->prenom == prenom_interne && plage[i]->formateur == formateur )
+            {
+                tmpp = plage[i];
+            }
+        }
+    }
+    compter_visites( i );
+    arreter_compteur( &ch );
+    return tmpp;
+}
+
+/*
+ * Cette fonction parcourt l'entierete de la base de donnees db_personne *db dans l'ordre choisi et affiche
+ * les informations que l'on souhaite afficher de chaque personne presente dans la base de donnees.
+ */
+void afficher_db_personne_ordre( db_personne *db, int ordre )
+{
+    curseur_personne c;
+    personne *tmpp;
+    printf( "* %2s %-25s %-25s %-9s             *\n", "ID", "Nom", "Prenom", "Statut" );
+    printf( "* ---------------------------------------------------------------------------- *\n" );
+    for( tmpp = debut_curseur_personne( &c, db, ordre ); tmpp != NULL; tmpp = suivant_curseur_personne( &c ) )
+    {
+        afficher_personne( tmpp );
+    }
+}
+
+/*
+ * Cette fonction affiche toutes les personnes de la base de donnees, de la plus recente a la plus ancienne.
+ */
+void afficher_db_personne( db_personne *db )
+{
+    afficher_db_personne_ordre( db, ORDRE_RECENT );
+}
+
+/*                                 FIN PERSONNE                              */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                     FORMATION                             */
+/*
+ * Les horaires et les durees sont ecrits en heures et minutes avec deux decimales (14.30 pour 14 heures 30) et
+ * les prix en euros avec deux decimales, mais ils sont stockes en minutes et en centimes pour que les calculs
+ * soient exacts. FORMAT_HORAIRE et FORMAT_PRIX s'utilisent avec HORAIRE( minutes ) et PRIX( centimes ), qui
+ * donnent les deux entiers a ecrire.
+ */
+#define FORMAT_HORAIRE "%d.%02d"
+#define HORAIRE( minutes ) ( minutes ) / 60, ( minutes ) % 60
+#define FORMAT_PRIX "%d.%02d"
+#define PRIX( centimes ) ( centimes ) / 100, ( centimes ) % 100
+
+/*
+ * Cette fonction sert a lire l'horaire ou la duree texte (14.30, 8.5 pour 8.50 ou 14) et a le mettre en minutes
+ * dans *minutes. Les minutes vont de 00 a 59: 9.75 n'est pas un horaire.
+ * On obtient 1 si reussite, 0 si texte n'est pas un horaire.
+ */
+int lire_horaire( const char *texte, int *minutes )
+{
+    int heures = 0, mm = 0, chiffres = 0;
+    if( !isdigit( ( unsigned char ) *texte ) )
+    {
+        return 0;
+    }
+    for( ; isdigit( ( unsigned char ) *texte ); texte++ )
+    {
+        heures = heures * 10 + *texte - '0';
+        if( heures > 9999 )
+        {
+            return 0;
+        }
+    }
+    if( *texte == '.' )
+    {
+        for( texte++; isdigit( ( unsigned char ) *texte ); texte++, chiffres++ )
+        {
+            if( chiffres < 2 )
+            {
+                mm = mm * 10 + *texte - '0';
+            }
+            else if( *texte != '0' )
+            {
+                return 0;
+            }
+        }
+        mm *= chiffres == 1 ? 10 : 1;
+    }
+    if( *texte != '\0' || mm >= 60 )
+    {
+        return 0;
+    }
+    *minutes = heures * 60 + mm;
+    return 1;
+}
+
+/*
+ * Cette fonction sert a lire la duree texte en heures decimales (1.5 pour 1 heure 30, 1.75 pour 1 heure 45 ou 2),
+ * comme la saisie du menu et le format 1 de CaculliTyranowskiFormation.dat, et a la mettre en minutes dans
+ * *minutes, arrondie a la minute la plus proche.
+ * On obtient 1 si reussite, 0 si texte n'est pas une duree.
+ */
+int lire_duree( const char *texte, int *minutes )
+{
+    long fraction = 0, diviseur = 1;
+    int heures = 0;
+    if( !isdigit( ( unsigned char ) *texte ) )
+    {
+        return 0;
+    }
+    for( ; isdigit( ( unsigned char ) *texte ); texte++ )
+    {
+        heures = heures * 10 + *texte - '0';
+        if( heures > 9999 )
+        {
+            return 0;
+        }
+    }
+    if( *texte == '.' )
+    {
+        for( texte++; isdigit( ( unsigned char ) *texte ); texte++ )
+        {
+            if( diviseur < 1000000 )
+            {
+                fraction = fraction * 10 + *texte - '0';
+                diviseur *= 10;
+            }
+        }
+    }
+    if( *texte != '\0' )
+    {
+        return 0;
+    }
+    *minutes = heures * 60 + ( int ) ( ( fraction * 120 + diviseur ) / ( 2 * diviseur ) );
+    return 1;
+}
+
+/*
+ * Cette fonction sert a lire le prix texte en euros (152.25, 12.5 ou 12) et a le mettre en centimes dans
+ * *centimes. Au-dela de deux decimales, le prix est arrondi au centime.
+ * On obtient 1 si reussite, 0 si texte n'est pas un prix.
+ */
+int lire_prix( const char *texte, int *centimes )
+{
+    long euros = 0;
+    int cents = 0, chiffres = 0, arrondi = 0;
+    if( !isdigit( ( unsigned char ) *texte ) )
+    {
+        return 0;
+    }
+    for( ; isdigit( ( unsigned char ) *texte ); texte++ )
+    {
+        euros = euros * 10 + *texte - '0';
+        if( euros > 20000000 )
+        {
+            return 0;
+        }
+    }
+    if( *texte == '.' )
+    {
+        for( texte++; isdigit( ( unsigned char ) *texte ); texte++, chiffres++ )
+        {
+            if( chiffres < 2 )
+            {
+                cents = cents * 10 + *texte - '0';
+            }
+            else if( chiffres == 2 )
+            {
+                arrondi = *texte >= '5';
+            }
+        }
+        cents *= chiffres == 1 ? 10 : 1;
+    }
+    if( *texte != '\0' )
+    {
+        return 0;
+    }
+    *centimes = ( int ) ( euros * 100 + cents + arrondi );
+    return 1;
+}
+
+/*
+ * Cette fonction sert a creer un pointeur qui permettra d'initialiser les differentes informations presentes dans
+ * la structure formation.
+ * Lors de l'initialisation d'une formation, on n'aura besoin que du nom de la formation et de son prix (en
+ * centimes).
+ * Le reste des informations est manipule par la suite lors des differentes interactions.
+ */
+formation *creer_formation( const char nom[], int prix )
+{
+    formation *tmp = ( formation * ) ALLOUER( 1, sizeof( formation ), "formation" );
+    compter_octets( sizeof( formation ) );
+    tmp->nom = interner( nom );
+    tmp->prix = prix;
+    return tmp;
+}
+
+/*
+ * Cette fonction sert a liberer une formation creee par creer_formation qui n'a pas ete ajoutee a une base de
+ * donnees, avec sa reference sur son nom.
+ */
+void liberer_formation( formation *f )
+{
+    relacher( f->nom );
+    LIBERER( f );
+}
+
+/*
+ * Cette fonction sert a inscrire la personne *p dans la formation *f, sans verifier si elle y est deja.
+ * La personne est ajoutee a la fin du vecteur inscrits, qui est agrandi si necessaire.
+ */
+void inscrire_personne( formation *f, personne *p )
+{
+    if( f->nb_inscrits == f->capacite_inscrits )
+    {
+        int capacite = f->capacite_inscrits ? f->capacite_inscrits * 2 : 8;
+        f->inscrits = ( personne ** ) REALLOUER( f->inscrits, capacite * sizeof( personne * ), "inscrits" );
+        compter_octets( ( capacite - f->capacite_inscrits ) * sizeof( personne * ) );
+        f->capacite_inscrits = capacite;
+    }
+    f->inscrits[ f->nb_inscrits ] = p;
+    f->nb_inscrits += 1;
+    f->nb_apprenants += !p->formateur;
+    noter_inscrit( f, p, f->nb_inscrits - 1, 1 );
+}
+
+/*
+ * Cette fonction sert a inscrire la personne *p dans la formation *f.
+ * Ici, l'ajout a lieu par le mecanisme suivant:
+ * On parcourt le vecteur inscrits de la formation, si la personne y est deja, on arrete la fonction et on
+ * obtient 0.
+ * Sinon, on ajoute la personne a la fin du vecteur et on obtient 1.
+ */
+int ajouter_formation( formation *f, personne *p )
+{
+    chrono ch;
+    int i;
+    demarrer_compteur( &ch, CPT_AJOUTER_FORMATION );
+    for( i = 0; i < f->nb_inscrits; i++ )
+    {
+        if( f->inscrits[i] != NULL && f->inscrits[i]->id == p->id )
+        {
+            compter_visites( i + 1 );
+            arreter_compteur( &ch );
+            return 0;
+        }
+    }
+    compter_visites( i );
+    inscrire_personne( f, p );
+    arreter_compteur( &ch );
+    return 1;
+}
+
+/*
+ * Cette fonction sert a retirer les pierres tombales du vecteur inscrits de la formation *f,
+ * en gardant l'ordre d'inscription des participants restants.
+ */
+void compacter_inscrits( formation *f )
+{
+    int i, j = 0;
+    for( i = 0; i < f->nb_inscrits; i++ )
+    {
+        if( f->inscrits[i] != NULL )
+        {
+            f->inscrits[ j++ ] = f->inscrits[i];
+        }
+    }
+    f->nb_inscrits = j;
+    f->nb_desinscrits = 0;
+}
+
+/*
+ * Cette fonction sert a remplacer la case i des inscrits de la formation *f par une pierre tombale. Quand les
+ * pierres tombales representent plus de la moitie du vecteur, on le compacte.
+ */
+void retirer_inscrit( formation *f, int i )
+{
+    noter_inscrit( f, f->inscrits[i], i, 0 );
+    f->nb_apprenants -= !f->inscrits[i]->formateur;
+    f->inscrits[i] = NULL;
+    f->nb_desinscrits += 1;
+    if( f->nb_desinscrits > 16 && f->nb_desinscrits * 2 > f->nb_inscrits )
+    {
+        compter_visites( f->nb_inscrits );
+        compacter_inscrits( f );
+    }
+}
+
+/*
+ * Cette fonction sert a supprimer une personne de la formation a partir de son identifiant.
+ * La demarche faite dans cette fonction est la suivant:
+ * On verifie que la formation existe, si pas, on arrete la fonction.
+ * On parcourt le vecteur inscrits jusqu'au moment ou l'on trouve la personne qui a le meme id que l'id en
+ * parametre.
+ * Si on la trouve, on remplace sa case par une pierre tombale (NULL). Quand les pierres tombales representent
+ * plus de la moitie du vecteur, on le compacte.
+ * On arrete la fonction, si reussite, on obtient 1, si pas, on obtient 0.
+ */
+int supprimer_personne_de_formation( formation *f, int id )
+{
+    chrono ch;
+    int i;
+    if( f == NULL )
+    {
+        printf( "Formation pas trouvee\n" );
+        return 0;
+    }
+    demarrer_compteur( &ch, CPT_SUPPRIMER_PERSONNE_DE_FORMATION );
+    for( i = 0; i < f->nb_inscrits; i++ )
+    {
+        if( f->inscrits[i] != NULL && f->inscrits[i]->id == id )
+        {
+            compter_visites( i + 1 );
+            retirer_inscrit( f, i );
+            arreter_compteur( &ch );
+            return 1;
+        }
+    }
+    compter_visites( i );
+    arreter_compteur( &ch );
+    return 0;
+}
+
+/*
+ * Cette fonction sert a afficher les informations de base qui caracterisent une formation.
+ * De maniere generale, son identifiant, son nom, son prix, ainsi que les personnes qui y participent.
+ * Les participants sont affiches du dernier inscrit au premier.
+ */
+void afficher_formation( formation *f )
+{
+    formation *tmp = f;
+    int i;
+    printf( "ID: %d - Nom formation: %s\n", tmp->id, tmp->nom );
+    printf( "Participants dans la formation:\n" );
+    printf( "Formateurs:\n" );
+    for( i = tmp->nb_inscrits - 1; i >= 0; i-- )
+    {
+        if( tmp->inscrits[i] != NULL && tmp->inscrits[i]->formateur == 1 )
+        {
+            printf( "%2d %s %s\n", tmp->inscrits[i]->id, tmp->inscrits[i]->nom, tmp->inscrits[i]->prenom );
+        }
+    }
+    printf( "Etudiants:\n" );
+    for( i = tmp->nb_inscrits - 1; i >= 0; i-- )
+    {
+        if( tmp->inscrits[i] != NULL && tmp->inscrits[i]->formateur == 0 )
+        {
+            printf( "%2d %s %s\n", tmp->inscrits[i]->id, tmp->inscrits[i]->nom, tmp->inscrits[i]->prenom );
+        }
+    }
+    printf( "\n" );
+}
+
+/*
+ * Cette fonction sert a creer une base de donnees de formations vide, afin que l'on puisse commencer a faire des
+ * manipulations avec cette structure.
+ */
+db_formation *creer_db_formation()
+{
+    db_formation *db = ( db_formation * ) ALLOUER( 1, sizeof( db_formation ), "db_formation" );
+    return db;
+}
+
+/*
+ * Cette fonction renvoie la formation qui a l'identifiant id, NULL si elle n'existe pas.
+ */
+formation *get_formation_par_id( db_formation *dbf, int id )
+{
+    page_formation *page;
+    if( id <= 0 || ( id >> DECALAGE_PAGE ) >= dbf->nb_pages )
+    {
+        return NULL;
+    }
+    page = dbf->pages[ id >> DECALAGE_PAGE ];
+    if( page == NULL || !page->vivant[ id & ( TAILLE_PAGE - 1 ) ] )
+    {
+        return NULL;
+    }
+    return &page->enregistrements[ id & ( TAILLE_PAGE - 1 ) ];
+}
+
+/*
+ * Cette fonction sert a calculer les tranches horaires (de *premiere a *derniere, incluses) que touche une
+ * seance de debut a fin (en minutes).
+ */
+void tranches_seance( int debut, int fin, int *premiere, int *derniere )
+{
+    *premiere = debut < 0 ? 0 : debut >= 24 * 60 ? 23 : debut / 60;
+    if( fin <= ( *premiere + 1 ) * 60 )
+    {
+        *derniere = *premiere;
+    }
+    else if( fin >= 24 * 60 )
+    {
+        *derniere = 23;
+    }
+    else
+    {
+        *derniere = ( fin - 1 ) / 60;
+    }
+}
+
+/*
+ * Cette fonction sert a ajouter les seances de la formation *f a l'index des seances de db.
+ * Les creneaux dont le jour n'est pas entre 1 et 7 sont ignores.
+ */
+void indexer_seances( db_formation *db, formation *f )
+{
+    int j, h, premiere, derniere;
+    for( j = 0; j < f->nb_jours; j++ )
+    {
+        if( f->jours[j] < 1 || f->jours[j] > 7 )
+        {
+            continue;
+        }
+        tranches_seance( f->heures[j], f->heures[j] + f->durees[j], &premiere, &derniere );
+        for( h = premiere; h <= derniere; h++ )
+        {
+            tranche_horaire *t = &db->horaire[ f->jours[j] - 1 ][h];
+            if( t->nb == t->capacite )
+            {
+                t->capacite = t->capacite ? t->capacite * 2 : 8;
+                t->seances = ( seance * ) REALLOUER( t->seances, t->capacite * sizeof( seance ), "index_seances" );
+            }
+            t->seances[ t->nb ].formation = f->id;
+            t->seances[ t->nb ].creneau = j;
+            t->seances[ t->nb ].debut = f->heures[j];
+            t->seances[ t->nb ].fin = f->heures[j] + f->durees[j];
+            t->nb += 1;
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a retirer les seances de la formation *f de l'index des seances de db, en les remplacant
+ * par des pierres tombales. Une tranche est compactee quand ses pierres tombales en representent plus de la moitie.
+ */
+void retirer_seances( db_formation *db, formation *f )
+{
+    int j, h, k, premiere, derniere;
+    for( j = 0; j < f->nb_jours; j++ )
+    {
+        if( f->jours[j] < 1 || f->jours[j] > 7 )
+        {
+            continue;
+        }
+        tranches_seance( f->heures[j], f->heures[j] + f->durees[j], &premiere, &derniere );
+        for( h = premiere; h <= derniere; h++ )
+        {
+            tranche_horaire *t = &db->horaire[ f->jours[j] - 1 ][h];
+            for( k = 0; k < t->nb && ( t->seances[k].formation != f->id || t->seances[k].creneau != j ); k++ )
+            {
+            }
+            if( k == t->nb )
+            {
+                continue;
+            }
+            t->seances[k].formation = 0;
+            t->nb_tombes += 1;
+            if( t->nb_tombes > 16 && t->nb_tombes * 2 > t->nb )
+            {
+                int i, n = 0;
+                for( i = 0; i < t->nb; i++ )
+                {
+                    if( t->seances[i].formation != 0 )
+                    {
+                        t->seances[ n++ ] = t->seances[i];
+                    }
+                }
+                t->nb = n;
+                t->nb_tombes = 0;
+            }
+        }
+    }
+}
+
+/*
+ * Les politiques de priorite des listes d'attente, voir rang_attente.
+ * ATTENTE_PREREQUIS : Les personnes a qui il manque le moins de prerequis passent d'abord, puis par anciennete.
+ * ATTENTE_ANCIENNETE : Premier arrive, premier servi.
+ * ATTENTE_REDUCTION : Les etudiants qui ont droit a une reduction passent d'abord, puis par anciennete.
+ */
+#define ATTENTE_PREREQUIS 0
+#define ATTENTE_ANCIENNETE 1
+#define ATTENTE_REDUCTION 2
+
+/*
+ * Une case de la table des demandes qui a contenu une demande retiree (pierre tombale).
+ */
+demande_attente case_attente_retiree;
+
+/*
+ * Cette fonction renvoie le rang de la demande de la personne *p pour la formation *f selon la politique de db:
+ * plus il est petit, plus la demande est prioritaire.
+ */
+int rang_attente( db_formation *db, formation *f, personne *p )
+{
+    int rang = 0, i, k;
+    if( db->politique_attente == ATTENTE_REDUCTION )
+    {
+        return p->reduction ? 0 : 1;
+    }
+    if( db->politique_attente == ATTENTE_PREREQUIS )
+    {
+        for( i = 0; i < f->nb_prerequis; i++ )
+        {
+            for( k = 0; k < p->nb_formations && p->formations[k] != f->prerequis[i]; k++ )
+            {
+            }
+            rang += k == p->nb_formations;
+        }
+    }
+    return rang;
+}
+
+/*
+ * Cette fonction renvoie la case de la table des demandes ou commence la recherche des demandes de la personne
+ * personne. Elle ne depend pas de la formation: toutes les demandes d'une personne se trouvent donc entre cette
+ * case et la premiere case vide qui la suit (voir retirer_attentes_personne).
+ */
+int case_initiale_attente( table_attente *t, int personne )
+{
+    unsigned long h = ( unsigned long ) personne * 2654435761UL;
+    h ^= h >> 15;
+    return ( int ) ( h & ( unsigned long ) ( t->capacite - 1 ) );
+}
+
+/*
+ * Cette fonction renvoie la case de la table des demandes ou se trouve la demande de la personne personne pour la
+ * formation formation, ou la case vide ou elle devrait etre ajoutee.
+ */
+int chercher_case_attente( table_attente *t, int formation, int personne )
+{
+    int i = case_initiale_attente( t, personne ), tombe = -1;
+    for( ;; )
+    {
+        demande_attente *d = t->cases[i];
+        if( d == NULL )
+        {
+            return tombe >= 0 ? tombe : i;
+        }
+        if( d == &case_attente_retiree )
+        {
+            if( tombe < 0 )
+            {
+                tombe = i;
+            }
+        }
+        else if( d->formation == formation && d->p->id == personne )
+        {
+            return i;
+        }
+        i = ( i + 1 ) & ( t->capacite - 1 );
+    }
+}
+
+/*
+ * Cette fonction sert a agrandir (ou a nettoyer de ses pierres tombales) la table des demandes quand elle est
+ * remplie aux trois quarts.
+ */
+void agrandir_table_attente( table_attente *t )
+{
+    demande_attente **anciennes = t->cases;
+    int ancienne_capacite = t->capacite, i;
+    if( t->capacite > 0 && ( t->nb + t->nb_tombes + 1 ) * 4 < t->capacite * 3 )
+    {
+        return;
+    }
+    while( t->capacite == 0 || ( t->nb + 1 ) * 2 > t->capacite )
+    {
+        t->capacite = t->capacite ? t->capacite * 2 : 64;
+    }
+    t->cases = ( demande_attente ** ) ALLOUER( t->capacite, sizeof( demande_attente * ), "table_attente" );
+    t->nb_tombes = 0;
+    for( i = 0; i < ancienne_capacite; i++ )
+    {
+        if( anciennes[i] != NULL && anciennes[i] != &case_attente_retiree )
+        {
+            t->cases[ chercher_case_attente( t, anciennes[i]->formation, anciennes[i]->p->id ) ] = anciennes[i];
+        }
+    }
+    LIBERER( anciennes );
+}
+
+/*
+ * Cette fonction renvoie la demande de la personne idp pour la formation idf, NULL si elle n'attend pas.
+ */
+demande_attente *trouver_attente( db_formation *db, int idf, int idp )
+{
+    demande_attente *d;
+    if( db->attentes.nb == 0 )
+    {
+        return NULL;
+    }
+    d = db->attentes.cases[ chercher_case_attente( &db->attentes, idf, idp ) ];
+    return d == &case_attente_retiree ? NULL : d;
+}
+
+/*
+ * Cette fonction renvoie 1 si la demande a doit etre servie avant la demande b, 0 si pas.
+ */
+int precede_attente( demande_attente *a, demande_attente *b )
+{
+    return a->rang != b->rang ? a->rang < b->rang : a->numero < b->numero;
+}
+
+/*
+ * Ces fonctions servent a remonter ou a descendre la demande de la case k du tas de la file *file jusqu'a sa
+ * place. Chaque demande deplacee garde sa position a jour, en O(log n).
+ */
+void monter_attente( file_attente *file, int k )
+{
+    demande_attente *d = file->tas[k];
+    while( k > 0 && precede_attente( d, file->tas[ ( k - 1 ) / 2 ] ) )
+    {
+        file->tas[k] = file->tas[ ( k - 1 ) / 2 ];
+        file->tas[k]->position = k;
+        k = ( k - 1 ) / 2;
+    }
+    file->tas[k] = d;
+    d->position = k;
+}
+
+void descendre_attente( file_attente *file, int k )
+{
+    demande_attente *d = file->tas[k];
+    for( ;; )
+    {
+        int fils = 2 * k + 1;
+        if( fils >= file->nb )
+        {
+            break;
+        }
+        if( fils + 1 < file->nb && precede_attente( file->tas[ fils + 1 ], file->tas[ fils ] ) )
+        {
+            fils += 1;
+        }
+        if( !precede_attente( file->tas[ fils ], d ) )
+        {
+            break;
+        }
+        file->tas[k] = file->tas[ fils ];
+        file->tas[k]->position = k;
+        k = fils;
+    }
+    file->tas[k] = d;
+    d->position = k;
+}
+
+/*
+ * Cette fonction sert a mettre la personne *p en liste d'attente de la formation *f, avec le rang rang et le
+ * numero numero (si numero vaut 0, la demande recoit le numero suivant).
+ * On obtient 1 si reussite, 0 si la personne attend deja.
+ */
+int ajouter_attente( db_formation *db, formation *f, personne *p, int rang, int numero )
+{
+    demande_attente *d;
+    int c;
+    agrandir_table_attente( &db->attentes );
+    c = chercher_case_attente( &db->attentes, f->id, p->id );
+    if( db->attentes.cases[c] != NULL && db->attentes.cases[c] != &case_attente_retiree )
+    {
+        return 0;
+    }
+    if( f->attente == NULL )
+    {
+        f->attente = ( file_attente * ) ALLOUER( 1, sizeof( file_attente ), "file_attente" );
+    }
+    if( f->attente->nb == f->attente->capacite )
+    {
+        f->attente->capacite = f->attente->capacite ? f->attente->capacite * 2 : 8;
+        f->attente->tas = ( demande_attente ** ) REALLOUER( f->attente->tas,
+                                                            f->attente->capacite * sizeof( demande_attente * ),
+                                                            "file_attente" );
+    }
+    d = ( demande_attente * ) ALLOUER( 1, sizeof( demande_attente ), "demande_attente" );
+    d->p = p;
+    d->formation = f->id;
+    d->rang = rang;
+    d->numero = numero > 0 ? numero : db->numero_attente + 1;
+    if( d->numero > db->numero_attente )
+    {
+        db->numero_attente = d->numero;
+    }
+    if( db->attentes.cases[c] == &case_attente_retiree )
+    {
+        db->attentes.nb_tombes -= 1;
+    }
+    db->attentes.cases[c] = d;
+    db->attentes.nb += 1;
+    f->attente->tas[ f->attente->nb ] = d;
+    f->attente->nb += 1;
+    monter_attente( f->attente, f->attente->nb - 1 );
+    noter_attente( d, 1 );
+    return 1;
+}
+
+/*
+ * Cette fonction sert a retirer la demande *d de la liste d'attente de la formation *f et a la liberer, en
+ * O(log n): la derniere demande du tas prend sa place puis remonte ou descend.
+ */
+void retirer_demande_attente( db_formation *db, formation *f, demande_attente *d )
+{
+    file_attente *file = f->attente;
+    int k = d->position;
+    noter_attente( d, 0 );
+    db->attentes.cases[ chercher_case_attente( &db->attentes, d->formation, d->p->id ) ] = &case_attente_retiree;
+    db->attentes.nb -= 1;
+    db->attentes.nb_tombes += 1;
+    file->nb -= 1;
+    if( k < file->nb )
+    {
+        demande_attente *derniere = file->tas[ file->nb ];
+        file->tas[k] = derniere;
+        derniere->position = k;
+        monter_attente( file, k );
+        descendre_attente( file, derniere->position );
+    }
+    LIBERER( d );
+}
+
+/*
+ * Cette fonction sert a retirer toutes les demandes de la liste d'attente de la formation *f et a liberer la file.
+ */
+void vider_attente( db_formation *db, formation *f )
+{
+    int i;
+    if( f->attente == NULL )
+    {
+        return;
+    }
+    for( i = f->attente->nb - 1; i >= 0; i-- )
+    {
+        retirer_demande_attente( db, f, f->attente->tas[i] );
+    }
+    LIBERER( f->attente->tas );
+    LIBERER( f->attente );
+    f->attente = NULL;
+}
+
+/*
+ * Cette fonction sert a ranger la formation *f, creee par creer_formation, dans la base de donnees db_formation
+ * *db. Elle suit la meme logique que ranger_db_personne: f est toujours consommee, copiee dans sa page puis
+ * liberee, et on renvoie l'adresse de la formation dans la base de donnees. Si l'identifiant est invalide ou
+ * deja utilise, f est liberee par liberer_formation et on renvoie NULL.
+ */
+formation *ranger_db_formation( db_formation *db, formation *f )
+{
+    page_formation *page;
+    int k = f->id >> DECALAGE_PAGE, i = f->id & ( TAILLE_PAGE - 1 );
+    if( f->id <= 0 || f->id > ID_MAX || get_formation_par_id( db, f->id ) != NULL )
+    {
+        liberer_formation( f );
+        return NULL;
+    }
+    agrandir_pages( ( void *** ) &db->pages, &db->nb_pages, k );
+    if( db->pages[k] == NULL )
+    {
+        db->pages[k] = ( page_formation * ) ALLOUER( 1, sizeof( page_formation ), "page_formation" );
+        compter_octets( sizeof( page_formation ) );
+    }
+    page = db->pages[k];
+    page->enregistrements[i] = *f;
+    page->vivant[i] = 1;
+    page->nb_vivants += 1;
+    agrandir_ordre( &db->ordre, &db->capacite_ordre, db->taille_ordre );
+    page->position[i] = db->taille_ordre;
+    db->ordre[ db->taille_ordre ] = f->id;
+    db->taille_ordre += 1;
+    db->nb += 1;
+    db->index_a_jour = 0;
+    reserver_id( &db->ids, f->id );
+    indexer_seances( db, &page->enregistrements[i] );
+    noter_formation( &page->enregistrements[i], page->position[i], 1 );
+    LIBERER( f );
+    return &page->enregistrements[i];
+}
+
+/*
+ * Cette fonction suit la meme logique que compacter_db_personne pour la base de donnees des formations.
+ */
+void compacter_db_formation( db_formation *dbf )
+{
+    int i, j = 0;
+    for( i = 0; i < dbf->taille_ordre; i++ )
+    {
+        int id = dbf->ordre[i];
+        if( id != 0 )
+        {
+            dbf->pages[ id >> DECALAGE_PAGE ]->position[ id & ( TAILLE_PAGE - 1 ) ] = j;
+            dbf->ordre[ j++ ] = id;
+        }
+    }
+    dbf->taille_ordre = j;
+    dbf->nb_tombes = 0;
+    for( i = 0; i < dbf->nb_pages; i++ )
+    {
+        if( dbf->pages[i] != NULL && dbf->pages[i]->nb_vivants == 0 )
+        {
+            LIBERER( dbf->pages[i] );
+            dbf->pages[i] = NULL;
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a supprimer une formation de la base de donnees a partir de son identifiant.
+ * Elle suit la meme demarche que supprimer_db_personne, le vecteur des inscrits de la formation est libere.
+ * On arrete la fonction, si reussite, on obtient 1, si pas, on obtient 0.
+ */
+int supprimer_db_formation( db_formation *dbf, int id )
+{
+    formation *f = get_formation_par_id( dbf, id );
+    page_formation *page;
+    chrono ch;
+    int i;
+    if( f == NULL )
+    {
+        return 0;
+    }
+    demarrer_compteur( &ch, CPT_SUPPRIMER_DB_FORMATION );
+    compter_visites( 1 );
+    page = dbf->pages[ id >> DECALAGE_PAGE ];
+    i = id & ( TAILLE_PAGE - 1 );
+    dbf->ordre[ page->position[i] ] = 0;
+    dbf->nb_tombes += 1;
+    retirer_seances( dbf, f );
+    vider_attente( dbf, f );
+    noter_formation( f, page->position[i], 0 );
+    LIBERER( f->inscrits );
+    relacher( f->nom );
+    memset( f, 0, sizeof( formation ) );
+    page->vivant[i] = 0;
+    page->nb_vivants -= 1;
+    dbf->nb -= 1;
+    dbf->index_a_jour = 0;
+    liberer_id( &dbf->ids, id );
+    if( dbf->nb_tombes > 32 && dbf->nb_tombes * 2 > dbf->taille_ordre )
+    {
+        compter_visites( dbf->taille_ordre );
+        compacter_db_formation( dbf );
+    }
+    arreter_compteur( &ch );
+    return 1;
+}
+
+/*
+ * Cette fonction sert a liberer toute la memoire occupee par la base de donnees dbf, dbf compris,
+ * y compris les vecteurs des inscrits de chaque formation.
+ */
+void liberer_db_formation( db_formation *dbf )
+{
+    int k, i;
+    for( k = 0; k < dbf->nb_pages; k++ )
+    {
+        if( dbf->pages[k] != NULL )
+        {
+            for( i = 0; i < TAILLE_PAGE; i++ )
+            {
+                file_attente *file = dbf->pages[k]->enregistrements[i].attente;
+                if( file != NULL )
+                {
+                    int d;
+                    for( d = 0; d < file->nb; d++ )
+                    {
+                        LIBERER( file->tas[d] );
+                    }
+                    LIBERER( file->tas );
+                    LIBERER( file );
+                }
+                LIBERER( dbf->pages[k]->enregistrements[i].inscrits );
+                relacher( dbf->pages[k]->enregistrements[i].nom );
+            }
+            LIBERER( dbf->pages[k] );
+        }
+    }
+    for( k = 0; k < 7; k++ )
+    {
+        for( i = 0; i < 24; i++ )
+        {
+            LIBERER( dbf->horaire[k][i].seances );
+        }
+    }
+    LIBERER( dbf->pages );
+    LIBERER( dbf->ordre );
+    LIBERER( dbf->par_nom );
+    LIBERER( dbf->salles );
+    LIBERER( dbf->attentes.cases );
+    vider_allocateur_id( &dbf->ids );
+    LIBERER( dbf );
+}
+
+/*
+ * Fonction de comparaison utilisee par qsort pour construire l'index par nom de db_formation.
+ */
+int comparer_formation_nom( const void *a, const void *b )
+{
+    const formation *fa = *( formation * const * ) a;
+    const formation *fb = *( formation * const * ) b;
+    int res = comparer_noms( fa->nom, fb->nom );
+    if( res == 0 )
+    {
+        res = fa->id < fb->id ? -1 : fa->id > fb->id;
+    }
+    return res;
+}
+
+formation *suivant_curseur_formation( curseur_formation *c );
+void indexer_db_formation( db_formation *db );
+
+/*
+ * Cette fonction suit la meme logique que debut_curseur_personne pour la base de donnees des formations.
+ */
+formation *debut_curseur_formation( curseur_formation *c, db_formation *db, int ordre )
+{
+    c->db = db;
+    c->ordre = ordre;
+    c->position = -1;
+    if( ordre == ORDRE_RECENT )
+    {
+        c->position = db->taille_ordre;
+    }
+    else if( ordre == ORDRE_ID )
+    {
+        c->position = 0;
+    }
+    else if( ordre == ORDRE_NOM )
+    {
+        indexer_db_formation( db );
+    }
+    return suivant_curseur_formation( c );
+}
+
+/*
+ * Cette fonction sert a avancer le curseur c et renvoie la formation suivante, NULL a la fin du parcours.
+ */
+formation *suivant_curseur_formation( curseur_formation *c )
+{
+    db_formation *db = c->db;
+    if( c->ordre == ORDRE_INSERTION )
+    {
+        while( ++c->position < db->taille_ordre )
+        {
+            if( db->ordre[ c->position ] != 0 )
+            {
+                return get_formation_par_id( db, db->ordre[ c->position ] );
+            }
+        }
+        return NULL;
+    }
+    if( c->ordre == ORDRE_RECENT )
+    {
+        while( --c->position >= 0 )
+        {
+            if( db->ordre[ c->position ] != 0 )
+            {
+                return get_formation_par_id( db, db->ordre[ c->position ] );
+            }
+        }
+        return NULL;
+    }
+    if( c->ordre == ORDRE_ID )
+    {
+        while( ++c->position < db->nb_pages * TAILLE_PAGE )
+        {
+            page_formation *page = db->pages[ c->position >> DECALAGE_PAGE ];
+            if( page == NULL )
+            {
+                c->position |= TAILLE_PAGE - 1;
+                continue;
+            }
+            if( page->vivant[ c->position & ( TAILLE_PAGE - 1 ) ] )
+            {
+                return &page->enregistrements[ c->position & ( TAILLE_PAGE - 1 ) ];
+            }
+        }
+        return NULL;
+    }
+    if( ++c->position < db->nb )
+    {
+        return db->par_nom[ c->position ];
+    }
+    return NULL;
+}
+
+/*
+ * Cette fonction suit la meme logique que indexer_db_personne pour la base de donnees des formations.
+ */
+void indexer_db_formation( db_formation *db )
+{
+    curseur_formation c;
+    formation *tmpf;
+    int i = 0;
+    if( db->index_a_jour )
+    {
+        return;
+    }
+    if( db->nb > db->capacite_index )
+    {
+        int capacite = db->capacite_index ? db->capacite_index : 16;
+        while( capacite < db->nb )
+        {
+            capacite *= 2;
+        }
+        LIBERER( db->par_nom );
+        db->par_nom = ( formation ** ) ALLOUER( capacite, sizeof( formation * ), "index_nom" );
+        db->capacite_index = capacite;
+    }
+    for( tmpf = debut_curseur_formation( &c, db, ORDRE_ID ); tmpf != NULL; tmpf = suivant_curseur_formation( &c ) )
+    {
+        db->par_nom[ i++ ] = tmpf;
+    }
+    qsort( db->par_nom, db->nb, sizeof( formation * ), comparer_formation_nom );
+    db->index_a_jour = 1;
+}
+
+formation **plage_nom_formations( db_formation *db, const char *cle, const char *texte, int *nb );
+
+/*
+ * Cette fonction renvoie NULL si une formation avec un nom specifique n'existe pas dans
+ * la base de donnees db_formation *dbf.
+ * Sinon, la fonction retourne la formation trouvee, celle qui a le plus petit identifiant s'il y en a plusieurs.
+ * Comme dans get_personne, le nom est d'abord cherche dans la table des chaines, puis dans l'index par nom, ou
+ * les formations de meme nom se suivent par identifiant.
+ */
+formation *get_formation( db_formation *dbf, const char nom_formation[] )
+{
+    formation **plage = NULL;
+    chrono ch;
+    int nb = 0;
+    const char *nom_interne = chaine_existante( nom_formation );
+    demarrer_compteur( &ch, CPT_GET_FORMATION );
+    if( nom_interne != NULL )
+    {
+        plage = plage_nom_formations( dbf, cle_pliee( nom_interne ), nom_interne, &nb );
+    }
+    compter_visites( nb > 0 );
+    arreter_compteur( &ch );
+    return nb > 0 ? plage[0] : NULL;
+}
+
+/*
+ * Cette fonction sert a afficher la ligne d'une formation dans une liste.
+ */
+void afficher_ligne_formation( formation *f )
+{
+    printf( "* %2d %-*s %3d.%02d                           *\n", f->id, largeur_utf8( f->nom, 40 ), f->nom,
+            PRIX( f->prix ) );
+}
+
+/*
+ * Cette fonction affiche l'identifiant, le nom et le prix de chaque formation de la base de donnees,
+ * dans l'ordre choisi.
+ */
+void afficher_liste_formations( db_formation *dbf, int ordre )
+{
+    curseur_formation c;
+    formation *tmpf;
+    printf( "* %2s %-40s %-6s                           *\n", "ID", "Nom", "Prix" );
+    printf( "* ---------------------------------------------------------------------------- *\n" );
+    for( tmpf = debut_curseur_formation( &c, dbf, ordre ); tmpf != NULL; tmpf = suivant_curseur_formation( &c ) )
+    {
+        afficher_ligne_formation( tmpf );
+    }
+}
+
+/*
+ * Cette structure associe l'identifiant d'une formation a sa position dans la base de donnees.
+ * Un vecteur de ces entrees, trie par identifiant, permet de retrouver les prerequis d'une formation
+ * par recherche dichotomique au lieu de reparcourir toute la base de donnees.
+ */
+typedef struct position_formation
+{
+    int id;
+    int position;
+} position_formation;
+
+/*
+ * Cette structure decrit une tranche du planning: les formations de la position debut (incluse) a la position
+ * fin (exclue) pour un jour donne. Chaque tranche est construite par un ouvrier dans son propre tampon.
+ * formation **formations : Les formations de la base de donnees, dans l'ordre de la liste chainee.
+ * position_formation *index : Les positions des formations, triees par identifiant.
+ * int nb_formations : Le nombre de formations dans les deux vecteurs.
+ * int jour : Le jour de la semaine (1 - lundi, 2 - mardi, etc...).
+ * int debut, fin : Les positions des formations traitees par cette tranche.
+ * tampon sortie : Le texte produit par la tranche.
+ */
+typedef struct tranche_planning
+{
+    formation **formations;
+    position_formation *index;
+    int nb_formations;
+    int jour;
+    int debut;
+    int fin;
+    tampon sortie;
+} tranche_planning;
+
+/*
+ * Nombre de formations traitees par une tranche du planning.
+ */
+#define TAILLE_TRANCHE_PLANNING 128
+
+/*
+ * En dessous de ce nombre de formations, le planning est construit sans threads.
+ */
+#define SEUIL_PLANNING_PARALLELE 256
+
+int comparer_position_formation( const void *a, const void *b )
+{
+    const position_formation *pa = ( const position_formation * ) a;
+    const position_formation *pb = ( const position_formation * ) b;
+    if( pa->id != pb->id )
+    {
+        return pa->id < pb->id ? -1 : 1;
+    }
+    return pa->position - pb->position;
+}
+
+/*
+ * Cette fonction sert a ecrire dans le tampon t les prerequis de la formation f.
+ * Les noms sont ecrits dans l'ordre de la base de donnees, puis dans l'ordre du vecteur prerequis,
+ * exactement comme le ferait un parcours de toute la liste pour chaque prerequis.
+ */
+void rendre_prerequis_planning( tampon *t, formation *f, tranche_planning *tr )
+{
+    position_formation local[ 32 ];
+    position_formation *trouves = local;
+    int nb_trouves = 0, capacite = 32;
+    int k, i;
+    for( k = 0; k < f->nb_prerequis; k++ )
+    {
+        int bas = 0, haut = tr->nb_formations;
+        while( bas < haut )
+        {
+            int milieu = bas + ( haut - bas ) / 2;
+            if( tr->index[ milieu ].id < f->prerequis[k] )
+            {
+                bas = milieu + 1;
+            }
+            else
+            {
+                haut = milieu;
+            }
+        }
+        for( i = bas; i < tr->nb_formations && tr->index[i].id == f->prerequis[k]; i++ )
+        {
+            if( nb_trouves == capacite )
+            {
+                position_formation *plus = ( position_formation * ) ALLOUER( capacite * 2, sizeof( position_formation ),
+                                                                             "prerequis_planning" );
+                memcpy( plus, trouves, nb_trouves * sizeof( position_formation ) );
+                if( trouves != local )
+                {
+                    LIBERER( trouves );
+                }
+                trouves = plus;
+                capacite *= 2;
+            }
+            /* id sert ici a garder l'ordre du vecteur prerequis pour une meme position */
+            trouves[ nb_trouves ].id = k;
+            trouves[ nb_trouves ].position = tr->index[i].position;
+            nb_trouves += 1;
+        }
+    }
+    for( i = 1; i < nb_trouves; i++ )
+    {
+        position_formation cle = trouves[i];
+        int j = i - 1;
+        while( j >= 0 && ( trouves[j].position > cle.position ||
+               ( trouves[j].position == cle.position && trouves[j].id > cle.id ) ) )
+        {
+            trouves[ j + 1 ] = trouves[j];
+            j--;
+        }
+        trouves[ j + 1 ] = cle;
+    }
+    for( i = 0; i < nb_trouves; i++ )
+    {
+        tampon_printf( t, "%s ", tr->formations[ trouves[i].position ]->nom );
+    }
+    if( trouves != local )
+    {
+        LIBERER( trouves );
+    }
+}
+
+/*
+ * Cette fonction sert a ecrire dans le tampon t une seance de la formation f: ses participants,
+ * l'horaire de la seance j et ses prerequis.
+ */
+void rendre_seance_planning( tampon *t, formation *f, int j, tranche_planning *tr )
+{
+    int i;
+    tampon_printf( t, "ID: %d - Nom formation: %s\n", f->id, f->nom );
+    tampon_printf( t, "Participants dans la formation:\n" );
+    tampon_printf( t, "Formateurs:\n" );
+    for( i = f->nb_inscrits - 1; i >= 0; i-- )
+    {
+        if( f->inscrits[i] != NULL && f->inscrits[i]->formateur == 1 )
+        {
+            tampon_printf( t, "%2d %s %s\n", f->inscrits[i]->id, f->inscrits[i]->nom, f->inscrits[i]->prenom );
+        }
+    }
+    tampon_printf( t, "Etudiants:\n" );
+    for( i = f->nb_inscrits - 1; i >= 0; i-- )
+    {
+        if( f->inscrits[i] != NULL && f->inscrits[i]->formateur == 0 )
+        {
+            tampon_printf( t, "%2d %s %s\n", f->inscrits[i]->id, f->inscrits[i]->nom, f->inscrits[i]->prenom );
+        }
+    }
+    tampon_printf( t, "\n" );
+    tampon_printf( t, "De: " FORMAT_HORAIRE " - A " FORMAT_HORAIRE "\n", HORAIRE( f->heures[j] ),
+                   HORAIRE( f->heures[j] + f->durees[j] ) );
+    tampon_printf( t, "Prerequis: " );
+    if( f->nb_prerequis > 0 )
+    {
+        rendre_prerequis_planning( t, f, tr );
+        tampon_printf( t, "\n\n" );
+    }
+    else
+    {
+        tampon_printf( t, "Aucun\n\n" );
+    }
+}
+
+/*
+ * Cette fonction est la tache executee par le pool pour une tranche du planning.
+ * Elle parcourt les formations de la tranche et ecrit chaque seance qui a lieu le jour de la tranche.
+ */
+void construire_tranche_planning( void *arg )
+{
+    tranche_planning *tr = ( tranche_planning * ) arg;
+    int i;
+    for( i = tr->debut; i < tr->fin; i++ )
+    {
+        formation *f = tr->formations[i];
+        int j;
+        for( j = 0; j < f->nb_jours; j++ )
+        {
+            if( f->jours[j] == tr->jour )
+            {
+                rendre_seance_planning( &tr->sortie, f, j, tr );
+            }
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a ecrire le planning de la semaine de la base de donnees dbf dans le flux sortie.
+ * Chaque jour est decoupe en tranches de TAILLE_TRANCHE_PLANNING formations, les tranches sont construites
+ * en parallele par un pool d'ouvriers dans des tampons separes, puis ecrites dans l'ordre.
+ * Le texte produit est identique a celui d'un parcours sequentiel jour par jour.
+ */
+void ecrire_planning_flux( db_formation *dbf, FILE *sortie )
+{
+    char jour[7][9] = { "Lundi", "Mardi", "Mercredi", "Jeudi", "Vendredi", "Samedi", "Dimanche" };
+    curseur_formation c;
+    formation *tmpf;
+    formation **formations;
+    position_formation *index;
+    tranche_planning *tranches;
+    pool_taches *pool;
+    chrono ch;
+    int nb_formations = dbf->nb, nb_par_jour, nb_tranches, i, t;
+    demarrer_compteur( &ch, CPT_ECRIRE_PLANNING );
+    formations = ( formation ** ) ALLOUER( nb_formations + 1, sizeof( formation * ), "planning" );
+    index = ( position_formation * ) ALLOUER( nb_formations + 1, sizeof( position_formation ), "position_formation" );
+    compter_octets( ( nb_formations + 1 ) * ( sizeof( formation * ) + sizeof( position_formation ) ) );
+    for( i = 0, tmpf = debut_curseur_formation( &c, dbf, ORDRE_RECENT ); tmpf != NULL;
+         i++, tmpf = suivant_curseur_formation( &c ) )
+    {
+        formations[i] = tmpf;
+        index[i].id = tmpf->id;
+        index[i].position = i;
+    }
+    qsort( index, nb_formations, sizeof( position_formation ), comparer_position_formation );
+    nb_par_jour = ( nb_formations + TAILLE_TRANCHE_PLANNING - 1 ) / TAILLE_TRANCHE_PLANNING;
+    nb_tranches = 7 * nb_par_jour;
+    tranches = ( tranche_planning * ) ALLOUER( nb_tranches + 1, sizeof( tranche_planning ), "tranche_planning" );
+    compter_octets( ( nb_tranches + 1 ) * sizeof( tranche_planning ) );
+    pool = creer_pool_taches( nb_formations < SEUIL_PLANNING_PARALLELE ? 0 : nombre_processeurs() );
+    for( t = 0; t < nb_tranches; t++ )
+    {
+        tranches[t].formations = formations;
+        tranches[t].index = index;
+        tranches[t].nb_formations = nb_formations;
+        tranches[t].jour = t / nb_par_jour + 1;
+        tranches[t].debut = ( t % nb_par_jour ) * TAILLE_TRANCHE_PLANNING;
+        tranches[t].fin = tranches[t].debut + TAILLE_TRANCHE_PLANNING;
+        if( tranches[t].fin > nb_formations )
+        {
+            tranches[t].fin = nb_formations;
+        }
+        initialiser_tampon( &tranches[t].sortie );
+        soumettre_tache( pool, construire_tranche_planning, &tranches[t] );
+    }
+    attendre_pool_taches( pool );
+    detruire_pool_taches( pool );
+    compter_visites( 7 * ( unsigned long ) nb_formations );
+    for( i = 1; i <= 7; i++ )
+    {
+        fprintf( sortie, "********************************************************************************\n" );
+        fprintf( sortie, "Cours du: %s\n", jour[i - 1] );
+        fprintf( sortie, "********************************************************************************\n" );
+        for( t = ( i - 1 ) * nb_par_jour; t < i * nb_par_jour; t++ )
+        {
+            if( tranches[t].sortie.taille > 0 )
+            {
+                fwrite( tranches[t].sortie.donnees, 1, tranches[t].sortie.taille, sortie );
+            }
+            compter_octets( tranches[t].sortie.capacite );
+            liberer_tampon( &tranches[t].sortie );
+        }
+    }
+    LIBERER( tranches );
+    LIBERER( index );
+    LIBERER( formations );
+    arreter_compteur( &ch );
+}
+
+/*
+ * Cette fonction sert a afficher le planning de la semaine: pour chaque jour, les formations qui ont
+ * lieu ce jour-la avec leurs participants, leur horaire et leurs prerequis.
+ */
+void afficher_db_formation( db_formation *dbf )
+{
+    ecrire_planning_flux( dbf, stdout );
+}
+
+/*
+ * Fonction de comparaison utilisee par qsort pour trier des seances par heure de debut, puis de fin, puis par
+ * formation.
+ */
+int comparer_seances( const void *a, const void *b )
+{
+    const seance *sa = ( const seance * ) a;
+    const seance *sb = ( const seance * ) b;
+    if( sa->debut != sb->debut )
+    {
+        return sa->debut < sb->debut ? -1 : 1;
+    }
+    if( sa->fin != sb->fin )
+    {
+        return sa->fin < sb->fin ? -1 : 1;
+    }
+    return sa->formation != sb->formation ? ( sa->formation < sb->formation ? -1 : 1 ) : sa->creneau - sb->creneau;
+}
+
+/*
+ * Cette fonction sert a chercher dans l'index des seances celles du jour jour (1 a 7) qui ont lieu entre les
+ * minutes debut et fin, ou a la minute debut si fin <= debut. Seules les tranches horaires de la fenetre sont lues,
+ * et une seance n'est retenue que dans la premiere tranche de la fenetre qu'elle touche: le travail est
+ * proportionnel au nombre de seances trouvees.
+ * Les seances sont mises dans *resultats (a liberer), triees par heure. On renvoie leur nombre.
+ */
+int chercher_seances( db_formation *dbf, int jour, int debut, int fin, seance **resultats )
+{
+    chrono ch;
+    int h, k, premiere, derniere, nb = 0, capacite = 0;
+    *resultats = NULL;
+    if( jour < 1 || jour > 7 )
+    {
+        return 0;
+    }
+    demarrer_compteur( &ch, CPT_CHERCHER_SEANCES );
+    tranches_seance( debut, fin > debut ? fin : debut, &premiere, &derniere );
+    for( h = premiere; h <= derniere; h++ )
+    {
+        tranche_horaire *t = &dbf->horaire[ jour - 1 ][h];
+        compter_visites( t->nb );
+        for( k = 0; k < t->nb; k++ )
+        {
+            seance *s = &t->seances[k];
+            int tranche;
+            if( s->formation == 0 || s->fin <= debut || ( fin > debut ? s->debut >= fin : s->debut > debut ) )
+            {
+                continue;
+            }
+            tranche = s->debut < 0 ? 0 : s->debut >= 24 * 60 ? 23 : s->debut / 60;
+            if( h != ( tranche > premiere ? tranche : premiere ) )
+            {
+                continue;
+            }
+            if( nb == capacite )
+            {
+                capacite = capacite ? capacite * 2 : 16;
+                *resultats = ( seance * ) REALLOUER( *resultats, capacite * sizeof( seance ), "seances_trouvees" );
+            }
+            ( *resultats )[ nb++ ] = *s;
+        }
+    }
+    if( nb > 1 )
+    {
+        qsort( *resultats, nb, sizeof( seance ), comparer_seances );
+    }
+    arreter_compteur( &ch );
+    return nb;
+}
+
+/*
+ * Cette fonction sert a donner le jour (1 pour lundi a 7 pour dimanche) et l'heure actuels, en minutes depuis
+ * minuit comme dans les formations.
+ */
+void instant_present( int *jour, int *minutes )
+{
+    time_t t = time( NULL );
+    struct tm *maintenant_tm = localtime( &t );
+    *jour = maintenant_tm->tm_wday == 0 ? 7 : maintenant_tm->tm_wday;
+    *minutes = maintenant_tm->tm_hour * 60 + maintenant_tm->tm_min;
+}
+
+/*
+ * Cette fonction sert a afficher les seances du jour jour entre les minutes debut et fin (a la minute debut si
+ * fin <= debut).
+ */
+void afficher_seances( db_formation *dbf, int jour, int debut, int fin )
+{
+    char nom_jour[7][9] = { "Lundi", "Mardi", "Mercredi", "Jeudi", "Vendredi", "Samedi", "Dimanche" };
+    seance *seances;
+    int i, nb = chercher_seances( dbf, jour, debut, fin, &seances );
+    if( fin > debut )
+    {
+        printf( "* %s de " FORMAT_HORAIRE " a " FORMAT_HORAIRE ": %d seance(s)\n", nom_jour[ jour - 1 ],
+                HORAIRE( debut ), HORAIRE( fin ), nb );
+    }
+    else
+    {
+        printf( "* %s a " FORMAT_HORAIRE ": %d seance(s) en cours\n", nom_jour[ jour - 1 ], HORAIRE( debut ), nb );
+    }
+    for( i = 0; i < nb; i++ )
+    {
+        formation *f = get_formation_par_id( dbf, seances[i].formation );
+        printf( "* De: %2d.%02d - A %2d.%02d  %2d %s\n", HORAIRE( seances[i].debut ), HORAIRE( seances[i].fin ),
+                f->id, f->nom );
+    }
+    LIBERER( seances );
+}
+
+/*                             FIN FORMATION                                 */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                           FONCTIONS GENERALES                             */
+
+/*
+ * Cette fonction sert a attribuer la personne *p a la formation *f: la personne est inscrite dans la formation
+ * et la formation est ajoutee a la liste formations de la personne.
+ * On obtient 1 si reussite, 0 si la personne participe deja a la formation, -1 si elle participe deja a
+ * 30 formations.
+ */
+int attribuer_formation( formation *f, personne *p )
+{
+    if( p->nb_formations >= 30 )
+    {
+        return -1;
+    }
+    if( ajouter_formation( f, p ) == 0 )
+    {
+        return 0;
+    }
+    p->nb_formations += 1;
+    p->formations[ p->nb_formations - 1 ] = f->id;
+    noter_liste( p, p->nb_formations - 1, 1 );
+    return 1;
+}
+
+/*
+ * Cette fonction sert a retirer la formation idf de la liste formations de la personne *p, en gardant l'ordre des
+ * formations suivantes.
+ * On obtient 1 si reussite, 0 si la formation n'est pas dans la liste.
+ */
+int retirer_formation_liste( personne *p, int idf )
+{
+    int k;
+    for( k = 0; k < p->nb_formations && p->formations[k] != idf; k++ )
+    {
+    }
+    if( k == p->nb_formations )
+    {
+        return 0;
+    }
+    noter_liste( p, k, 0 );
+    memmove( &p->formations[k], &p->formations[ k + 1 ], ( p->nb_formations - k - 1 ) * sizeof( int ) );
+    p->nb_formations -= 1;
+    return 1;
+}
+
+/*
+ * Les seances sont reperees au quart d'heure pres dans les masques d'occupation: 96 quarts d'heure par jour,
+ * ranges dans MOTS_QUARTS mots.
+ */
+#define QUARTS_PAR_JOUR 96
+#define MOTS_QUARTS ( ( QUARTS_PAR_JOUR + BITS_PAR_MOT - 1 ) / BITS_PAR_MOT )
+
+/*
+ * Cette structure decrit la disponibilite et la charge d'un formateur pour la semaine.
+ * personne *p : Le formateur.
+ * unsigned int indisponible : Le bit j - 1 vaut 1 si le formateur est indisponible le jour j.
+ * unsigned int occupe[7][MOTS_QUARTS] : Les quarts d'heure de chaque jour (lundi = 0) ou il donne cours.
+ * int minutes : Le nombre de minutes de cours par semaine.
+ * int nb_seances : Le nombre de seances par semaine.
+ * int nb_conflits : Le nombre de seances qui tombent un jour d'indisponibilite.
+ */
+typedef struct disponibilite_formateur
+{
+    personne *p;
+    unsigned int indisponible;
+    unsigned int occupe[7][ MOTS_QUARTS ];
+    int minutes;
+    int nb_seances;
+    int nb_conflits;
+} disponibilite_formateur;
+
+/*
+ * Cette fonction sert a mettre a 1 dans masque les quarts d'heure touches par une seance de debut a fin (en
+ * minutes). Une fin au-dela de minuit est coupee a minuit.
+ */
+void marquer_quarts( unsigned int masque[], int debut, int fin )
+{
+    int q, dernier = ( fin + 14 ) / 15;
+    if( dernier > QUARTS_PAR_JOUR )
+    {
+        dernier = QUARTS_PAR_JOUR;
+    }
+    for( q = debut / 15; q < dernier; q++ )
+    {
+        masque[ q / BITS_PAR_MOT ] |= 1u << ( q % BITS_PAR_MOT );
+    }
+}
+
+/*
+ * Cette fonction renvoie 1 si les masques a et b ont un quart d'heure en commun, 0 si pas.
+ */
+int quarts_communs( const unsigned int a[], const unsigned int b[] )
+{
+    int i;
+    for( i = 0; i < MOTS_QUARTS; i++ )
+    {
+        if( a[i] & b[i] )
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Cette fonction sert a calculer la disponibilite et la charge du formateur *p: on ne lit que ses jours
+ * d'indisponibilite et ses formations (30 au plus).
+ */
+void calculer_disponibilite( disponibilite_formateur *d, db_formation *dbf, personne *p )
+{
+    int i, j;
+    memset( d, 0, sizeof( disponibilite_formateur ) );
+    d->p = p;
+    for( i = 0; i < p->nb_jours_indisponible && i < 7; i++ )
+    {
+        if( p->jours_indisponible[i] >= 1 && p->jours_indisponible[i] <= 7 )
+        {
+            d->indisponible |= 1u << ( p->jours_indisponible[i] - 1 );
+        }
+    }
+    for( i = 0; i < p->nb_formations && i < 30; i++ )
+    {
+        formation *f = get_formation_par_id( dbf, p->formations[i] );
+        if( f == NULL )
+        {
+            continue;
+        }
+        for( j = 0; j < f->nb_jours && j < 7; j++ )
+        {
+            int debut = f->heures[j];
+            int fin = f->heures[j] + f->durees[j];
+            if( f->jours[j] < 1 || f->jours[j] > 7 )
+            {
+                continue;
+            }
+            marquer_quarts( d->occupe[ f->jours[j] - 1 ], debut, fin );
+            d->minutes += fin - debut;
+            d->nb_seances += 1;
+            if( d->indisponible & ( 1u << ( f->jours[j] - 1 ) ) )
+            {
+                d->nb_conflits += 1;
+            }
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a prevenir, avant d'attribuer le formateur *p a la formation *f, des seances de f qui
+ * tombent un jour ou il est indisponible ou pendant un de ses autres cours. On renvoie le nombre d'avertissements.
+ */
+int avertir_disponibilite( db_formation *dbf, formation *f, personne *p )
+{
+    char nom_jour[7][9] = { "Lundi", "Mardi", "Mercredi", "Jeudi", "Vendredi", "Samedi", "Dimanche" };
+    disponibilite_formateur d;
+    int j, k, nb = 0;
+    for( k = 0; k < p->nb_formations; k++ )
+    {
+        if( p->formations[k] == f->id )
+        {
+            return 0;
+        }
+    }
+    calculer_disponibilite( &d, dbf, p );
+    for( j = 0; j < f->nb_jours && j < 7; j++ )
+    {
+        unsigned int seance[ MOTS_QUARTS ];
+        if( f->jours[j] < 1 || f->jours[j] > 7 )
+        {
+            continue;
+        }
+        if( d.indisponible & ( 1u << ( f->jours[j] - 1 ) ) )
+        {
+            printf( "* Attention: %s %s est indisponible le %s (" FORMAT_HORAIRE " - " FORMAT_HORAIRE ")\n",
+                    p->nom, p->prenom, nom_jour[ f->jours[j] - 1 ], HORAIRE( f->heures[j] ),
+                    HORAIRE( f->heures[j] + f->durees[j] ) );
+            nb += 1;
+            continue;
+        }
+        memset( seance, 0, sizeof( seance ) );
+        marquer_quarts( seance, f->heures[j], f->heures[j] + f->durees[j] );
+        if( quarts_communs( seance, d.occupe[ f->jours[j] - 1 ] ) )
+        {
+            printf( "* Attention: %s %s donne deja cours le %s entre " FORMAT_HORAIRE " et " FORMAT_HORAIRE "\n",
+                    p->nom, p->prenom, nom_jour[ f->jours[j] - 1 ], HORAIRE( f->heures[j] ),
+                    HORAIRE( f->heures[j] + f->durees[j] ) );
+            nb += 1;
+        }
+    }
+    return nb;
+}
+
+/*
+ * Cette fonction renvoie la salle qui a l'identifiant id, NULL si elle n'existe pas. Les salles sont triees par
+ * identifiant, on les cherche par dichotomie.
+ */
+salle *get_salle_par_id( db_formation *dbf, int id )
+{
+    int bas = 0, haut = dbf->nb_salles;
+    while( bas < haut )
+    {
+        int milieu = bas + ( haut - bas ) / 2;
+        if( dbf->salles[ milieu ].id < id )
+        {
+            bas = milieu + 1;
+        }
+        else
+        {
+            haut = milieu;
+        }
+    }
+    return bas < dbf->nb_salles && dbf->salles[ bas ].id == id ? &dbf->salles[ bas ] : NULL;
+}
+
+/*
+ * Cette fonction sert a ajouter une salle de capacite places a la base de donnees dbf. Si id vaut 0, la salle
+ * recoit l'identifiant qui suit le plus grand identifiant existant, au plus ID_MAX.
+ * On renvoie la salle ajoutee, NULL si l'identifiant est deja utilise ou epuise, ou si la capacite est invalide.
+ */
+salle *ajouter_salle( db_formation *dbf, int id, const char *nom, int capacite )
+{
+    int i;
+    if( id == 0 )
+    {
+        id = dbf->nb_salles > 0 ? dbf->salles[ dbf->nb_salles - 1 ].id : 0;
+        if( id >= ID_MAX )
+        {
+            return NULL;
+        }
+        id += 1;
+    }
+    if( id < 0 || capacite <= 0 || get_salle_par_id( dbf, id ) != NULL )
+    {
+        return NULL;
+    }
+    if( dbf->nb_salles == dbf->capacite_salles )
+    {
+        dbf->capacite_salles = dbf->capacite_salles ? dbf->capacite_salles * 2 : 16;
+        dbf->salles = ( salle * ) REALLOUER( dbf->salles, dbf->capacite_salles * sizeof( salle ), "salle" );
+    }
+    for( i = dbf->nb_salles; i > 0 && dbf->salles[ i - 1 ].id > id; i-- )
+    {
+        dbf->salles[i] = dbf->salles[ i - 1 ];
+    }
+    dbf->salles[i].id = id;
+    dbf->salles[i].capacite = capacite;
+    strncpy( dbf->salles[i].nom, nom, sizeof( dbf->salles[i].nom ) - 1 );
+    dbf->salles[i].nom[ sizeof( dbf->salles[i].nom ) - 1 ] = '\0';
+    dbf->nb_salles += 1;
+    noter_salle( &dbf->salles[i] );
+    return &dbf->salles[i];
+}
+
+/*
+ * Cette fonction sert a supprimer la salle id: les seances qui y avaient lieu n'ont plus de salle.
+ * On obtient 1 si reussite, 0 si la salle n'existe pas.
+ */
+int supprimer_salle( db_formation *dbf, int id )
+{
+    curseur_formation c;
+    formation *tmpf;
+    salle *s = get_salle_par_id( dbf, id );
+    int j;
+    if( s == NULL )
+    {
+        return 0;
+    }
+    memmove( s, s + 1, ( dbf->nb_salles - ( s - dbf->salles ) - 1 ) * sizeof( salle ) );
+    dbf->nb_salles -= 1;
+    for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_ID ); tmpf != NULL; tmpf = suivant_curseur_formation( &c ) )
+    {
+        for( j = 0; j < tmpf->nb_jours && j < 7; j++ )
+        {
+            if( tmpf->salles[j] == id )
+            {
+                tmpf->salles[j] = 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/*
+ * Cette fonction renvoie le nombre de participants (formateurs compris) de la formation *f.
+ */
+int nb_participants( formation *f )
+{
+    return f->nb_inscrits - f->nb_desinscrits;
+}
+
+/*
+ * Cette fonction renvoie le nombre d'apprenants de la formation *f en parcourant ses inscrits: ses participants qui
+ * ne sont pas formateurs. Le compte tenu a jour dans nb_apprenants doit toujours lui etre egal.
+ */
+int compter_apprenants( formation *f )
+{
+    int i, nb = 0;
+    for( i = 0; i < f->nb_inscrits; i++ )
+    {
+        nb += f->inscrits[i] != NULL && !f->inscrits[i]->formateur;
+    }
+    return nb;
+}
+
+/*
+ * Cette fonction sert a recompter les apprenants de toutes les formations de dbf, apres que des personnes inscrites
+ * ont pu changer de statut (voir commande_importer).
+ */
+void recompter_apprenants( db_formation *dbf )
+{
+    curseur_formation c;
+    formation *f;
+    for( f = debut_curseur_formation( &c, dbf, ORDRE_ID ); f != NULL; f = suivant_curseur_formation( &c ) )
+    {
+        f->nb_apprenants = compter_apprenants( f );
+    }
+}
+
+/*
+ * Cette fonction renvoie le nombre de places de la formation *f: la capacite de la plus petite des salles de ses
+ * seances, 0 si aucune de ses seances n'a de salle (pas de limite).
+ */
+int capacite_formation( db_formation *dbf, formation *f )
+{
+    int j, capacite = 0;
+    for( j = 0; j < f->nb_jours && j < 7; j++ )
+    {
+        salle *s = f->salles[j] != 0 ? get_salle_par_id( dbf, f->salles[j] ) : NULL;
+        if( s != NULL && ( capacite == 0 || s->capacite < capacite ) )
+        {
+            capacite = s->capacite;
+        }
+    }
+    return capacite;
+}
+
+/*
+ * Cette fonction renvoie 1 si la personne *p peut etre inscrite a la formation *f sans la surcharger, 0 si la
+ * formation est complete. Un formateur n'occupe pas de place.
+ */
+int place_libre( db_formation *dbf, formation *f, personne *p )
+{
+    int places = capacite_formation( dbf, f );
+    return places == 0 || p->formateur || f->nb_apprenants < places;
+}
+
+/*
+ * Cette fonction sert a mettre la personne *p en liste d'attente de la formation *f, a son rang selon la
+ * politique de dbf.
+ * On obtient 1 si reussite, 0 si la personne attend deja.
+ */
+int mettre_en_attente( db_formation *dbf, formation *f, personne *p )
+{
+    return ajouter_attente( dbf, f, p, rang_attente( dbf, f, p ), 0 );
+}
+
+/*
+ * Cette fonction sert a retirer la personne idp de la liste d'attente de la formation *f.
+ * On obtient 1 si reussite, 0 si la personne n'attendait pas.
+ */
+int retirer_attente( db_formation *dbf, formation *f, int idp )
+{
+    demande_attente *d = trouver_attente( dbf, f->id, idp );
+    if( d == NULL )
+    {
+        return 0;
+    }
+    retirer_demande_attente( dbf, f, d );
+    if( f->attente->nb == 0 )
+    {
+        vider_attente( dbf, f );
+    }
+    return 1;
+}
+
+/*
+ * Cette fonction sert a retirer la personne idp de toutes les listes d'attente, sans parcourir les formations:
+ * ses demandes sont toutes dans les cases de la table qui suivent case_initiale_attente, jusqu'a la premiere case
+ * vide. Retirer une demande laisse une pierre tombale, le parcours n'est donc pas interrompu.
+ * On obtient le nombre de demandes retirees.
+ */
+int retirer_attentes_personne( db_formation *dbf, int idp )
+{
+    table_attente *t = &dbf->attentes;
+    int i, nb = 0;
+    if( t->nb == 0 )
+    {
+        return 0;
+    }
+    for( i = case_initiale_attente( t, idp ); t->cases[i] != NULL; i = ( i + 1 ) & ( t->capacite - 1 ) )
+    {
+        demande_attente *d = t->cases[i];
+        formation *f = d != &case_attente_retiree && d->p->id == idp ? get_formation_par_id( dbf, d->formation ) :
+                       NULL;
+        if( f != NULL )
+        {
+            retirer_demande_attente( dbf, f, d );
+            if( f->attente->nb == 0 )
+            {
+                vider_attente( dbf, f );
+            }
+            nb += 1;
+        }
+    }
+    return nb;
+}
+
+/*
+ * Cette fonction sert a inscrire dans la formation *f les premieres personnes de sa liste d'attente, tant qu'il
+ * reste des places (toutes si la formation n'a pas de limite). Une personne qui participe deja a 30 formations
+ * perd sa place dans la file. Si journal ne vaut pas NULL, chaque personne inscrite y est ecrite.
+ * On obtient le nombre de personnes inscrites.
+ */
+int promouvoir_attente( db_formation *dbf, formation *f, FILE *journal )
+{
+    int nb = 0;
+    while( f->attente != NULL && f->attente->nb > 0 && place_libre( dbf, f, f->attente->tas[0]->p ) )
+    {
+        personne *p = f->attente->tas[0]->p;
+        int res = attribuer_formation( f, p );
+        retirer_attente( dbf, f, p->id );
+        if( res == 1 )
+        {
+            nb += 1;
+            if( journal != NULL )
+            {
+                fprintf( journal, "* %s %s quitte la liste d'attente de %s et y est inscrit(e) *\n",
+                         p->nom, p->prenom, f->nom );
+            }
+        }
+    }
+    return nb;
+}
+
+/*
+ * Les resultats de demander_inscription.
+ * INSCRIPTION_FAITE : La personne est inscrite.
+ * INSCRIPTION_EN_ATTENTE : La formation est complete, la personne est mise en liste d'attente.
+ * INSCRIPTION_DEJA_FAITE, INSCRIPTION_DEJA_EN_ATTENTE : Rien ne change, la personne participe deja a la formation
+ * ou l'attend deja.
+ * INSCRIPTION_IMPOSSIBLE : La personne participe deja a 30 formations.
+ */
+#define INSCRIPTION_FAITE 1
+#define INSCRIPTION_EN_ATTENTE 2
+#define INSCRIPTION_DEJA_FAITE 0
+#define INSCRIPTION_DEJA_EN_ATTENTE 3
+#define INSCRIPTION_IMPOSSIBLE -1
+
+/*
+ * Cette fonction sert a inscrire la personne *p a la formation *f s'il y reste une place (voir place_libre),
+ * sinon a la mettre en liste d'attente. Un apprenant ne passe pas devant ceux qui attendent deja: il prend son
+ * rang dans la file, puis les places libres sont attribuees dans l'ordre de la file. Une personne inscrite quitte
+ * la liste d'attente.
+ * C'est le chemin de toutes les inscriptions: le menu, la commande attente et l'importation. Le doublon est
+ * cherche dans la liste formations de la personne (30 au plus) plutot que dans les inscrits, qui peuvent etre des
+ * milliers.
+ * On obtient un des resultats INSCRIPTION_*.
+ */
+int demander_inscription( db_formation *dbf, formation *f, personne *p )
+{
+    int k;
+    for( k = 0; k < p->nb_formations && p->formations[k] != f->id; k++ )
+    {
+    }
+    if( k < p->nb_formations )
+    {
+        return INSCRIPTION_DEJA_FAITE;
+    }
+    if( p->nb_formations >= 30 )
+    {
+        return INSCRIPTION_IMPOSSIBLE;
+    }
+    if( !place_libre( dbf, f, p ) || ( !p->formateur && f->attente != NULL && f->attente->nb > 0 ) )
+    {
+        k = mettre_en_attente( dbf, f, p );
+        promouvoir_attente( dbf, f, NULL );
+        if( p->nb_formations > 0 && p->formations[ p->nb_formations - 1 ] == f->id )
+        {
+            return INSCRIPTION_FAITE;
+        }
+        return k ? INSCRIPTION_EN_ATTENTE : INSCRIPTION_DEJA_EN_ATTENTE;
+    }
+    inscrire_personne( f, p );
+    p->formations[ p->nb_formations ] = f->id;
+    p->nb_formations += 1;
+    noter_liste( p, p->nb_formations - 1, 1 );
+    retirer_attente( dbf, f, p->id );
+    return INSCRIPTION_FAITE;
+}
+
+/*
+ * Cette fonction sert a recalculer le rang de toutes les demandes d'attente, apres un changement de politique,
+ * et a reconstruire chaque tas en O(n).
+ */
+void reclasser_attentes( db_formation *dbf )
+{
+    curseur_formation c;
+    formation *f;
+    int i;
+    for( f = debut_curseur_formation( &c, dbf, ORDRE_RECENT ); f != NULL; f = suivant_curseur_formation( &c ) )
+    {
+        if( f->attente == NULL )
+        {
+            continue;
+        }
+        for( i = 0; i < f->attente->nb; i++ )
+        {
+            f->attente->tas[i]->rang = rang_attente( dbf, f, f->attente->tas[i]->p );
+        }
+        for( i = f->attente->nb / 2 - 1; i >= 0; i-- )
+        {
+            descendre_attente( f->attente, i );
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a comparer deux demandes d'attente pour qsort, dans l'ordre ou elles seront servies.
+ */
+int comparer_demandes_attente( const void *a, const void *b )
+{
+    demande_attente *da = *( demande_attente ** ) a, *db = *( demande_attente ** ) b;
+    return precede_attente( da, db ) ? -1 : precede_attente( db, da );
+}
+
+/*
+ * Cette fonction sert a copier dans *ordre (alloue, a liberer) les demandes de la liste d'attente de la formation
+ * *f dans l'ordre ou elles seront servies. Le tas n'est pas modifie.
+ * On obtient le nombre de demandes.
+ */
+int trier_attente( formation *f, demande_attente ***ordre )
+{
+    int nb = f->attente != NULL ? f->attente->nb : 0;
+    *ordre = ( demande_attente ** ) ALLOUER( nb + 1, sizeof( demande_attente * ), "ordre_attente" );
+    if( nb > 0 )
+    {
+        memcpy( *ordre, f->attente->tas, nb * sizeof( demande_attente * ) );
+        qsort( *ordre, nb, sizeof( demande_attente * ), comparer_demandes_attente );
+    }
+    return nb;
+}
+
+/*
+ * Une seance a placer dans une salle: le creneau creneau de la formation *f, le jour jour, de debut a fin
+ * (en minutes), pour besoin apprenants.
+ */
+typedef struct seance_a_placer
+{
+    formation *f;
+    int creneau;
+    int jour;
+    int debut;
+    int fin;
+    int besoin;
+} seance_a_placer;
+
+/*
+ * Fonction de comparaison utilisee par qsort pour trier les seances a placer par jour, par heure de debut, puis
+ * de la plus grande a la plus petite (les grandes seances choisissent leur salle en premier).
+ */
+int comparer_seances_a_placer( const void *a, const void *b )
+{
+    const seance_a_placer *sa = ( const seance_a_placer * ) a;
+    const seance_a_placer *sb = ( const seance_a_placer * ) b;
+    if( sa->jour != sb->jour )
+    {
+        return sa->jour - sb->jour;
+    }
+    if( sa->debut != sb->debut )
+    {
+        return sa->debut - sb->debut;
+    }
+    if( sa->besoin != sb->besoin )
+    {
+        return sb->besoin - sa->besoin;
+    }
+    return sa->f->id != sb->f->id ? ( sa->f->id < sb->f->id ? -1 : 1 ) : sa->creneau - sb->creneau;
+}
+
+/*
+ * Fonction de comparaison utilisee par qsort pour trier des salles de la plus petite a la plus grande.
+ */
+int comparer_capacite_salles( const void *a, const void *b )
+{
+    const salle *sa = *( salle * const * ) a;
+    const salle *sb = *( salle * const * ) b;
+    if( sa->capacite != sb->capacite )
+    {
+        return sa->capacite - sb->capacite;
+    }
+    return sa->id - sb->id;
+}
+
+/*
+ * Cette fonction sert a attribuer une salle a toutes les seances de la semaine, sans que deux seances qui se
+ * chevauchent partagent une salle. Les seances de chaque jour sont balayees par heure de debut, comme pour colorier
+ * un graphe d'intervalles: une salle est libre si la seance qui l'occupait est finie, et chaque seance prend la
+ * plus petite salle libre qui peut accueillir ses apprenants, inscrits ou en liste d'attente (les formateurs
+ * n'occupent pas de place, voir place_libre). Avec des salles identiques, ce balayage utilise le plus petit nombre
+ * de salles possible.
+ * Les attributions precedentes sont remplacees. On renvoie le nombre de seances qui n'ont pas trouve de salle,
+ * *nb_seances recoit le nombre total de seances.
+ */
+int attribuer_salles( db_formation *dbf, int *nb_seances )
+{
+    curseur_formation c;
+    formation *tmpf;
+    seance_a_placer *seances;
+    salle **par_capacite;
+    int *liberation;
+    chrono ch;
+    int nb = 0, capacite = 256, sans_salle = 0, i, j, r;
+    demarrer_compteur( &ch, CPT_ATTRIBUER_SALLES );
+    seances = ( seance_a_placer * ) ALLOUER( capacite, sizeof( seance_a_placer ), "seance_a_placer" );
+    for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_ID ); tmpf != NULL; tmpf = suivant_curseur_formation( &c ) )
+    {
+        noter_salles( tmpf );
+        for( j = 0; j < tmpf->nb_jours && j < 7; j++ )
+        {
+            tmpf->salles[j] = 0;
+            if( tmpf->jours[j] < 1 || tmpf->jours[j] > 7 )
+            {
+                continue;
+            }
+            if( nb == capacite )
+            {
+                capacite *= 2;
+                seances = ( seance_a_placer * ) REALLOUER( seances, capacite * sizeof( seance_a_placer ),
+                                                           "seance_a_placer" );
+            }
+            seances[ nb ].f = tmpf;
+            seances[ nb ].creneau = j;
+            seances[ nb ].jour = tmpf->jours[j];
+            seances[ nb ].debut = tmpf->heures[j];
+            seances[ nb ].fin = tmpf->heures[j] + tmpf->durees[j];
+            seances[ nb ].besoin = tmpf->nb_apprenants + ( tmpf->attente != NULL ? tmpf->attente->nb : 0 );
+            nb += 1;
+        }
+    }
+    qsort( seances, nb, sizeof( seance_a_placer ), comparer_seances_a_placer );
+    par_capacite = ( salle ** ) ALLOUER( dbf->nb_salles + 1, sizeof( salle * ), "salles_par_capacite" );
+    liberation = ( int * ) ALLOUER( dbf->nb_salles + 1, sizeof( int ), "liberation_salles" );
+    for( r = 0; r < dbf->nb_salles; r++ )
+    {
+        par_capacite[r] = &dbf->salles[r];
+    }
+    qsort( par_capacite, dbf->nb_salles, sizeof( salle * ), comparer_capacite_salles );
+    for( i = 0; i < nb; i++ )
+    {
+        seance_a_placer *s = &seances[i];
+        int bas = 0, haut = dbf->nb_salles;
+        if( i == 0 || s->jour != seances[ i - 1 ].jour )
+        {
+            memset( liberation, 0, dbf->nb_salles * sizeof( int ) );
+        }
+        while( bas < haut )
+        {
+            int milieu = bas + ( haut - bas ) / 2;
+            if( par_capacite[ milieu ]->capacite < s->besoin )
+            {
+                bas = milieu + 1;
+            }
+            else
+            {
+                haut = milieu;
+            }
+        }
+        for( r = bas; r < dbf->nb_salles && liberation[r] > s->debut; r++ )
+        {
+        }
+        if( r == dbf->nb_salles )
+        {
+            sans_salle += 1;
+            continue;
+        }
+        liberation[r] = s->fin;
+        s->f->salles[ s->creneau ] = par_capacite[r]->id;
+    }
+    compter_visites( nb );
+    compter_octets( capacite * sizeof( seance_a_placer ) +
+                    ( dbf->nb_salles + 1 ) * ( sizeof( salle * ) + sizeof( int ) ) );
+    LIBERER( liberation );
+    LIBERER( par_capacite );
+    LIBERER( seances );
+    arreter_compteur( &ch );
+    *nb_seances = nb;
+    return sans_salle;
+}
+
+int valider_transaction( db_formation *dbf, db_personne *dbp );
+void annuler_transaction( db_formation *dbf, db_personne *dbp );
+
+/*
+ * Cette fonction sert a supprimer entierement la personne idp: elle est d'abord retiree des formations de sa
+ * liste formations, puis supprimee de la base de donnees, dans une seule transaction.
+ * On obtient 1 si reussite, 0 si la personne n'existe pas ou si la transaction a ete annulee.
+ */
+int supprimer_personne_partout( db_formation *dbf, db_personne *dbp, int idp )
+{
+    personne *tmpp = get_personne_par_id( dbp, idp );
+    chrono ch;
+    int k, res;
+    if( tmpp == NULL )
+    {
+        return 0;
+    }
+    demarrer_compteur( &ch, CPT_SUPPRIMER_PERSONNE_PARTOUT );
+    commencer_transaction();
+    compter_visites( tmpp->nb_formations );
+    retirer_attentes_personne( dbf, idp );
+    for( k = 0; k < tmpp->nb_formations; k++ )
+    {
+        formation *tmpf = get_formation_par_id( dbf, tmpp->formations[k] );
+        if( tmpf != NULL )
+        {
+            supprimer_personne_de_formation( tmpf, idp );
+            promouvoir_attente( dbf, tmpf, NULL );
+        }
+    }
+    res = supprimer_db_personne( dbp, idp );
+    if( res )
+    {
+        res = valider_transaction( dbf, dbp );
+    }
+    else
+    {
+        annuler_transaction( dbf, dbp );
+    }
+    arreter_compteur( &ch );
+    return res;
+}
+
+/*
+ * Cette fonction sert a supprimer entierement la formation idf: elle est supprimee de la base de donnees,
+ * puis retiree de la liste formations de chaque personne, dans une seule transaction.
+ * On obtient 1 si reussite, 0 si la formation n'existe pas ou si la transaction a ete annulee.
+ */
+int supprimer_formation_partout( db_formation *dbf, db_personne *dbp, int idf )
+{
+    curseur_personne c;
+    personne *tmpp;
+    chrono ch;
+    int res;
+    if( get_formation_par_id( dbf, idf ) == NULL )
+    {
+        return 0;
+    }
+    demarrer_compteur( &ch, CPT_SUPPRIMER_FORMATION_PARTOUT );
+    commencer_transaction();
+    if( !supprimer_db_formation( dbf, idf ) )
+    {
+        annuler_transaction( dbf, dbp );
+        arreter_compteur( &ch );
+        return 0;
+    }
+    compter_visites( dbp->nb );
+    for( tmpp = debut_curseur_personne( &c, dbp, ORDRE_RECENT ); tmpp != NULL; tmpp = suivant_curseur_personne( &c ) )
+    {
+        retirer_formation_liste( tmpp, idf );
+    }
+    res = valider_transaction( dbf, dbp );
+    arreter_compteur( &ch );
+    return res;
+}
+
+/*
+ * Cette fonction sert a retirer la personne *p de la formation *f, de ses inscrits et de sa liste formations,
+ * puis a inscrire a sa place les premieres personnes de la liste d'attente (voir promouvoir_attente), dans une
+ * seule transaction.
+ * On obtient 1 si reussite, 0 si la personne ne participe pas a la formation ou si la transaction a ete annulee.
+ */
+int desinscrire_personne( db_formation *dbf, db_personne *dbp, formation *f, personne *p, FILE *journal )
+{
+    commencer_transaction();
+    if( !supprimer_personne_de_formation( f, p->id ) )
+    {
+        annuler_transaction( dbf, dbp );
+        return 0;
+    }
+    retirer_formation_liste( p, f->id );
+    promouvoir_attente( dbf, f, journal );
+    return valider_transaction( dbf, dbp );
+}
+
+/*
+ * Cette fonction sert a remettre l'identifiant id, qui vient d'etre ajoute a la fin du vecteur ordre, a la
+ * position position qu'il occupait avant d'etre supprime, si c'est toujours une pierre tombale (la base de
+ * donnees n'a pas ete compactee entre-temps). L'ordre des fichiers .dat est ainsi retrouve apres une annulation.
+ * int *position_page : La case de la page qui note la position de l'identifiant.
+ */
+void replacer_ordre( int *ordre, int *taille_ordre, int *nb_tombes, int *position_page, int id, int position )
+{
+    if( position < *taille_ordre - 1 && ordre[ position ] == 0 && ordre[ *taille_ordre - 1 ] == id )
+    {
+        ordre[ position ] = id;
+        *position_page = position;
+        *taille_ordre -= 1;
+        *nb_tombes -= 1;
+    }
+}
+
+/*
+ * Cette fonction sert a remettre dans la base de donnees la personne ou la formation copiee dans la modification
+ * m, a sa position d'origine dans le vecteur ordre. Les references de la copie sur ses noms passent a la base de
+ * donnees.
+ */
+void remettre_enregistrement( db_formation *dbf, db_personne *dbp, modification *m )
+{
+    if( m->type == MODIF_PERSONNE )
+    {
+        personne *p = ( personne * ) ALLOUER( 1, sizeof( personne ), "personne" );
+        page_personne *page;
+        *p = m->copie.p;
+        m->noms = 0;
+        if( ranger_db_personne( dbp, p ) == NULL )
+        {
+            return;
+        }
+        page = dbp->pages[ m->idp >> DECALAGE_PAGE ];
+        replacer_ordre( dbp->ordre, &dbp->taille_ordre, &dbp->nb_tombes,
+                        &page->position[ m->idp & ( TAILLE_PAGE - 1 ) ], m->idp, m->position );
+    }
+    else
+    {
+        formation *f = ( formation * ) ALLOUER( 1, sizeof( formation ), "formation" );
+        page_formation *page;
+        *f = m->copie.f;
+        m->noms = 0;
+        if( ranger_db_formation( dbf, f ) == NULL )
+        {
+            return;
+        }
+        page = dbf->pages[ m->idf >> DECALAGE_PAGE ];
+        replacer_ordre( dbf->ordre, &dbf->taille_ordre, &dbf->nb_tombes,
+                        &page->position[ m->idf & ( TAILLE_PAGE - 1 ) ], m->idf, m->position );
+    }
+}
+
+/*
+ * Cette fonction sert a retirer de la base de donnees la personne ou la formation de la modification m, apres en
+ * avoir garde une copie et sa position dans le vecteur ordre.
+ */
+void retirer_enregistrement( db_formation *dbf, db_personne *dbp, modification *m )
+{
+    if( m->type == MODIF_PERSONNE )
+    {
+        personne *p = get_personne_par_id( dbp, m->idp );
+        if( p != NULL )
+        {
+            copier_personne_modification( m, p );
+            m->position = dbp->pages[ m->idp >> DECALAGE_PAGE ]->position[ m->idp & ( TAILLE_PAGE - 1 ) ];
+            supprimer_db_personne( dbp, m->idp );
+        }
+    }
+    else
+    {
+        formation *f = get_formation_par_id( dbf, m->idf );
+        if( f != NULL )
+        {
+            copier_formation_modification( m, f );
+            m->position = dbf->pages[ m->idf >> DECALAGE_PAGE ]->position[ m->idf & ( TAILLE_PAGE - 1 ) ];
+            supprimer_db_formation( dbf, m->idf );
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a remettre la personne de la modification m dans la case ou elle etait inscrite, si cette
+ * case est toujours vide, sinon a la fin des inscrits (dont la case est notee pour la prochaine fois).
+ */
+void remettre_inscrit( db_formation *dbf, db_personne *dbp, modification *m )
+{
+    formation *f = get_formation_par_id( dbf, m->idf );
+    personne *p = get_personne_par_id( dbp, m->idp );
+    if( f == NULL || p == NULL )
+    {
+        return;
+    }
+    if( m->position < f->nb_inscrits && f->inscrits[ m->position ] == NULL )
+    {
+        f->inscrits[ m->position ] = p;
+        f->nb_desinscrits -= 1;
+        f->nb_apprenants += !p->formateur;
+        return;
+    }
+    inscrire_personne( f, p );
+    m->position = f->nb_inscrits - 1;
+}
+
+/*
+ * Cette fonction sert a retirer la personne de la modification m des inscrits de sa formation: la derniere case
+ * est simplement enlevee, une autre case devient une pierre tombale. Si la personne n'est plus dans sa case (les
+ * inscrits ont ete compactes), elle est cherchee.
+ */
+void retirer_inscrit_modification( db_formation *dbf, modification *m )
+{
+    formation *f = get_formation_par_id( dbf, m->idf );
+    int i = m->position;
+    if( f == NULL )
+    {
+        return;
+    }
+    if( i >= f->nb_inscrits || f->inscrits[i] == NULL || f->inscrits[i]->id != m->idp )
+    {
+        supprimer_personne_de_formation( f, m->idp );
+    }
+    else if( i == f->nb_inscrits - 1 )
+    {
+        f->nb_apprenants -= !f->inscrits[i]->formateur;
+        f->nb_inscrits -= 1;
+    }
+    else
+    {
+        retirer_inscrit( f, i );
+    }
+}
+
+/*
+ * Cette fonction sert a remettre la formation de la modification m dans la liste formations de sa personne, a la
+ * case ou elle etait.
+ */
+void remettre_liste( db_personne *dbp, modification *m )
+{
+    personne *p = get_personne_par_id( dbp, m->idp );
+    int k = m->position;
+    if( p == NULL || p->nb_formations >= 30 )
+    {
+        return;
+    }
+    if( k > p->nb_formations )
+    {
+        k = p->nb_formations;
+    }
+    memmove( &p->formations[ k + 1 ], &p->formations[k], ( p->nb_formations - k ) * sizeof( int ) );
+    p->formations[k] = m->idf;
+    p->nb_formations += 1;
+}
+
+/*
+ * Cette fonction sert a retirer la formation de la modification m de la liste formations de sa personne.
+ */
+void retirer_liste( db_personne *dbp, modification *m )
+{
+    personne *p = get_personne_par_id( dbp, m->idp );
+    if( p != NULL )
+    {
+        retirer_formation_liste( p, m->idf );
+    }
+}
+
+/*
+ * Cette fonction sert a faire la modification m (refaire vaut 1) ou a la defaire (refaire vaut 0).
+ */
+void appliquer_modification( db_formation *dbf, db_personne *dbp, modification *m, int refaire )
+{
+    int ajouter = m->ajout == refaire;
+    formation *f = m->idf != 0 ? get_formation_par_id( dbf, m->idf ) : NULL;
+    switch( m->type )
+    {
+        case MODIF_PERSONNE:
+        case MODIF_FORMATION:
+            if( ajouter )
+            {
+                remettre_enregistrement( dbf, dbp, m );
+            }
+            else
+            {
+                retirer_enregistrement( dbf, dbp, m );
+            }
+            break;
+        case MODIF_SALLE:
+            if( ajouter )
+            {
+                ajouter_salle( dbf, m->copie.s.id, m->copie.s.nom, m->copie.s.capacite );
+            }
+            else
+            {
+                supprimer_salle( dbf, m->copie.s.id );
+            }
+            break;
+        case MODIF_INSCRIT:
+            if( ajouter )
+            {
+                remettre_inscrit( dbf, dbp, m );
+            }
+            else
+            {
+                retirer_inscrit_modification( dbf, m );
+            }
+            break;
+        case MODIF_LISTE:
+            if( ajouter )
+            {
+                remettre_liste( dbp, m );
+            }
+            else
+            {
+                retirer_liste( dbp, m );
+            }
+            break;
+        case MODIF_ATTENTE:
+            if( f != NULL && ajouter && get_personne_par_id( dbp, m->idp ) != NULL )
+            {
+                ajouter_attente( dbf, f, get_personne_par_id( dbp, m->idp ), m->rang, m->numero );
+            }
+            else if( f != NULL && !ajouter )
+            {
+                demande_attente *d = trouver_attente( dbf, m->idf, m->idp );
+                if( d != NULL )
+                {
+                    m->rang = d->rang;
+                    m->numero = d->numero;
+                    retirer_attente( dbf, f, m->idp );
+                }
+            }
+            break;
+        case MODIF_SALLES:
+            if( f != NULL )
+            {
+                int salles[7];
+                memcpy( salles, f->salles, sizeof( salles ) );
+                memcpy( f->salles, m->copie.f.salles, sizeof( salles ) );
+                memcpy( m->copie.f.salles, salles, sizeof( salles ) );
+            }
+            break;
+    }
+}
+
+/*
+ * Cette fonction sert a annuler la derniere etape de l'historique: ses modifications sont defaites de la derniere
+ * a la premiere. On obtient le nombre de modifications defaites, 0 s'il n'y a rien a annuler.
+ */
+int annuler_etape( db_formation *dbf, db_personne *dbp )
+{
+    int nb = 0;
+    if( historique.courante == 0 )
+    {
+        return 0;
+    }
+    historique.actif = 0;
+    do
+    {
+        historique.courante -= 1;
+        appliquer_modification( dbf, dbp, modification_historique( historique.courante ), 0 );
+        nb += 1;
+    } while( historique.courante > 0 && !modification_historique( historique.courante )->debut );
+    historique.actif = 1;
+    commencer_etape();
+    return nb;
+}
+
+/*
+ * Cette fonction sert a retablir la derniere etape annulee: ses modifications sont refaites dans l'ordre.
+ * On obtient le nombre de modifications refaites, 0 s'il n'y a rien a retablir.
+ */
+int retablir_etape( db_formation *dbf, db_personne *dbp )
+{
+    int nb = 0;
+    if( historique.courante == historique.nb )
+    {
+        return 0;
+    }
+    historique.actif = 0;
+    do
+    {
+        appliquer_modification( dbf, dbp, modification_historique( historique.courante ), 1 );
+        historique.courante += 1;
+        nb += 1;
+    } while( historique.courante < historique.nb && !modification_historique( historique.courante )->debut );
+    historique.actif = 1;
+    commencer_etape();
+    return nb;
+}
+
+/*
+ * Cette fonction sert a signaler dans le journal, s'il ne vaut pas NULL, un invariant de la base de donnees qui
+ * n'est pas respecte. On obtient toujours 1, pour compter les erreurs.
+ */
+int signaler_invariant( FILE *journal, const char *format, ... )
+{
+    va_list args;
+    if( journal != NULL )
+    {
+        fprintf( journal, "* Invariant: " );
+        va_start( args, format );
+        vfprintf( journal, format, args );
+        va_end( args );
+        fprintf( journal, " *\n" );
+    }
+    return 1;
+}
+
+/*
+ * Cette fonction sert a verifier les invariants de la base de donnees en memoire, en temps lineaire:
+ * - chaque identifiant du vecteur ordre est vivant et sa page note sa position, le nombre d'enregistrements et de
+ *   pierres tombales correspond;
+ * - chaque participant d'une formation est une personne de la base de donnees, une seule fois, et la formation
+ *   est dans sa liste formations; nb_desinscrits compte les cases vides des inscrits;
+ * - chaque formation de la liste formations d'une personne existe, une seule fois, et la personne est dans ses
+ *   inscrits (le nombre d'inscriptions de la personne est egal a la taille de sa liste);
+ * - chaque demande d'attente est a sa place dans le tas et dans la table, sa personne existe et ne participe pas
+ *   deja a la formation.
+ * Chaque erreur est ecrite dans le journal, s'il ne vaut pas NULL.
+ * On obtient le nombre d'erreurs trouvees.
+ */
+int verifier_invariants( db_formation *dbf, db_personne *dbp, FILE *journal )
+{
+    int nb_ids = dbp->nb_pages << DECALAGE_PAGE, nb = 0, nb_vivants = 0, nb_attentes = 0, i, k;
+    int *inscriptions = ( int * ) ALLOUER( nb_ids + 1, sizeof( int ), "invariants" );
+    int *derniere = ( int * ) ALLOUER( nb_ids + 1, sizeof( int ), "invariants" );
+    curseur_personne cp;
+    curseur_formation cf;
+    personne *p;
+    formation *f;
+    for( i = 0; i < dbp->taille_ordre; i++ )
+    {
+        int id = dbp->ordre[i];
+        p = id != 0 ? get_personne_par_id( dbp, id ) : NULL;
+        nb_vivants += id != 0;
+        if( id != 0 && ( p == NULL || dbp->pages[ id >> DECALAGE_PAGE ]->position[ id & ( TAILLE_PAGE - 1 ) ] != i ) )
+        {
+            nb += signaler_invariant( journal, "la personne %d en position %d de l'ordre est mal rangee", id, i );
+        }
+    }
+    if( nb_vivants != dbp->nb || dbp->taille_ordre - nb_vivants != dbp->nb_tombes )
+    {
+        nb += signaler_invariant( journal, "%d personnes et %d pierres tombales, %d et %d attendues", dbp->nb,
+                                  dbp->nb_tombes, nb_vivants, dbp->taille_ordre - nb_vivants );
+    }
+    nb_vivants = 0;
+    for( i = 0; i < dbf->taille_ordre; i++ )
+    {
+        int id = dbf->ordre[i];
+        f = id != 0 ? get_formation_par_id( dbf, id ) : NULL;
+        nb_vivants += id != 0;
+        if( id != 0 && ( f == NULL || dbf->pages[ id >> DECALAGE_PAGE ]->position[ id & ( TAILLE_PAGE - 1 ) ] != i ) )
+        {
+            nb += signaler_invariant( journal, "la formation %d en position %d de l'ordre est mal rangee", id, i );
+        }
+    }
+    if( nb_vivants != dbf->nb || dbf->taille_ordre - nb_vivants != dbf->nb_tombes )
+    {
+        nb += signaler_invariant( journal, "%d formations et %d pierres tombales, %d et %d attendues", dbf->nb,
+                                  dbf->nb_tombes, nb_vivants, dbf->taille_ordre - nb_vivants );
+    }
+    for( f = debut_curseur_formation( &cf, dbf, ORDRE_ID ); f != NULL; f = suivant_curseur_formation( &cf ) )
+    {
+        int vides = 0;
+        for( i = 0; i < f->nb_inscrits; i++ )
+        {
+            p = f->inscrits[i];
+            if( p == NULL )
+            {
+                vides += 1;
+                continue;
+            }
+            if( get_personne_par_id( dbp, p->id ) != p )
+            {
+                nb += signaler_invariant( journal, "la formation %d a un inscrit qui n'existe pas", f->id );
+                continue;
+            }
+            if( derniere[ p->id ] == f->id )
+            {
+                nb += signaler_invariant( journal, "la personne %d est inscrite deux fois a la formation %d", p->id,
+                                          f->id );
+            }
+            derniere[ p->id ] = f->id;
+            inscriptions[ p->id ] += 1;
+            for( k = 0; k < p->nb_formations && k < 30 && p->formations[k] != f->id; k++ )
+            {
+            }
+            if( k == p->nb_formations || k == 30 )
+            {
+                nb += signaler_invariant( journal, "la personne %d est inscrite a la formation %d sans la suivre",
+                                          p->id, f->id );
+            }
+        }
+        if( vides != f->nb_desinscrits )
+        {
+            nb += signaler_invariant( journal, "la formation %d a %d cases vides, pas %d", f->id, vides,
+                                      f->nb_desinscrits );
+        }
+        if( compter_apprenants( f ) != f->nb_apprenants )
+        {
+            nb += signaler_invariant( journal, "la formation %d a %d apprenants, pas %d", f->id,
+                                      compter_apprenants( f ), f->nb_apprenants );
+        }
+        for( i = 0; f->attente != NULL && i < f->attente->nb; i++ )
+        {
+            demande_attente *d = f->attente->tas[i];
+            nb_attentes += 1;
+            if( d->position != i || d->formation != f->id || trouver_attente( dbf, f->id, d->p->id ) != d )
+            {
+                nb += signaler_invariant( journal, "la demande de %d pour la formation %d est mal rangee",
+                                          d->p->id, f->id );
+            }
+            if( get_personne_par_id( dbp, d->p->id ) != d->p )
+            {
+                nb += signaler_invariant( journal, "la formation %d a une demande d'une personne qui n'existe pas",
+                                          f->id );
+                continue;
+            }
+            for( k = 0; k < d->p->nb_formations && k < 30 && d->p->formations[k] != f->id; k++ )
+            {
+            }
+            if( k < d->p->nb_formations && k < 30 )
+            {
+                nb += signaler_invariant( journal, "la personne %d attend la formation %d qu'elle suit deja",
+                                          d->p->id, f->id );
+            }
+        }
+    }
+    if( nb_attentes != dbf->attentes.nb )
+    {
+        nb += signaler_invariant( journal, "%d demandes d'attente dans les files, %d dans la table", nb_attentes,
+                                  dbf->attentes.nb );
+    }
+    for( p = debut_curseur_personne( &cp, dbp, ORDRE_ID ); p != NULL; p = suivant_curseur_personne( &cp ) )
+    {
+        int suivies = 0;
+        if( p->nb_formations < 0 || p->nb_formations > 30 )
+        {
+            nb += signaler_invariant( journal, "la personne %d suit %d formations", p->id, p->nb_formations );
+            continue;
+        }
+        for( k = 0; k < p->nb_formations; k++ )
+        {
+            int j;
+            if( get_formation_par_id( dbf, p->formations[k] ) == NULL )
+            {
+                nb += signaler_invariant( journal, "la personne %d suit la formation %d qui n'existe pas", p->id,
+                                          p->formations[k] );
+                continue;
+            }
+            suivies += 1;
+            for( j = 0; j < k && p->formations[j] != p->formations[k]; j++ )
+            {
+            }
+            if( j < k )
+            {
+                nb += signaler_invariant( journal, "la personne %d suit deux fois la formation %d", p->id,
+                                          p->formations[k] );
+            }
+        }
+        if( suivies != inscriptions[ p->id ] )
+        {
+            nb += signaler_invariant( journal, "la personne %d suit %d formations mais est inscrite a %d", p->id,
+                                      suivies, inscriptions[ p->id ] );
+        }
+    }
+    LIBERER( inscriptions );
+    LIBERER( derniere );
+    return nb;
+}
+
+/*
+ * Cette fonction sert a vider le tampon de la transaction en cours, une fois terminee.
+ */
+void terminer_transaction()
+{
+    transaction_en_cours.nb = 0;
+    transaction_en_cours.profondeur = 0;
+    transaction_en_cours.echec = 0;
+}
+
+/*
+ * Cette fonction sert a annuler la transaction en cours: ses modifications sont defaites de la derniere a la
+ * premiere, comme annuler_etape le fait pour l'historique, puis oubliees. Une transaction interne fait seulement
+ * echouer la transaction externe.
+ */
+void annuler_transaction( db_formation *dbf, db_personne *dbp )
+{
+    int actif = historique.actif, i;
+    if( transaction_en_cours.profondeur > 1 )
+    {
+        transaction_en_cours.profondeur -= 1;
+        transaction_en_cours.echec = 1;
+        return;
+    }
+    transaction_en_cours.profondeur = 0;
+    historique.actif = 0;
+    for( i = transaction_en_cours.nb - 1; i >= 0; i-- )
+    {
+        appliquer_modification( dbf, dbp, &transaction_en_cours.modifications[i], 0 );
+        oublier_modification( &transaction_en_cours.modifications[i] );
+    }
+    historique.actif = actif;
+    terminer_transaction();
+}
+
+/*
+ * Cette fonction sert a valider la transaction en cours: ses modifications sont gardees et passent dans l'etape
+ * en cours de l'historique (s'il est actif). Une transaction interne ne change rien avant la fin de la
+ * transaction externe.
+ * Si le programme est compile avec VERIFIER_INVARIANTS (./configure --enable-debug), les invariants de la base
+ * de donnees sont d'abord verifies (voir verifier_invariants): s'ils ne sont pas respectes, la transaction est
+ * annulee.
+ * On obtient 1 si la transaction est validee, 0 si elle a ete annulee.
+ */
+int valider_transaction( db_formation *dbf, db_personne *dbp )
+{
+    int i;
+    if( transaction_en_cours.profondeur > 1 )
+    {
+        transaction_en_cours.profondeur -= 1;
+        return !transaction_en_cours.echec;
+    }
+#ifdef VERIFIER_INVARIANTS
+    if( !transaction_en_cours.echec && verifier_invariants( dbf, dbp, stderr ) > 0 )
+    {
+        transaction_en_cours.echec = 1;
+    }
+#endif
+    if( transaction_en_cours.echec )
+    {
+        annuler_transaction( dbf, dbp );
+        return 0;
+    }
+    transaction_en_cours.profondeur = 0;
+    for( i = 0; i < transaction_en_cours.nb; i++ )
+    {
+        modification *t = &transaction_en_cours.modifications[i];
+        modification *m = nouvelle_modification( t->type, t->ajout );
+        if( m == NULL )
+        {
+            oublier_modification( t );
+        }
+        else
+        {
+            int debut = m->debut;
+            *m = *t;
+            m->debut = debut;
+        }
+    }
+    terminer_transaction();
+    return 1;
+}
+
+void menu_creer_formation( db_formation *f )
+{
+    db_formation *tmpdbf = f;
+    int i, prix = 0;
+    char nom[ LONGUEUR_NOM_MAX + 2 ], saisie[32];
+    printf( "* Nom de la formation: " );
+    fgets( nom, sizeof( nom ), stdin );
+    if( strlen( nom ) > 0 && nom[ strlen( nom ) - 1 ] == '\n' )
+    {
+        nom[ strlen( nom ) - 1 ] = '\0';
+    }
+    couper_utf8( nom );
+    formation *tmp = get_formation( f, nom );
+    if( tmp == NULL )
+    {
+        printf( "* Cout de la formation: " );
+        while( scanf( "%31s", saisie ) == 1 && !lire_prix( saisie, &prix ) )
+        {
+            printf( "* Option %s - INVALIDE: Min 0\n", saisie );
+            printf( "* Cout de la formation: " );
+        }
+        getchar();
+        formation *tmpf = creer_formation( nom, prix );
+        char choix_prerequis[4];
+        printf( "* Est-ce que la formation a des prerequis ? (o/n) " );
+        scanf( "%s", choix_prerequis );
+        getchar();
+        while( strcmp( choix_prerequis, "o" ) != 0 && strcmp( choix_prerequis, "oui" ) != 0 &&
+               strcmp( choix_prerequis, "n" ) != 0 && strcmp( choix_prerequis, "non" ) != 0 )
+        {
+            printf( "* Options %s - INVALIDE: o pour oui et n pour non s'il vous plait\n", choix_prerequis );
+            printf( "* Est-ce que la formation a des prerequis ? (o/n) " );
+            scanf( "%s", choix_prerequis );
+            getchar();
+        }
+        if( strcmp( choix_prerequis, "o" ) == 0 || strcmp( choix_prerequis, "oui" ) == 0 )
+        {
+            curseur_formation c;
+            formation *tmpf2;
+            printf( "* %2s %-40s                                  *\n", "ID", "Nom" );
+            printf( "* ---------------------------------------------------------------------------- *\n" );
+            for( tmpf2 = debut_curseur_formation( &c, tmpdbf, ORDRE_RECENT ); tmpf2 != NULL;
+                 tmpf2 = suivant_curseur_formation( &c ) )
+            {
+                printf( "* %2d %-40s                                  *\n", tmpf2->id, tmpf2->nom );
+            }
+            int nb_prerequis;
+            int max_prerequis = tmpdbf->nb < 10 ? tmpdbf->nb : 10;
+            printf( "* Combien de prerequis faut-il ? " );
+            while( scanf( "%d", &nb_prerequis ) != 1 )
+            {
+                printf( "* Option %d - INVALIDE: Max %d prerequis Min 0\n", nb_prerequis, max_prerequis );
+                printf( "* Combien de prerequis faut-il ? " );
+                scanf( "%d", &nb_prerequis );
+                getchar();
+            }
+            getchar();
+            while( nb_prerequis > max_prerequis || nb_prerequis < 0 )
+            {
+                printf( "* Option %d - INVALIDE: Max %d prerequis Min 0\n", nb_prerequis, max_prerequis );
+                printf( "* Combien de prerequis faut-il ? " );
+                scanf( "%d", &nb_prerequis );
+                getchar();
+            }
+            tmpf->nb_prerequis = nb_prerequis;
+            for( i = 0; i < nb_prerequis; i++ )
+            {
+                int id_prerequis;
+                printf( "* ID du prerequis N.%d a rajouter: ", i + 1 );
+                while( scanf( "%d", &id_prerequis ) != 1 || get_formation_par_id( tmpdbf, id_prerequis ) == NULL )
+                {
+                    printf( "* Option %d - INVALIDE: veullez choisir 1 dans la liste\n", id_prerequis );
+                    printf( "* ID du prerequis N.%d a rajouter: ", i + 1 );
+                    scanf( "%d", &id_prerequis );
+                    getchar();
+                }
+                tmpf->prerequis[i] = id_prerequis;
+            }
+        }
+        int nb_jours;
+        printf( "* Combien de fois par semaine a la formation lieu ? " );
+        while( scanf( "%d", &nb_jours ) != 1 )
+        {
+            printf( "Option %d - INVALIDE: Max 7 jours Min 1 jour\n", nb_jours );
+            printf( "* Combien de fois par semaine a la formation lieu ? " );
+            scanf( "%d", &nb_jours );
+            getchar();
+        }
+        getchar();
+        while( nb_jours > 7 || nb_jours <= 0 )
+        {
+            printf( "Option %d - INVALIDE: Max 7 jours Min 1 jour\n", nb_jours );
+            printf( "* Combien de fois par semaine a laformation lieu ? " );
+            scanf( "%d", &nb_jours );
+            getchar();
+        }
+        tmpf->nb_jours = nb_jours;
+        printf( "* 1. lundi\n* 2. mardi\n* 3. mercredi\n* 4. jeudi\n* 5. vendredi\n* 6. samedi\n* 7. dimanche\n" );
+        for ( i = 0; i < tmpf->nb_jours; i++ )
+        {
+            int jour;
+            printf( "* Quel jour de la semaine a la formation N. %d lieu ? ", i + 1 );
+            while( scanf( "%d", &jour ) != 1 || jour < 0 || jour > 7  )
+            {
+                printf( "* Option %d - INVALIDE: Max 7 Min 1\n", i );
+                printf( "* Quel jour de la semaine a la formation N. %d lieu ? ", i + 1 );
+                scanf( "%d", &jour );
+                getchar();
+            }
+            tmpf->jours[i] = jour;
+            int heure = 6 * 60;
+            printf( "* A quelle heure debute la formation (ex. 08.15) ? " );
+            while( scanf( "%31s", saisie ) == 1 &&
+                   ( !lire_horaire( saisie, &heure ) || heure > 18 * 60 || heure < 6 * 60 ) )
+            {
+                printf( "* Option %s - INVALIDE: MIN 6 MAX 18\n", saisie );
+                printf( "* A quelle heure debute la formation (ex. 08.15) ? " );
+            }
+            tmpf->heures[i] = heure;
+            int duree = 60;
+            printf( "* Combien d'heures dure la formation (ex. 1.5 pour 1 h 30) ? " );
+            while( scanf( "%31s", saisie ) == 1 &&
+                   ( !lire_duree( saisie, &duree ) || duree > 8 * 60 || duree < 60 ) )
+            {
+                printf( "* Option %s - INVALIDE: MIN 1 heures MAX 8 heures\n", saisie );
+                printf( "* Combien d'heures dure la formation (ex. 1.5 pour 1 h 30) ? " );
+            }
+            tmpf->durees[i] = duree;
+        }
+        char confirmation[4];
+        printf( "* Etes vous sur de vouloir ajouter la formation %s avec prix " FORMAT_PRIX
+                " a la base de donnees ? (o/n) ", tmpf->nom, PRIX( tmpf->prix ) );
+        scanf( "%s", confirmation );
+        while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
+               strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
+        {
+            printf( "Veuillez inserer o / oui - n / non : " );
+            scanf( "%s", confirmation );
+        }
+        if( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 )
+        {
+            formation *ajoutee;
+            tmpf->id = allouer_id( &tmpdbf->ids );
+            ajoutee = ranger_db_formation( tmpdbf, tmpf );
+            system( clear );
+            if( ajoutee == NULL )
+            {
+                printf( "* /!\\ Plus aucun identifiant de formation disponible /!\\ *\n" );
+                return;
+            }
+            printf( "* %s a ete ajoutee a la base de donnees avec succes *\n", ajoutee->nom );
+        }
+        else
+        {
+            system( clear );
+            printf( "* %s n'a PAS ete ajoutee a la base de donnees *\n", tmpf->nom );
+            liberer_formation( tmpf );
+        }
+    }
+    else
+    {
+        system( clear );
+        printf( "* Formation deja existente dans la base de donnees *\n" );
+    }
+}
+
+void menu_creer_personne( db_personne *p )
+{
+    db_personne *tmpdbp = p;
+    char nom[ LONGUEUR_NOM_MAX + 1 ], prenom[ LONGUEUR_NOM_MAX + 1 ], choix_formateur[4];
+    int formateur, nb_jours_indisponible = 0, jours_indisponible[7], reduction = 0, pourcent_reduction;
+    printf( "* Nom de famille de la personne: " );
+    lire_mot( nom, sizeof( nom ) );
+    printf( "* Prenom de la personne: " );
+    lire_mot( prenom, sizeof( prenom ) );
+    printf( "* Est-ce que cette personne est un formateur ou un etudiant ? (f/e) " );
+    scanf( "%s", choix_formateur );
+    int i;
+    for( i = 0; choix_formateur[i]; i++ )
+    {
+        choix_formateur[i] = tolower( choix_formateur[i] );
+    }
+    while( strcmp( choix_formateur, "f" ) != 0 && strcmp( choix_formateur, "formateur" ) != 0 &&
+           strcmp( choix_formateur, "e" ) != 0 && strcmp( choix_formateur, "etudiant" ) != 0 )
+    {
+        printf( "* Option %s - INVALIDE: f ou e seulement sont acceptees                       *\n",
+                choix_formateur );
+        printf( "* Est-ce que cette personne est un formateur ou un etudiant ? (f/e) " );
+        scanf( "%s", choix_formateur );
+        for( i = 0; choix_formateur[i]; i++ )
+        {
+            choix_formateur[i] = tolower( choix_formateur[i] );
+        }
+    }
+    if( strcmp( choix_formateur, "f" ) == 0 || strcmp( choix_formateur, "formateur" ) == 0 )
+    {
+        formateur = 1;
+        char choix_indisponible[4];
+        printf( "* Est-ce que ce formateur as des jours ou il/elle est indisponible ? (o/n) " );
+        scanf( "%s", choix_indisponible );
+        getchar();
+        while( strcmp( choix_indisponible, "o" ) != 0 && strcmp( choix_indisponible, "oui" ) != 0 &&
+               strcmp( choix_indisponible, "n" ) != 0 && strcmp( choix_indisponible, "non" ) != 0 )
+        {
+            printf( "* Option %s - INVALIDE: o ou n sont acceptees                                  *\n",
+                    choix_indisponible );
+            printf( "* Est-ce que ce formateur as des jours ou il/elle est indisponible ? (o/n) " );
+            scanf( "%s", choix_indisponible );
+            getchar();
+        }
+        if( strcmp( choix_indisponible, "o" ) == 0 || strcmp( choix_indisponible, "oui" ) == 0 )
+        {
+            printf( "* Combien de jours serait ce formateur indisponible ? " );
+            scanf( "%d", &nb_jours_indisponible );
+            getchar();
+            while( nb_jours_indisponible < 0 )
+            {
+                printf( "* Option %d - INVALIDE: Max 7 jours - Min 0                                    *\n",
+                        nb_jours_indisponible );
+                printf( "* Combien de jours serait ce formateur indisponible ? " );
+                scanf( "%d", &nb_jours_indisponible );
+                getchar();
+            }
+            if( nb_jours_indisponible > 0 )
+            {
+                while ( nb_jours_indisponible > 7 || nb_jours_indisponible < 0)
+                {
+                    printf( "* Option %d - INVALIDE: Max 7 jours - Min 0                                    *\n",
+                            nb_jours_indisponible );
+                    printf( "* Combien de jours serait ce formateur indisponible ? " );
+                    scanf( "%d", &nb_jours_indisponible );
+                    getchar();
+                }
+                printf( "* 1. lundi\n* 2. mardi\n* 3. mercredi\n* 4. jeudi\n* 5. vendredi\n* 6. samedi\n* 7. dimanche\n" );
+                for ( i = 0; i < nb_jours_indisponible; i++ )
+                {
+                    int jour;
+                    printf( "* Quel serait son jour d'indisponibilite N.%d ? ", i + 1 );
+                    scanf( "%d", &jour );
+                    jours_indisponible[ i ] = jour;
+                }
+            }
+        }
+    }
+    else
+    {
+        formateur = 0;
+        printf( "* Est-ce que cet etudiant beneficie d'une reduction ? (o/n) " );
+        char choix_reduction[4];
+        scanf( "%s", choix_reduction );
+        getchar();
+        while( strcmp( choix_reduction, "o" ) != 0 && strcmp( choix_reduction, "oui" ) != 0 &&
+               strcmp( choix_reduction, "n" ) != 0 && strcmp( choix_reduction, "non" ) != 0 )
+        {
+            printf( "* Option %s - INVALIDE: o ou n sont acceptees                                  *\n",
+                    choix_reduction );
+            printf( "* Est-ce que cet etudiant beneficie d'une reduction ? (o/n) " );
+            scanf( "%s", choix_reduction );
+            getchar();
+        }
+        if( strcmp( choix_reduction, "o" ) == 0 || strcmp( choix_reduction, "oui" ) == 0 )
+        {
+            printf( "* Combien de pourcentage de reduction beneficie cet etudiant ? " );
+            scanf( "%d", &pourcent_reduction );
+            getchar();
+            while ( pourcent_reduction > 100 || pourcent_reduction < 0 )
+            {
+                printf( "* Option %d - INVALIDE: Max 100 pourcent - Min 0                               *\n",
+                        nb_jours_indisponible );
+                printf( "* Combien de pourcentage de reduction beneficie cet etudiant ? " );
+                scanf( "%d", &pourcent_reduction );
+            }
+            if( pourcent_reduction > 0 )
+            {
+                reduction = 1;
+            }
+        }
+    }
+    personne *tmpp = creer_personne( nom, prenom, formateur );
+    if( tmpp->formateur == 0 )
+    {
+        tmpp->reduction = reduction;
+        if( reduction == 1 )
+        {
+            tmpp->val_reduction = pourcent_reduction;
+        }
+    }
+    else
+    {
+        tmpp->nb_jours_indisponible = nb_jours_indisponible;
+        if( nb_jours_indisponible > 0 )
+        {
+            memcpy( tmpp->jours_indisponible, jours_indisponible, sizeof(tmpp->jours_indisponible) );
+        }
+    }
+    char confirmation[4];
+    printf( "* Etes vous sur de vouloir ajouter %s: %s %s a la base de donnees ? (o/n) ",
+            tmpp->formateur ? "formateur" : "etudiant", tmpp->prenom, tmpp->nom );
+    scanf( "%s", confirmation );
+    while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
+           strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
+    {
+        printf( "Veuillez inserer o / oui - n / non : " );
+        scanf( "%s", confirmation );
+    }
+    if( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 )
+    {
+        personne *ajoutee;
+        tmpp->id = allouer_id( &tmpdbp->ids );
+        ajoutee = ranger_db_personne( p, tmpp );
+        system( clear );
+        if( ajoutee == NULL )
+        {
+            printf( "* /!\\ Plus aucun identifiant de personne disponible /!\\ *\n" );
+            return;
+        }
+        printf( "* %s %s a ete ajoute(e) a la base de donnees avec succes *\n", ajoutee->nom, ajoutee->prenom );
+    }
+    else
+    {
+        system( clear );
+        printf( "* %s %s n'a PAS ete ajoute(e) a la base de donnees *\n", tmpp->nom, tmpp->prenom );
+        liberer_personne( tmpp );
+    }
+}
+
+/*
+ * Menu permettant d'ajouter une salle de cours a la base de donnees.
+ */
+void menu_creer_salle( db_formation *dbf )
+{
+    char nom[40];
+    int capacite;
+    salle *s;
+    printf( "* Nom de la salle: " );
+    if( fgets( nom, 40, stdin ) == NULL )
+    {
+        return;
+    }
+    nom[ strcspn( nom, "\n" ) ] = '\0';
+    printf( "* Nombre de places: " );
+    while( scanf( "%d", &capacite ) != 1 || capacite <= 0 )
+    {
+        getchar();
+        printf( "* Option INVALIDE: Min 1\n" );
+        printf( "* Nombre de places: " );
+    }
+    getchar();
+    system( clear );
+    s = ajouter_salle( dbf, 0, nom, capacite );
+    if( s == NULL )
+    {
+        printf( "* La salle n'a pas pu etre ajoutee: plus aucun identifiant disponible *\n" );
+        return;
+    }
+    printf( "* La salle %s (%d places) a ete ajoutee avec l'identifiant %d *\n", s->nom, s->capacite, s->id );
+}
+
+/*
+ * Menu permettant d'attribuer une salle a toutes les seances de la semaine, avec attribuer_salles.
+ */
+void menu_attribuer_salles( db_formation *dbf )
+{
+    int nb_seances, sans_salle;
+    system( clear );
+    if( dbf->nb_salles == 0 )
+    {
+        printf( "* Aucune salle: ajoutez d'abord des salles *\n" );
+        return;
+    }
+    sans_salle = attribuer_salles( dbf, &nb_seances );
+    printf( "* %d seance(s) sur %d ont une salle *\n", nb_seances - sans_salle, nb_seances );
+    if( sans_salle > 0 )
+    {
+        printf( "* /!\\ %d seance(s) sans salle: pas de salle libre assez grande /!\\ *\n", sans_salle );
+    }
+}
+
+int menu_creer( db_formation *f, db_personne *p )
+{
+    int choix;
+    do
+    {
+        db_formation *tmpdbf = f;
+        db_personne *tmpdbp = p;
+        commencer_etape();
+        printf( "********************************************************************************\n" );
+        printf( "* MENU AJOUT                                                                   *\n" );
+        printf( "********************************************************************************\n" );
+        printf( "* 1. Ajouter une nouvelle personne a la base de donnees                        *\n" );
+        printf( "* 2. Ajouter une nouvelle formation a la base de donneees                      *\n" );
+        printf( "* 3. Ajouter une salle de cours                                                *\n" );
+        printf( "* 4. Attribuer une salle a toutes les seances de la semaine                    *\n" );
+        printf( "* 0. Retour                                                                    *\n" );
+        printf( "********************************************************************************\n" );
+        printf( "* Que voudriez-vous ajouter a la base de donnees ? " );
+        scanf( "%d", &choix );
+        getchar();
+        switch( choix )
+        {
+            case 1:
+                menu_creer_personne( tmpdbp );
+                break;
+            case 2:
+                menu_creer_formation( tmpdbf );
+                break;
+            case 3:
+                menu_creer_salle( tmpdbf );
+                break;
+            case 4:
+                menu_attribuer_salles( tmpdbf );
+                break;
+            case 0:
+                system( clear );
+                break;
+            default:
+                system( clear );
+                printf( "/!\\ Option %d - INVALIDE /!\\\n", choix );
+                break;
+        }
+    } while( choix != 0 );
+    return 0;
+}
+
+void menu_ajouter_formation( db_formation *f, db_personne *p )
+{
+    db_formation *tmpdbf =f;
+    db_personne *tmpdbp = p;
+    formation *tmpf;
+    personne *tmpp;
+    printf( "********************************************************************************\n" );
+    printf( "* MENU ATTRIBUTION                                                             *\n" );
+    printf( "********************************************************************************\n" );
+    printf( "********************************************************************************\n" );
+    printf( "* Liste des cours                                                              *\n" );
+    printf( "********************************************************************************\n" );
+    afficher_liste_formations( tmpdbf, ORDRE_RECENT );
+    printf( "*  0 Retour                                                                    *\n" );
+    printf( "********************************************************************************\n" );
+    int cours;
+    printf( "* A quelle formation voudriez vous attribuer une personne? " );
+    scanf( "%d", &cours );
+    getchar();
+    while( cours > 0 && get_formation_par_id( tmpdbf, cours ) == NULL )
+    {
+        printf( "* Valeur %d - INVALIDE! *\n", cours );
+        printf( "* A quelle formation voudriez vous attribuer une personne? " );
+        scanf( "%d", &cours );
+        getchar();
+    }
+    if( cours <= 0 )
+    {
+        system( clear );
+        return;
+    }
+    tmpf = get_formation_par_id( tmpdbf, cours );
+    printf( "********************************************************************************\n" );
+    printf( "* Liste des personnes                                                          *\n" );
+    printf( "********************************************************************************\n" );
+    printf( "* Formation choisie: %-40s                  *\n", tmpf->nom );
+    if( capacite_formation( tmpdbf, tmpf ) > 0 )
+    {
+        printf( "* Places occupees: %d / %d\n", tmpf->nb_apprenants, capacite_formation( tmpdbf, tmpf ) );
+    }
+    printf( "********************************************************************************\n" );
+    afficher_db_personne( tmpdbp );
+    printf( "*  0 Retour                                                                    *\n" );
+    printf( "********************************************************************************\n" );
+    int idp;
+    printf( "* Qui voudriez vous attribuer a la formation : %s ? ", tmpf->nom );
+    scanf( "%d", &idp );
+    getchar();
+    while( idp > 0 && get_personne_par_id( tmpdbp, idp ) == NULL )
+    {
+        printf( "* Valeur %d - INVALIDE\n", idp );
+        printf( "* Qui voudriez vous attribuer a la formation : %s ? ", tmpf->nom );
+        scanf( "%d", &idp );
+        getchar();
+    }
+    if( idp <= 0 )
+    {
+        system( clear );
+        return;
+    }
+    tmpp = get_personne_par_id( tmpdbp, idp );
+    if( tmpp->formateur )
+    {
+        avertir_disponibilite( tmpdbf, tmpf, tmpp );
+    }
+    char confirmation[4];
+    printf( "* Etes vous sur de vouloir attribuer %s %s a la formation %s ? (o/n) ",
+            tmpp->nom, tmpp->prenom, tmpf->nom );
+    scanf( "%s", confirmation );
+    while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
+           strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
+    {
+        printf( "Veuillez inserer o / oui - n / non : " );
+        scanf( "%s", confirmation );
+    }
+    if( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 )
+    {
+        int res = demander_inscription( tmpdbf, tmpf, tmpp );
+        system( clear );
+        if( res == INSCRIPTION_EN_ATTENTE || res == INSCRIPTION_DEJA_EN_ATTENTE )
+        {
+            printf( "* La formation %s est complete: %d places *\n", tmpf->nom, capacite_formation( tmpdbf, tmpf ) );
+            printf( res == INSCRIPTION_EN_ATTENTE ? "* %s %s est mis(e) en liste d'attente: %d personne(s) "
+                    "attendent *\n" : "* %s %s est deja en liste d'attente: %d personne(s) attendent *\n",
+                    tmpp->nom, tmpp->prenom, tmpf->attente->nb );
+            return;
+        }
+        if( res == INSCRIPTION_IMPOSSIBLE )
+        {
+            printf( "* %s %s participe deja a 30 formations *\n", tmpp->nom, tmpp->prenom );
+            return;
+        }
+        if ( res == INSCRIPTION_FAITE )
+        {
+            printf( "* %s %s a ete attribue(e) a la formation %s avec succes *\n",
+                    tmpp->nom, tmpp->prenom, tmpf->nom );
+            return;
+        }
+        printf( "* %s %s est deja present dans la formation %s *\n" ,
+                tmpp->nom, tmpp->prenom, tmpf->nom );
+    }
+    else
+    {
+        system( clear );
+        printf( "* %s %s n'a PAS ete attribue(e) a la formation %s *\n" ,
+                tmpp->nom, tmpp->prenom, tmpf->nom );
+    }
+}
+
+void menu_supprimer_personne( db_formation *dbf, db_personne *dbp )
+{
+    int idp;
+    db_formation *tmpdbf = dbf;
+    db_personne *tmpdbp = dbp;
+    personne *tmpp;
+    afficher_db_personne( tmpdbp );
+    printf( "*  0 Retour                                                                    *\n" );
+    printf( "* Quelle personne voudriez vous supprimer entierement ? " );
+    scanf( "%d", &idp );
+    getchar();
+    while( idp > 0 && get_personne_par_id( tmpdbp, idp ) == NULL )
+    {
+        printf( "* Option %d - INVALIDE\n", idp );
+        printf( "* Quelle personne voudriez vous supprimer entierement ? " );
+        scanf( "%d", &idp );
+        getchar();
+    }
+    if( idp <= 0 )
+    {
+        system( clear );
+        return;
+    }
+    tmpp = get_personne_par_id( tmpdbp, idp );
+    const char *nom = interner( tmpp->nom ), *prenom = interner( tmpp->prenom );
+    char confirmation[4];
+    printf( "* Etes vous sur de vouloir supprimer %s %s entierement de la base de donnees ? (o/n) ",
+            nom, prenom );
+    scanf( "%s", confirmation );
+    while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
+           strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
+    {
+        printf( "Veuillez inserer o / oui - n / non : " );
+        scanf( "%s", confirmation );
+    }
+    if( ( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 ) &&
+        supprimer_personne_partout( tmpdbf, tmpdbp, idp ) )
+    {
+        system( clear );
+        printf( "* %s %s a ete supprime(e) entierement de la base de donnees *\n",
+                nom, prenom );
+    }
+    else
+    {
+        system( clear );
+        printf( "* %s %s n'a PAS ete supprimer de la base de donnees *\n",
+                nom, prenom );
+    }
+    relacher( nom );
+    relacher( prenom );
+}
+
+void menu_supprimer_formation( db_formation *dbf, db_personne *dbp )
+{
+    int idf;
+    db_formation *tmpdbf = dbf;
+    db_personne *tmpdbp = dbp;
+    curseur_formation cf;
+    formation *tmpf;
+    printf( "********************************************************************************\n" );
+    printf( "* MENU SUPPRESSION : Liste des formations                                      *\n" );
+    printf( "********************************************************************************\n" );
+    printf( "* %2s %-40s                                  *\n", "ID", "Nom" );
+    printf( "* ---------------------------------------------------------------------------- *\n" );
+    for( tmpf = debut_curseur_formation( &cf, tmpdbf, ORDRE_RECENT ); tmpf != NULL;
+         tmpf = suivant_curseur_formation( &cf ) )
+    {
+        printf( "* %2d %-40s                                  *\n", tmpf->id, tmpf->nom );
+    }
+    printf( "*  0 Retour                                                                    *\n" );
+    printf( "********************************************************************************\n" );
+    printf( "* Quelle formation voudriez vous supprimer? " );
+    scanf( "%d", &idf );
+    getchar();
+    printf( "********************************************************************************\n" );
+    while( idf > 0 && get_formation_par_id( tmpdbf, idf ) == NULL )
+    {
+        printf( "* Option %d - INVALIDE\n", idf );
+        printf( "* Quelle formation voudriez vous supprimer? " );
+        scanf( "%d", &idf );
+        getchar();
+    }
+    if( idf <= 0 )
+    {
+        system( clear );
+        return;
+    }
+    tmpf = get_formation_par_id( tmpdbf, idf );
+    const char *nom = interner( tmpf->nom );
+    char confirmation[4];
+    printf( "* Etes vous sur de vouloir supprimer %s entierement de la base de donnees ? (o/n) ",
+            nom );
+    scanf( "%s", confirmation );
+    while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
+           strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
+    {
+        printf( "Veuillez inserer o / oui - n / non : " );
+        scanf( "%s", confirmation );
+    }
+    if( ( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 ) &&
+        supprimer_formation_partout( tmpdbf, tmpdbp, idf ) )
+    {
+        system( clear );
+        printf( "* %s a ete supprimee de la base de donnees *\n", nom );
+    }
+    else
+    {
+        system( clear );
+        printf( "* %s n'a PAS ete supprimee de la base de donnees *\n", nom );
+    }
+    relacher( nom );
+}
+
+int menu_supprimer_personne_de_formation( db_formation *dbf, db_personne *dbp )
+{
+    int idf, i;
+    db_formation *tmpdbf = dbf;
+    curseur_formation cf;
+    formation *tmpf;
+    printf( "********************************************************************************\n" );
+    printf( "* MENU SUPPRESSION : Liste des formations                                      *\n" );
+    printf( "********************************************************************************\n" );
+    for( tmpf = debut_curseur_formation( &cf, tmpdbf, ORDRE_RECENT ); tmpf != NULL;
+         tmpf = suivant_curseur_formation( &cf ) )
+    {
+        printf( "* %2d %-40s                                  *\n", tmpf->id, tmpf->nom );
+    }
+    printf( "*  0 Retour                                                                    *\n" );
+    printf( "* De quelle formation voudriez vous supprimer quelqu'un ? " );
+    scanf( "%d", &idf );
+    getchar();
+    while( idf > 0 && get_formation_par_id( tmpdbf, idf ) == NULL )
+    {
+        printf( "* Option %d - INVALIDE\n", idf );
+        printf( "* De quelle formation voudriez vous supprimer quelqu'un ? " );
+        scanf( "%d", &idf );
+        getchar();
+    }
+    if ( idf <= 0 )
+    {
+        system( clear );
+        return 0;
+    }
+    tmpf = get_formation_par_id( tmpdbf, idf );
+    printf( "Cours choisi: %s\n", tmpf->nom );
+    if( tmpf->nb_inscrits == tmpf->nb_desinscrits )
+    {
+        system( clear );
+        printf( "* /!\\ La formation est vide /!\\                                        *\n" );
+        return 0;
+    }
+    for( i = tmpf->nb_inscrits - 1; i >= 0; i-- )
+    {
+        personne *tmpp = tmpf->inscrits[i];
+        if( tmpp != NULL )
+        {
+            printf( "* %2d %-25s %-25s %-10s            *\n",
+                    tmpp->id, tmpp->nom, tmpp->prenom, tmpp->formateur ? "Formateur" : "Etudiant" );
+        }
+    }
+    printf( "*  0 Retour                                                                    *\n" );
+    int idp;
+    printf( "* Quelle personne voudriez vous supprimer de cette formation ? " );
+    scanf( "%d", &idp );
+    getchar();
+    while( idp < 0 )
+    {
+        printf( "* Option %d - INVALIDE\n", idp );
+        printf( "* Quelle personne voudriez vous supprimer de cette formation ? " );
+        scanf( "%d", &idp );
+        getchar();
+    }
+    if( idp <= 0 )
+    {
+        system( clear );
+        return 0;
+    }
+    for( i = tmpf->nb_inscrits - 1; i >= 0; i-- )
+    {
+        personne *tmpp = tmpf->inscrits[i];
+        if( tmpp != NULL && tmpp->id == idp )
+        {
+            char confirmation[4];
+            printf( "* Etes vous sur de vouloir supprimer %s %s de la formation %s ? (o/n) ",
+                    tmpp->nom, tmpp->prenom, tmpf->nom );
+            scanf( "%s", confirmation );
+            while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
+                   strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
+            {
+                printf( "Veuillez inserer o / oui - n / non : " );
+                scanf( "%s", confirmation );
+            }
+            if( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 )
+            {
+                system( clear );
+                if( desinscrire_personne( tmpdbf, dbp, tmpf, tmpp, stdout ) )
+                {
+                    printf( "* %s %s a ete supprime de la formation %s avec succes *\n",
+                            tmpp->nom, tmpp->prenom, tmpf->nom );
+                    printf( "\n\n" );
+                    afficher_formation( tmpf );
+                    return 1;
+                }
+                printf( "* %s %s n'a PAS ete supprime de la formation %s *\n",
+                        tmpp->nom, tmpp->prenom, tmpf->nom );
+            }
+            else
+            {
+                system( clear );
+                printf( "* %s %s n'a PAS ete supprime de la formation %s *\n",
+                        tmpp->nom, tmpp->prenom, tmpf->nom );
+            }
+        }
+    }
+    return 0;
+}
+
+int menu_supprimer( db_formation *dbf, db_personne *dbp )
+{
+    int choix;
+    do
+    {
+        db_formation *tmpdbf = dbf;
+        db_personne *tmpdbp = dbp;
+        commencer_etape();
+        printf( "********************************************************************************\n" );
+        printf( "* MENU SUPPRESSION                                                             *\n" );
+        printf( "********************************************************************************\n" );
+        printf( "* 1. Supprimer une personne de la base de donnees                              *\n" );
+        printf( "* 2. Supprimer une formation de la base de donnes                              *\n" );
+        printf( "* 3. Supprimer une personne specifique d'une formation specifique              *\n" );
+        printf( "* 0. Retour                                                                    *\n" );
+        printf( "********************************************************************************\n" );
+        printf ("* Que voudriez vous supprimer ? " );
+        scanf( "%d", &choix );
+        getchar();
+        switch( choix )
+        {
+            case 1:
+                menu_supprimer_personne( tmpdbf, tmpdbp );
+                break;
+            case 2:
+                menu_supprimer_formation( tmpdbf, tmpdbp );
+                break;
+            case 3:
+                menu_supprimer_personne_de_formation( tmpdbf, tmpdbp );
+                break;
+            case 0:
+                system( clear );
+                break;
+            default:
+                system( clear );
+                break;
+        }
+    } while( choix != 0 );
+    return 0;
+}
+
+/*
+ * Le nombre de lignes d'une page des listes affichees par menu_affichage.
+ */
+#define LIGNES_PAR_ECRAN 20
+
+/*
+ * Cette structure sert a afficher une liste de personnes ou de formations page par page.
+ * Une des deux bases de donnees est renseignee, l'autre vaut NULL.
+ * int ordre : ORDRE_RECENT ou ORDRE_NOM. La liste est lue dans le vecteur ordre (compacte, sans pierre tombale)
+ *             ou dans l'index par nom: la ligne k s'y trouve directement, afficher une page ne coute que ses
+ *             lignes, quelle que soit sa position.
+ * int debut : La position de la premiere ligne de la page affichee.
+ */
+typedef struct liste_paginee
+{
+    db_personne *dbp;
+    db_formation *dbf;
+    int ordre;
+    int debut;
+} liste_paginee;
+
+/*
+ * Cette fonction sert a preparer la liste l (compacter le vecteur ordre ou construire l'index par nom si
+ * necessaire) et renvoie son nombre de lignes.
+ */
+int preparer_liste( liste_paginee *l )
+{
+    if( l->dbp != NULL )
+    {
+        if( l->ordre == ORDRE_NOM )
+        {
+            indexer_db_personne( l->dbp );
+        }
+        else if( l->dbp->nb_tombes > 0 )
+        {
+            compacter_db_personne( l->dbp );
+        }
+        return l->dbp->nb;
+    }
+    if( l->ordre == ORDRE_NOM )
+    {
+        indexer_db_formation( l->dbf );
+    }
+    else if( l->dbf->nb_tombes > 0 )
+    {
+        compacter_db_formation( l->dbf );
+    }
+    return l->dbf->nb;
+}
+
+/*
+ * Ces fonctions renvoient la personne ou la formation a la position k de la liste l, qui doit etre preparee.
+ */
+personne *personne_de_liste( liste_paginee *l, int k )
+{
+    if( l->ordre == ORDRE_NOM )
+    {
+        return l->dbp->par_nom[k];
+    }
+    return get_personne_par_id( l->dbp, l->dbp->ordre[ l->dbp->taille_ordre - 1 - k ] );
+}
+
+formation *formation_de_liste( liste_paginee *l, int k )
+{
+    if( l->ordre == ORDRE_NOM )
+    {
+        return l->dbf->par_nom[k];
+    }
+    return get_formation_par_id( l->dbf, l->dbf->ordre[ l->dbf->taille_ordre - 1 - k ] );
+}
+
+/*
+ * Cette fonction renvoie le nom de la ligne k de la liste l.
+ */
+const char *nom_de_liste( liste_paginee *l, int k )
+{
+    return l->dbp != NULL ? personne_de_liste( l, k )->nom : formation_de_liste( l, k )->nom;
+}
+
+/*
+ * Cette fonction renvoie la position dans la liste l de la personne ou de la formation id, -1 si elle n'existe
+ * pas. Dans l'ordre recent, la page de l'enregistrement donne directement sa position dans le vecteur ordre; dans
+ * l'ordre des noms, on la cherche par dichotomie dans l'index.
+ */
+int position_id_liste( liste_paginee *l, int id )
+{
+    int debut = 0, fin, n = preparer_liste( l );
+    personne *p = l->dbp != NULL ? get_personne_par_id( l->dbp, id ) : NULL;
+    formation *f = l->dbf != NULL ? get_formation_par_id( l->dbf, id ) : NULL;
+    if( p == NULL && f == NULL )
+    {
+        return -1;
+    }
+    if( l->ordre != ORDRE_NOM )
+    {
+        int position = p != NULL ? l->dbp->pages[ id >> DECALAGE_PAGE ]->position[ id & ( TAILLE_PAGE - 1 ) ] :
+                       l->dbf->pages[ id >> DECALAGE_PAGE ]->position[ id & ( TAILLE_PAGE - 1 ) ];
+        return n - 1 - position;
+    }
+    fin = n;
+    while( debut < fin )
+    {
+        int milieu = ( debut + fin ) / 2;
+        int res = p != NULL ? comparer_personne_nom( &l->dbp->par_nom[ milieu ], &p ) :
+                  comparer_formation_nom( &l->dbf->par_nom[ milieu ], &f );
+        if( res < 0 )
+        {
+            debut = milieu + 1;
+        }
+        else
+        {
+            fin = milieu;
+        }
+    }
+    return debut;
+}
+
+/*
+ * Cette fonction renvoie la position de la premiere ligne de la liste l dont le nom commence par prefixe, sans
+ * tenir compte des majuscules ni des accents (les cles pliees sont comparees), -1 s'il n'y en a pas. Dans l'ordre
+ * des noms, on la cherche par dichotomie; dans l'ordre recent, on cherche la suivante a partir de la position
+ * depuis, en revenant au debut de la liste si necessaire. Un prefixe de plus de LONGUEUR_NOM_MAX octets ne peut
+ * commencer aucun nom.
+ */
+int position_prefixe_liste( liste_paginee *l, const char *prefixe, int depuis )
+{
+    int n = preparer_liste( l ), debut = 0, fin = n, i;
+    char cle[ LONGUEUR_NOM_MAX + 1 ];
+    size_t taille;
+    if( strlen( prefixe ) > LONGUEUR_NOM_MAX )
+    {
+        return -1;
+    }
+    plier_nom( prefixe, cle );
+    taille = strlen( cle );
+    if( l->ordre == ORDRE_NOM )
+    {
+        while( debut < fin )
+        {
+            int milieu = ( debut + fin ) / 2;
+            if( strcmp( cle_pliee( nom_de_liste( l, milieu ) ), cle ) < 0 )
+            {
+                debut = milieu + 1;
+            }
+            else
+            {
+                fin = milieu;
+            }
+        }
+        return debut < n && strncmp( cle_pliee( nom_de_liste( l, debut ) ), cle, taille ) == 0 ? debut : -1;
+    }
+    for( i = 0; i < n; i++ )
+    {
+        int k = ( depuis + i ) % n;
+        if( strncmp( cle_pliee( nom_de_liste( l, k ) ), cle, taille ) == 0 )
+        {
+            return k;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Cette fonction sert a afficher les lignes de la position debut (incluse) a la position fin (exclue) de la
+ * liste l, avec l'entete des colonnes.
+ */
+void afficher_lignes_liste( liste_paginee *l, int debut, int fin )
+{
+    int k;
+    if( l->dbp != NULL )
+    {
+        printf( "* %2s %-25s %-25s %-9s             *\n", "ID", "Nom", "Prenom", "Statut" );
+    }
+    else
+    {
+        printf( "* %2s %-40s %-6s                           *\n", "ID", "Nom", "Prix" );
+    }
+    printf( "* ---------------------------------------------------------------------------- *\n" );
+    for( k = debut; k < fin; k++ )
+    {
+        if( l->dbp != NULL )
+        {
+            afficher_personne( personne_de_liste( l, k ) );
+        }
+        else
+        {
+            afficher_ligne_formation( formation_de_liste( l, k ) );
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a parcourir la liste l page par page. Une liste qui tient sur une page est affichee
+ * directement, comme avant. Sinon, apres chaque page, on peut demander:
+ * Entree ou s : la page suivante, p : la precedente, d / f : la premiere / la derniere, un nombre : cette page,
+ * #id : la page de cet identifiant, /texte : la page du premier nom qui commence par texte, q : quitter.
+ */
+void paginer_liste( liste_paginee *l )
+{
+    char ligne[64];
+    int n = preparer_liste( l ), nb_pages = ( n + LIGNES_PAR_ECRAN - 1 ) / LIGNES_PAR_ECRAN;
+    if( n <= LIGNES_PAR_ECRAN )
+    {
+        afficher_lignes_liste( l, 0, n );
+        return;
+    }
+    l->debut = 0;
+    while( 1 )
+    {
+        size_t taille;
+        int k, fin = l->debut + LIGNES_PAR_ECRAN < n ? l->debut + LIGNES_PAR_ECRAN : n;
+        afficher_lignes_liste( l, l->debut, fin );
+        printf( "* Page %d/%d - lignes %d a %d sur %d\n", l->debut / LIGNES_PAR_ECRAN + 1, nb_pages, l->debut + 1,
+                fin, n );
+        printf( "* [Entree] suivante [p]recedente [d]ebut [f]in [N] page [#id] [/nom] [q]uitter ? " );
+        if( fgets( ligne, sizeof( ligne ), stdin ) == NULL )
+        {
+            return;
+        }
+        taille = strlen( ligne );
+        while( taille > 0 && isspace( ( unsigned char ) ligne[ taille - 1 ] ) )
+        {
+            ligne[ --taille ] = '\0';
+        }
+        system( clear );
+        if( strcmp( ligne, "q" ) == 0 )
+        {
+            return;
+        }
+        k = l->debut;
+        if( ligne[0] == '\0' || strcmp( ligne, "s" ) == 0 )
+        {
+            k = fin < n ? fin : l->debut;
+        }
+        else if( strcmp( ligne, "p" ) == 0 )
+        {
+            k = l->debut - LIGNES_PAR_ECRAN;
+        }
+        else if( strcmp( ligne, "d" ) == 0 )
+        {
+            k = 0;
+        }
+        else if( strcmp( ligne, "f" ) == 0 )
+        {
+            k = n - 1;
+        }
+        else if( isdigit( ( unsigned char ) ligne[0] ) )
+        {
+            k = ( atoi( ligne ) - 1 ) * LIGNES_PAR_ECRAN;
+        }
+        else if( ligne[0] == '#' || ligne[0] == '/' )
+        {
+            k = ligne[0] == '#' ? position_id_liste( l, atoi( ligne + 1 ) ) :
+                position_prefixe_liste( l, ligne + 1, fin < n ? fin : 0 );
+            if( k < 0 )
+            {
+                printf( "/!\\ %s introuvable /!\\\n", ligne + 1 );
+                k = l->debut;
+            }
+        }
+        else
+        {
+            printf( "/!\\ Option %s - INVALIDE /!\\\n", ligne );
+        }
+        k = k < 0 ? 0 : k >= n ? n - 1 : k;
+        l->debut = k - k % LIGNES_PAR_ECRAN;
+    }
+}
+
+/*
+ * Ces fonctions servent a afficher les personnes ou les formations de la base de donnees page par page, dans
+ * l'ordre choisi (ORDRE_RECENT ou ORDRE_NOM).
+ */
+void paginer_db_personne( db_personne *dbp, int ordre )
+{
+    liste_paginee l;
+    memset( &l, 0, sizeof( l ) );
+    l.dbp = dbp;
+    l.ordre = ordre;
+    paginer_liste( &l );
+}
+
+void paginer_db_formation( db_formation *dbf, int ordre )
+{
+    liste_paginee l;
+    memset( &l, 0, sizeof( l ) );
+    l.dbf = dbf;
+    l.ordre = ordre;
+    paginer_liste( &l );
+}
+
+/*
+ * Cette fonction sert a afficher les salles avec le nombre de seances qui y ont lieu, puis le nombre de seances
+ * sans salle.
+ */
+void afficher_salles( db_formation *dbf )
+{
+    curseur_formation c;
+    formation *tmpf;
+    int *occupations = ( int * ) ALLOUER( dbf->nb_salles + 1, sizeof( int ), "occupations_salles" );
+    int sans_salle = 0, i, j;
+    for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_ID ); tmpf != NULL; tmpf = suivant_curseur_formation( &c ) )
+    {
+        for( j = 0; j < tmpf->nb_jours && j < 7; j++ )
+        {
+            salle *s = tmpf->salles[j] != 0 ? get_salle_par_id( dbf, tmpf->salles[j] ) : NULL;
+            if( s != NULL )
+            {
+                occupations[ s - dbf->salles ] += 1;
+            }
+            else
+            {
+                sans_salle += 1;
+            }
+        }
+    }
+    printf( "********************************************************************************\n" );
+    printf( "* %2s %-40s %8s %8s                *\n", "ID", "Salle", "Places", "Seances" );
+    printf( "* ---------------------------------------------------------------------------- *\n" );
+    for( i = 0; i < dbf->nb_salles; i++ )
+    {
+        printf( "* %2d %-40s %8d %8d                *\n", dbf->salles[i].id, dbf->salles[i].nom,
+                dbf->salles[i].capacite, occupations[i] );
+    }
+    printf( "********************************************************************************\n" );
+    printf( "* Seances sans salle: %d\n", sans_salle );
+    LIBERER( occupations );
+}
+
+/*
+ * Cette fonction sert a afficher la liste d'attente d'une formation choisie par l'utilisateur, dans l'ordre ou
+ * les personnes seront inscrites quand des places se liberent.
+ */
+void menu_liste_attente( db_formation *dbf )
+{
+    const char *politiques[] = { "prerequis manquants", "anciennete", "reduction" };
+    demande_attente **ordre;
+    formation *tmpf;
+    int idf, nb, i;
+    printf( "* Formation (identifiant): " );
+    if( scanf( "%d", &idf ) != 1 )
+    {
+        idf = 0;
+    }
+    getchar();
+    tmpf = get_formation_par_id( dbf, idf );
+    system( clear );
+    if( tmpf == NULL )
+    {
+        printf( "* Formation %d - INVALIDE *\n", idf );
+        return;
+    }
+    nb = trier_attente( tmpf, &ordre );
+    printf( "********************************************************************************\n" );
+    printf( "* Liste d'attente de %s (priorite: %s)\n", tmpf->nom,
+            politiques[ dbf->politique_attente >= 0 && dbf->politique_attente <= 2 ? dbf->politique_attente : 0 ] );
+    printf( "* Places occupees: %d / %d\n", tmpf->nb_apprenants, capacite_formation( dbf, tmpf ) );
+    printf( "* ---------------------------------------------------------------------------- *\n" );
+    for( i = 0; i < nb; i++ )
+    {
+        printf( "* %3d %4d %-25s %-25s rang %d\n", i + 1, ordre[i]->p->id, ordre[i]->p->nom, ordre[i]->p->prenom,
+                ordre[i]->rang );
+    }
+    printf( "********************************************************************************\n" );
+    printf( "* %d personne(s) en attente\n", nb );
+    LIBERER( ordre );
+}
+
+/*
+ * Menu permettant d'afficher les seances d'un jour, eventuellement entre deux heures, ou celles en cours.
+ */
+void menu_seances( db_formation *dbf )
+{
+    int jour, debut = 0, fin = 24 * 60;
+    char texte_debut[32], texte_fin[32];
+    printf( "* 1. lundi\n* 2. mardi\n* 3. mercredi\n* 4. jeudi\n* 5. vendredi\n* 6. samedi\n* 7. dimanche\n" );
+    printf( "* Quel jour ? (0 pour les seances en ce moment) " );
+    while( scanf( "%d", &jour ) != 1 || jour < 0 || jour > 7 )
+    {
+        getchar();
+        printf( "* Option INVALIDE: Max 7 Min 0\n" );
+        printf( "* Quel jour ? (0 pour les seances en ce moment) " );
+    }
+    if( jour == 0 )
+    {
+        instant_present( &jour, &debut );
+        fin = debut;
+    }
+    else
+    {
+        printf( "* Entre quelles heures ? (ex. 8 12.30, 0 24 pour toute la journee) " );
+        while( scanf( "%31s %31s", texte_debut, texte_fin ) == 2 &&
+               ( !lire_horaire( texte_debut, &debut ) || !lire_horaire( texte_fin, &fin ) || fin < debut ) )
+        {
+            printf( "* Option INVALIDE: debut puis fin, fin apres debut\n" );
+            printf( "* Entre quelles heures ? (ex. 8 12.30, 0 24 pour toute la journee) " );
+        }
+    }
+    getchar();
+    system( clear );
+    afficher_seances( dbf, jour, debut, fin );
+}
+
+void menu_requete( db_formation *dbf, db_personne *dbp );
+void menu_emploi_du_temps( db_formation *dbf, db_personne *dbp );
+void menu_formateurs_libres( db_formation *dbf, db_personne *dbp );
+void menu_recherche_approchee( db_formation *dbf, db_personne *dbp );
+
+int menu_affichage( db_formation *f, db_personne *p )
+{
+    int choix;
+    do
+    {
+        db_formation *tmpdbf = f;
+        db_personne *tmpdbp = p;
+        printf( "********************************************************************************\n" );
+        printf( "* MENU AFFICHAGE                                                               *\n" );
+        printf( "********************************************************************************\n" );
+        printf( "* 1. Liste des personnes                                                       *\n" );
+        printf( "* 2. Liste des formations                                                      *\n" );
+        printf( "* 3. Planning de la semaine                                                    *\n" );
+        printf( "* 4. Liste des personnes triee par nom                                         *\n" );
+        printf( "* 5. Liste des formations triee par nom                                        *\n" );
+        printf( "* 6. Requete sur les personnes, les formations ou les inscriptions             *\n" );
+        printf( "* 7. Seances d'un jour ou en ce moment                                         *\n" );
+        printf( "* 8. Emploi du temps d'une personne                                            *\n" );
+        printf( "* 9. Formateurs libres a un moment de la semaine                               *\n" );
+        printf( "* 10. Salles de cours                                                          *\n" );
+        printf( "* 11. Liste d'attente d'une formation                                          *\n" );
+        printf( "* 12. Recherche approchee d'une personne ou d'une formation                    *\n" );
+        printf( "* 0. Retour                                                                    *\n" );
+        printf( "********************************************************************************\n" );
+        printf( "* Que voudriez-vous afficher ? " );
+        scanf( "%d", &choix );
+        getchar();
+        switch( choix )
+        {
+            case 1:
+                system( clear );
+                paginer_db_personne( tmpdbp, ORDRE_RECENT );
+                break;
+            case 2:
+                system( clear );
+                paginer_db_formation( tmpdbf, ORDRE_RECENT );
+                break;
+            case 3:
+                system( clear );
+                afficher_db_formation( tmpdbf );
+                break;
+            case 4:
+                system( clear );
+                paginer_db_personne( tmpdbp, ORDRE_NOM );
+                break;
+            case 5:
+                system( clear );
+                paginer_db_formation( tmpdbf, ORDRE_NOM );
+                break;
+            case 6:
+                system( clear );
+                menu_requete( tmpdbf, tmpdbp );
+                break;
+            case 7:
+                system( clear );
+                menu_seances( tmpdbf );
+                break;
+            case 8:
+                system( clear );
+                menu_emploi_du_temps( tmpdbf, tmpdbp );
+                break;
+            case 9:
+                system( clear );
+                menu_formateurs_libres( tmpdbf, tmpdbp );
+                break;
+            case 10:
+                system( clear );
+                afficher_salles( tmpdbf );
+                break;
+            case 11:
+                system( clear );
+                menu_liste_attente( tmpdbf );
+                break;
+            case 12:
+                system( clear );
+                menu_recherche_approchee( tmpdbf, tmpdbp );
+                break;
+            case 0:
+                system( clear );
+                break;
+            default:
+                system( clear );
+                printf( "/!\\ Option %d - INVALIDE /!\\\n", choix );
+                break;
+        }
+    } while( choix != 0 );
+    return 0;
+}
+
+/*
+ * Cette fonction sert a ecrire le planning de la semaine dans le fichier CaculliTyranowski.res.
+ */
+void ecrire_planning( db_formation *dbf )
+{
+    FILE *fres = fopen( "CaculliTyranowski.res", "w" );
+    ecrire_planning_flux( dbf, fres );
+    fclose( fres );
+}
+
+/*
+ * Cette fonction sert a ecrire toutes les personnes de la base de donnees dbp dans le fichier fdat_p,
+ * au format de CaculliTyranowskiPersonne.dat. Les personnes sont ecrites dans leur ordre d'ajout.
+ */
+void ecrire_db_personne( db_personne *dbp, FILE *fdat_p )
+{
+    curseur_personne c;
+    personne *tmpp;
+    for( tmpp = debut_curseur_personne( &c, dbp, ORDRE_INSERTION ); tmpp != NULL;
+         tmpp = suivant_curseur_personne( &c ) )
+    {
+        compter_visites( 1 );
+        fprintf( fdat_p, "%02d %-24s %-24s %d   %d   ",
+                 tmpp->id, tmpp->nom, tmpp->prenom, tmpp->formateur, tmpp->nb_formations );
+        int i;
+        for ( i = 0; i < tmpp->nb_formations; i++ )
+        {
+            fprintf( fdat_p, "%d ", tmpp->formations[ i ] );
+        }
+        if ( tmpp->formateur == 0 )
+        {
+            fprintf( fdat_p, "   %d   ", tmpp->reduction );
+            if ( tmpp->reduction > 0 )
+            {
+                fprintf( fdat_p, "%d", tmpp->val_reduction );
+            }
+        } else
+        {
+            fprintf( fdat_p, "  %d  ", tmpp->nb_jours_indisponible );
+            for ( i = 0; i < tmpp->nb_jours_indisponible; i++ )
+            {
+                fprintf( fdat_p, "%d ", tmpp->jours_indisponible[ i ] );
+            }
+        }
+        fprintf( fdat_p, "\n" );
+    }
+}
+
+/*
+ * Le format de CaculliTyranowskiFormation.dat. Le format 1 (sans ligne "format" au debut du fichier) ecrivait
+ * les horaires, les durees et les prix en virgule flottante; le format 2 les ecrit en minutes et en centimes.
+ */
+#define FORMAT_FICHIER_FORMATION 2
+
+/*
+ * Cette fonction sert a ecrire toutes les formations de la base de donnees dbf dans le fichier fdat_f,
+ * au format de CaculliTyranowskiFormation.dat. Les formations sont ecrites dans leur ordre d'ajout.
+ */
+void ecrire_db_formation( db_formation *dbf, FILE *fdat_f )
+{
+    curseur_formation c;
+    formation *tmpf;
+    fprintf( fdat_f, "format %d\n", FORMAT_FICHIER_FORMATION );
+    for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_INSERTION ); tmpf != NULL;
+         tmpf = suivant_curseur_formation( &c ) )
+    {
+        int i;
+        compter_visites( 1 );
+        fprintf( fdat_f, "%02d %d ", tmpf->id, tmpf->nb_prerequis );
+        if ( tmpf->nb_prerequis > 0 )
+        {
+            for ( i = 0; i < tmpf->nb_prerequis; i++ )
+            {
+                fprintf( fdat_f, "%d ", tmpf->prerequis[ i ] );
+            }
+            fprintf( fdat_f, "%d   ", tmpf->nb_jours );
+        } else
+        {
+            fprintf( fdat_f, "  %d   ", tmpf->nb_jours );
+        }
+        for ( i = 0; i < tmpf->nb_jours; i++ )
+        {
+            fprintf( fdat_f, "%d   %d   %d   ",
+                     tmpf->jours[ i ], tmpf->heures[ i ], tmpf->durees[ i ] );
+        }
+        fprintf( fdat_f, "%d %-s\n", tmpf->prix, tmpf->nom );
+    }
+}
+
+/*
+ * Noms des fichiers utilises par la sauvegarde. La sauvegarde automatique ecrit dans des fichiers separes
+ * (_AUTO) afin de ne pas remplacer les fichiers principaux sans l'accord de l'utilisateur.
+ */
+#define FICHIER_FORMATION "CaculliTyranowskiFormation.dat"
+#define FICHIER_PERSONNE "CaculliTyranowskiPersonne.dat"
+#define FICHIER_FORMATION_AUTO "CaculliTyranowskiFormation_AUTO.dat"
+#define FICHIER_PERSONNE_AUTO "CaculliTyranowskiPersonne_AUTO.dat"
+#define FICHIER_ID "CaculliTyranowskiId.dat"
+#define FICHIER_ID_AUTO "CaculliTyranowskiId_AUTO.dat"
+#define FICHIER_SALLES "CaculliTyranowskiSalles.dat"
+#define FICHIER_SALLES_AUTO "CaculliTyranowskiSalles_AUTO.dat"
+#define FICHIER_ATTENTE "CaculliTyranowskiAttente.dat"
+#define FICHIER_ATTENTE_AUTO "CaculliTyranowskiAttente_AUTO.dat"
+
+/*
+ * Cette structure regroupe les deux bases de donnees, pour les fonctions qui ont besoin des deux
+ * mais ne recoivent qu'un seul pointeur.
+ */
+typedef struct paire_db
+{
+    db_formation *dbf;
+    db_personne *dbp;
+} paire_db;
+
+/*
+ * Cette fonction sert a ecrire dans le fichier fid l'etat des allocateurs d'identifiants:
+ * le plus grand identifiant attribue des personnes et des formations, et si le recyclage est active.
+ */
+void ecrire_ids( void *db, FILE *fid )
+{
+    paire_db *bases = ( paire_db * ) db;
+    fprintf( fid, "personne %d\n", bases->dbp->ids.haut );
+    fprintf( fid, "formation %d\n", bases->dbf->ids.haut );
+    fprintf( fid, "recyclage %d\n", bases->dbp->ids.recycler );
+}
+
+/*
+ * Cette fonction sert a marquer comme libres tous les identifiants inferieurs au plus grand identifiant
+ * attribue qui ne sont portes par aucune personne, si le recyclage est active.
+ */
+void recalculer_ids_libres_personne( db_personne *dbp )
+{
+    int id;
+    for( id = 1; id <= dbp->ids.haut && id <= ID_MAX; id++ )
+    {
+        if( get_personne_par_id( dbp, id ) == NULL )
+        {
+            liberer_id( &dbp->ids, id );
+        }
+    }
+}
+
+void recalculer_ids_libres_formation( db_formation *dbf )
+{
+    int id;
+    for( id = 1; id <= dbf->ids.haut && id <= ID_MAX; id++ )
+    {
+        if( get_formation_par_id( dbf, id ) == NULL )
+        {
+            liberer_id( &dbf->ids, id );
+        }
+    }
+}
+
+/*
+ * Le bilan du chargement des fichiers: chaque ligne ignoree, parce qu'elle est mal formee, incomplete, hors
+ * limites, en double ou parce qu'elle cite un enregistrement qui n'existe pas, est signalee et comptee.
+ * FILE *journal : Le fichier ou les lignes ignorees sont signalees, la sortie d'erreur si NULL.
+ * int nb : Le nombre de lignes ignorees depuis la derniere remise a zero.
+ */
+typedef struct bilan_chargement
+{
+    FILE *journal;
+    int nb;
+} bilan_chargement;
+
+bilan_chargement chargement;
+
+/*
+ * Cette fonction sert a signaler une ligne ignoree au chargement, voir bilan_chargement.
+ */
+void signaler_chargement( const char *format, ... )
+{
+    FILE *journal = chargement.journal != NULL ? chargement.journal : stderr;
+    va_list args;
+    va_start( args, format );
+    vfprintf( journal, format, args );
+    va_end( args );
+    fprintf( journal, "\n" );
+    chargement.nb += 1;
+}
+
+/*
+ * LONGUEUR_LIGNE_MAX est la longueur maximale d'une ligne des fichiers .dat: un enregistrement valide, avec ses
+ * listes et ses noms les plus longs, y tient toujours.
+ */
+#define LONGUEUR_LIGNE_MAX 2048
+
+/*
+ * Cette fonction sert a sauter la fin de la ligne en cours du fichier fichier, apres une ligne trop longue.
+ */
+void sauter_ligne( FILE *fichier )
+{
+    int c;
+    while( ( c = fgetc( fichier ) ) != EOF && c != '\n' )
+    {
+    }
+}
+
+/*
+ * Cette fonction sert a lire la ligne suivante du fichier fichier dans ligne, de LONGUEUR_LIGNE_MAX + 1 cases, sans
+ * son retour a la ligne. *numero compte les lignes lues.
+ * On obtient 1 si la ligne est complete, 0 a la fin du fichier, -1 si elle est trop longue (sa fin est sautee),
+ * si elle contient un caractere nul ou si elle s'arrete avant son retour a la ligne (une derniere ligne tronquee).
+ */
+int lire_ligne( FILE *fichier, char ligne[], int *numero )
+{
+    size_t longueur;
+    ligne[ LONGUEUR_LIGNE_MAX ] = 'x';
+    if( fgets( ligne, LONGUEUR_LIGNE_MAX + 1, fichier ) == NULL )
+    {
+        return 0;
+    }
+    *numero += 1;
+    longueur = strlen( ligne );
+    if( longueur > 0 && ligne[ longueur - 1 ] == '\n' )
+    {
+        ligne[ longueur - 1 ] = '\0';
+        return 1;
+    }
+    if( ligne[ LONGUEUR_LIGNE_MAX ] == '\0' && ligne[ LONGUEUR_LIGNE_MAX - 1 ] != '\n' )
+    {
+        sauter_ligne( fichier );
+    }
+    return -1;
+}
+
+/*
+ * Ces fonctions servent a lire le champ suivant de la ligne *texte, en avancant *texte juste apres lui: un entier
+ * dans *valeur, ou un mot d'au plus LONGUEUR_NOM_MAX caracteres dans mot. Comme seule la ligne est lue, un champ
+ * manquant ne prend jamais celui de la ligne suivante.
+ * On obtient 1 si le champ a ete lu, 0 s'il manque ou s'il est mal forme.
+ */
+int lire_champ_entier( const char **texte, int *valeur )
+{
+    char *fin;
+    long v = strtol( *texte, &fin, 10 );
+    if( fin == *texte || ( *fin != '\0' && !isspace( ( unsigned char ) *fin ) ) || v < -2000000000L ||
+        v > 2000000000L )
+    {
+        return 0;
+    }
+    *valeur = ( int ) v;
+    *texte = fin;
+    return 1;
+}
+
+int lire_champ_mot( const char **texte, char mot[] )
+{
+    const char *debut = *texte;
+    size_t longueur;
+    while( isspace( ( unsigned char ) *debut ) )
+    {
+        debut++;
+    }
+    longueur = strcspn( debut, " \t\r\v\f" );
+    if( longueur == 0 || longueur > LONGUEUR_NOM_MAX )
+    {
+        return 0;
+    }
+    memcpy( mot, debut, longueur );
+    mot[ longueur ] = '\0';
+    *texte = debut + longueur;
+    return 1;
+}
+
+/*
+ * Cette fonction renvoie 1 s'il ne reste que des blancs dans texte, 0 si la ligne a des champs en trop.
+ */
+int fin_de_ligne( const char *texte )
+{
+    while( isspace( ( unsigned char ) *texte ) )
+    {
+        texte++;
+    }
+    return *texte == '\0';
+}
+
+/*
+ * Cette fonction sert a lire le fichier nom ecrit par ecrire_ids, avant le chargement des fichiers .dat: le plus
+ * grand identifiant attribue qu'il donne borne les identifiants acceptes au chargement (voir borne_ids). Les
+ * donnees chargees ensuite peuvent encore l'augmenter, puis recalculer_ids_libres_personne et
+ * recalculer_ids_libres_formation marquent les identifiants libres.
+ * Si le fichier n'existe pas, seules les donnees chargees sont prises en compte.
+ */
+void charger_ids( db_formation *dbf, db_personne *dbp, const char *nom )
+{
+    FILE *fid = fopen( nom, "r" );
+    char cle[ 32 ];
+    int valeur;
+    if( fid != NULL )
+    {
+        while( fscanf( fid, "%31s %d", cle, &valeur ) == 2 )
+        {
+            if( strcmp( cle, "personne" ) == 0 )
+            {
+                reserver_id( &dbp->ids, valeur );
+            }
+            else if( strcmp( cle, "formation" ) == 0 )
+            {
+                reserver_id( &dbf->ids, valeur );
+            }
+            else if( strcmp( cle, "recyclage" ) == 0 )
+            {
+                dbp->ids.recycler = valeur != 0;
+                dbf->ids.recycler = valeur != 0;
+            }
+        }
+        fclose( fid );
+    }
+}
+
+/*
+ * Cette fonction renvoie le plus grand identifiant qu'un enregistrement du fichier fichier, qui vient d'etre
+ * ouvert, peut porter: le plus grand identifiant deja attribue haut (voir charger_ids), ou deux fois la taille du
+ * fichier en octets si c'est plus. Une ligne valide fait au moins dix octets, un identifiant accepte depasse donc
+ * au plus de vingt fois le nombre d'enregistrements. Un identifiant plus grand est une corruption: le charger
+ * allouerait une page d'enregistrements presque vide, de TAILLE_PAGE cases.
+ */
+int borne_ids( FILE *fichier, int haut )
+{
+    long taille;
+    if( fseek( fichier, 0, SEEK_END ) != 0 || ( taille = ftell( fichier ) ) < 0 || fseek( fichier, 0, SEEK_SET ) != 0 ||
+        taille > ID_MAX / 2 )
+    {
+        rewind( fichier );
+        return ID_MAX;
+    }
+    return haut > taille * 2 + TAILLE_PAGE ? haut : ( int ) taille * 2 + TAILLE_PAGE;
+}
+
+/*
+ * Cette fonction sert a ecrire dans le fichier fsal les salles de la base de donnees db, une ligne
+ * "salle id capacite nom" par salle, puis une ligne "seance formation creneau salle" par seance qui a une salle.
+ */
+void ecrire_salles( void *db, FILE *fsal )
+{
+    db_formation *dbf = ( db_formation * ) db;
+    curseur_formation c;
+    formation *tmpf;
+    int i, j;
+    for( i = 0; i < dbf->nb_salles; i++ )
+    {
+        fprintf( fsal, "salle %d %d %s\n", dbf->salles[i].id, dbf->salles[i].capacite, dbf->salles[i].nom );
+    }
+    for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_ID ); tmpf != NULL; tmpf = suivant_curseur_formation( &c ) )
+    {
+        for( j = 0; j < tmpf->nb_jours && j < 7; j++ )
+        {
+            if( tmpf->salles[j] != 0 )
+            {
+                fprintf( fsal, "seance %d %d %d\n", tmpf->id, j, tmpf->salles[j] );
+            }
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a lire le fichier nom ecrit par ecrire_salles, apres le chargement des formations.
+ * Une seance dont la formation, le creneau ou la salle n'existe pas est ignoree (voir signaler_chargement). Si
+ * le fichier n'existe pas, il n'y a aucune salle.
+ */
+void charger_salles( db_formation *dbf, const char *nom )
+{
+    FILE *fsal = fopen( nom, "r" );
+    char cle[ 32 ], nom_salle[ 40 ];
+    int id, capacite, creneau, id_salle;
+    if( fsal == NULL )
+    {
+        return;
+    }
+    while( fscanf( fsal, "%31s", cle ) == 1 )
+    {
+        if( strcmp( cle, "salle" ) == 0 && fscanf( fsal, "%d %d ", &id, &capacite ) == 2 &&
+            fgets( nom_salle, sizeof( nom_salle ), fsal ) != NULL )
+        {
+            nom_salle[ strcspn( nom_salle, "\n" ) ] = '\0';
+            if( ajouter_salle( dbf, id, nom_salle, capacite ) == NULL )
+            {
+                signaler_chargement( "Salle %d ignoree: identifiant ou capacite invalide", id );
+            }
+        }
+        else if( strcmp( cle, "seance" ) == 0 && fscanf( fsal, "%d %d %d", &id, &creneau, &id_salle ) == 3 )
+        {
+            formation *f = get_formation_par_id( dbf, id );
+            if( f != NULL && creneau >= 0 && creneau < f->nb_jours && get_salle_par_id( dbf, id_salle ) != NULL )
+            {
+                f->salles[ creneau ] = id_salle;
+            }
+            else
+            {
+                signaler_chargement( "Seance %d de la formation %d ignoree: formation, creneau ou salle %d inconnu",
+                                     creneau, id, id_salle );
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+    fclose( fsal );
+}
+
+/*
+ * Cette fonction sert a ecrire dans fatt la politique et les listes d'attente de la base de donnees
+ * db_formation *db. Une ligne par demande: "attente formation personne rang numero".
+ */
+void ecrire_attente( void *db, FILE *fatt )
+{
+    db_formation *dbf = ( db_formation * ) db;
+    curseur_formation c;
+    formation *tmpf;
+    int i;
+    fprintf( fatt, "politique %d\n", dbf->politique_attente );
+    for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_ID ); tmpf != NULL; tmpf = suivant_curseur_formation( &c ) )
+    {
+        for( i = 0; tmpf->attente != NULL && i < tmpf->attente->nb; i++ )
+        {
+            demande_attente *d = tmpf->attente->tas[i];
+            fprintf( fatt, "attente %d %d %d %d\n", d->formation, d->p->id, d->rang, d->numero );
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a lire le fichier nom ecrit par ecrire_attente, apres le chargement des formations et
+ * des personnes. Les demandes dont la formation ou la personne n'existe plus, en double, ou d'une personne qui
+ * participe deja a la formation sont ignorees (voir signaler_chargement).
+ */
+void charger_attente( db_formation *dbf, db_personne *dbp, const char *nom )
+{
+    FILE *fatt = fopen( nom, "r" );
+    char cle[ 32 ];
+    int idf, idp, rang, numero;
+    if( fatt == NULL )
+    {
+        return;
+    }
+    while( fscanf( fatt, "%31s", cle ) == 1 )
+    {
+        if( strcmp( cle, "politique" ) == 0 && fscanf( fatt, "%d", &rang ) == 1 )
+        {
+            dbf->politique_attente = rang;
+        }
+        else if( strcmp( cle, "attente" ) == 0 && fscanf( fatt, "%d %d %d %d", &idf, &idp, &rang, &numero ) == 4 )
+        {
+            formation *f = get_formation_par_id( dbf, idf );
+            personne *p = get_personne_par_id( dbp, idp );
+            int k;
+            for( k = 0; p != NULL && k < p->nb_formations && p->formations[k] != idf; k++ )
+            {
+            }
+            if( f == NULL || p == NULL || numero <= 0 )
+            {
+                signaler_chargement( "Demande d'attente de %d pour la formation %d ignoree: formation, personne ou "
+                                     "numero invalide", idp, idf );
+            }
+            else if( k < p->nb_formations || !ajouter_attente( dbf, f, p, rang, numero ) )
+            {
+                signaler_chargement( "Demande d'attente de %d pour la formation %d ignoree: deja inscrit(e) ou en "
+                                     "double", idp, idf );
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+    fclose( fatt );
+}
+
+/*
+ * Cette fonction sert a lire dans *lue, nom et prenom la personne de la ligne ligne, au format de
+ * CaculliTyranowskiPersonne.dat. Les noms de *lue ne sont pas remplis.
+ * On obtient NULL si la ligne est valide, sinon la raison pour laquelle elle doit etre ignoree.
+ */
+const char *lire_ligne_personne( const char *ligne, personne *lue, char nom[], char prenom[] )
+{
+    int j, complet;
+    memset( lue, 0, sizeof( personne ) );
+    complet = lire_champ_entier( &ligne, &lue->id ) && lire_champ_mot( &ligne, nom ) &&
+              lire_champ_mot( &ligne, prenom ) && lire_champ_entier( &ligne, &lue->formateur ) &&
+              ( lue->formateur == 0 || lue->formateur == 1 ) && lire_champ_entier( &ligne, &lue->nb_formations );
+    if( complet && ( lue->nb_formations < 0 || lue->nb_formations > 30 ) )
+    {
+        return "nombre de formations hors limites (30 au plus)";
+    }
+    for( j = 0; complet && j < lue->nb_formations; j++ )
+    {
+        complet = lire_champ_entier( &ligne, &lue->formations[j] );
+    }
+    if( complet && lue->formateur == 0 )
+    {
+        complet = lire_champ_entier( &ligne, &lue->reduction ) &&
+                  ( lue->reduction != 1 || lire_champ_entier( &ligne, &lue->val_reduction ) );
+    }
+    else if( complet )
+    {
+        complet = lire_champ_entier( &ligne, &lue->nb_jours_indisponible );
+        if( complet && ( lue->nb_jours_indisponible < 0 || lue->nb_jours_indisponible > 7 ) )
+        {
+            return "nombre de jours d'indisponibilite hors limites (7 au plus)";
+        }
+        for( j = 0; complet && j < lue->nb_jours_indisponible; j++ )
+        {
+            complet = lire_champ_entier( &ligne, &lue->jours_indisponible[j] );
+        }
+    }
+    if( !complet )
+    {
+        return "enregistrement incomplet ou mal forme";
+    }
+    return fin_de_ligne( ligne ) ? NULL : "champs en trop";
+}
+
+/*
+ * Cette fonction sert a charger dans dbp les personnes du fichier nom, au format de
+ * CaculliTyranowskiPersonne.dat. Les liens vers les formations sont faits ensuite par relier_db.
+ * Chaque enregistrement est lu ligne par ligne: une ligne tronquee, trop longue, mal formee, avec un champ
+ * manquant ou en trop, dont une liste depasse sa taille maximale ou dont l'identifiant est deja utilise ou au-dela
+ * de borne_ids est ignoree (voir signaler_chargement), sans toucher a la ligne suivante.
+ * On renvoie le nombre de personnes chargees, -1 si le fichier n'a pas pu etre ouvert.
+ */
+int charger_db_personne( db_personne *dbp, const char *nom_fichier )
+{
+    FILE *fdat_p = fopen( nom_fichier, "r" );
+    char ligne[ LONGUEUR_LIGNE_MAX + 1 ], nom[ LONGUEUR_NOM_MAX + 1 ], prenom[ LONGUEUR_NOM_MAX + 1 ];
+    chrono ch;
+    int i = 0, numero = 0, lue, borne;
+    if( fdat_p == NULL )
+    {
+        return -1;
+    }
+    borne = borne_ids( fdat_p, dbp->ids.haut );
+    demarrer_compteur( &ch, CPT_CHARGEMENT_PERSONNES );
+    while( ( lue = lire_ligne( fdat_p, ligne, &numero ) ) != 0 )
+    {
+        const char *raison = lue < 0 ? "ligne tronquee ou trop longue" : NULL;
+        personne p, *tmp;
+        if( raison == NULL && fin_de_ligne( ligne ) )
+        {
+            continue;
+        }
+        if( raison == NULL )
+        {
+            raison = lire_ligne_personne( ligne, &p, nom, prenom );
+        }
+        if( raison == NULL && p.id > borne )
+        {
+            raison = "identifiant tres au-dela du nombre d'enregistrements";
+        }
+        if( raison != NULL )
+        {
+            signaler_chargement( "Ligne %d de %s ignoree: %s", numero, nom_fichier, raison );
+            continue;
+        }
+        tmp = creer_personne( nom, prenom, p.formateur );
+        p.nom = tmp->nom;
+        p.prenom = tmp->prenom;
+        *tmp = p;
+        if( ranger_db_personne( dbp, tmp ) == NULL )
+        {
+            signaler_chargement( "Ligne %d de %s ignoree: la personne %d a un identifiant invalide ou deja utilise",
+                                 numero, nom_fichier, p.id );
+            continue;
+        }
+        i += 1;
+    }
+    compter_visites( i );
+    arreter_compteur( &ch );
+    fclose( fdat_p );
+    return i;
+}
+
+/*
+ * Cette fonction sert a lire la ligne "format" au debut du fichier de formations fdat_f.
+ * On renvoie le format du fichier, 1 s'il n'a pas de ligne "format".
+ */
+int lire_format_formation( FILE *fdat_f )
+{
+    int format = 1;
+    if( fscanf( fdat_f, " format %d", &format ) != 1 )
+    {
+        format = 1;
+    }
+    return format;
+}
+
+/*
+ * Cette fonction sert a lire dans *lue et nom la formation de la ligne ligne, au format format de
+ * CaculliTyranowskiFormation.dat. Au format 1, les horaires, les durees et le prix sont relus comme du texte, donc
+ * sans erreur d'arrondi: les horaires y sont en heures et minutes (14.30), les durees en heures decimales (1.75 pour
+ * 1 heure 45, voir lire_duree). Le nom de *lue n'est pas rempli.
+ * On obtient NULL si la ligne est valide, sinon la raison pour laquelle elle doit etre ignoree.
+ */
+const char *lire_ligne_formation( const char *ligne, int format, formation *lue, char nom[] )
+{
+    char texte_heure[ LONGUEUR_NOM_MAX + 1 ], texte_duree[ LONGUEUR_NOM_MAX + 1 ];
+    int j, complet;
+    memset( lue, 0, sizeof( formation ) );
+    complet = lire_champ_entier( &ligne, &lue->id ) && lire_champ_entier( &ligne, &lue->nb_prerequis );
+    if( complet && ( lue->nb_prerequis < 0 || lue->nb_prerequis > 10 ) )
+    {
+        return "nombre de prerequis hors limites (10 au plus)";
+    }
+    for( j = 0; complet && j < lue->nb_prerequis; j++ )
+    {
+        complet = lire_champ_entier( &ligne, &lue->prerequis[j] );
+    }
+    complet = complet && lire_champ_entier( &ligne, &lue->nb_jours );
+    if( complet && ( lue->nb_jours < 0 || lue->nb_jours > 7 ) )
+    {
+        return "nombre de seances hors limites (7 au plus)";
+    }
+    for( j = 0; complet && j < lue->nb_jours; j++ )
+    {
+        complet = lire_champ_entier( &ligne, &lue->jours[j] );
+        if( complet && format >= 2 )
+        {
+            complet = lire_champ_entier( &ligne, &lue->heures[j] ) && lire_champ_entier( &ligne, &lue->durees[j] );
+        }
+        else if( complet )
+        {
+            complet = lire_champ_mot( &ligne, texte_heure ) && lire_champ_mot( &ligne, texte_duree ) &&
+                      lire_horaire( texte_heure, &lue->heures[j] ) && lire_duree( texte_duree, &lue->durees[j] );
+        }
+    }
+    if( complet && format >= 2 )
+    {
+        complet = lire_champ_entier( &ligne, &lue->prix );
+    }
+    else if( complet )
+    {
+        complet = lire_champ_mot( &ligne, texte_heure ) && lire_prix( texte_heure, &lue->prix );
+    }
+    if( !complet )
+    {
+        return "enregistrement incomplet ou mal forme";
+    }
+    while( isspace( ( unsigned char ) *ligne ) )
+    {
+        ligne++;
+    }
+    if( *ligne == '\0' || strlen( ligne ) > LONGUEUR_NOM_MAX )
+    {
+        return "nom manquant ou trop long";
+    }
+    strcpy( nom, ligne );
+    return NULL;
+}
+
+/*
+ * Cette fonction sert a charger dans dbf les formations du fichier nom, au format de
+ * CaculliTyranowskiFormation.dat. Un fichier au format 1 est converti en le lisant (voir lire_ligne_formation).
+ * Comme pour les personnes, chaque enregistrement est lu ligne par ligne: une ligne tronquee, trop longue, mal
+ * formee, incomplete, avec plus de 10 prerequis ou de 7 seances, ou dont l'identifiant est deja utilise ou au-dela
+ * de borne_ids est ignoree (voir signaler_chargement), sans toucher a la ligne suivante.
+ * On renvoie le nombre de formations chargees, -1 si le fichier n'a pas pu etre ouvert.
+ */
+int charger_db_formation( db_formation *dbf, const char *nom_fichier )
+{
+    FILE *fdat_f = fopen( nom_fichier, "r" );
+    char ligne[ LONGUEUR_LIGNE_MAX + 1 ], nom[ LONGUEUR_NOM_MAX + 1 ];
+    chrono ch;
+    int i = 0, numero = 0, format = 1, lue, borne;
+    if( fdat_f == NULL )
+    {
+        return -1;
+    }
+    borne = borne_ids( fdat_f, dbf->ids.haut );
+    demarrer_compteur( &ch, CPT_CHARGEMENT_FORMATIONS );
+    while( ( lue = lire_ligne( fdat_f, ligne, &numero ) ) != 0 )
+    {
+        const char *raison = lue < 0 ? "ligne tronquee ou trop longue" : NULL, *texte = ligne + 6;
+        formation f, *tmp;
+        if( raison == NULL && fin_de_ligne( ligne ) )
+        {
+            continue;
+        }
+        if( raison == NULL && i == 0 && strncmp( ligne, "format", 6 ) == 0 )
+        {
+            if( !lire_champ_entier( &texte, &format ) || !fin_de_ligne( texte ) )
+            {
+                signaler_chargement( "Ligne %d de %s ignoree: format mal forme", numero, nom_fichier );
+                format = FORMAT_FICHIER_FORMATION;
+            }
+            continue;
+        }
+        if( raison == NULL )
+        {
+            raison = lire_ligne_formation( ligne, format, &f, nom );
+        }
+        if( raison == NULL && f.id > borne )
+        {
+            raison = "identifiant tres au-dela du nombre d'enregistrements";
+        }
+        if( raison != NULL )
+        {
+            signaler_chargement( "Ligne %d de %s ignoree: %s", numero, nom_fichier, raison );
+            continue;
+        }
+        tmp = creer_formation( nom, f.prix );
+        f.nom = tmp->nom;
+        *tmp = f;
+        if( ranger_db_formation( dbf, tmp ) == NULL )
+        {
+            signaler_chargement( "Ligne %d de %s ignoree: la formation %d a un identifiant invalide ou deja utilise",
+                                 numero, nom_fichier, f.id );
+            continue;
+        }
+        i += 1;
+    }
+    compter_visites( i );
+    arreter_compteur( &ch );
+    fclose( fdat_f );
+    return i;
+}
+
+/*
+ * Cette fonction sert a inscrire chaque personne chargee dans les formations de sa liste formations.
+ * Les personnes sont parcourues de la plus recente a la plus ancienne, comme l'ancien parcours de la liste.
+ * Une formation citee deux fois par la meme personne ne l'inscrit qu'une fois.
+ */
+void relier_db( db_formation *dbf, db_personne *dbp )
+{
+    curseur_personne c;
+    personne *tmpp;
+    chrono ch;
+    demarrer_compteur( &ch, CPT_LIAISON );
+    for( tmpp = debut_curseur_personne( &c, dbp, ORDRE_RECENT ); tmpp != NULL; tmpp = suivant_curseur_personne( &c ) )
+    {
+        int j, k;
+        compter_visites( 1 + tmpp->nb_formations );
+        for( j = 0; j < tmpp->nb_formations; j++ )
+        {
+            formation *tmpf = get_formation_par_id( dbf, tmpp->formations[j] );
+            for( k = 0; k < j && tmpp->formations[k] != tmpp->formations[j]; k++ )
+            {
+            }
+            if( tmpf != NULL && k == j )
+            {
+                inscrire_personne( tmpf, tmpp );
+            }
+        }
+    }
+    arreter_compteur( &ch );
+}
+
+/*
+ * Cette fonction sert a ecrire dans chemin le nom du fichier nom dans le dossier dossier.
+ */
+void chemin_fichier( char chemin[], const char *dossier, const char *nom )
+{
+    sprintf( chemin, "%.200s/%.50s", dossier, nom );
+}
+
+/*
+ * Cette fonction sert a charger les fichiers .dat, le fichier des identifiants et celui des salles du dossier
+ * dossier dans dbf et dbp, puis a relier les personnes a leurs formations et a charger les listes d'attente.
+ */
+void charger_db_dossier( db_formation *dbf, db_personne *dbp, const char *dossier )
+{
+    char chemin[ 256 ];
+    chemin_fichier( chemin, dossier, FICHIER_ID );
+    charger_ids( dbf, dbp, chemin );
+    chemin_fichier( chemin, dossier, FICHIER_PERSONNE );
+    charger_db_personne( dbp, chemin );
+    chemin_fichier( chemin, dossier, FICHIER_FORMATION );
+    charger_db_formation( dbf, chemin );
+    recalculer_ids_libres_personne( dbp );
+    recalculer_ids_libres_formation( dbf );
+    chemin_fichier( chemin, dossier, FICHIER_SALLES );
+    charger_salles( dbf, chemin );
+    relier_db( dbf, dbp );
+    chemin_fichier( chemin, dossier, FICHIER_ATTENTE );
+    charger_attente( dbf, dbp, chemin );
+}
+
+/*
+ * Cette fonction sert a charger les fichiers du dossier courant, voir charger_db_dossier.
+ */
+void charger_db( db_formation *dbf, db_personne *dbp )
+{
+    charger_db_dossier( dbf, dbp, "." );
+}
+
+/*
+ * Cette structure suit l'etat de la sauvegarde en arriere-plan.
+ * int pid : Le processus enfant qui ecrit la sauvegarde, 0 si aucune sauvegarde n'est en cours.
+ * int fd : Le tube par lequel l'enfant envoie sa progression, -1 si aucun.
+ * int automatique : 1 si la sauvegarde en cours est une sauvegarde automatique.
+ * char ligne[128] : Le debut d'un message de progression qui n'a pas encore ete recu en entier.
+ * int intervalle : Le nombre de minutes entre deux sauvegardes automatiques, 0 si desactivees.
+ * time_t derniere : Le moment de la derniere sauvegarde lancee.
+ */
+typedef struct sauvegarde
+{
+    int pid;
+    int fd;
+    int automatique;
+    char ligne[128];
+    int intervalle;
+    time_t derniere;
+} sauvegarde;
+
+/*
+ * Cette fonction sert a envoyer un message de progression au processus qui a lance la sauvegarde.
+ * Si la sauvegarde n'a pas lieu en arriere-plan (fd vaut -1), le message est affiche directement.
+ * Le message et sa fin de ligne sont ecrits ensemble, en reprenant apres une ecriture partielle ou interrompue.
+ * Si le tube ne peut plus etre ecrit (le parent a ete arrete), le message est ecrit sur la sortie d'erreur.
+ */
+void signaler_progression( int fd, const char *message )
+{
+#if defined(HAVE_FORK) && defined(HAVE_SYS_WAIT_H)
+    if( fd >= 0 )
+    {
+        char ligne[ 256 ];
+        size_t n = strlen( message ), envoye = 0;
+        ssize_t res;
+        n = n < sizeof( ligne ) - 1 ? n : sizeof( ligne ) - 1;
+        memcpy( ligne, message, n );
+        ligne[ n++ ] = '\n';
+        while( envoye < n )
+        {
+            res = write( fd, ligne + envoye, n - envoye );
+            if( res < 0 && errno == EINTR )
+            {
+                continue;
+            }
+            if( res <= 0 )
+            {
+                fprintf( stderr, "* Sauvegarde: %s\n", message );
+                return;
+            }
+            envoye += ( size_t ) res;
+        }
+        return;
+    }
+#endif
+    printf( "* Sauvegarde: %s\n", message );
+}
+
+/*
+ * Cette fonction sert a ecrire un fichier de facon atomique: on ecrit dans un fichier temporaire,
+ * puis on le renomme. Un fichier lu pendant l'ecriture est donc toujours complet.
+ * On renvoie 1 si reussite, 0 si pas.
+ */
+int ecrire_fichier_atomique( const char *nom, void ( *ecrire )( void *db, FILE *fichier ), void *db )
+{
+    char tmp[ 256 ];
+    FILE *fichier;
+    sprintf( tmp, "%.240s.tmp", nom );
+    fichier = fopen( tmp, "w" );
+    if( fichier == NULL )
+    {
+        return 0;
+    }
+    ecrire( db, fichier );
+    if( ferror( fichier ) | ( fclose( fichier ) != 0 ) )
+    {
+        remove( tmp );
+        return 0;
+    }
+    return rename( tmp, nom ) == 0;
+}
+
+/*
+ * Cette fonction sert a garder une copie du fichier .dat nom avant de le remplacer. La copie s'appelle comme nom,
+ * suivi de suffixe et du moment (CaculliTyranowskiPersonne_ORIGINAL_20261019-031500.dat), puis d'un numero si ce
+ * nom est deja pris: une copie existante n'est jamais ecrasee. Le nom de la copie est ecrit dans copie, de 256
+ * cases.
+ * On renvoie 1 si reussite, 0 si la copie n'a pas pu etre ecrite en entier.
+ */
+int garder_copie( const char *nom, const char *suffixe, char copie[] )
+{
+    char moment[ 32 ], tampon[ 4096 ];
+    time_t instant = time( NULL );
+    FILE *source, *destination = NULL;
+    size_t lus;
+    int n, res;
+    strftime( moment, sizeof( moment ), "%Y%m%d-%H%M%S", localtime( &instant ) );
+    for( n = 1; n < 100; n++ )
+    {
+        FILE *existe;
+        sprintf( copie, n == 1 ? "%.*s%.20s_%s.dat" : "%.*s%.20s_%s_%d.dat", ( int ) strlen( nom ) - 4, nom,
+                 suffixe, moment, n );
+        existe = fopen( copie, "r" );
+        if( existe == NULL )
+        {
+            break;
+        }
+        fclose( existe );
+    }
+    source = n < 100 ? fopen( nom, "rb" ) : NULL;
+    destination = source != NULL ? fopen( copie, "wb" ) : NULL;
+    if( destination == NULL )
+    {
+        if( source != NULL )
+        {
+            fclose( source );
+        }
+        return 0;
+    }
+    while( ( lus = fread( tampon, 1, sizeof( tampon ), source ) ) > 0 && fwrite( tampon, 1, lus, destination ) == lus )
+    {
+    }
+    res = !ferror( source ) && !ferror( destination );
+    fclose( source );
+    res = fclose( destination ) == 0 && res;
+    if( !res )
+    {
+        remove( copie );
+    }
+    return res;
+}
+
+void ecrire_db_personne_fichier( void *db, FILE *fichier )
+{
+    ecrire_db_personne( ( db_personne * ) db, fichier );
+}
+
+void ecrire_db_formation_fichier( void *db, FILE *fichier )
+{
+    ecrire_db_formation( ( db_formation * ) db, fichier );
+}
+
+void ecrire_planning_fichier( void *db, FILE *fichier )
+{
+    ecrire_planning_flux( ( db_formation * ) db, fichier );
+}
+
+/*
+ * Cette fonction sert a ecrire les deux fichiers .dat, puis le planning si avec_planning vaut 1.
+ * Chaque etape est signalee par signaler_progression.
+ * On renvoie 1 si reussite, 0 si pas.
+ */
+int ecrire_sauvegarde( db_formation *dbf, db_personne *dbp, int automatique, int fd )
+{
+    paire_db bases;
+    if( !ecrire_fichier_atomique( automatique ? FICHIER_PERSONNE_AUTO : FICHIER_PERSONNE,
+                                  ecrire_db_personne_fichier, dbp ) )
+    {
+        signaler_progression( fd, "ERREUR lors de l'ecriture des personnes" );
+        return 0;
+    }
+    signaler_progression( fd, "personnes ecrites" );
+    if( !ecrire_fichier_atomique( automatique ? FICHIER_FORMATION_AUTO : FICHIER_FORMATION,
+                                  ecrire_db_formation_fichier, dbf ) )
+    {
+        signaler_progression( fd, "ERREUR lors de l'ecriture des formations" );
+        return 0;
+    }
+    signaler_progression( fd, "formations ecrites" );
+    bases.dbf = dbf;
+    bases.dbp = dbp;
+    if( !ecrire_fichier_atomique( automatique ? FICHIER_ID_AUTO : FICHIER_ID, ecrire_ids, &bases ) )
+    {
+        signaler_progression( fd, "ERREUR lors de l'ecriture des identifiants" );
+        return 0;
+    }
+    if( !ecrire_fichier_atomique( automatique ? FICHIER_SALLES_AUTO : FICHIER_SALLES, ecrire_salles, dbf ) )
+    {
+        signaler_progression( fd, "ERREUR lors de l'ecriture des salles" );
+        return 0;
+    }
+    if( !ecrire_fichier_atomique( automatique ? FICHIER_ATTENTE_AUTO : FICHIER_ATTENTE, ecrire_attente, dbf ) )
+    {
+        signaler_progression( fd, "ERREUR lors de l'ecriture des listes d'attente" );
+        return 0;
+    }
+    if( !automatique )
+    {
+        if( !ecrire_fichier_atomique( "CaculliTyranowski.res", ecrire_planning_fichier, dbf ) )
+        {
+            signaler_progression( fd, "ERREUR lors de l'ecriture du planning" );
+            return 0;
+        }
+        signaler_progression( fd, "planning ecrit" );
+    }
+    return 1;
+}
+
+/*
+ * Cette fonction sert a faire une sauvegarde avec ecrire_sauvegarde en la mesurant par le compteur
+ * CPT_SAUVEGARDE. On renvoie 1 si reussite, 0 si pas.
+ */
+int sauvegarder_db( db_formation *dbf, db_personne *dbp, int automatique, int fd )
+{
+    chrono ch;
+    int res;
+    demarrer_compteur( &ch, CPT_SAUVEGARDE );
+    res = ecrire_sauvegarde( dbf, dbp, automatique, fd );
+    arreter_compteur( &ch );
+    return res;
+}
+
+/*
+ * Le fichier dans lequel les compteurs de l'instrumentation sont ecrits a la fin du programme.
+ */
+#define FICHIER_STATS "CaculliTyranowskiStats.json"
+
+/*
+ * Cette fonction sert a afficher les compteurs de l'instrumentation sous forme de tableau.
+ */
+void afficher_statistiques()
+{
+    int i;
+    printf( "********************************************************************************\n" );
+    printf( "* STATISTIQUES                                                                 *\n" );
+    printf( "********************************************************************************\n" );
+    if( !instrumentation )
+    {
+        printf( "* Instrumentation desactivee (CACULLITYRANOWSKI_STATS=0)                       *\n" );
+        return;
+    }
+    printf( "* %-32s %8s %10s %12s %10s *\n", "Compteur", "Appels", "Visites", "Octets", "Temps ms" );
+    printf( "* ---------------------------------------------------------------------------- *\n" );
+    for( i = 0; i < NB_COMPTEURS; i++ )
+    {
+        printf( "* %-32s %8lu %10lu %12lu %10.3f *\n", compteurs[i].nom, compteurs[i].appels,
+                compteurs[i].visites, compteurs[i].octets, compteurs[i].temps * 1e3 );
+    }
+    printf( "********************************************************************************\n" );
+}
+
+/*
+ * Cette fonction sert a ecrire les compteurs de l'instrumentation au format JSON dans le fichier fichier.
+ * Le parametre db n'est pas utilise, il permet de passer cette fonction a ecrire_fichier_atomique.
+ */
+void ecrire_statistiques_json( void *db, FILE *fichier )
+{
+    int i;
+    ( void ) db;
+    fprintf( fichier, "{\n  \"horodatage\": %ld,\n  \"compteurs\": {\n", ( long ) time( NULL ) );
+    for( i = 0; i < NB_COMPTEURS; i++ )
+    {
+        fprintf( fichier, "    \"%s\": { \"appels\": %lu, \"visites\": %lu, \"octets\": %lu, \"temps_s\": %.9f }%s\n",
+                 compteurs[i].nom, compteurs[i].appels, compteurs[i].visites, compteurs[i].octets,
+                 compteurs[i].temps, i + 1 < NB_COMPTEURS ? "," : "" );
+    }
+    fprintf( fichier, "  }\n}\n" );
+}
+
+/*
+ * Cette fonction est enregistree avec atexit quand l'instrumentation est active: elle ecrit les compteurs
+ * dans FICHIER_STATS a la fin du programme.
+ */
+void ecrire_statistiques_a_la_sortie()
+{
+    if( !ecrire_fichier_atomique( FICHIER_STATS, ecrire_statistiques_json, NULL ) )
+    {
+        fprintf( stderr, "Impossible d'ecrire %s\n", FICHIER_STATS );
+    }
+}
+
+/*
+ * Une sauvegarde en arriere-plan met a jour les compteurs de l'enfant, pas ceux du parent.
+ * L'enfant envoie donc ses compteurs non nuls par le tube de progression, une ligne par compteur
+ * commencant par "=stats", et le parent les ajoute aux siens a la reception (voir suivre_sauvegarde).
+ */
+void transmettre_compteurs( int fd )
+{
+    int i;
+    for( i = 0; i < NB_COMPTEURS && instrumentation; i++ )
+    {
+        if( compteurs[i].appels > 0 )
+        {
+            char ligne[ 128 ];
+            sprintf( ligne, "=stats %d %lu %lu %lu %.9f", i, compteurs[i].appels, compteurs[i].visites,
+                     compteurs[i].octets, compteurs[i].temps );
+            signaler_progression( fd, ligne );
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a ajouter aux compteurs ceux recus dans une ligne "=stats" de l'enfant.
+ * On renvoie 1 si la ligne etait une ligne de compteurs, 0 si pas.
+ */
+int recevoir_compteurs( const char *ligne )
+{
+    unsigned long appels, visites, octets;
+    double temps;
+    int i;
+    if( strncmp( ligne, "=stats ", 7 ) != 0 )
+    {
+        return 0;
+    }
+    if( sscanf( ligne + 7, "%d %lu %lu %lu %lf", &i, &appels, &visites, &octets, &temps ) == 5 &&
+        i >= 0 && i < NB_COMPTEURS )
+    {
+        compteurs[i].appels += appels;
+        compteurs[i].visites += visites;
+        compteurs[i].octets += octets;
+        compteurs[i].temps += temps;
+    }
+    return 1;
+}
+
+/*
+ * Cette fonction sert a afficher les messages de progression envoyes par la sauvegarde en arriere-plan et
+ * a detecter sa fin. Si bloquant vaut 1, on attend que la sauvegarde soit terminee.
+ */
+void suivre_sauvegarde( sauvegarde *sv, int bloquant )
+{
+#if defined(HAVE_FORK) && defined(HAVE_SYS_WAIT_H)
+    char lu[ 256 ];
+    ssize_t n;
+    int statut;
+    if( sv->pid == 0 )
+    {
+        return;
+    }
+    if( bloquant )
+    {
+        fcntl( sv->fd, F_SETFL, fcntl( sv->fd, F_GETFL ) & ~O_NONBLOCK );
+    }
+    while( ( n = read( sv->fd, lu, sizeof( lu ) ) ) > 0 )
+    {
+        ssize_t i;
+        for( i = 0; i < n; i++ )
+        {
+            size_t l = strlen( sv->ligne );
+            if( lu[i] == '\n' )
+            {
+                if( !recevoir_compteurs( sv->ligne ) )
+                {
+                    printf( "* Sauvegarde%s: %s\n", sv->automatique ? " automatique" : "", sv->ligne );
+                }
+                sv->ligne[0] = '\0';
+            }
+            else if( l < sizeof( sv->ligne ) - 1 )
+            {
+                sv->ligne[l] = lu[i];
+                sv->ligne[ l + 1 ] = '\0';
+            }
+        }
+    }
+    if( waitpid( sv->pid, &statut, bloquant ? 0 : WNOHANG ) == sv->pid )
+    {
+        if( WIFEXITED( statut ) && WEXITSTATUS( statut ) == 0 )
+        {
+            printf( "* Sauvegarde%s terminee avec succes *\n", sv->automatique ? " automatique" : "" );
+        }
+        else
+        {
+            printf( "* /!\\ La sauvegarde%s a echoue /!\\ *\n", sv->automatique ? " automatique" : "" );
+        }
+        close( sv->fd );
+        sv->fd = -1;
+        sv->pid = 0;
+        sv->ligne[0] = '\0';
+    }
+#else
+    ( void ) sv;
+    ( void ) bloquant;
+#endif
+}
+
+/*
+ * Cette fonction sert a lancer une sauvegarde de l'etat actuel des bases de donnees.
+ * Le processus est duplique avec fork: l'enfant recoit une copie figee des bases de donnees (les pages
+ * memoire ne sont copiees que si le parent les modifie), il ecrit les fichiers et envoie sa progression
+ * par un tube, pendant que le parent retourne immediatement au menu.
+ * Sans fork, la sauvegarde est faite directement.
+ * On renvoie 1 si la sauvegarde a ete lancee (ou faite), 0 si pas.
+ */
+int lancer_sauvegarde( sauvegarde *sv, db_formation *dbf, db_personne *dbp, int automatique )
+{
+#if defined(HAVE_FORK) && defined(HAVE_SYS_WAIT_H)
+    int tube[2];
+    pid_t pid;
+    if( sv->pid != 0 )
+    {
+        suivre_sauvegarde( sv, 1 );
+    }
+    sv->derniere = time( NULL );
+    fflush( stdout );
+    if( pipe( tube ) == 0 )
+    {
+        pid = fork();
+        if( pid == 0 )
+        {
+            int res;
+            close( tube[0] );
+            signal( SIGPIPE, SIG_IGN );
+            reinitialiser_compteurs();
+            res = sauvegarder_db( dbf, dbp, automatique, tube[1] );
+            transmettre_compteurs( tube[1] );
+            _exit( res ? 0 : 1 );
+        }
+        close( tube[1] );
+        if( pid > 0 )
+        {
+            fcntl( tube[0], F_SETFL, fcntl( tube[0], F_GETFL ) | O_NONBLOCK );
+            sv->pid = ( int ) pid;
+            sv->fd = tube[0];
+            sv->automatique = automatique;
+            sv->ligne[0] = '\0';
+            return 1;
+        }
+        close( tube[0] );
+    }
+#endif
+    sv->derniere = time( NULL );
+    return sauvegarder_db( dbf, dbp, automatique, -1 );
+}
+
+/*
+ * Cette fonction sert a lancer une sauvegarde automatique si elles sont activees, que l'intervalle choisi
+ * est ecoule et qu'aucune sauvegarde n'est deja en cours.
+ */
+void verifier_sauvegarde_automatique( sauvegarde *sv, db_formation *dbf, db_personne *dbp )
+{
+    if( sv->intervalle <= 0 || sv->pid != 0 )
+    {
+        return;
+    }
+    if( difftime( time( NULL ), sv->derniere ) >= sv->intervalle * 60.0 )
+    {
+        lancer_sauvegarde( sv, dbf, dbp, 1 );
+    }
+}
+
+/*
+ * Cette fonction sert a attendre que l'utilisateur tape son choix dans le menu principal, quand l'entree est un
+ * terminal. L'attente est faite avec select: une sauvegarde automatique est lancee des que son intervalle est
+ * ecoule, meme si l'utilisateur ne fait rien, et la progression d'une sauvegarde en cours est suivie chaque
+ * seconde. L'invite est reaffichee apres les messages de fin d'une sauvegarde.
+ * L'entree est alors lue sans tampon (voir menu), afin que select voie tout ce qui n'a pas encore ete lu. Sans
+ * select ou avec une entree redirigee, on revient tout de suite et la sauvegarde automatique n'est verifiee
+ * qu'apres chaque action du menu.
+ */
+void attendre_choix( sauvegarde *sv, db_formation *dbf, db_personne *dbp )
+{
+#if defined(HAVE_SYS_SELECT_H) && defined(HAVE_UNISTD_H)
+    if( !isatty( STDIN_FILENO ) )
+    {
+        return;
+    }
+    for( ;; )
+    {
+        fd_set lecture;
+        struct timeval delai, *attente = NULL;
+        time_t derniere = sv->derniere;
+        int pid = sv->pid, n;
+        if( sv->pid != 0 )
+        {
+            delai.tv_sec = 1;
+            attente = &delai;
+        }
+        else if( sv->intervalle > 0 )
+        {
+            double reste = sv->intervalle * 60.0 - difftime( time( NULL ), sv->derniere );
+            delai.tv_sec = reste > 0 ? ( long ) reste + 1 : 0;
+            attente = &delai;
+        }
+        if( attente != NULL )
+        {
+            delai.tv_usec = 0;
+        }
+        FD_ZERO( &lecture );
+        FD_SET( STDIN_FILENO, &lecture );
+        fflush( stdout );
+        n = select( STDIN_FILENO + 1, &lecture, NULL, NULL, attente );
+        if( n > 0 || ( n < 0 && errno != EINTR ) )
+        {
+            return;
+        }
+        suivre_sauvegarde( sv, 0 );
+        verifier_sauvegarde_automatique( sv, dbf, dbp );
+        if( sv->pid == 0 && ( pid != 0 || sv->derniere != derniere ) )
+        {
+            printf( "* Que voudriez-vous faire ? " );
+        }
+    }
+#else
+    ( void ) sv;
+    ( void ) dbf;
+    ( void ) dbp;
+#endif
+}
+
+/*
+ * Menu permettant de choisir l'intervalle des sauvegardes automatiques.
+ */
+void menu_sauvegarde_automatique( sauvegarde *sv )
+{
+    int intervalle;
+    printf( "* Sauvegarde automatique actuelle: " );
+    if( sv->intervalle > 0 )
+    {
+        printf( "toutes les %d minutes\n", sv->intervalle );
+    }
+    else
+    {
+        printf( "desactivee\n" );
+    }
+    printf( "* Toutes les combien de minutes sauvegarder automatiquement ? (0 pour desactiver) " );
+    while( scanf( "%d", &intervalle ) != 1 || intervalle < 0 )
+    {
+        getchar();
+        printf( "* Option INVALIDE: Min 0\n" );
+        printf( "* Toutes les combien de minutes sauvegarder automatiquement ? (0 pour desactiver) " );
+    }
+    getchar();
+    sv->intervalle = intervalle;
+    sv->derniere = time( NULL );
+    system( clear );
+    if( intervalle > 0 )
+    {
+        printf( "* Sauvegarde automatique dans %s et %s toutes les %d minutes *\n",
+                FICHIER_PERSONNE_AUTO, FICHIER_FORMATION_AUTO, intervalle );
+    }
+    else
+    {
+        printf( "* Sauvegarde automatique desactivee *\n" );
+    }
+}
+
+/*
+ * Menu permettant a l'utilisateur d'interagir avec le programme
+ */
+int menu( db_formation *f, db_personne *p )
+{
+    int choix, nb;
+    sauvegarde sv;
+    memset( &sv, 0, sizeof( sv ) );
+    sv.fd = -1;
+    sv.derniere = time( NULL );
+#if defined(HAVE_SYS_SELECT_H) && defined(HAVE_UNISTD_H)
+    if( isatty( STDIN_FILENO ) )
+    {
+        setvbuf( stdin, NULL, _IONBF, 0 );
+    }
+#endif
+    activer_historique();
+    do
+    {
+        suivre_sauvegarde( &sv, 0 );
+        commencer_etape();
+        printf( "********************************************************************************\n" );
+        printf( "* MENU PRINCIPALE                                                              *\n" );
+        printf( "********************************************************************************\n" );
+        db_formation *tmpdbf = f;
+        db_personne *tmpdbp = p;
+        printf( "* 1: Afficher la liste des etudiants/formateurs ou la liste des formations     *\n" );
+        printf( "* 2: Ajouter une nouvelle personne ou formation a la base de donnees           *\n" );
+        printf( "* 3: Attribuer une personne a une formation                                    *\n" );
+        printf( "* 4: Supprimer une formation, une personne ou une personne d'une formation     *\n" );
+        printf( "* 5: Sauvegarder les changements en arriere-plan                               *\n" );
+        printf( "* 6: Configurer la sauvegarde automatique                                      *\n" );
+        printf( "* 7: Afficher les statistiques d'instrumentation                               *\n" );
+        printf( "* 8: Annuler la derniere modification                                          *\n" );
+        printf( "* 9: Retablir la derniere modification annulee                                 *\n" );
+        printf( "* 0: Quitter le programme                                                      *\n" );
+        printf( "********************************************************************************\n" );
+        printf( "* Que voudriez-vous faire ? " );
+        attendre_choix( &sv, tmpdbf, tmpdbp );
+        scanf( "%d", &choix );
+        getchar();
+        switch ( choix )
+        {
+            case 1:
+                system( clear );
+                menu_affichage( tmpdbf, tmpdbp );
+                break;
+            case 2:
+                system( clear );
+                menu_creer( tmpdbf, tmpdbp );
+                break;
+            case 3:
+                system( clear );
+                menu_ajouter_formation( tmpdbf, tmpdbp );
+                break;
+            case 4:
+                system( clear );
+                menu_supprimer( tmpdbf, tmpdbp );
+                break;
+            case 5:
+                system( clear );
+                if( lancer_sauvegarde( &sv, tmpdbf, tmpdbp, 0 ) )
+                {
+                    printf( "* Sauvegarde lancee *\n" );
+                }
+                break;
+            case 6:
+                system( clear );
+                menu_sauvegarde_automatique( &sv );
+                break;
+            case 7:
+                system( clear );
+                suivre_sauvegarde( &sv, 0 );
+                afficher_statistiques();
+                break;
+            case 8:
+                system( clear );
+                nb = annuler_etape( tmpdbf, tmpdbp );
+                printf( nb > 0 ? "* Modification annulee (%d changement(s)) *\n" : "* Rien a annuler *\n", nb );
+                break;
+            case 9:
+                system( clear );
+                nb = retablir_etape( tmpdbf, tmpdbp );
+                printf( nb > 0 ? "* Modification retablie (%d changement(s)) *\n" : "* Rien a retablir *\n", nb );
+                break;
+            case 0:
+                printf( "Voulez vous sauvegarder les changements ? (o/n) " );
+                char choix_sauvegarde[4];
+                scanf( "%s", choix_sauvegarde );
+                if( strcmp( choix_sauvegarde, "o" ) == 0 || strcmp( choix_sauvegarde, "oui" ) == 0 )
+                {
+                    if( lancer_sauvegarde( &sv, tmpdbf, tmpdbp, 0 ) )
+                    {
+                        /*
+                         * Sans utilisateur devant le terminal (entree redirigee), on attend la fin de la
+                         * sauvegarde pour que les fichiers soient complets lorsque le programme se termine.
+                         */
+#ifdef HAVE_UNISTD_H
+                        if( sv.pid != 0 && !isatty( STDIN_FILENO ) )
+                        {
+                            suivre_sauvegarde( &sv, 1 );
+                        }
+#endif
+                        if( sv.pid != 0 )
+                        {
+                            printf( "La sauvegarde se termine en arriere-plan (processus %d)\n", sv.pid );
+                        }
+                        else
+                        {
+                            printf( "Changements sauvegardes!\n" );
+                        }
+                    }
+                }
+                else
+                {
+                    suivre_sauvegarde( &sv, 0 );
+                }
+                printf( "Fermeture du programme...\n" );
+                printf( "Au revoir!\n" );
+                break;
+            default:
+                system( clear );
+                printf( "/!\\ Option %d - INVALIDE /!\\\n", choix );
+                break;
+        }
+        if( choix != 0 )
+        {
+            verifier_sauvegarde_automatique( &sv, tmpdbf, tmpdbp );
+        }
+    } while ( choix != 0 );
+    desactiver_historique();
+    return 0;
+}
+
+/*****************************************************************************/
+/*                                EXPORTATION                                */
+
+/*
+ * Les formats d'exportation.
+ * EXPORT_CSV : Une ligne d'entete puis une ligne par enregistrement, champs separes par des virgules (RFC 4180).
+ * EXPORT_JSONL : Un objet JSON par ligne (JSON Lines).
+ */
+#define EXPORT_CSV 0
+#define EXPORT_JSONL 1
+
+/*
+ * Cette structure sert a ecrire des enregistrements un par un, sans jamais les garder en memoire.
+ * FILE *sortie : Le flux dans lequel on ecrit.
+ * int format : EXPORT_CSV ou EXPORT_JSONL.
+ * int premier : 1 si aucun champ n'a encore ete ecrit sur la ligne en cours.
+ * unsigned long nb_lignes : Le nombre d'enregistrements ecrits.
+ * const char *annee, *campus : Si annee n'est pas NULL, chaque enregistrement commence par les colonnes annee et
+ * campus de sa partition (voir PARTITIONS).
+ */
+typedef struct exporteur
+{
+    FILE *sortie;
+    int format;
+    int premier;
+    unsigned long nb_lignes;
+    const char *annee;
+    const char *campus;
+} exporteur;
+
+/*
+ * Cette fonction sert a ecrire le texte texte entre guillemets, en doublant les guillemets en CSV ou en
+ * echappant les guillemets, les barres obliques inverses et les caracteres de controle en JSON.
+ * En CSV, le texte n'est entoure de guillemets que s'il contient une virgule, un guillemet, un retour a la ligne
+ * ou une espace au debut ou a la fin.
+ */
+void exporter_texte( exporteur *ex, const char *texte )
+{
+    const char *c;
+    if( ex->format == EXPORT_CSV )
+    {
+        size_t n = strlen( texte );
+        if( strpbrk( texte, ",\"\r\n" ) == NULL && ( n == 0 || ( texte[0] != ' ' && texte[ n - 1 ] != ' ' ) ) )
+        {
+            fputs( texte, ex->sortie );
+            return;
+        }
+        putc( '"', ex->sortie );
+        for( c = texte; *c; c++ )
+        {
+            if( *c == '"' )
+            {
+                putc( '"', ex->sortie );
+            }
+            putc( *c, ex->sortie );
+        }
+        putc( '"', ex->sortie );
+        return;
+    }
+    putc( '"', ex->sortie );
+    for( c = texte; *c; c++ )
+    {
+        if( *c == '"' || *c == '\\' )
+        {
+            putc( '\\', ex->sortie );
+            putc( *c, ex->sortie );
+        }
+        else if( ( unsigned char ) *c < 0x20 )
+        {
+            fprintf( ex->sortie, "\\u%04x", ( unsigned char ) *c );
+        }
+        else
+        {
+            putc( *c, ex->sortie );
+        }
+    }
+    putc( '"', ex->sortie );
+}
+
+/*
+ * Cette fonction sert a ecrire la ligne d'entete du CSV, les noms des nb colonnes. Rien n'est ecrit en JSON Lines.
+ */
+void exporter_entete( exporteur *ex, const char *colonnes[], int nb )
+{
+    int i;
+    if( ex->format != EXPORT_CSV )
+    {
+        return;
+    }
+    if( ex->annee != NULL )
+    {
+        fputs( "annee,campus,", ex->sortie );
+    }
+    for( i = 0; i < nb; i++ )
+    {
+        fprintf( ex->sortie, "%s%s", i > 0 ? "," : "", colonnes[i] );
+    }
+    putc( '\n', ex->sortie );
+}
+
+void exporter_champ_texte( exporteur *ex, const char *nom, const char *valeur );
+
+/*
+ * Ces fonctions servent a commencer et a terminer l'enregistrement en cours.
+ */
+void exporter_debut( exporteur *ex )
+{
+    ex->premier = 1;
+    if( ex->format == EXPORT_JSONL )
+    {
+        putc( '{', ex->sortie );
+    }
+    if( ex->annee != NULL )
+    {
+        exporter_champ_texte( ex, "annee", ex->annee );
+        exporter_champ_texte( ex, "campus", ex->campus );
+    }
+}
+
+void exporter_fin( exporteur *ex )
+{
+    if( ex->format == EXPORT_JSONL )
+    {
+        putc( '}', ex->sortie );
+    }
+    putc( '\n', ex->sortie );
+    ex->nb_lignes += 1;
+}
+
+/*
+ * Cette fonction sert a ecrire le separateur avant un champ et, en JSON, son nom.
+ */
+void exporter_nom( exporteur *ex, const char *nom )
+{
+    if( !ex->premier )
+    {
+        putc( ',', ex->sortie );
+    }
+    ex->premier = 0;
+    if( ex->format == EXPORT_JSONL )
+    {
+        fprintf( ex->sortie, "\"%s\":", nom );
+    }
+}
+
+/*
+ * Ces fonctions servent a ecrire un champ de l'enregistrement en cours: un entier, un horaire (en minutes) ou un
+ * prix (en centimes) avec deux decimales, un booleen, un texte ou une liste d'entiers ou d'horaires (separes par
+ * des points-virgules en CSV).
+ */
+void exporter_entier( exporteur *ex, const char *nom, int valeur )
+{
+    exporter_nom( ex, nom );
+    fprintf( ex->sortie, "%d", valeur );
+}
+
+void exporter_horaire( exporteur *ex, const char *nom, int minutes )
+{
+    exporter_nom( ex, nom );
+    fprintf( ex->sortie, FORMAT_HORAIRE, HORAIRE( minutes ) );
+}
+
+void exporter_prix( exporteur *ex, const char *nom, int centimes )
+{
+    exporter_nom( ex, nom );
+    fprintf( ex->sortie, FORMAT_PRIX, PRIX( centimes ) );
+}
+
+void exporter_booleen( exporteur *ex, const char *nom, int valeur )
+{
+    exporter_nom( ex, nom );
+    if( ex->format == EXPORT_JSONL )
+    {
+        fputs( valeur ? "true" : "false", ex->sortie );
+    }
+    else
+    {
+        putc( valeur ? '1' : '0', ex->sortie );
+    }
+}
+
+void exporter_champ_texte( exporteur *ex, const char *nom, const char *valeur )
+{
+    exporter_nom( ex, nom );
+    exporter_texte( ex, valeur );
+}
+
+void exporter_liste( exporteur *ex, const char *nom, const int valeurs[], int nb )
+{
+    int i;
+    exporter_nom( ex, nom );
+    if( ex->format == EXPORT_JSONL )
+    {
+        putc( '[', ex->sortie );
+    }
+    for( i = 0; i < nb; i++ )
+    {
+        if( i > 0 )
+        {
+            putc( ex->format == EXPORT_JSONL ? ',' : ';', ex->sortie );
+        }
+        fprintf( ex->sortie, "%d", valeurs[i] );
+    }
+    if( ex->format == EXPORT_JSONL )
+    {
+        putc( ']', ex->sortie );
+    }
+}
+
+void exporter_liste_horaires( exporteur *ex, const char *nom, const int minutes[], int nb )
+{
+    int i;
+    exporter_nom( ex, nom );
+    if( ex->format == EXPORT_JSONL )
+    {
+        putc( '[', ex->sortie );
+    }
+    for( i = 0; i < nb; i++ )
+    {
+        if( i > 0 )
+        {
+            putc( ex->format == EXPORT_JSONL ? ',' : ';', ex->sortie );
+        }
+        fprintf( ex->sortie, FORMAT_HORAIRE, HORAIRE( minutes[i] ) );
+    }
+    if( ex->format == EXPORT_JSONL )
+    {
+        putc( ']', ex->sortie );
+    }
+}
+
+/*
+ * Les colonnes des personnes, des formations et des inscriptions exportees.
+ */
+const char *colonnes_personnes[] = { "id", "nom", "prenom", "formateur", "reduction", "jours_indisponibles" };
+const char *colonnes_formations[] =
+{
+    "id", "nom", "prix", "prerequis", "jours", "heures", "durees", "participants"
+};
+const char *colonnes_inscriptions[] = { "formation_id", "personne_id", "formateur" };
+
+/*
+ * Ces fonctions servent a exporter une personne, une formation ou une inscription (la personne *p dans la
+ * formation *f), avec les colonnes ci-dessus.
+ */
+void exporter_personne( exporteur *ex, personne *p )
+{
+    exporter_debut( ex );
+    exporter_entier( ex, "id", p->id );
+    exporter_champ_texte( ex, "nom", p->nom );
+    exporter_champ_texte( ex, "prenom", p->prenom );
+    exporter_booleen( ex, "formateur", p->formateur );
+    exporter_entier( ex, "reduction", p->formateur == 0 && p->reduction ? p->val_reduction : 0 );
+    exporter_liste( ex, "jours_indisponibles", p->jours_indisponible, p->formateur ? p->nb_jours_indisponible : 0 );
+    exporter_fin( ex );
+}
+
+void exporter_formation( exporteur *ex, formation *f )
+{
+    exporter_debut( ex );
+    exporter_entier( ex, "id", f->id );
+    exporter_champ_texte( ex, "nom", f->nom );
+    exporter_prix( ex, "prix", f->prix );
+    exporter_liste( ex, "prerequis", f->prerequis, f->nb_prerequis );
+    exporter_liste( ex, "jours", f->jours, f->nb_jours );
+    exporter_liste_horaires( ex, "heures", f->heures, f->nb_jours );
+    exporter_liste_horaires( ex, "durees", f->durees, f->nb_jours );
+    exporter_entier( ex, "participants", f->nb_inscrits - f->nb_desinscrits );
+    exporter_fin( ex );
+}
+
+void exporter_inscription( exporteur *ex, formation *f, personne *p )
+{
+    exporter_debut( ex );
+    exporter_entier( ex, "formation_id", f->id );
+    exporter_entier( ex, "personne_id", p->id );
+    exporter_booleen( ex, "formateur", p->formateur );
+    exporter_fin( ex );
+}
+
+/*
+ * Cette fonction sert a exporter toutes les personnes de dbp, dans leur ordre d'ajout.
+ */
+void exporter_personnes( exporteur *ex, db_personne *dbp )
+{
+    curseur_personne c;
+    personne *tmpp;
+    exporter_entete( ex, colonnes_personnes, 6 );
+    for( tmpp = debut_curseur_personne( &c, dbp, ORDRE_INSERTION ); tmpp != NULL;
+         tmpp = suivant_curseur_personne( &c ) )
+    {
+        exporter_personne( ex, tmpp );
+    }
+}
+
+/*
+ * Cette fonction sert a exporter toutes les formations de dbf, dans leur ordre d'ajout.
+ */
+void exporter_formations( exporteur *ex, db_formation *dbf )
+{
+    curseur_formation c;
+    formation *tmpf;
+    exporter_entete( ex, colonnes_formations, 8 );
+    for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_INSERTION ); tmpf != NULL;
+         tmpf = suivant_curseur_formation( &c ) )
+    {
+        exporter_formation( ex, tmpf );
+    }
+}
+
+/*
+ * Cette fonction sert a exporter les inscriptions: une ligne par participant de chaque formation, les
+ * formations dans leur ordre d'ajout et les participants dans leur ordre d'inscription.
+ */
+void exporter_inscriptions( exporteur *ex, db_formation *dbf )
+{
+    curseur_formation c;
+    formation *tmpf;
+    int i;
+    exporter_entete( ex, colonnes_inscriptions, 3 );
+    for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_INSERTION ); tmpf != NULL;
+         tmpf = suivant_curseur_formation( &c ) )
+    {
+        for( i = 0; i < tmpf->nb_inscrits; i++ )
+        {
+            if( tmpf->inscrits[i] == NULL )
+            {
+                continue;
+            }
+            exporter_inscription( ex, tmpf, tmpf->inscrits[i] );
+        }
+    }
+}
+
+/*
+ * Les colonnes du planning exporte, une ligne par seance.
+ */
+const char *colonnes_planning[] = { "jour", "nom_jour", "debut", "fin", "formation_id", "formation" };
+
+/*
+ * Cette fonction sert a exporter la seance du creneau j de la formation *f, le jour jour.
+ */
+void exporter_seance( exporteur *ex, int jour, formation *f, int j )
+{
+    char nom_jour[7][9] = { "Lundi", "Mardi", "Mercredi", "Jeudi", "Vendredi", "Samedi", "Dimanche" };
+    exporter_debut( ex );
+    exporter_entier( ex, "jour", jour );
+    exporter_champ_texte( ex, "nom_jour", nom_jour[ jour - 1 ] );
+    exporter_horaire( ex, "debut", f->heures[j] );
+    exporter_horaire( ex, "fin", f->heures[j] + f->durees[j] );
+    exporter_entier( ex, "formation_id", f->id );
+    exporter_champ_texte( ex, "formation", f->nom );
+    exporter_fin( ex );
+}
+
+/*
+ * Cette fonction sert a exporter le planning de la semaine: une ligne par seance, jour par jour, dans l'ordre de
+ * CaculliTyranowski.res. Chaque jour parcourt les formations une fois, rien n'est copie.
+ */
+void exporter_planning( exporteur *ex, db_formation *dbf )
+{
+    curseur_formation c;
+    formation *tmpf;
+    int i, j;
+    exporter_entete( ex, colonnes_planning, 6 );
+    for( i = 1; i <= 7; i++ )
+    {
+        for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_RECENT ); tmpf != NULL;
+             tmpf = suivant_curseur_formation( &c ) )
+        {
+            for( j = 0; j < tmpf->nb_jours; j++ )
+            {
+                if( tmpf->jours[j] != i )
+                {
+                    continue;
+                }
+                exporter_seance( ex, i, tmpf, j );
+            }
+        }
+    }
+}
+
+/*
+ * Cette structure decrit une exportation a faire, pour ecrire_export_fichier.
+ * const char *quoi : "personnes", "formations", "inscriptions" ou "planning".
+ */
+typedef struct demande_export
+{
+    paire_db bases;
+    const char *quoi;
+    int format;
+    unsigned long nb_lignes;
+} demande_export;
+
+/*
+ * Cette fonction sert a faire l'exportation decrite par db dans le fichier fichier, elle peut etre passee a
+ * ecrire_fichier_atomique.
+ */
+void ecrire_export_fichier( void *db, FILE *fichier )
+{
+    demande_export *d = ( demande_export * ) db;
+    exporteur ex;
+    ex.sortie = fichier;
+    ex.format = d->format;
+    ex.premier = 1;
+    ex.nb_lignes = 0;
+    ex.annee = NULL;
+    if( strcmp( d->quoi, "personnes" ) == 0 )
+    {
+        exporter_personnes( &ex, d->bases.dbp );
+    }
+    else if( strcmp( d->quoi, "formations" ) == 0 )
+    {
+        exporter_formations( &ex, d->bases.dbf );
+    }
+    else if( strcmp( d->quoi, "inscriptions" ) == 0 )
+    {
+        exporter_inscriptions( &ex, d->bases.dbf );
+    }
+    else
+    {
+        exporter_planning( &ex, d->bases.dbf );
+    }
+    d->nb_lignes = ex.nb_lignes;
+}
+
+/*
+ * Commande exporter: charge les fichiers .dat du dossier courant et exporte les personnes, les formations,
+ * les inscriptions ou le planning en CSV ou en JSON Lines, sur la sortie standard ou dans un fichier.
+ * Les enregistrements sont ecrits au fur et a mesure du parcours, la memoire utilisee ne depend pas de leur
+ * nombre.
+ */
+int commande_exporter( int argc, char *argv[] )
+{
+    demande_export d;
+    const char *fichier = NULL;
+    int i, res = 1;
+    d.format = EXPORT_CSV;
+    d.quoi = argc > 0 ? argv[0] : "";
+    for( i = 1; i + 1 < argc && argv[i][0] == '-'; i += 2 )
+    {
+        if( strcmp( argv[i], "-f" ) == 0 && strcmp( argv[ i + 1 ], "csv" ) == 0 )
+        {
+            d.format = EXPORT_CSV;
+        }
+        else if( strcmp( argv[i], "-f" ) == 0 && strcmp( argv[ i + 1 ], "jsonl" ) == 0 )
+        {
+            d.format = EXPORT_JSONL;
+        }
+        else if( strcmp( argv[i], "-o" ) == 0 )
+        {
+            fichier = argv[ i + 1 ];
+        }
+        else
+        {
+            break;
+        }
+    }
+    if( i != argc || ( strcmp( d.quoi, "personnes" ) != 0 && strcmp( d.quoi, "formations" ) != 0 &&
+                       strcmp( d.quoi, "inscriptions" ) != 0 && strcmp( d.quoi, "planning" ) != 0 ) )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski exporter personnes|formations|inscriptions|planning "
+                         "[-f csv|jsonl] [-o fichier]\n" );
+        return 1;
+    }
+    d.bases.dbp = creer_db_personne();
+    d.bases.dbf = creer_db_formation();
+    charger_db( d.bases.dbf, d.bases.dbp );
+    if( fichier != NULL )
+    {
+        res = ecrire_fichier_atomique( fichier, ecrire_export_fichier, &d );
+        if( res )
+        {
+            fprintf( stderr, "%lu lignes exportees dans %s\n", d.nb_lignes, fichier );
+        }
+        else
+        {
+            fprintf( stderr, "Impossible d'ecrire %s\n", fichier );
+        }
+    }
+    else
+    {
+        ecrire_export_fichier( &d, stdout );
+        res = fflush( stdout ) == 0;
+    }
+    liberer_db_personne( d.bases.dbp );
+    liberer_db_formation( d.bases.dbf );
+    return res ? 0 : 1;
+}
+
+/*
+ * Cette fonction renvoie le jour (1 a 7) ecrit en chiffre ou en toutes lettres dans texte, 0 s'il est invalide.
+ */
+int lire_jour( const char *texte )
+{
+    const char *jours[] = { "lundi", "mardi", "mercredi", "jeudi", "vendredi", "samedi", "dimanche" };
+    int i, j;
+    for( i = 0; i < 7; i++ )
+    {
+        for( j = 0; texte[j] != '\0' && tolower( ( unsigned char ) texte[j] ) == jours[i][j]; j++ )
+        {
+        }
+        if( texte[j] == '\0' && jours[i][j] == '\0' )
+        {
+            return i + 1;
+        }
+    }
+    return texte[0] >= '1' && texte[0] <= '7' && texte[1] == '\0' ? texte[0] - '0' : 0;
+}
+
+/*
+ * Commande seances: charge les fichiers .dat du dossier courant et ecrit, avec les colonnes du planning, les
+ * seances d'un jour (toute la journee ou entre deux heures) ou celles qui ont lieu en ce moment, triees par heure.
+ * Les seances sont lues dans l'index des seances par jour et par heure.
+ */
+int commande_seances( int argc, char *argv[] )
+{
+    db_formation *dbf;
+    db_personne *dbp;
+    exporteur ex;
+    seance *seances;
+    int debut = 0, fin = 24 * 60, jour = 0, i = 1, nb, res;
+    ex.format = EXPORT_CSV;
+    if( argc > 0 && strcmp( argv[0], "maintenant" ) == 0 )
+    {
+        instant_present( &jour, &debut );
+        fin = debut;
+    }
+    else if( argc > 0 )
+    {
+        jour = lire_jour( argv[0] );
+        if( argc > 2 && argv[1][0] != '-' )
+        {
+            if( !lire_horaire( argv[1], &debut ) || !lire_horaire( argv[2], &fin ) )
+            {
+                jour = 0;
+            }
+            i = 3;
+        }
+    }
+    if( i + 1 < argc && strcmp( argv[i], "-f" ) == 0 && strcmp( argv[ i + 1 ], "jsonl" ) == 0 )
+    {
+        ex.format = EXPORT_JSONL;
+        i += 2;
+    }
+    else if( i + 1 < argc && strcmp( argv[i], "-f" ) == 0 && strcmp( argv[ i + 1 ], "csv" ) == 0 )
+    {
+        i += 2;
+    }
+    if( jour == 0 || i < argc )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski seances lundi..dimanche|1..7 [debut fin] | maintenant "
+                         "[-f csv|jsonl]\n" );
+        return 1;
+    }
+    dbp = creer_db_personne();
+    dbf = creer_db_formation();
+    charger_db( dbf, dbp );
+    ex.sortie = stdout;
+    ex.premier = 1;
+    ex.nb_lignes = 0;
+    ex.annee = NULL;
+    nb = chercher_seances( dbf, jour, debut, fin, &seances );
+    exporter_entete( &ex, colonnes_planning, 6 );
+    for( i = 0; i < nb; i++ )
+    {
+        exporter_seance( &ex, jour, get_formation_par_id( dbf, seances[i].formation ), seances[i].creneau );
+    }
+    LIBERER( seances );
+    res = fflush( stdout ) == 0;
+    liberer_db_personne( dbp );
+    liberer_db_formation( dbf );
+    return res ? 0 : 1;
+}
+
+/*                              FIN EXPORTATION                              */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                IMPORTATION                                */
+
+/*
+ * Un enregistrement lu par l'importation: ses champs sous forme de texte, avec leur nom.
+ * Les listes (prerequis, jours, ...) sont stockees separees par des points-virgules, quel que soit le format lu.
+ * Un champ de plus de TAILLE_CHAMP_IMPORT - 1 octets fait rejeter sa ligne.
+ */
+#define MAX_CHAMPS_IMPORT 16
+#define TAILLE_CHAMP_IMPORT 256
+
+typedef struct enregistrement_import
+{
+    int nb;
+    char noms[ MAX_CHAMPS_IMPORT ][ 32 ];
+    char valeurs[ MAX_CHAMPS_IMPORT ][ TAILLE_CHAMP_IMPORT ];
+} enregistrement_import;
+
+/*
+ * Cette structure sert a lire un fichier d'importation enregistrement par enregistrement.
+ * FILE *entree : Le fichier lu.
+ * int format : EXPORT_CSV ou EXPORT_JSONL.
+ * char ligne[4096] : La ligne en cours, une ligne plus longue est rejetee.
+ * unsigned long numero : Le numero de la ligne en cours dans le fichier.
+ * enregistrement_import entete : Les noms des colonnes, lus sur la premiere ligne d'un CSV.
+ * const char *erreur : La raison pour laquelle la derniere ligne lue est rejetee.
+ */
+typedef struct lecteur_import
+{
+    FILE *entree;
+    int format;
+    char ligne[ 4096 ];
+    unsigned long numero;
+    enregistrement_import entete;
+    const char *erreur;
+} lecteur_import;
+
+/*
+ * Cette fonction sert a ajouter l'octet o a la fin du champ v de taille octets, dont *n sont deja utilises.
+ * On renvoie 1 si reussite, 0 si le champ est plein.
+ */
+int ajouter_octet_champ( char v[], int *n, int taille, char o )
+{
+    if( *n >= taille - 1 )
+    {
+        return 0;
+    }
+    v[ ( *n )++ ] = o;
+    return 1;
+}
+
+/*
+ * Cette fonction sert a decouper une ligne CSV en champs (RFC 4180, sans retour a la ligne dans un champ).
+ * On renvoie 1 si reussite, 0 si la ligne est mal formee, -1 si un champ est trop long.
+ */
+int decouper_csv( const char *ligne, enregistrement_import *e )
+{
+    const char *c = ligne;
+    e->nb = 0;
+    while( 1 )
+    {
+        char *v;
+        int n = 0;
+        if( e->nb == MAX_CHAMPS_IMPORT )
+        {
+            return 0;
+        }
+        v = e->valeurs[ e->nb ];
+        if( *c == '"' )
+        {
+            c++;
+            while( *c != '\0' && !( *c == '"' && c[1] != '"' ) )
+            {
+                if( *c == '"' )
+                {
+                    c++;
+                }
+                if( !ajouter_octet_champ( v, &n, TAILLE_CHAMP_IMPORT, *c ) )
+                {
+                    return -1;
+                }
+                c++;
+            }
+            if( *c != '"' )
+            {
+                return 0;
+            }
+            c++;
+        }
+        else
+        {
+            while( *c != '\0' && *c != ',' && *c != '\r' && *c != '\n' )
+            {
+                if( !ajouter_octet_champ( v, &n, TAILLE_CHAMP_IMPORT, *c ) )
+                {
+                    return -1;
+                }
+                c++;
+            }
+        }
+        v[n] = '\0';
+        e->nb += 1;
+        if( *c != ',' )
+        {
+            return *c == '\0' || *c == '\r' || *c == '\n';
+        }
+        c++;
+    }
+}
+
+/*
+ * Cette fonction sert a lire les 4 chiffres hexadecimaux d'une sequence \uXXXX qui commencent en c dans *code.
+ * On renvoie 1 si reussite, 0 s'il manque un chiffre.
+ */
+int lire_hexa_json( const char *c, unsigned long *code )
+{
+    const char *chiffres = "0123456789abcdef";
+    int i;
+    *code = 0;
+    for( i = 0; i < 4; i++ )
+    {
+        if( !isxdigit( ( unsigned char ) c[i] ) )
+        {
+            return 0;
+        }
+        *code = *code * 16 + ( strchr( chiffres, tolower( ( unsigned char ) c[i] ) ) - chiffres );
+    }
+    return 1;
+}
+
+/*
+ * Cette fonction sert a ecrire en UTF-8 dans o le caractere de code code (au plus U+10FFFF).
+ * On renvoie le nombre d'octets ecrits, de 1 a 4.
+ */
+int encoder_utf8( unsigned long code, char o[] )
+{
+    if( code < 0x80 )
+    {
+        o[0] = ( char ) code;
+        return 1;
+    }
+    if( code < 0x800 )
+    {
+        o[0] = ( char ) ( 0xC0 | ( code >> 6 ) );
+        o[1] = ( char ) ( 0x80 | ( code & 0x3F ) );
+        return 2;
+    }
+    if( code < 0x10000 )
+    {
+        o[0] = ( char ) ( 0xE0 | ( code >> 12 ) );
+        o[1] = ( char ) ( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+        o[2] = ( char ) ( 0x80 | ( code & 0x3F ) );
+        return 3;
+    }
+    o[0] = ( char ) ( 0xF0 | ( code >> 18 ) );
+    o[1] = ( char ) ( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+    o[2] = ( char ) ( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+    o[3] = ( char ) ( 0x80 | ( code & 0x3F ) );
+    return 4;
+}
+
+/*
+ * Cette fonction sert a lire une chaine JSON qui commence a *c et a la copier dans v (au plus taille octets).
+ * Les sequences \uXXXX sont ecrites en UTF-8, une paire de substitution (\uD83D\uDE00) donnant un seul
+ * caractere. \u0000 et une moitie de paire isolee sont refuses. *trop_long vaut 1 si la chaine ne tient pas dans
+ * v, 0 si pas.
+ * On renvoie la position apres la chaine, NULL si elle est mal formee ou trop longue.
+ */
+const char *lire_chaine_json( const char *c, char v[], int taille, int *trop_long )
+{
+    int n = 0, nb, i;
+    *trop_long = 0;
+    if( *c != '"' )
+    {
+        return NULL;
+    }
+    for( c++; *c != '"'; c++ )
+    {
+        char o[4];
+        o[0] = *c;
+        nb = 1;
+        if( *c == '\0' )
+        {
+            return NULL;
+        }
+        if( *c == '\\' )
+        {
+            c++;
+            switch( *c )
+            {
+                case 'n':
+                    o[0] = '\n';
+                    break;
+                case 't':
+                    o[0] = '\t';
+                    break;
+                case 'r':
+                    o[0] = '\r';
+                    break;
+                case 'b':
+                    o[0] = '\b';
+                    break;
+                case 'f':
+                    o[0] = '\f';
+                    break;
+                case 'u':
+                {
+                    unsigned long code, bas;
+                    if( !lire_hexa_json( c + 1, &code ) || code == 0 || ( code >= 0xDC00 && code <= 0xDFFF ) )
+                    {
+                        return NULL;
+                    }
+                    c += 4;
+                    if( code >= 0xD800 && code <= 0xDBFF )
+                    {
+                        if( c[1] != '\\' || c[2] != 'u' || !lire_hexa_json( c + 3, &bas ) || bas < 0xDC00 ||
+                            bas > 0xDFFF )
+                        {
+                            return NULL;
+                        }
+                        code = 0x10000 + ( ( code - 0xD800 ) << 10 ) + ( bas - 0xDC00 );
+                        c += 6;
+                    }
+                    nb = encoder_utf8( code, o );
+                    break;
+                }
+                case '\0':
+                    return NULL;
+                default:
+                    o[0] = *c;
+                    break;
+            }
+        }
+        for( i = 0; i < nb; i++ )
+        {
+            if( !ajouter_octet_champ( v, &n, taille, o[i] ) )
+            {
+                *trop_long = 1;
+                return NULL;
+            }
+        }
+    }
+    v[n] = '\0';
+    return c + 1;
+}
+
+/*
+ * Cette fonction sert a decouper un objet JSON plat (une ligne JSON Lines) en champs. Les valeurs peuvent etre
+ * des chaines, des nombres, true, false, null ou des tableaux de nombres.
+ * On renvoie 1 si reussite, 0 si la ligne est mal formee, -1 si un champ est trop long.
+ */
+int decouper_json( const char *ligne, enregistrement_import *e )
+{
+    const char *c = ligne;
+    int trop_long;
+    e->nb = 0;
+    while( isspace( ( unsigned char ) *c ) )
+    {
+        c++;
+    }
+    if( *c++ != '{' )
+    {
+        return 0;
+    }
+    while( 1 )
+    {
+        char *v;
+        int n = 0;
+        while( isspace( ( unsigned char ) *c ) )
+        {
+            c++;
+        }
+        if( *c == '}' && e->nb == 0 )
+        {
+            return 1;
+        }
+        if( e->nb == MAX_CHAMPS_IMPORT )
+        {
+            return 0;
+        }
+        c = lire_chaine_json( c, e->noms[ e->nb ], 32, &trop_long );
+        if( c == NULL )
+        {
+            return trop_long ? -1 : 0;
+        }
+        while( isspace( ( unsigned char ) *c ) )
+        {
+            c++;
+        }
+        if( *c++ != ':' )
+        {
+            return 0;
+        }
+        while( isspace( ( unsigned char ) *c ) )
+        {
+            c++;
+        }
+        v = e->valeurs[ e->nb ];
+        if( *c == '"' )
+        {
+            c = lire_chaine_json( c, v, TAILLE_CHAMP_IMPORT, &trop_long );
+            if( c == NULL )
+            {
+                return trop_long ? -1 : 0;
+            }
+        }
+        else if( *c == '[' )
+        {
+            for( c++; *c != ']'; c++ )
+            {
+                if( *c == '\0' || *c == '[' || *c == '{' || *c == '"' )
+                {
+                    return 0;
+                }
+                if( !isspace( ( unsigned char ) *c ) &&
+                    !ajouter_octet_champ( v, &n, TAILLE_CHAMP_IMPORT, *c == ',' ? ';' : *c ) )
+                {
+                    return -1;
+                }
+            }
+            v[n] = '\0';
+            c++;
+        }
+        else
+        {
+            while( *c != '\0' && *c != ',' && *c != '}' && !isspace( ( unsigned char ) *c ) )
+            {
+                if( !ajouter_octet_champ( v, &n, TAILLE_CHAMP_IMPORT, *c ) )
+                {
+                    return -1;
+                }
+                c++;
+            }
+            v[n] = '\0';
+            if( strcmp( v, "true" ) == 0 )
+            {
+                strcpy( v, "1" );
+            }
+            else if( strcmp( v, "false" ) == 0 )
+            {
+                strcpy( v, "0" );
+            }
+            else if( strcmp( v, "null" ) == 0 )
+            {
+                v[0] = '\0';
+            }
+        }
+        e->nb += 1;
+        while( isspace( ( unsigned char ) *c ) )
+        {
+            c++;
+        }
+        if( *c == '}' )
+        {
+            return 1;
+        }
+        if( *c++ != ',' )
+        {
+            return 0;
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a lire l'enregistrement suivant dans e. Les lignes vides sont ignorees.
+ * On renvoie 1 si un enregistrement a ete lu, 0 a la fin du fichier, -1 si la ligne lue est rejetee (la raison est
+ * dans l->erreur).
+ */
+int lire_enregistrement_import( lecteur_import *l, enregistrement_import *e )
+{
+    size_t n;
+    int i, res;
+    l->erreur = "ligne mal formee";
+    do
+    {
+        if( fgets( l->ligne, sizeof( l->ligne ), l->entree ) == NULL )
+        {
+            return 0;
+        }
+        l->numero += 1;
+        n = strlen( l->ligne );
+        if( n == sizeof( l->ligne ) - 1 && l->ligne[ n - 1 ] != '\n' )
+        {
+            int c;
+            while( ( c = getc( l->entree ) ) != EOF && c != '\n' )
+            {
+            }
+            l->erreur = "ligne trop longue";
+            return -1;
+        }
+    } while( strspn( l->ligne, " \t\r\n" ) == n );
+    res = l->format == EXPORT_JSONL ? decouper_json( l->ligne, e ) : decouper_csv( l->ligne, e );
+    if( res < 0 )
+    {
+        l->erreur = "champ trop long (255 octets au plus)";
+        return -1;
+    }
+    if( res == 0 || ( l->format == EXPORT_CSV && e->nb != l->entete.nb ) )
+    {
+        return -1;
+    }
+    if( l->format == EXPORT_JSONL )
+    {
+        return 1;
+    }
+    for( i = 0; i < e->nb; i++ )
+    {
+        strcpy( e->noms[i], l->entete.noms[i] );
+    }
+    return 1;
+}
+
+/*
+ * Cette fonction renvoie la valeur du champ nom de l'enregistrement e, NULL s'il n'y en a pas.
+ */
+const char *champ_import( enregistrement_import *e, const char *nom )
+{
+    int i;
+    for( i = 0; i < e->nb; i++ )
+    {
+        if( strcmp( e->noms[i], nom ) == 0 )
+        {
+            return e->valeurs[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Cette fonction sert a lire l'entier du champ nom dans *valeur. Un champ absent ou vide donne defaut.
+ * On renvoie 1 si reussite, 0 si le champ n'est pas un entier.
+ */
+int entier_import( enregistrement_import *e, const char *nom, int defaut, int *valeur )
+{
+    const char *texte = champ_import( e, nom );
+    char *fin;
+    long v;
+    if( texte == NULL || texte[0] == '\0' )
+    {
+        *valeur = defaut;
+        return 1;
+    }
+    v = strtol( texte, &fin, 10 );
+    if( *fin != '\0' || v < -ID_MAX || v > ID_MAX )
+    {
+        return 0;
+    }
+    *valeur = ( int ) v;
+    return 1;
+}
+
+/*
+ * Cette fonction sert a lire la liste d'entiers du champ nom dans valeurs (au plus max valeurs).
+ * On renvoie le nombre de valeurs lues, -1 si le champ est invalide ou contient plus de max valeurs.
+ */
+int liste_import( enregistrement_import *e, const char *nom, int valeurs[], int max )
+{
+    const char *c = champ_import( e, nom );
+    int nb = 0;
+    if( c == NULL )
+    {
+        return 0;
+    }
+    while( *c != '\0' )
+    {
+        char *fin;
+        long v = strtol( c, &fin, 10 );
+        if( fin == c || nb == max || v < -ID_MAX || v > ID_MAX )
+        {
+            return -1;
+        }
+        valeurs[ nb++ ] = ( int ) v;
+        c = fin;
+        if( *c == ';' )
+        {
+            c++;
+        }
+        else if( *c != '\0' )
+        {
+            return -1;
+        }
+    }
+    return nb;
+}
+
+/*
+ * Cette fonction suit la meme logique que liste_import pour une liste d'horaires (14.30;8), lus en minutes par
+ * lire_horaire.
+ */
+int liste_horaires_import( enregistrement_import *e, const char *nom, int minutes[], int max )
+{
+    const char *c = champ_import( e, nom );
+    int nb = 0;
+    if( c == NULL )
+    {
+        return 0;
+    }
+    while( *c != '\0' )
+    {
+        char horaire[32];
+        size_t n = strcspn( c, ";" );
+        if( n == 0 || n >= sizeof( horaire ) || nb == max )
+        {
+            return -1;
+        }
+        memcpy( horaire, c, n );
+        horaire[n] = '\0';
+        if( !lire_horaire( horaire, &minutes[ nb++ ] ) )
+        {
+            return -1;
+        }
+        c += n;
+        if( *c == ';' )
+        {
+            c++;
+        }
+    }
+    return nb;
+}
+
+/*
+ * Cet index sert a retrouver une personne ou une formation par son identite pendant une importation:
+ * (nom, prenom, formateur) pour une personne, comme get_personne, et le nom pour une formation, comme
+ * get_formation. C'est une table de hachage a adressage ouvert qui contient des identifiants: 0 pour une case
+ * vide, -1 pour une case liberee. Quand plusieurs enregistrements ont la meme identite, l'index garde celui qui a
+ * le plus petit identifiant, comme get_personne et get_formation.
+ */
+typedef struct index_identite
+{
+    int *cases;
+    int capacite;
+    int nb_occupees;
+} index_identite;
+
+/*
+ * Cette fonction renvoie le hachage FNV-1a de l'identite (nom, prenom, formateur). prenom vaut NULL pour une
+ * formation.
+ */
+unsigned long hacher_identite( const char *nom, const char *prenom, int formateur )
+{
+    unsigned long h = 2166136261UL;
+    const char *c;
+    for( c = nom; *c; c++ )
+    {
+        h = ( ( h ^ ( unsigned char ) *c ) * 16777619UL ) & 0xFFFFFFFFUL;
+    }
+    if( prenom != NULL )
+    {
+        h = ( ( h ^ 0xFF ) * 16777619UL ) & 0xFFFFFFFFUL;
+        for( c = prenom; *c; c++ )
+        {
+            h = ( ( h ^ ( unsigned char ) *c ) * 16777619UL ) & 0xFFFFFFFFUL;
+        }
+        h = ( ( h ^ ( unsigned char ) formateur ) * 16777619UL ) & 0xFFFFFFFFUL;
+    }
+    return h;
+}
+
+/*
+ * Cette structure regroupe ce dont l'index a besoin pour comparer une identite a un enregistrement.
+ * Exactement une des deux bases de donnees est renseignee.
+ */
+typedef struct cle_identite
+{
+    db_personne *dbp;
+    db_formation *dbf;
+    const char *nom;
+    const char *prenom;
+    int formateur;
+} cle_identite;
+
+int identite_egale( cle_identite *cle, int id )
+{
+    if( cle->dbp != NULL )
+    {
+        personne *p = get_personne_par_id( cle->dbp, id );
+        return p != NULL && p->formateur == cle->formateur && strcmp( p->nom, cle->nom ) == 0 &&
+               strcmp( p->prenom, cle->prenom ) == 0;
+    }
+    else
+    {
+        formation *f = get_formation_par_id( cle->dbf, id );
+        return f != NULL && strcmp( f->nom, cle->nom ) == 0;
+    }
+}
+
+/*
+ * Cette fonction renvoie la case de l'index qui contient l'identite cle, ou la case ou l'inserer si elle n'y
+ * est pas (la premiere case liberee rencontree, sinon la case vide qui termine la recherche).
+ */
+int chercher_case_identite( index_identite *index, cle_identite *cle )
+{
+    unsigned long h = hacher_identite( cle->nom, cle->prenom, cle->formateur );
+    int masque = index->capacite - 1, i = ( int ) ( h & ( unsigned long ) masque ), liberee = -1;
+    while( index->cases[i] != 0 )
+    {
+        if( index->cases[i] == -1 )
+        {
+            if( liberee < 0 )
+            {
+                liberee = i;
+            }
+        }
+        else if( identite_egale( cle, index->cases[i] ) )
+        {
+            return i;
+        }
+        i = ( i + 1 ) & masque;
+    }
+    return liberee >= 0 ? liberee : i;
+}
+
+void inserer_identite( index_identite *index, cle_identite *cle, int id );
+
+/*
+ * Cette fonction sert a doubler la taille de l'index quand il est rempli aux deux tiers (cases liberees
+ * comprises). Les identites sont relues dans les bases de donnees.
+ */
+void agrandir_index_identite( index_identite *index, cle_identite *modele )
+{
+    int *anciennes = index->cases, ancienne_capacite = index->capacite, i;
+    index->capacite = index->capacite ? index->capacite * 2 : 1024;
+    index->cases = ( int * ) ALLOUER( index->capacite, sizeof( int ), "index_identite" );
+    index->nb_occupees = 0;
+    for( i = 0; i < ancienne_capacite; i++ )
+    {
+        if( anciennes[i] > 0 )
+        {
+            cle_identite cle = *modele;
+            if( cle.dbp != NULL )
+            {
+                personne *p = get_personne_par_id( cle.dbp, anciennes[i] );
+                cle.nom = p->nom;
+                cle.prenom = p->prenom;
+                cle.formateur = p->formateur;
+            }
+            else
+            {
+                cle.nom = get_formation_par_id( cle.dbf, anciennes[i] )->nom;
+            }
+            inserer_identite( index, &cle, anciennes[i] );
+        }
+    }
+    LIBERER( anciennes );
+}
+
+/*
+ * Cette fonction renvoie l'identifiant de l'enregistrement qui a l'identite cle, 0 s'il n'y en a pas.
+ */
+int chercher_identite( index_identite *index, cle_identite *cle )
+{
+    int i;
+    if( index->capacite == 0 )
+    {
+        return 0;
+    }
+    i = chercher_case_identite( index, cle );
+    return index->cases[i] > 0 ? index->cases[i] : 0;
+}
+
+/*
+ * Cette fonction sert a ajouter l'identite cle de l'enregistrement id, si elle n'est pas deja dans l'index.
+ */
+void inserer_identite( index_identite *index, cle_identite *cle, int id )
+{
+    int i;
+    if( ( index->nb_occupees + 1 ) * 3 >= index->capacite * 2 )
+    {
+        agrandir_index_identite( index, cle );
+    }
+    i = chercher_case_identite( index, cle );
+    if( index->cases[i] > 0 )
+    {
+        return;
+    }
+    if( index->cases[i] == 0 )
+    {
+        index->nb_occupees += 1;
+    }
+    index->cases[i] = id;
+}
+
+/*
+ * Cette fonction sert a retirer l'identite cle de l'index si elle appartient a l'enregistrement id.
+ */
+void retirer_identite( index_identite *index, cle_identite *cle, int id )
+{
+    int i;
+    if( index->capacite == 0 )
+    {
+        return;
+    }
+    i = chercher_case_identite( index, cle );
+    if( index->cases[i] == id )
+    {
+        index->cases[i] = -1;
+    }
+}
+
+/*
+ * Le bilan d'une importation: le nombre d'enregistrements inseres, mis a jour, inchanges et rejetes, et le
+ * nombre d'inscriptions mises en liste d'attente parce que la formation est complete.
+ */
+typedef struct bilan_import
+{
+    unsigned long inseres;
+    unsigned long mis_a_jour;
+    unsigned long inchanges;
+    unsigned long rejetes;
+    unsigned long en_attente;
+} bilan_import;
+
+/*
+ * Le nombre de rejets detailles sur la sortie d'erreur, les suivants sont seulement comptes.
+ */
+#define MAX_REJETS_AFFICHES 20
+
+/*
+ * Cette fonction sert a compter un enregistrement rejete et a afficher la raison des premiers rejets.
+ */
+void rejeter_import( bilan_import *b, lecteur_import *l, const char *raison )
+{
+    b->rejetes += 1;
+    if( b->rejetes <= MAX_REJETS_AFFICHES )
+    {
+        fprintf( stderr, "Ligne %lu rejetee: %s\n", l->numero, raison );
+    }
+    else if( b->rejetes == MAX_REJETS_AFFICHES + 1 )
+    {
+        fprintf( stderr, "Rejets suivants non detailles...\n" );
+    }
+}
+
+/*
+ * Cette fonction sert a verifier qu'un nom ou un prenom peut etre ecrit dans CaculliTyranowskiPersonne.dat, qui
+ * separe les champs par des espaces: il doit etre non vide, en UTF-8 valide, sans espace et d'au plus
+ * LONGUEUR_NOM_MAX octets.
+ */
+int nom_personne_valide( const char *nom )
+{
+    const char *c;
+    if( nom == NULL || nom[0] == '\0' || strlen( nom ) > LONGUEUR_NOM_MAX || !utf8_valide( nom ) )
+    {
+        return 0;
+    }
+    for( c = nom; *c; c++ )
+    {
+        if( isspace( ( unsigned char ) *c ) )
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Cette fonction renvoie 1 si les nb_a entiers de a sont les nb_b entiers de b, dans le meme ordre, 0 si pas.
+ */
+int memes_entiers( const int a[], int nb_a, const int b[], int nb_b )
+{
+    return nb_a == nb_b && ( nb_a == 0 || memcmp( a, b, nb_a * sizeof( int ) ) == 0 );
+}
+
+/*
+ * Ces fonctions renvoient 1 si les personnes (ou les formations) a et b ont les memes champs, 0 si pas. Les
+ * champs sont compares un a un, et les vecteurs seulement sur leurs cases utilisees: un memcmp des structures
+ * comparerait aussi leur remplissage et les cases au-dela du nombre utilise, dont le contenu n'est pas fixe.
+ */
+int personnes_egales( const personne *a, const personne *b )
+{
+    return a->id == b->id && a->nom == b->nom && a->prenom == b->prenom && a->formateur == b->formateur &&
+           a->reduction == b->reduction && a->val_reduction == b->val_reduction &&
+           memes_entiers( a->formations, a->nb_formations, b->formations, b->nb_formations ) &&
+           memes_entiers( a->jours_indisponible, a->nb_jours_indisponible, b->jours_indisponible,
+                          b->nb_jours_indisponible );
+}
+
+int formations_egales( const formation *a, const formation *b )
+{
+    return a->id == b->id && a->nom == b->nom && a->prix == b->prix &&
+           memes_entiers( a->jours, a->nb_jours, b->jours, b->nb_jours ) &&
+           memes_entiers( a->heures, a->nb_jours, b->heures, b->nb_jours ) &&
+           memes_entiers( a->durees, a->nb_jours, b->durees, b->nb_jours ) &&
+           memes_entiers( a->salles, a->nb_jours, b->salles, b->nb_jours ) &&
+           memes_entiers( a->prerequis, a->nb_prerequis, b->prerequis, b->nb_prerequis ) &&
+           a->inscrits == b->inscrits && a->nb_inscrits == b->nb_inscrits &&
+           a->nb_desinscrits == b->nb_desinscrits && a->nb_apprenants == b->nb_apprenants &&
+           a->capacite_inscrits == b->capacite_inscrits &&
+           a->attente == b->attente;
+}
+
+/*
+ * Cette fonction sert a importer une personne.
+ * L'enregistrement est retrouve par son identifiant s'il en a un qui existe deja, sinon par son identite
+ * (nom, prenom, formateur). S'il est trouve, il est mis a jour (ses formations ne changent pas), sinon il est
+ * insere avec son identifiant, ou un nouvel identifiant s'il n'en a pas.
+ * vus contient les personnes deja importees par ce fichier: les retrouver une deuxieme fois est un doublon.
+ */
+void importer_personne( enregistrement_import *e, lecteur_import *l, db_personne *dbp, index_identite *index,
+                        index_identite *vus, bilan_import *b )
+{
+    cle_identite cle;
+    personne nouvelle, *p;
+    int id, formateur, reduction, jours[7], nb_jours, i, par_identite;
+    const char *nom = champ_import( e, "nom" ), *prenom = champ_import( e, "prenom" );
+    memset( &cle, 0, sizeof( cle ) );
+    cle.dbp = dbp;
+    if( !nom_personne_valide( nom ) || !nom_personne_valide( prenom ) )
+    {
+        rejeter_import( b, l, "nom ou prenom invalide (vide, avec espace, trop long ou pas en UTF-8)" );
+        return;
+    }
+    if( !entier_import( e, "id", 0, &id ) || id < 0 || !entier_import( e, "formateur", 0, &formateur ) ||
+        ( formateur != 0 && formateur != 1 ) || !entier_import( e, "reduction", 0, &reduction ) ||
+        reduction < 0 || reduction > 100 )
+    {
+        rejeter_import( b, l, "id, formateur ou reduction invalide" );
+        return;
+    }
+    nb_jours = liste_import( e, "jours_indisponibles", jours, 7 );
+    for( i = 0; i < nb_jours && jours[i] >= 1 && jours[i] <= 7; i++ )
+    {
+    }
+    if( nb_jours < 0 || i < nb_jours || ( nb_jours > 0 && !formateur ) || ( reduction > 0 && formateur ) )
+    {
+        rejeter_import( b, l, "jours indisponibles ou reduction incompatibles" );
+        return;
+    }
+    memset( &nouvelle, 0, sizeof( nouvelle ) );
+    nouvelle.formateur = formateur;
+    nouvelle.reduction = reduction > 0;
+    nouvelle.val_reduction = reduction;
+    nouvelle.nb_jours_indisponible = nb_jours;
+    memcpy( nouvelle.jours_indisponible, jours, nb_jours * sizeof( int ) );
+    cle.nom = nom;
+    cle.prenom = prenom;
+    cle.formateur = formateur;
+    par_identite = chercher_identite( index, &cle );
+    p = id > 0 ? get_personne_par_id( dbp, id ) : NULL;
+    if( p == NULL && id == 0 && par_identite > 0 )
+    {
+        p = get_personne_par_id( dbp, par_identite );
+    }
+    if( par_identite > 0 && ( p == NULL || p->id != par_identite ) )
+    {
+        rejeter_import( b, l, "identite deja portee par une autre personne" );
+        return;
+    }
+    if( p == NULL )
+    {
+        personne *tmpp;
+        if( id > ID_MAX )
+        {
+            rejeter_import( b, l, "identifiant trop grand" );
+            return;
+        }
+        tmpp = creer_personne( nom, prenom, formateur );
+        nouvelle.nom = tmpp->nom;
+        nouvelle.prenom = tmpp->prenom;
+        *tmpp = nouvelle;
+        tmpp->id = id > 0 ? id : allouer_id( &dbp->ids );
+        p = ranger_db_personne( dbp, tmpp );
+        if( p == NULL )
+        {
+            rejeter_import( b, l, "plus aucun identifiant disponible" );
+            return;
+        }
+        inserer_identite( index, &cle, p->id );
+        inserer_identite( vus, &cle, p->id );
+        b->inseres += 1;
+        return;
+    }
+    {
+        cle_identite ancienne = cle;
+        ancienne.nom = p->nom;
+        ancienne.prenom = p->prenom;
+        ancienne.formateur = p->formateur;
+        if( chercher_identite( vus, &ancienne ) == p->id || chercher_identite( vus, &cle ) > 0 )
+        {
+            rejeter_import( b, l, "doublon dans le fichier importe" );
+            return;
+        }
+        nouvelle.id = p->id;
+        nouvelle.nb_formations = p->nb_formations;
+        memcpy( nouvelle.formations, p->formations, sizeof( p->formations ) );
+        inserer_identite( vus, &cle, p->id );
+        nouvelle.nom = interner( nom );
+        nouvelle.prenom = interner( prenom );
+        if( personnes_egales( &nouvelle, p ) )
+        {
+            relacher( nouvelle.nom );
+            relacher( nouvelle.prenom );
+            b->inchanges += 1;
+            return;
+        }
+        retirer_identite( index, &ancienne, p->id );
+        relacher( p->nom );
+        relacher( p->prenom );
+        *p = nouvelle;
+        inserer_identite( index, &cle, p->id );
+        dbp->index_a_jour = 0;
+        b->mis_a_jour += 1;
+    }
+}
+
+/*
+ * Le parcours des prerequis de prerequis_atteint, garde d'une ligne importee a l'autre pour ne pas allouer ni
+ * effacer un tableau par formation. La formation d'identifiant id est vue pendant le parcours en cours si
+ * marques[ id ] == tour.
+ * unsigned int *marques, int *pile : Les formations vues et celles qui restent a visiter, cases cases chacun.
+ * int cases : La taille allouee, agrandie quand la base de donnees grandit.
+ * unsigned int tour : Le numero du parcours en cours.
+ */
+typedef struct parcours_prerequis
+{
+    unsigned int *marques;
+    int *pile;
+    int cases;
+    unsigned int tour;
+} parcours_prerequis;
+
+/*
+ * Cette fonction renvoie 1 si la formation cible est atteinte en suivant les prerequis a partir des nb formations
+ * de depart, 0 si pas. Le parcours en profondeur est iteratif et visite chaque formation une fois au plus; les
+ * prerequis inexistants sont sautes. Les tableaux de pp ne sont realloues que si dbf a grandi.
+ */
+int prerequis_atteint( db_formation *dbf, parcours_prerequis *pp, const int depart[], int nb, int cible )
+{
+    int nb_ids = dbf->nb_pages << DECALAGE_PAGE, hauteur = 0, trouve = 0, i;
+    if( nb_ids + 1 > pp->cases )
+    {
+        LIBERER( pp->marques );
+        LIBERER( pp->pile );
+        pp->cases = nb_ids + 1;
+        pp->marques = ( unsigned int * ) ALLOUER( pp->cases, sizeof( unsigned int ), "prerequis_atteint" );
+        pp->pile = ( int * ) ALLOUER( pp->cases, sizeof( int ), "prerequis_atteint" );
+        pp->tour = 0;
+    }
+    pp->tour += 1;
+    if( pp->tour == 0 )
+    {
+        memset( pp->marques, 0, pp->cases * sizeof( unsigned int ) );
+        pp->tour = 1;
+    }
+    for( i = 0; i < nb; i++ )
+    {
+        if( depart[i] > 0 && depart[i] <= nb_ids && pp->marques[ depart[i] ] != pp->tour )
+        {
+            pp->marques[ depart[i] ] = pp->tour;
+            pp->pile[ hauteur++ ] = depart[i];
+        }
+    }
+    while( hauteur > 0 && !trouve )
+    {
+        formation *g = get_formation_par_id( dbf, pp->pile[ --hauteur ] );
+        if( g == NULL )
+        {
+            continue;
+        }
+        trouve = g->id == cible;
+        for( i = 0; i < g->nb_prerequis; i++ )
+        {
+            int h = g->prerequis[i];
+            if( h > 0 && h <= nb_ids && pp->marques[h] != pp->tour )
+            {
+                pp->marques[h] = pp->tour;
+                pp->pile[ hauteur++ ] = h;
+            }
+        }
+    }
+    return trouve;
+}
+
+/*
+ * Cette fonction sert a importer une formation, selon la meme logique que importer_personne. L'identite d'une
+ * formation est son nom. Ses prerequis doivent exister deja (ou avoir ete importes plus haut dans le fichier).
+ * Une formation ne peut pas devenir, par ses nouveaux prerequis, un prerequis d'elle-meme: la ligne qui
+ * fermerait un cycle est rejetee, avant toute modification.
+ * Lors d'une mise a jour, une seance dont le jour et l'horaire ne changent pas garde sa salle.
+ */
+void importer_formation( enregistrement_import *e, lecteur_import *l, db_formation *dbf, index_identite *index,
+                         index_identite *vus, parcours_prerequis *pp, bilan_import *b )
+{
+    cle_identite cle;
+    formation nouvelle, *f;
+    const char *nom = champ_import( e, "nom" ), *prix = champ_import( e, "prix" );
+    int id, i, nb_heures, nb_durees, par_identite, cible;
+    memset( &cle, 0, sizeof( cle ) );
+    cle.dbf = dbf;
+    memset( &nouvelle, 0, sizeof( nouvelle ) );
+    if( nom == NULL || nom[0] == '\0' || strlen( nom ) > LONGUEUR_NOM_MAX || strpbrk( nom, "\r\n" ) != NULL ||
+        nom[0] == ' ' || nom[ strlen( nom ) - 1 ] == ' ' || !utf8_valide( nom ) )
+    {
+        rejeter_import( b, l, "nom invalide (vide, avec espace au bord, trop long ou pas en UTF-8)" );
+        return;
+    }
+    if( prix == NULL || !lire_prix( prix, &nouvelle.prix ) || !entier_import( e, "id", 0, &id ) || id < 0 )
+    {
+        rejeter_import( b, l, "id ou prix invalide" );
+        return;
+    }
+    nouvelle.nb_prerequis = liste_import( e, "prerequis", nouvelle.prerequis, 10 );
+    nouvelle.nb_jours = liste_import( e, "jours", nouvelle.jours, 7 );
+    nb_heures = liste_horaires_import( e, "heures", nouvelle.heures, 7 );
+    nb_durees = liste_horaires_import( e, "durees", nouvelle.durees, 7 );
+    if( nouvelle.nb_prerequis < 0 || nouvelle.nb_jours < 1 || nb_heures != nouvelle.nb_jours ||
+        nb_durees != nouvelle.nb_jours )
+    {
+        rejeter_import( b, l, "il faut de 1 a 7 jours avec autant d'heures et de durees, et 10 prerequis maximum" );
+        return;
+    }
+    for( i = 0; i < nouvelle.nb_jours; i++ )
+    {
+        if( nouvelle.jours[i] < 1 || nouvelle.jours[i] > 7 || nouvelle.heures[i] < 6 * 60 ||
+            nouvelle.heures[i] > 18 * 60 || nouvelle.durees[i] < 60 || nouvelle.durees[i] > 8 * 60 )
+        {
+            rejeter_import( b, l, "jour, heure ou duree hors limites" );
+            return;
+        }
+    }
+    for( i = 0; i < nouvelle.nb_prerequis; i++ )
+    {
+        if( get_formation_par_id( dbf, nouvelle.prerequis[i] ) == NULL || nouvelle.prerequis[i] == id )
+        {
+            rejeter_import( b, l, "prerequis inexistant" );
+            return;
+        }
+    }
+    cle.nom = nom;
+    par_identite = chercher_identite( index, &cle );
+    f = id > 0 ? get_formation_par_id( dbf, id ) : NULL;
+    if( f == NULL && id == 0 && par_identite > 0 )
+    {
+        f = get_formation_par_id( dbf, par_identite );
+    }
+    if( par_identite > 0 && ( f == NULL || f->id != par_identite ) )
+    {
+        rejeter_import( b, l, "nom deja porte par une autre formation" );
+        return;
+    }
+    cible = f != NULL ? f->id : id;
+    if( cible > 0 && nouvelle.nb_prerequis > 0 &&
+        ( f == NULL || !memes_entiers( nouvelle.prerequis, nouvelle.nb_prerequis, f->prerequis, f->nb_prerequis ) ) &&
+        prerequis_atteint( dbf, pp, nouvelle.prerequis, nouvelle.nb_prerequis, cible ) )
+    {
+        rejeter_import( b, l, "les prerequis fermeraient un cycle" );
+        return;
+    }
+    if( f == NULL )
+    {
+        formation *tmpf;
+        if( id > ID_MAX )
+        {
+            rejeter_import( b, l, "identifiant trop grand" );
+            return;
+        }
+        tmpf = creer_formation( nom, nouvelle.prix );
+        nouvelle.nom = tmpf->nom;
+        *tmpf = nouvelle;
+        tmpf->id = id > 0 ? id : allouer_id( &dbf->ids );
+        f = ranger_db_formation( dbf, tmpf );
+        if( f == NULL )
+        {
+            rejeter_import( b, l, "plus aucun identifiant disponible" );
+            return;
+        }
+        inserer_identite( index, &cle, f->id );
+        inserer_identite( vus, &cle, f->id );
+        b->inseres += 1;
+        return;
+    }
+    {
+        cle_identite ancienne = cle;
+        ancienne.nom = f->nom;
+        if( chercher_identite( vus, &ancienne ) == f->id || chercher_identite( vus, &cle ) > 0 )
+        {
+            rejeter_import( b, l, "doublon dans le fichier importe" );
+            return;
+        }
+        nouvelle.id = f->id;
+        nouvelle.inscrits = f->inscrits;
+        nouvelle.nb_inscrits = f->nb_inscrits;
+        nouvelle.nb_desinscrits = f->nb_desinscrits;
+        nouvelle.nb_apprenants = f->nb_apprenants;
+        nouvelle.capacite_inscrits = f->capacite_inscrits;
+        nouvelle.attente = f->attente;
+        for( i = 0; i < nouvelle.nb_jours && i < f->nb_jours; i++ )
+        {
+            if( nouvelle.jours[i] == f->jours[i] && nouvelle.heures[i] == f->heures[i] &&
+                nouvelle.durees[i] == f->durees[i] )
+            {
+                nouvelle.salles[i] = f->salles[i];
+            }
+        }
+        inserer_identite( vus, &cle, f->id );
+        nouvelle.nom = interner( nom );
+        if( formations_egales( &nouvelle, f ) )
+        {
+            relacher( nouvelle.nom );
+            b->inchanges += 1;
+            return;
+        }
+        retirer_identite( index, &ancienne, f->id );
+        retirer_seances( dbf, f );
+        relacher( f->nom );
+        *f = nouvelle;
+        indexer_seances( dbf, f );
+        inserer_identite( index, &cle, f->id );
+        dbf->index_a_jour = 0;
+        b->mis_a_jour += 1;
+    }
+}
+
+/*
+ * Cette fonction sert a importer une inscription (formation_id, personne_id) par demander_inscription, comme le
+ * menu: une formation complete met la personne en liste d'attente. Une inscription ou une demande d'attente qui
+ * existe deja est comptee comme inchangee.
+ */
+void importer_inscription( enregistrement_import *e, lecteur_import *l, db_formation *dbf, db_personne *dbp,
+                           bilan_import *b )
+{
+    formation *f;
+    personne *p;
+    int idf, idp;
+    if( !entier_import( e, "formation_id", 0, &idf ) || !entier_import( e, "personne_id", 0, &idp ) )
+    {
+        rejeter_import( b, l, "formation_id ou personne_id invalide" );
+        return;
+    }
+    f = get_formation_par_id( dbf, idf );
+    p = get_personne_par_id( dbp, idp );
+    if( f == NULL || p == NULL )
+    {
+        rejeter_import( b, l, "formation ou personne inexistante" );
+        return;
+    }
+    switch( demander_inscription( dbf, f, p ) )
+    {
+        case INSCRIPTION_FAITE:
+            b->inseres += 1;
+            break;
+        case INSCRIPTION_EN_ATTENTE:
+            b->en_attente += 1;
+            break;
+        case INSCRIPTION_IMPOSSIBLE:
+            rejeter_import( b, l, "la personne participe deja a 30 formations" );
+            break;
+        default:
+            b->inchanges += 1;
+            break;
+    }
+}
+
+/*
+ * Cette fonction sert a construire l'index des identites des personnes ou des formations deja chargees.
+ * Les enregistrements sont parcourus par identifiant croissant, une identite en double garde donc le plus petit.
+ */
+void indexer_identites( index_identite *index, db_formation *dbf, db_personne *dbp )
+{
+    cle_identite cle;
+    memset( &cle, 0, sizeof( cle ) );
+    if( dbp != NULL )
+    {
+        curseur_personne c;
+        personne *tmpp;
+        cle.dbp = dbp;
+        for( tmpp = debut_curseur_personne( &c, dbp, ORDRE_ID ); tmpp != NULL;
+             tmpp = suivant_curseur_personne( &c ) )
+        {
+            cle.nom = tmpp->nom;
+            cle.prenom = tmpp->prenom;
+            cle.formateur = tmpp->formateur;
+            inserer_identite( index, &cle, tmpp->id );
+        }
+    }
+    else
+    {
+        curseur_formation c;
+        formation *tmpf;
+        cle.dbf = dbf;
+        for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_ID ); tmpf != NULL;
+             tmpf = suivant_curseur_formation( &c ) )
+        {
+            cle.nom = tmpf->nom;
+            inserer_identite( index, &cle, tmpf->id );
+        }
+    }
+}
+
+/*
+ * Le nombre d'enregistrements entre deux messages de progression de l'importation.
+ */
+#define LOT_IMPORT 100000
+
+/*
+ * Commande importer: charge les fichiers .dat du dossier courant, importe les personnes, les formations ou les
+ * inscriptions d'un fichier CSV (avec ligne d'entete, les colonnes de la commande exporter) ou JSON Lines, puis
+ * sauvegarde. Le fichier est lu ligne par ligne: la memoire utilisee ne depend que de la taille des bases de
+ * donnees, pas de celle du fichier. Avec -n, rien n'est sauvegarde.
+ */
+int commande_importer( int argc, char *argv[] )
+{
+    const char *quoi = argc > 0 ? argv[0] : "", *fichier = argc > 1 ? argv[1] : NULL;
+    lecteur_import l;
+    enregistrement_import e;
+    index_identite index, vus;
+    parcours_prerequis pp;
+    bilan_import b;
+    paire_db bases;
+    int i, res, simulation = 0;
+    memset( &l, 0, sizeof( l ) );
+    memset( &index, 0, sizeof( index ) );
+    memset( &vus, 0, sizeof( vus ) );
+    memset( &pp, 0, sizeof( pp ) );
+    memset( &b, 0, sizeof( b ) );
+    l.format = fichier != NULL && strlen( fichier ) > 6 && strcmp( fichier + strlen( fichier ) - 6, ".jsonl" ) == 0 ?
+               EXPORT_JSONL : EXPORT_CSV;
+    for( i = 2; i < argc; i++ )
+    {
+        if( strcmp( argv[i], "-n" ) == 0 )
+        {
+            simulation = 1;
+        }
+        else if( strcmp( argv[i], "-f" ) == 0 && i + 1 < argc && strcmp( argv[ i + 1 ], "csv" ) == 0 )
+        {
+            l.format = EXPORT_CSV;
+            i++;
+        }
+        else if( strcmp( argv[i], "-f" ) == 0 && i + 1 < argc && strcmp( argv[ i + 1 ], "jsonl" ) == 0 )
+        {
+            l.format = EXPORT_JSONL;
+            i++;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if( fichier == NULL || i != argc || ( strcmp( quoi, "personnes" ) != 0 && strcmp( quoi, "formations" ) != 0 &&
+                                          strcmp( quoi, "inscriptions" ) != 0 ) )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski importer personnes|formations|inscriptions fichier|- "
+                         "[-f csv|jsonl] [-n]\n" );
+        return 1;
+    }
+    l.entree = strcmp( fichier, "-" ) == 0 ? stdin : fopen( fichier, "r" );
+    if( l.entree == NULL )
+    {
+        fprintf( stderr, "Impossible d'ouvrir %s\n", fichier );
+        return 1;
+    }
+    if( l.format == EXPORT_CSV )
+    {
+        if( fgets( l.ligne, sizeof( l.ligne ), l.entree ) == NULL || decouper_csv( l.ligne, &l.entete ) != 1 )
+        {
+            fprintf( stderr, "Ligne d'entete manquante ou invalide dans %s\n", fichier );
+            if( l.entree != stdin )
+            {
+                fclose( l.entree );
+            }
+            return 1;
+        }
+        l.numero = 1;
+        for( i = 0; i < l.entete.nb; i++ )
+        {
+            strncpy( l.entete.noms[i], l.entete.valeurs[i], sizeof( l.entete.noms[i] ) - 1 );
+            l.entete.noms[i][ sizeof( l.entete.noms[i] ) - 1 ] = '\0';
+        }
+    }
+    bases.dbp = creer_db_personne();
+    bases.dbf = creer_db_formation();
+    charger_db( bases.dbf, bases.dbp );
+    if( strcmp( quoi, "personnes" ) == 0 )
+    {
+        indexer_identites( &index, NULL, bases.dbp );
+    }
+    else if( strcmp( quoi, "formations" ) == 0 )
+    {
+        indexer_identites( &index, bases.dbf, NULL );
+    }
+    while( ( res = lire_enregistrement_import( &l, &e ) ) != 0 )
+    {
+        if( res < 0 )
+        {
+            rejeter_import( &b, &l, l.erreur );
+        }
+        else if( strcmp( quoi, "personnes" ) == 0 )
+        {
+            importer_personne( &e, &l, bases.dbp, &index, &vus, &b );
+        }
+        else if( strcmp( quoi, "formations" ) == 0 )
+        {
+            importer_formation( &e, &l, bases.dbf, &index, &vus, &pp, &b );
+        }
+        else
+        {
+            importer_inscription( &e, &l, bases.dbf, bases.dbp, &b );
+        }
+        if( ( b.inseres + b.mis_a_jour + b.inchanges + b.rejetes + b.en_attente ) % LOT_IMPORT == 0 )
+        {
+            fprintf( stderr, "%lu enregistrements traites...\n",
+                     b.inseres + b.mis_a_jour + b.inchanges + b.rejetes + b.en_attente );
+        }
+    }
+    if( l.entree != stdin )
+    {
+        fclose( l.entree );
+    }
+    if( strcmp( quoi, "personnes" ) == 0 && b.mis_a_jour > 0 )
+    {
+        recompter_apprenants( bases.dbf );
+    }
+    printf( "%s: %lu inseres, %lu mis a jour, %lu inchanges, %lu rejetes\n",
+            quoi, b.inseres, b.mis_a_jour, b.inchanges, b.rejetes );
+    if( b.en_attente > 0 )
+    {
+        printf( "%s: %lu mis(es) en liste d'attente, les formations etant completes\n", quoi, b.en_attente );
+    }
+    res = 1;
+    if( !simulation && b.inseres + b.mis_a_jour + b.en_attente > 0 )
+    {
+        res = sauvegarder_db( bases.dbf, bases.dbp, 0, -1 );
+    }
+    LIBERER( index.cases );
+    LIBERER( vus.cases );
+    LIBERER( pp.marques );
+    LIBERER( pp.pile );
+    liberer_db_personne( bases.dbp );
+    liberer_db_formation( bases.dbf );
+    return res ? 0 : 1;
+}
+
+/*
+ * Commande migrer: convertit une fois pour toutes les fichiers de formations du dossier courant
+ * (CaculliTyranowskiFormation.dat et sa sauvegarde automatique) du format 1 au format 2, ou les horaires et les
+ * durees sont en minutes et les prix en centimes. Une copie de l'ancien fichier est d'abord gardee avec le
+ * suffixe _V1 (voir garder_copie), puis le nouveau fichier le remplace de facon atomique. Un fichier
+ * deja au format 2 n'est pas modifie. Si une seule ligne de l'ancien fichier est ignoree au chargement (voir
+ * signaler_chargement), rien n'est ecrit: le fichier reste au format 1 pour etre corrige a la main. Le programme
+ * lit aussi le format 1, la migration evite de le convertir a chaque chargement.
+ */
+int commande_migrer( int argc, char *argv[] )
+{
+    const char *fichiers[] = { FICHIER_FORMATION, FICHIER_FORMATION_AUTO }, *ids[] = { FICHIER_ID, FICHIER_ID_AUTO };
+    int i, res = 1;
+    ( void ) argv;
+    if( argc > 0 )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski migrer\n" );
+        return 1;
+    }
+    for( i = 0; i < 2; i++ )
+    {
+        char ancien[ 256 ];
+        db_formation *dbf;
+        db_personne *dbp;
+        FILE *fdat_f = fopen( fichiers[i], "r" );
+        int format, nb, rejets;
+        if( fdat_f == NULL )
+        {
+            continue;
+        }
+        format = lire_format_formation( fdat_f );
+        fclose( fdat_f );
+        if( format >= FORMAT_FICHIER_FORMATION )
+        {
+            fprintf( stderr, "%s: deja au format %d\n", fichiers[i], format );
+            continue;
+        }
+        dbf = creer_db_formation();
+        dbp = creer_db_personne();
+        charger_ids( dbf, dbp, ids[i] );
+        liberer_db_personne( dbp );
+        rejets = chargement.nb;
+        nb = charger_db_formation( dbf, fichiers[i] );
+        if( chargement.nb != rejets )
+        {
+            fprintf( stderr, "%s: %d ligne(s) ignoree(s), fichier non migre\n", fichiers[i], chargement.nb - rejets );
+            res = 0;
+        }
+        else if( !garder_copie( fichiers[i], "_V1", ancien ) ||
+            !ecrire_fichier_atomique( fichiers[i], ecrire_db_formation_fichier, dbf ) )
+        {
+            fprintf( stderr, "%s: migration impossible\n", fichiers[i] );
+            res = 0;
+        }
+        else
+        {
+            fprintf( stderr, "%s: %d formation(s) migree(s) au format %d, ancien fichier garde dans %s\n",
+                     fichiers[i], nb, FORMAT_FICHIER_FORMATION, ancien );
+        }
+        liberer_db_formation( dbf );
+    }
+    return res ? 0 : 1;
+}
+
+/*                              FIN IMPORTATION                              */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                 REQUETES                                  */
+
+/*
+ * Le langage de requete, pour interroger les bases de donnees sans tout exporter:
+ *
+ *   requete     := source [ si condition ] [ tri champ [ desc ] ] [ limite entier ]
+ *   source      := personnes | formations | inscriptions
+ *   condition   := terme { ou terme }
+ *   terme       := facteur { et facteur }
+ *   facteur     := non facteur | ( condition ) | inscrit ( condition ) | participant ( condition )
+ *                | champ operateur valeur
+ *   operateur   := = | != | < | <= | > | >= | ~ | ~=
+ *
+ * inscrit( c ) est vrai si la personne participe a une formation qui verifie c, participant( c ) si la formation a
+ * un participant qui verifie c. Dans une requete sur les inscriptions, chaque ligne est une personne dans une
+ * formation. Un champ peut etre prefixe par personne. ou formation. pour lever une ambiguite (id, nom) ou pour
+ * designer la personne ou la formation exterieure dans inscrit( ) et participant( ).
+ * Sur une liste (jours, prerequis, ...), = est vrai si la liste contient la valeur, != si elle ne la contient pas,
+ * les autres operateurs si un element de la liste convient. Les jours peuvent etre ecrits lundi ... dimanche.
+ * ~ est vrai si le texte contient la valeur, ~= s'il lui est egal, sans tenir compte des majuscules ni des accents
+ * (les deux sont compares par leur cle pliee, voir cle_pliee). Une valeur qui contient des espaces ou des
+ * caracteres speciaux s'ecrit entre guillemets.
+ * Sans tri, les resultats sont donnes par identifiant croissant (par formation puis par ordre d'inscription pour
+ * les inscriptions).
+ *
+ * Exemple: personnes si reduction > 20 et inscrit( nom = Java et jours = mardi ) tri nom limite 10
+ */
+#define SOURCE_PERSONNES 0
+#define SOURCE_FORMATIONS 1
+#define SOURCE_INSCRIPTIONS 2
+
+#define ENTITE_PERSONNE 1
+#define ENTITE_FORMATION 2
+
+/*
+ * Les champs que l'on peut interroger.
+ * const char *nom : Le nom du champ dans une requete.
+ * int entite : ENTITE_PERSONNE ou ENTITE_FORMATION.
+ * int texte : 1 pour un texte, 0 pour un nombre.
+ * int liste : 1 pour une liste de nombres.
+ */
+typedef struct champ_requete
+{
+    const char *nom;
+    int entite;
+    int texte;
+    int liste;
+} champ_requete;
+
+#define CHAMP_PERSONNE_ID 0
+#define CHAMP_PERSONNE_NOM 1
+#define CHAMP_PERSONNE_PRENOM 2
+#define CHAMP_FORMATEUR 3
+#define CHAMP_REDUCTION 4
+#define CHAMP_NB_FORMATIONS 5
+#define CHAMP_JOURS_INDISPONIBLES 6
+#define CHAMP_FORMATIONS 7
+#define CHAMP_FORMATION_ID 8
+#define CHAMP_FORMATION_NOM 9
+#define CHAMP_PRIX 10
+#define CHAMP_JOURS 11
+#define CHAMP_PREREQUIS 12
+#define CHAMP_PARTICIPANTS 13
+#define NB_CHAMPS_REQUETE 14
+
+champ_requete champs_requete[ NB_CHAMPS_REQUETE ] =
+{
+    { "id", ENTITE_PERSONNE, 0, 0 },
+    { "nom", ENTITE_PERSONNE, 1, 0 },
+    { "prenom", ENTITE_PERSONNE, 1, 0 },
+    { "formateur", ENTITE_PERSONNE, 0, 0 },
+    { "reduction", ENTITE_PERSONNE, 0, 0 },
+    { "nb_formations", ENTITE_PERSONNE, 0, 0 },
+    { "jours_indisponibles", ENTITE_PERSONNE, 0, 1 },
+    { "formations", ENTITE_PERSONNE, 0, 1 },
+    { "id", ENTITE_FORMATION, 0, 0 },
+    { "nom", ENTITE_FORMATION, 1, 0 },
+    { "prix", ENTITE_FORMATION, 0, 0 },
+    { "jours", ENTITE_FORMATION, 0, 1 },
+    { "prerequis", ENTITE_FORMATION, 0, 1 },
+    { "participants", ENTITE_FORMATION, 0, 0 }
+};
+
+#define OP_EGAL 0
+#define OP_DIFFERENT 1
+#define OP_INFERIEUR 2
+#define OP_INFERIEUR_EGAL 3
+#define OP_SUPERIEUR 4
+#define OP_SUPERIEUR_EGAL 5
+#define OP_CONTIENT 6
+#define OP_SEMBLABLE 7
+
+#define NOEUD_ET 0
+#define NOEUD_OU 1
+#define NOEUD_NON 2
+#define NOEUD_COMPARAISON 3
+#define NOEUD_INSCRIT 4
+#define NOEUD_PARTICIPANT 5
+
+/*
+ * Un noeud de l'arbre d'une condition.
+ * int type : NOEUD_ET, NOEUD_OU, NOEUD_NON, NOEUD_COMPARAISON, NOEUD_INSCRIT ou NOEUD_PARTICIPANT.
+ * int gauche, droite : Les sous-conditions (gauche seulement pour NON, INSCRIT et PARTICIPANT), -1 si aucune.
+ * int champ, operateur : Le champ compare et l'operateur OP_*, pour une comparaison.
+ * double nombre, char texte[ LONGUEUR_NOM_MAX + 1 ] : La valeur comparee, selon le type du champ.
+ */
+typedef struct noeud_requete
+{
+    int type;
+    int gauche;
+    int droite;
+    int champ;
+    int operateur;
+    double nombre;
+    char texte[ LONGUEUR_NOM_MAX + 1 ];
+} noeud_requete;
+
+#define MAX_NOEUDS_REQUETE 64
+
+/*
+ * Une requete analysee.
+ * int racine : Le noeud de la condition, -1 s'il n'y en a pas.
+ * int tri : Le champ de tri, -1 pour l'ordre par defaut.
+ * long limite : Le nombre maximum de resultats, -1 sans limite.
+ * const char *plan : La description du plan choisi par executer_requete.
+ * unsigned long nb_examines : Le nombre de candidats examines par executer_requete.
+ * char erreur[128] : Le message d'erreur si l'analyse echoue.
+ */
+typedef struct requete
+{
+    int source;
+    int racine;
+    int nb_noeuds;
+    noeud_requete noeuds[ MAX_NOEUDS_REQUETE ];
+    int tri;
+    int descendant;
+    long limite;
+    const char *plan;
+    unsigned long nb_examines;
+    char erreur[128];
+} requete;
+
+#define JETON_FIN 0
+#define JETON_MOT 1
+#define JETON_TEXTE 2
+#define JETON_OPERATEUR 3
+#define JETON_OUVRANTE 4
+#define JETON_FERMANTE 5
+
+/*
+ * L'etat de l'analyse d'une requete: le texte qui reste a lire et le jeton courant.
+ */
+typedef struct analyseur
+{
+    const char *c;
+    int type;
+    char jeton[ LONGUEUR_NOM_MAX + 1 ];
+    requete *r;
+} analyseur;
+
+/*
+ * Cette fonction sert a lire le jeton suivant: un mot, un texte entre guillemets, un operateur ou une parenthese.
+ * On renvoie 0 si le texte est mal forme (guillemet non ferme, jeton trop long).
+ */
+int lire_jeton( analyseur *a )
+{
+    int n = 0;
+    while( isspace( ( unsigned char ) *a->c ) )
+    {
+        a->c++;
+    }
+    a->jeton[0] = '\0';
+    if( *a->c == '\0' )
+    {
+        a->type = JETON_FIN;
+        return 1;
+    }
+    if( *a->c == '(' || *a->c == ')' )
+    {
+        a->type = *a->c == '(' ? JETON_OUVRANTE : JETON_FERMANTE;
+        a->jeton[0] = *a->c++;
+        a->jeton[1] = '\0';
+        return 1;
+    }
+    if( strchr( "=!<>~", *a->c ) != NULL )
+    {
+        a->type = JETON_OPERATEUR;
+        a->jeton[ n++ ] = *a->c++;
+        if( *a->c == '=' && a->jeton[0] != '=' )
+        {
+            a->jeton[ n++ ] = *a->c++;
+        }
+        a->jeton[n] = '\0';
+        return 1;
+    }
+    if( *a->c == '"' )
+    {
+        a->type = JETON_TEXTE;
+        for( a->c++; *a->c != '"'; a->c++ )
+        {
+            if( *a->c == '\\' && a->c[1] != '\0' )
+            {
+                a->c++;
+            }
+            if( *a->c == '\0' || n == ( int ) sizeof( a->jeton ) - 1 )
+            {
+                snprintf( a->r->erreur, sizeof( a->r->erreur ), "texte entre guillemets non ferme ou trop long" );
+                return 0;
+            }
+            a->jeton[ n++ ] = *a->c;
+        }
+        a->c++;
+        a->jeton[n] = '\0';
+        return 1;
+    }
+    a->type = JETON_MOT;
+    while( *a->c != '\0' && !isspace( ( unsigned char ) *a->c ) && strchr( "()=!<>~\"", *a->c ) == NULL )
+    {
+        if( n == ( int ) sizeof( a->jeton ) - 1 )
+        {
+            snprintf( a->r->erreur, sizeof( a->r->erreur ), "mot trop long" );
+            return 0;
+        }
+        a->jeton[ n++ ] = *a->c++;
+    }
+    a->jeton[n] = '\0';
+    return 1;
+}
+
+/*
+ * Cette fonction renvoie 1 si le jeton courant est le mot-cle mot (sans tenir compte des majuscules).
+ */
+int jeton_est( analyseur *a, const char *mot )
+{
+    const char *c = a->jeton;
+    if( a->type != JETON_MOT )
+    {
+        return 0;
+    }
+    while( *c != '\0' && tolower( ( unsigned char ) *c ) == *mot )
+    {
+        c++;
+        mot++;
+    }
+    return *c == '\0' && *mot == '\0';
+}
+
+/*
+ * Cette fonction sert a ajouter un noeud a la requete. On renvoie son indice, -1 s'il y a trop de noeuds.
+ */
+int nouveau_noeud( analyseur *a, int type, int gauche, int droite )
+{
+    noeud_requete *n;
+    if( a->r->nb_noeuds == MAX_NOEUDS_REQUETE )
+    {
+        snprintf( a->r->erreur, sizeof( a->r->erreur ), "condition trop longue" );
+        return -1;
+    }
+    n = &a->r->noeuds[ a->r->nb_noeuds ];
+    memset( n, 0, sizeof( *n ) );
+    n->type = type;
+    n->gauche = gauche;
+    n->droite = droite;
+    return a->r->nb_noeuds++;
+}
+
+/*
+ * Cette fonction renvoie le champ designe par le mot nom, -1 s'il n'existe pas ou n'est pas utilisable ici.
+ * liees contient les entites (ENTITE_PERSONNE, ENTITE_FORMATION) dont les champs sont utilisables et defaut celle
+ * d'un champ sans prefixe, 0 si les deux sont possibles.
+ */
+int trouver_champ_requete( analyseur *a, const char *nom, int liees, int defaut )
+{
+    int entite = defaut, i, trouve = -1;
+    if( strncmp( nom, "personne.", 9 ) == 0 )
+    {
+        entite = ENTITE_PERSONNE;
+        nom += 9;
+    }
+    else if( strncmp( nom, "formation.", 10 ) == 0 )
+    {
+        entite = ENTITE_FORMATION;
+        nom += 10;
+    }
+    for( i = 0; i < NB_CHAMPS_REQUETE; i++ )
+    {
+        if( strcmp( champs_requete[i].nom, nom ) == 0 && ( entite == 0 || champs_requete[i].entite == entite ) )
+        {
+            if( trouve >= 0 )
+            {
+                snprintf( a->r->erreur, sizeof( a->r->erreur ),
+                          "champ %s ambigu, ecrire personne.%s ou formation.%s", nom, nom, nom );
+                return -1;
+            }
+            trouve = i;
+        }
+    }
+    if( trouve < 0 )
+    {
+        snprintf( a->r->erreur, sizeof( a->r->erreur ), "champ inconnu: %s", nom );
+    }
+    else if( !( champs_requete[ trouve ].entite & liees ) )
+    {
+        snprintf( a->r->erreur, sizeof( a->r->erreur ), "le champ %s n'est utilisable que dans %s( ... )", nom,
+                  champs_requete[ trouve ].entite == ENTITE_FORMATION ? "inscrit" : "participant" );
+        trouve = -1;
+    }
+    return trouve;
+}
+
+int analyser_condition( analyseur *a, int liees, int defaut );
+
+/*
+ * Cette fonction sert a analyser une comparaison: champ operateur valeur.
+ * On renvoie l'indice du noeud, -1 en cas d'erreur.
+ */
+int analyser_comparaison( analyseur *a, int liees, int defaut )
+{
+    const char *operateurs[] = { "=", "!=", "<", "<=", ">", ">=", "~", "~=" };
+    const char *jours[] = { "lundi", "mardi", "mercredi", "jeudi", "vendredi", "samedi", "dimanche" };
+    int n, champ, i;
+    noeud_requete *noeud;
+    if( a->type != JETON_MOT )
+    {
+        snprintf( a->r->erreur, sizeof( a->r->erreur ), "champ attendu au lieu de '%s'", a->jeton );
+        return -1;
+    }
+    champ = trouver_champ_requete( a, a->jeton, liees, defaut );
+    if( champ < 0 || !lire_jeton( a ) )
+    {
+        return -1;
+    }
+    for( i = 0; i < 8 && ( a->type != JETON_OPERATEUR || strcmp( a->jeton, operateurs[i] ) != 0 ); i++ )
+    {
+    }
+    if( i == 8 || ( i >= OP_CONTIENT && !champs_requete[ champ ].texte ) )
+    {
+        snprintf( a->r->erreur, sizeof( a->r->erreur ), "operateur invalide apres %s: '%s'",
+                  champs_requete[ champ ].nom, a->jeton );
+        return -1;
+    }
+    n = nouveau_noeud( a, NOEUD_COMPARAISON, -1, -1 );
+    if( n < 0 || !lire_jeton( a ) )
+    {
+        return -1;
+    }
+    noeud = &a->r->noeuds[n];
+    noeud->champ = champ;
+    noeud->operateur = i;
+    if( a->type != JETON_MOT && a->type != JETON_TEXTE )
+    {
+        snprintf( a->r->erreur, sizeof( a->r->erreur ), "valeur attendue apres %s", operateurs[i] );
+        return -1;
+    }
+    if( champs_requete[ champ ].texte )
+    {
+        if( strlen( a->jeton ) >= sizeof( noeud->texte ) )
+        {
+            snprintf( a->r->erreur, sizeof( a->r->erreur ), "texte trop long: %s", a->jeton );
+            return -1;
+        }
+        if( i >= OP_CONTIENT )
+        {
+            plier_nom( a->jeton, noeud->texte );
+        }
+        else
+        {
+            strcpy( noeud->texte, a->jeton );
+        }
+    }
+    else
+    {
+        char *fin;
+        noeud->nombre = strtod( a->jeton, &fin );
+        if( fin == a->jeton || *fin != '\0' )
+        {
+            for( i = 0; i < 7 && !jeton_est( a, jours[i] ); i++ )
+            {
+            }
+            if( i == 7 || ( champ != CHAMP_JOURS && champ != CHAMP_JOURS_INDISPONIBLES ) )
+            {
+                snprintf( a->r->erreur, sizeof( a->r->erreur ), "nombre attendu pour %s: %s",
+                          champs_requete[ champ ].nom, a->jeton );
+                return -1;
+            }
+            noeud->nombre = i + 1;
+        }
+    }
+    return lire_jeton( a ) ? n : -1;
+}
+
+/*
+ * Cette fonction sert a analyser un facteur: une negation, une condition entre parentheses, inscrit( ... ),
+ * participant( ... ) ou une comparaison.
+ */
+int analyser_facteur( analyseur *a, int liees, int defaut )
+{
+    int n, type;
+    if( jeton_est( a, "non" ) )
+    {
+        if( !lire_jeton( a ) || ( n = analyser_facteur( a, liees, defaut ) ) < 0 )
+        {
+            return -1;
+        }
+        return nouveau_noeud( a, NOEUD_NON, n, -1 );
+    }
+    type = -1;
+    if( jeton_est( a, "inscrit" ) )
+    {
+        type = NOEUD_INSCRIT;
+    }
+    else if( jeton_est( a, "participant" ) )
+    {
+        type = NOEUD_PARTICIPANT;
+    }
+    if( type >= 0 )
+    {
+        int entite = type == NOEUD_INSCRIT ? ENTITE_PERSONNE : ENTITE_FORMATION;
+        if( !( liees & entite ) || ( liees & ( ENTITE_PERSONNE | ENTITE_FORMATION ) & ~entite ) )
+        {
+            snprintf( a->r->erreur, sizeof( a->r->erreur ), "%s( ... ) n'est utilisable que sur des %s", a->jeton,
+                      type == NOEUD_INSCRIT ? "personnes" : "formations" );
+            return -1;
+        }
+        if( !lire_jeton( a ) )
+        {
+            return -1;
+        }
+        if( a->type != JETON_OUVRANTE )
+        {
+            snprintf( a->r->erreur, sizeof( a->r->erreur ), "( attendue apres %s",
+                      type == NOEUD_INSCRIT ? "inscrit" : "participant" );
+            return -1;
+        }
+    }
+    if( a->type == JETON_OUVRANTE )
+    {
+        int interieur = type == NOEUD_INSCRIT ? ENTITE_FORMATION : type == NOEUD_PARTICIPANT ? ENTITE_PERSONNE : 0;
+        if( !lire_jeton( a ) )
+        {
+            return -1;
+        }
+        n = analyser_condition( a, liees | interieur, interieur ? interieur : defaut );
+        if( n < 0 )
+        {
+            return -1;
+        }
+        if( a->type != JETON_FERMANTE )
+        {
+            snprintf( a->r->erreur, sizeof( a->r->erreur ), ") attendue au lieu de '%s'", a->jeton );
+            return -1;
+        }
+        if( !lire_jeton( a ) )
+        {
+            return -1;
+        }
+        return type >= 0 ? nouveau_noeud( a, type, n, -1 ) : n;
+    }
+    return analyser_comparaison( a, liees, defaut );
+}
+
+/*
+ * Cette fonction sert a analyser une suite de facteurs separes par et.
+ */
+int analyser_terme( analyseur *a, int liees, int defaut )
+{
+    int n = analyser_facteur( a, liees, defaut );
+    while( n >= 0 && jeton_est( a, "et" ) )
+    {
+        int droite;
+        if( !lire_jeton( a ) || ( droite = analyser_facteur( a, liees, defaut ) ) < 0 )
+        {
+            return -1;
+        }
+        n = nouveau_noeud( a, NOEUD_ET, n, droite );
+    }
+    return n;
+}
+
+/*
+ * Cette fonction sert a analyser une suite de termes separes par ou.
+ */
+int analyser_condition( analyseur *a, int liees, int defaut )
+{
+    int n = analyser_terme( a, liees, defaut );
+    while( n >= 0 && jeton_est( a, "ou" ) )
+    {
+        int droite;
+        if( !lire_jeton( a ) || ( droite = analyser_terme( a, liees, defaut ) ) < 0 )
+        {
+            return -1;
+        }
+        n = nouveau_noeud( a, NOEUD_OU, n, droite );
+    }
+    return n;
+}
+
+/*
+ * Cette fonction sert a analyser le texte d'une requete dans *r.
+ * On renvoie 1 si reussite, 0 si le texte est invalide; r->erreur decrit alors le probleme.
+ */
+int analyser_requete( requete *r, const char *texte )
+{
+    analyseur a;
+    int liees = 0, defaut = 0;
+    memset( r, 0, sizeof( *r ) );
+    r->racine = -1;
+    r->tri = -1;
+    r->limite = -1;
+    a.c = texte;
+    a.r = r;
+    if( !lire_jeton( &a ) )
+    {
+        return 0;
+    }
+    if( jeton_est( &a, "personnes" ) )
+    {
+        r->source = SOURCE_PERSONNES;
+        liees = defaut = ENTITE_PERSONNE;
+    }
+    else if( jeton_est( &a, "formations" ) )
+    {
+        r->source = SOURCE_FORMATIONS;
+        liees = defaut = ENTITE_FORMATION;
+    }
+    else if( jeton_est( &a, "inscriptions" ) )
+    {
+        r->source = SOURCE_INSCRIPTIONS;
+        liees = ENTITE_PERSONNE | ENTITE_FORMATION;
+    }
+    else
+    {
+        snprintf( r->erreur, sizeof( r->erreur ), "personnes, formations ou inscriptions attendu au lieu de '%s'",
+                  a.jeton );
+        return 0;
+    }
+    if( !lire_jeton( &a ) )
+    {
+        return 0;
+    }
+    if( jeton_est( &a, "si" ) )
+    {
+        if( !lire_jeton( &a ) || ( r->racine = analyser_condition( &a, liees, defaut ) ) < 0 )
+        {
+            return 0;
+        }
+    }
+    if( jeton_est( &a, "tri" ) )
+    {
+        if( !lire_jeton( &a ) )
+        {
+            return 0;
+        }
+        r->tri = a.type == JETON_MOT ? trouver_champ_requete( &a, a.jeton, liees, defaut ) : -1;
+        if( r->tri < 0 || champs_requete[ r->tri ].liste )
+        {
+            if( r->tri >= 0 || a.type != JETON_MOT )
+            {
+                snprintf( r->erreur, sizeof( r->erreur ), "impossible de trier sur '%s'", a.jeton );
+            }
+            return 0;
+        }
+        if( !lire_jeton( &a ) )
+        {
+            return 0;
+        }
+        if( jeton_est( &a, "desc" ) )
+        {
+            r->descendant = 1;
+            if( !lire_jeton( &a ) )
+            {
+                return 0;
+            }
+        }
+    }
+    if( jeton_est( &a, "limite" ) )
+    {
+        char *fin;
+        if( !lire_jeton( &a ) )
+        {
+            return 0;
+        }
+        r->limite = strtol( a.jeton, &fin, 10 );
+        if( a.type != JETON_MOT || fin == a.jeton || *fin != '\0' || r->limite < 0 )
+        {
+            snprintf( r->erreur, sizeof( r->erreur ), "nombre attendu apres limite: '%s'", a.jeton );
+            return 0;
+        }
+        if( !lire_jeton( &a ) )
+        {
+            return 0;
+        }
+    }
+    if( a.type != JETON_FIN )
+    {
+        snprintf( r->erreur, sizeof( r->erreur ), "'%s' inattendu", a.jeton );
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Cette fonction sert a mettre dans valeurs les valeurs du champ numerique champ de la personne p ou de la
+ * formation f (une seule, sauf pour une liste; 30 au plus). On renvoie leur nombre.
+ * Le prix est donne en euros.
+ */
+int valeurs_champ_requete( int champ, personne *p, formation *f, double valeurs[] )
+{
+    int i, nb = 1;
+    switch( champ )
+    {
+        case CHAMP_PERSONNE_ID:
+            valeurs[0] = p->id;
+            break;
+        case CHAMP_FORMATEUR:
+            valeurs[0] = p->formateur;
+            break;
+        case CHAMP_REDUCTION:
+            valeurs[0] = p->formateur == 0 && p->reduction ? p->val_reduction : 0;
+            break;
+        case CHAMP_NB_FORMATIONS:
+            valeurs[0] = p->nb_formations;
+            break;
+        case CHAMP_JOURS_INDISPONIBLES:
+            nb = p->formateur ? p->nb_jours_indisponible : 0;
+            for( i = 0; i < nb; i++ )
+            {
+                valeurs[i] = p->jours_indisponible[i];
+            }
+            break;
+        case CHAMP_FORMATIONS:
+            nb = p->nb_formations;
+            for( i = 0; i < nb; i++ )
+            {
+                valeurs[i] = p->formations[i];
+            }
+            break;
+        case CHAMP_FORMATION_ID:
+            valeurs[0] = f->id;
+            break;
+        case CHAMP_PRIX:
+            valeurs[0] = f->prix / 100.0;
+            break;
+        case CHAMP_JOURS:
+            nb = f->nb_jours;
+            for( i = 0; i < nb; i++ )
+            {
+                valeurs[i] = f->jours[i];
+            }
+            break;
+        case CHAMP_PREREQUIS:
+            nb = f->nb_prerequis;
+            for( i = 0; i < nb; i++ )
+            {
+                valeurs[i] = f->prerequis[i];
+            }
+            break;
+        case CHAMP_PARTICIPANTS:
+            valeurs[0] = f->nb_inscrits - f->nb_desinscrits;
+            break;
+        default:
+            nb = 0;
+            break;
+    }
+    return nb;
+}
+
+/*
+ * Cette fonction renvoie la valeur du champ texte champ de la personne p ou de la formation f.
+ */
+const char *texte_champ_requete( int champ, personne *p, formation *f )
+{
+    if( champ == CHAMP_PERSONNE_NOM )
+    {
+        return p->nom;
+    }
+    return champ == CHAMP_PERSONNE_PRENOM ? p->prenom : f->nom;
+}
+
+/*
+ * Cette fonction renvoie 1 si le resultat res d'une comparaison (negatif, nul ou positif) verifie l'operateur op.
+ */
+int verifier_operateur( int op, int res )
+{
+    switch( op )
+    {
+        case OP_EGAL:
+            return res == 0;
+        case OP_DIFFERENT:
+            return res != 0;
+        case OP_INFERIEUR:
+            return res < 0;
+        case OP_INFERIEUR_EGAL:
+            return res <= 0;
+        case OP_SUPERIEUR:
+            return res > 0;
+        default:
+            return res >= 0;
+    }
+}
+
+/*
+ * Cette fonction renvoie 1 si la personne p et/ou la formation f verifient la condition du noeud n de r.
+ */
+int evaluer_noeud( requete *r, int n, db_formation *dbf, personne *p, formation *f )
+{
+    noeud_requete *noeud = &r->noeuds[n];
+    double valeurs[30];
+    int i, nb;
+    switch( noeud->type )
+    {
+        case NOEUD_ET:
+            return evaluer_noeud( r, noeud->gauche, dbf, p, f ) && evaluer_noeud( r, noeud->droite, dbf, p, f );
+        case NOEUD_OU:
+            return evaluer_noeud( r, noeud->gauche, dbf, p, f ) || evaluer_noeud( r, noeud->droite, dbf, p, f );
+        case NOEUD_NON:
+            return !evaluer_noeud( r, noeud->gauche, dbf, p, f );
+        case NOEUD_INSCRIT:
+            for( i = 0; i < p->nb_formations; i++ )
+            {
+                formation *tmpf = get_formation_par_id( dbf, p->formations[i] );
+                if( tmpf != NULL && evaluer_noeud( r, noeud->gauche, dbf, p, tmpf ) )
+                {
+                    return 1;
+                }
+            }
+            return 0;
+        case NOEUD_PARTICIPANT:
+            for( i = 0; i < f->nb_inscrits; i++ )
+            {
+                if( f->inscrits[i] != NULL && evaluer_noeud( r, noeud->gauche, dbf, f->inscrits[i], f ) )
+                {
+                    return 1;
+                }
+            }
+            return 0;
+        default:
+            break;
+    }
+    if( champs_requete[ noeud->champ ].texte )
+    {
+        const char *texte = texte_champ_requete( noeud->champ, p, f );
+        if( noeud->operateur == OP_CONTIENT )
+        {
+            return strstr( cle_pliee( texte ), noeud->texte ) != NULL;
+        }
+        if( noeud->operateur == OP_SEMBLABLE )
+        {
+            return strcmp( cle_pliee( texte ), noeud->texte ) == 0;
+        }
+        return verifier_operateur( noeud->operateur, strcmp( texte, noeud->texte ) );
+    }
+    nb = valeurs_champ_requete( noeud->champ, p, f, valeurs );
+    if( noeud->operateur == OP_DIFFERENT )
+    {
+        for( i = 0; i < nb && valeurs[i] != noeud->nombre; i++ )
+        {
+        }
+        return i == nb;
+    }
+    for( i = 0; i < nb; i++ )
+    {
+        if( verifier_operateur( noeud->operateur, valeurs[i] < noeud->nombre ? -1 : valeurs[i] > noeud->nombre ) )
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Cette fonction cherche, parmi les conditions reliees par et a partir du noeud n, une egalite sur le champ champ
+ * (si type vaut NOEUD_COMPARAISON) ou un noeud inscrit( ) ou participant( ) (si type vaut NOEUD_INSCRIT ou
+ * NOEUD_PARTICIPANT). Toute ligne qui verifie la condition verifie donc aussi le noeud trouve.
+ * On renvoie l'indice du noeud, -1 s'il n'y en a pas.
+ */
+int chercher_noeud_requete( requete *r, int n, int type, int champ )
+{
+    noeud_requete *noeud;
+    int res;
+    if( n < 0 )
+    {
+        return -1;
+    }
+    noeud = &r->noeuds[n];
+    if( noeud->type == NOEUD_ET )
+    {
+        res = chercher_noeud_requete( r, noeud->gauche, type, champ );
+        return res >= 0 ? res : chercher_noeud_requete( r, noeud->droite, type, champ );
+    }
+    if( noeud->type != type )
+    {
+        return -1;
+    }
+    return type != NOEUD_COMPARAISON || ( noeud->champ == champ && ( noeud->operateur == OP_EGAL ||
+                                                                      noeud->operateur == OP_SEMBLABLE ) ) ? n : -1;
+}
+
+/*
+ * Une ligne du resultat d'une requete: une personne (p), une formation (f) ou une inscription (les deux).
+ * int rang : L'ordre par defaut apres l'identifiant de la formation: l'identifiant de la personne, ou sa position
+ *            dans les inscrits pour une inscription.
+ * double cle, const char *cle_texte, *cle_texte2 : La valeur du champ de tri (cle_texte2: le prenom apres le nom).
+ * int signe : 1 pour un tri croissant, -1 pour un tri decroissant.
+ */
+typedef struct resultat_requete
+{
+    personne *p;
+    formation *f;
+    int rang;
+    double cle;
+    const char *cle_texte;
+    const char *cle_texte2;
+    int signe;
+} resultat_requete;
+
+/*
+ * Fonction de comparaison utilisee par qsort pour trier les resultats d'une requete: par le champ de tri, puis
+ * dans l'ordre par defaut.
+ */
+int comparer_resultats( const void *a, const void *b )
+{
+    const resultat_requete *ra = ( const resultat_requete * ) a;
+    const resultat_requete *rb = ( const resultat_requete * ) b;
+    int res;
+    if( ra->cle_texte != NULL )
+    {
+        res = comparer_noms( ra->cle_texte, rb->cle_texte );
+        if( res == 0 && ra->cle_texte2 != NULL )
+        {
+            res = comparer_noms( ra->cle_texte2, rb->cle_texte2 );
+        }
+    }
+    else
+    {
+        res = ra->cle < rb->cle ? -1 : ra->cle > rb->cle;
+    }
+    res *= ra->signe;
+    if( res == 0 && ra->f != NULL )
+    {
+        res = ra->f->id < rb->f->id ? -1 : ra->f->id > rb->f->id;
+    }
+    if( res == 0 )
+    {
+        res = ra->rang < rb->rang ? -1 : ra->rang > rb->rang;
+    }
+    return res;
+}
+
+/*
+ * L'etat de l'execution d'une requete.
+ * resultat_requete *resultats : Les lignes retenues, nb sur capacite.
+ * long arret : Le nombre de lignes apres lequel le parcours peut s'arreter, -1 s'il faut tout parcourir.
+ * unsigned char *vus : Les identifiants deja examines, quand un plan peut trouver deux fois la meme ligne.
+ */
+typedef struct execution_requete
+{
+    requete *r;
+    db_formation *dbf;
+    resultat_requete *resultats;
+    long nb;
+    long capacite;
+    long arret;
+    unsigned char *vus;
+} execution_requete;
+
+/*
+ * Cette fonction sert a examiner une ligne candidate: elle est retenue si elle verifie la condition.
+ * On renvoie 0 si le parcours peut s'arreter.
+ */
+int examiner_candidat( execution_requete *e, personne *p, formation *f, int rang )
+{
+    requete *r = e->r;
+    resultat_requete *res;
+    r->nb_examines += 1;
+    compter_visites( 1 );
+    if( r->racine >= 0 && !evaluer_noeud( r, r->racine, e->dbf, p, f ) )
+    {
+        return 1;
+    }
+    if( e->nb == e->capacite )
+    {
+        e->capacite = e->capacite ? e->capacite * 2 : 64;
+        e->resultats = ( resultat_requete * ) REALLOUER( e->resultats, e->capacite * sizeof( resultat_requete ),
+                                                        "resultats_requete" );
+        compter_octets( e->capacite / 2 * sizeof( resultat_requete ) );
+    }
+    res = &e->resultats[ e->nb++ ];
+    memset( res, 0, sizeof( *res ) );
+    res->p = p;
+    res->f = f;
+    res->rang = rang;
+    res->signe = r->descendant ? -1 : 1;
+    if( r->tri >= 0 && champs_requete[ r->tri ].texte )
+    {
+        res->cle_texte = texte_champ_requete( r->tri, p, f );
+        res->cle_texte2 = r->tri == CHAMP_PERSONNE_NOM ? p->prenom : NULL;
+    }
+    else if( r->tri >= 0 )
+    {
+        valeurs_champ_requete( r->tri, p, f, &res->cle );
+    }
+    return e->arret < 0 || e->nb < e->arret;
+}
+
+/*
+ * Cette fonction renvoie 1 la premiere fois qu'elle est appelee avec l'identifiant id, 0 ensuite.
+ */
+int premiere_visite( execution_requete *e, int id )
+{
+    int res = !( e->vus[ id >> 3 ] & ( 1 << ( id & 7 ) ) );
+    e->vus[ id >> 3 ] |= ( unsigned char ) ( 1 << ( id & 7 ) );
+    return res;
+}
+
+/*
+ * Cette fonction compare le nom interne nom a une valeur cherchee dans l'ordre de comparer_noms: d'abord sa cle
+ * pliee a cle, puis, si texte n'est pas NULL, le nom lui-meme a texte.
+ */
+int comparer_cle_nom( const char *nom, const char *cle, const char *texte )
+{
+    int res = strcmp( cle_pliee( nom ), cle );
+    return res != 0 || texte == NULL ? res : strcmp( nom, texte );
+}
+
+/*
+ * Cette fonction renvoie les personnes de db dont le nom a la cle pliee cle (et, si texte n'est pas NULL, est
+ * egal a texte), et met leur nombre dans *nb. Elles sont cherchees par dichotomie dans l'index par nom, ou elles
+ * sont consecutives.
+ */
+personne **plage_nom_personnes( db_personne *db, const char *cle, const char *texte, int *nb )
+{
+    int debut = 0, fin;
+    indexer_db_personne( db );
+    fin = db->nb;
+    while( debut < fin )
+    {
+        int milieu = ( debut + fin ) / 2;
+        if( comparer_cle_nom( db->par_nom[ milieu ]->nom, cle, texte ) < 0 )
+        {
+            debut = milieu + 1;
+        }
+        else
+        {
+            fin = milieu;
+        }
+    }
+    for( fin = debut; fin < db->nb && comparer_cle_nom( db->par_nom[ fin ]->nom, cle, texte ) == 0; fin++ )
+    {
+    }
+    *nb = fin - debut;
+    return db->par_nom + debut;
+}
+
+/*
+ * Cette fonction suit la meme logique que plage_nom_personnes pour les formations.
+ */
+formation **plage_nom_formations( db_formation *db, const char *cle, const char *texte, int *nb )
+{
+    int debut = 0, fin;
+    indexer_db_formation( db );
+    fin = db->nb;
+    while( debut < fin )
+    {
+        int milieu = ( debut + fin ) / 2;
+        if( comparer_cle_nom( db->par_nom[ milieu ]->nom, cle, texte ) < 0 )
+        {
+            debut = milieu + 1;
+        }
+        else
+        {
+            fin = milieu;
+        }
+    }
+    for( fin = debut; fin < db->nb && comparer_cle_nom( db->par_nom[ fin ]->nom, cle, texte ) == 0; fin++ )
+    {
+    }
+    *nb = fin - debut;
+    return db->par_nom + debut;
+}
+
+/*
+ * Cette fonction renvoie les personnes qui verifient l'egalite du noeud n (sur l'identifiant ou sur le nom) et
+ * met leur nombre dans *nb. Le nom est cherche par dichotomie dans l'index par nom, les personnes trouvees y
+ * sont consecutives: l'index est trie par cle pliee puis par nom, une egalite sans majuscules ni accents (~=)
+ * ne compare que la cle. *seule sert a renvoyer la personne trouvee par son identifiant.
+ */
+personne **candidats_personnes( db_personne *db, noeud_requete *n, personne **seule, int *nb )
+{
+    char cle[ LONGUEUR_NOM_MAX + 1 ];
+    const char *texte = n->operateur == OP_SEMBLABLE ? NULL : n->texte;
+    if( n->champ == CHAMP_PERSONNE_ID )
+    {
+        *seule = n->nombre >= 0 && n->nombre <= ID_MAX && n->nombre == ( int ) n->nombre ?
+                 get_personne_par_id( db, ( int ) n->nombre ) : NULL;
+        *nb = *seule != NULL;
+        return seule;
+    }
+    plier_nom( n->texte, cle );
+    return plage_nom_personnes( db, cle, texte, nb );
+}
+
+/*
+ * Cette fonction suit la meme logique que candidats_personnes pour les formations.
+ */
+formation **candidats_formations( db_formation *db, noeud_requete *n, formation **seule, int *nb )
+{
+    char cle[ LONGUEUR_NOM_MAX + 1 ];
+    const char *texte = n->operateur == OP_SEMBLABLE ? NULL : n->texte;
+    if( n->champ == CHAMP_FORMATION_ID )
+    {
+        *seule = n->nombre >= 0 && n->nombre <= ID_MAX && n->nombre == ( int ) n->nombre ?
+                 get_formation_par_id( db, ( int ) n->nombre ) : NULL;
+        *nb = *seule != NULL;
+        return seule;
+    }
+    plier_nom( n->texte, cle );
+    return plage_nom_formations( db, cle, texte, nb );
+}
+
+/*
+ * Cette fonction renvoie le noeud d'egalite sur l'identifiant, ou a defaut sur le nom, de l'entite entite parmi
+ * les conditions reliees par et a partir du noeud n. On renvoie -1 s'il n'y en a pas.
+ */
+int chercher_egalite_requete( requete *r, int n, int entite )
+{
+    int res = chercher_noeud_requete( r, n, NOEUD_COMPARAISON,
+                                      entite == ENTITE_PERSONNE ? CHAMP_PERSONNE_ID : CHAMP_FORMATION_ID );
+    if( res < 0 )
+    {
+        res = chercher_noeud_requete( r, n, NOEUD_COMPARAISON,
+                                      entite == ENTITE_PERSONNE ? CHAMP_PERSONNE_NOM : CHAMP_FORMATION_NOM );
+    }
+    return res;
+}
+
+/*
+ * Cette fonction sert a parcourir toutes les lignes de la source de r, les bases de donnees dans l'ordre ordre
+ * (ORDRE_ID ou ORDRE_NOM) et les inscrits de chaque formation dans leur ordre d'inscription.
+ */
+void parcourir_requete( execution_requete *e, db_formation *dbf, db_personne *dbp, int ordre )
+{
+    curseur_personne cp;
+    curseur_formation cf;
+    personne *tmpp;
+    formation *tmpf;
+    int i;
+    if( e->r->source == SOURCE_PERSONNES )
+    {
+        for( tmpp = debut_curseur_personne( &cp, dbp, ordre ); tmpp != NULL; tmpp = suivant_curseur_personne( &cp ) )
+        {
+            if( !examiner_candidat( e, tmpp, NULL, tmpp->id ) )
+            {
+                return;
+            }
+        }
+        return;
+    }
+    for( tmpf = debut_curseur_formation( &cf, dbf, ordre ); tmpf != NULL; tmpf = suivant_curseur_formation( &cf ) )
+    {
+        if( e->r->source == SOURCE_FORMATIONS )
+        {
+            if( !examiner_candidat( e, NULL, tmpf, 0 ) )
+            {
+                return;
+            }
+            continue;
+        }
+        for( i = 0; i < tmpf->nb_inscrits; i++ )
+        {
+            if( tmpf->inscrits[i] != NULL && !examiner_candidat( e, tmpf->inscrits[i], tmpf, i ) )
+            {
+                return;
+            }
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a executer la requete r. Le plan est choisi ainsi:
+ * - une egalite sur l'identifiant ou le nom de la source (reliee au reste par et) limite les candidats a la
+ *   personne ou la formation trouvee par get_*_par_id ou par dichotomie dans l'index par nom;
+ * - sinon, pour les personnes, une telle egalite dans inscrit( ) limite les candidats aux participants des
+ *   formations trouvees, et pour les formations une egalite dans participant( ) aux formations des personnes
+ *   trouvees; pour les inscriptions, une egalite sur la formation ou sur la personne fait de meme;
+ * - sinon toute la source est parcourue une fois, dans l'ordre du tri s'il s'agit de l'identifiant ou du nom, ce
+ *   qui permet de s'arreter des que la limite est atteinte.
+ * Les lignes retenues sont mises dans *resultats (a liberer), triees et limitees. On renvoie leur nombre.
+ */
+long executer_requete( requete *r, db_formation *dbf, db_personne *dbp, resultat_requete **resultats )
+{
+    execution_requete e;
+    chrono ch;
+    int n, sous = -1, i, k, nb, ordre = ORDRE_ID, trie = 0, id_source, nom_source;
+    personne *seule_p, **pp;
+    formation *seule_f, **ff;
+    demarrer_compteur( &ch, CPT_REQUETE );
+    memset( &e, 0, sizeof( e ) );
+    e.r = r;
+    e.dbf = dbf;
+    e.arret = -1;
+    r->nb_examines = 0;
+    id_source = r->source == SOURCE_PERSONNES ? CHAMP_PERSONNE_ID : CHAMP_FORMATION_ID;
+    nom_source = r->source == SOURCE_PERSONNES ? CHAMP_PERSONNE_NOM : CHAMP_FORMATION_NOM;
+    n = chercher_egalite_requete( r, r->racine, r->source == SOURCE_PERSONNES ? ENTITE_PERSONNE : ENTITE_FORMATION );
+    if( n < 0 && r->source != SOURCE_INSCRIPTIONS )
+    {
+        sous = chercher_noeud_requete( r, r->racine,
+                                       r->source == SOURCE_PERSONNES ? NOEUD_INSCRIT : NOEUD_PARTICIPANT, 0 );
+        if( sous >= 0 )
+        {
+            n = chercher_egalite_requete( r, r->noeuds[ sous ].gauche,
+                                          r->source == SOURCE_PERSONNES ? ENTITE_FORMATION : ENTITE_PERSONNE );
+        }
+    }
+    else if( n < 0 )
+    {
+        n = chercher_egalite_requete( r, r->racine, ENTITE_PERSONNE );
+    }
+    if( n < 0 )
+    {
+        if( r->tri == nom_source && !r->descendant )
+        {
+            ordre = ORDRE_NOM;
+            trie = 1;
+        }
+        else if( r->tri < 0 || ( r->tri == id_source && !r->descendant ) )
+        {
+            trie = 1;
+        }
+        e.arret = trie ? r->limite : -1;
+        r->plan = ordre == ORDRE_NOM ? "parcours complet dans l'ordre des noms" : "parcours complet";
+        if( e.arret != 0 )
+        {
+            parcourir_requete( &e, dbf, dbp, ordre );
+        }
+    }
+    else if( champs_requete[ r->noeuds[n].champ ].entite == ENTITE_PERSONNE )
+    {
+        pp = candidats_personnes( dbp, &r->noeuds[n], &seule_p, &nb );
+        r->plan = r->noeuds[n].champ == CHAMP_PERSONNE_ID ? "personne trouvee par identifiant" :
+                  "personnes trouvees par l'index des noms";
+        if( r->source == SOURCE_FORMATIONS )
+        {
+            e.vus = ( unsigned char * ) ALLOUER( dbf->nb_pages * TAILLE_PAGE / 8 + 1, 1, "requete_vus" );
+        }
+        for( i = 0; i < nb; i++ )
+        {
+            if( r->source == SOURCE_PERSONNES )
+            {
+                examiner_candidat( &e, pp[i], NULL, pp[i]->id );
+                continue;
+            }
+            for( k = 0; k < pp[i]->nb_formations; k++ )
+            {
+                formation *tmpf = get_formation_par_id( dbf, pp[i]->formations[k] );
+                int rang = 0;
+                if( tmpf == NULL )
+                {
+                    continue;
+                }
+                if( r->source == SOURCE_FORMATIONS )
+                {
+                    if( premiere_visite( &e, tmpf->id ) )
+                    {
+                        examiner_candidat( &e, NULL, tmpf, 0 );
+                    }
+                    continue;
+                }
+                while( rang < tmpf->nb_inscrits && tmpf->inscrits[ rang ] != pp[i] )
+                {
+                    rang++;
+                }
+                examiner_candidat( &e, pp[i], tmpf, rang );
+            }
+        }
+    }
+    else
+    {
+        ff = candidats_formations( dbf, &r->noeuds[n], &seule_f, &nb );
+        r->plan = r->noeuds[n].champ == CHAMP_FORMATION_ID ? "formation trouvee par identifiant" :
+                  "formations trouvees par l'index des noms";
+        if( r->source == SOURCE_PERSONNES )
+        {
+            e.vus = ( unsigned char * ) ALLOUER( dbp->nb_pages * TAILLE_PAGE / 8 + 1, 1, "requete_vus" );
+        }
+        for( i = 0; i < nb; i++ )
+        {
+            if( r->source == SOURCE_FORMATIONS )
+            {
+                examiner_candidat( &e, NULL, ff[i], 0 );
+                continue;
+            }
+            for( k = 0; k < ff[i]->nb_inscrits; k++ )
+            {
+                personne *tmpp = ff[i]->inscrits[k];
+                if( tmpp == NULL )
+                {
+                    continue;
+                }
+                if( r->source == SOURCE_PERSONNES )
+                {
+                    if( premiere_visite( &e, tmpp->id ) )
+                    {
+                        examiner_candidat( &e, tmpp, NULL, tmpp->id );
+                    }
+                    continue;
+                }
+                examiner_candidat( &e, tmpp, ff[i], k );
+            }
+        }
+    }
+    LIBERER( e.vus );
+    if( !trie && e.nb > 1 )
+    {
+        qsort( e.resultats, e.nb, sizeof( resultat_requete ), comparer_resultats );
+    }
+    if( r->limite >= 0 && e.nb > r->limite )
+    {
+        e.nb = r->limite;
+    }
+    arreter_compteur( &ch );
+    *resultats = e.resultats;
+    return e.nb;
+}
+
+/*
+ * Cette fonction sert a ecrire la ligne d'entete des resultats de la requete r, avec les memes colonnes que la
+ * commande exporter.
+ */
+void exporter_entete_requete( exporteur *ex, requete *r )
+{
+    if( r->source == SOURCE_PERSONNES )
+    {
+        exporter_entete( ex, colonnes_personnes, 6 );
+    }
+    else if( r->source == SOURCE_FORMATIONS )
+    {
+        exporter_entete( ex, colonnes_formations, 8 );
+    }
+    else
+    {
+        exporter_entete( ex, colonnes_inscriptions, 3 );
+    }
+}
+
+/*
+ * Cette fonction sert a ecrire les nb resultats d'une requete avec l'exporteur ex, sans la ligne d'entete.
+ */
+void exporter_lignes_requete( exporteur *ex, requete *r, resultat_requete *resultats, long nb )
+{
+    long i;
+    for( i = 0; i < nb; i++ )
+    {
+        if( r->source == SOURCE_PERSONNES )
+        {
+            exporter_personne( ex, resultats[i].p );
+        }
+        else if( r->source == SOURCE_FORMATIONS )
+        {
+            exporter_formation( ex, resultats[i].f );
+        }
+        else
+        {
+            exporter_inscription( ex, resultats[i].f, resultats[i].p );
+        }
+    }
+}
+
+/*
+ * Cette fonction sert a ecrire les nb resultats d'une requete avec l'exporteur ex, avec les memes colonnes que la
+ * commande exporter.
+ */
+void exporter_resultats_requete( exporteur *ex, requete *r, resultat_requete *resultats, long nb )
+{
+    exporter_entete_requete( ex, r );
+    exporter_lignes_requete( ex, r, resultats, nb );
+}
+
+/*
+ * Cette structure decrit une requete a executer, pour ecrire_requete_fichier.
+ */
+typedef struct demande_requete
+{
+    paire_db bases;
+    requete *r;
+    int format;
+    unsigned long nb_lignes;
+} demande_requete;
+
+/*
+ * Cette fonction sert a executer la requete decrite par db et a ecrire ses resultats dans fichier, elle peut
+ * etre passee a ecrire_fichier_atomique.
+ */
+void ecrire_requete_fichier( void *db, FILE *fichier )
+{
+    demande_requete *d = ( demande_requete * ) db;
+    resultat_requete *resultats;
+    long nb = executer_requete( d->r, d->bases.dbf, d->bases.dbp, &resultats );
+    exporteur ex;
+    ex.sortie = fichier;
+    ex.format = d->format;
+    ex.premier = 1;
+    ex.nb_lignes = 0;
+    ex.annee = NULL;
+    exporter_resultats_requete( &ex, d->r, resultats, nb );
+    LIBERER( resultats );
+    d->nb_lignes = ex.nb_lignes;
+}
+
+/*
+ * Menu permettant d'executer une requete et d'afficher ses resultats en CSV.
+ */
+void menu_requete( db_formation *dbf, db_personne *dbp )
+{
+    char texte[512];
+    requete *r;
+    demande_requete d;
+    size_t n;
+    printf( "********************************************************************************\n" );
+    printf( "* REQUETE                                                                      *\n" );
+    printf( "********************************************************************************\n" );
+    printf( "* personnes | formations | inscriptions                                        *\n" );
+    printf( "*     [si condition] [tri champ [desc]] [limite n]                             *\n" );
+    printf( "* Personnes: id nom prenom formateur reduction nb_formations                   *\n" );
+    printf( "*     jours_indisponibles formations inscrit( condition sur la formation )     *\n" );
+    printf( "* Formations: id nom prix jours prerequis participants                         *\n" );
+    printf( "*     participant( condition sur la personne )                                 *\n" );
+    printf( "* Operateurs: = != < <= > >= ~ (contient), et, ou, non, ( )                    *\n" );
+    printf( "* Ex: personnes si reduction > 20 et inscrit( nom = Java et jours = mardi )    *\n" );
+    printf( "********************************************************************************\n" );
+    printf( "* Requete ? " );
+    if( fgets( texte, sizeof( texte ), stdin ) == NULL )
+    {
+        return;
+    }
+    n = strlen( texte );
+    if( n > 0 && texte[ n - 1 ] == '\n' )
+    {
+        texte[ n - 1 ] = '\0';
+    }
+    system( clear );
+    r = ( requete * ) ALLOUER( 1, sizeof( requete ), "requete" );
+    if( !analyser_requete( r, texte ) )
+    {
+        printf( "/!\\ Requete invalide: %s /!\\\n", r->erreur );
+        LIBERER( r );
+        return;
+    }
+    d.bases.dbf = dbf;
+    d.bases.dbp = dbp;
+    d.r = r;
+    d.format = EXPORT_CSV;
+    ecrire_requete_fichier( &d, stdout );
+    printf( "* %lu resultat(s) - %s, %lu candidat(s) examine(s) *\n", d.nb_lignes, r->plan, r->nb_examines );
+    LIBERER( r );
+}
+
+int nb_partitions_choisies();
+void ecrire_requete_partitions( void *db, FILE *fichier );
+void bilan_partitions( FILE *sortie );
+
+/*
+ * Commande requete: charge les fichiers .dat du dossier courant, execute la requete (les arguments restants,
+ * separes par des espaces) et ecrit ses resultats en CSV ou en JSON Lines, avec les colonnes de la commande
+ * exporter. Avec -x, le plan choisi et le nombre de candidats examines sont affiches sur la sortie d'erreur.
+ * Si plusieurs partitions sont choisies, la requete est executee dans chacune d'elles (voir
+ * ecrire_requete_partitions).
+ */
+int commande_requete( int argc, char *argv[] )
+{
+    demande_requete d;
+    void ( *ecrire )( void *db, FILE *fichier ) = ecrire_requete_fichier;
+    const char *fichier = NULL;
+    char texte[1024];
+    size_t n = 0;
+    int i, res = 1, expliquer = 0;
+    d.format = EXPORT_CSV;
+    for( i = 0; i < argc && argv[i][0] == '-'; i++ )
+    {
+        if( strcmp( argv[i], "-x" ) == 0 )
+        {
+            expliquer = 1;
+        }
+        else if( i + 1 < argc && strcmp( argv[i], "-f" ) == 0 && strcmp( argv[ i + 1 ], "csv" ) == 0 )
+        {
+            d.format = EXPORT_CSV;
+            i++;
+        }
+        else if( i + 1 < argc && strcmp( argv[i], "-f" ) == 0 && strcmp( argv[ i + 1 ], "jsonl" ) == 0 )
+        {
+            d.format = EXPORT_JSONL;
+            i++;
+        }
+        else if( i + 1 < argc && strcmp( argv[i], "-o" ) == 0 )
+        {
+            fichier = argv[ ++i ];
+        }
+        else
+        {
+            break;
+        }
+    }
+    texte[0] = '\0';
+    for( ; i < argc && n + strlen( argv[i] ) + 1 < sizeof( texte ); i++ )
+    {
+        n += sprintf( texte + n, "%s%s", n > 0 ? " " : "", argv[i] );
+    }
+    if( i != argc || n == 0 )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski requete [-f csv|jsonl] [-o fichier] [-x] "
+                         "personnes|formations|inscriptions [si condition] [tri champ [desc]] [limite n]\n" );
+        return 1;
+    }
+    d.r = ( requete * ) ALLOUER( 1, sizeof( requete ), "requete" );
+    if( !analyser_requete( d.r, texte ) )
+    {
+        fprintf( stderr, "Requete invalide: %s\n", d.r->erreur );
+        LIBERER( d.r );
+        return 1;
+    }
+    d.bases.dbp = NULL;
+    d.bases.dbf = NULL;
+    if( nb_partitions_choisies() > 1 )
+    {
+        ecrire = ecrire_requete_partitions;
+    }
+    else
+    {
+        d.bases.dbp = creer_db_personne();
+        d.bases.dbf = creer_db_formation();
+        charger_db( d.bases.dbf, d.bases.dbp );
+    }
+    if( fichier != NULL )
+    {
+        res = ecrire_fichier_atomique( fichier, ecrire, &d );
+        if( !res )
+        {
+            fprintf( stderr, "Impossible d'ecrire %s\n", fichier );
+        }
+    }
+    else
+    {
+        ecrire( &d, stdout );
+        res = fflush( stdout ) == 0;
+    }
+    if( expliquer || fichier != NULL )
+    {
+        fprintf( stderr, "%lu resultat(s) - %s, %lu candidat(s) examine(s)\n", d.nb_lignes, d.r->plan,
+                 d.r->nb_examines );
+    }
+    if( expliquer && d.bases.dbp == NULL )
+    {
+        bilan_partitions( stderr );
+    }
+    LIBERER( d.r );
+    if( d.bases.dbp != NULL )
+    {
+        liberer_db_personne( d.bases.dbp );
+        liberer_db_formation( d.bases.dbf );
+    }
+    return res ? 0 : 1;
+}
+
+/*                               FIN REQUETES                                */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                             EMPLOIS DU TEMPS                              */
+
+/*
+ * Nombre de personnes traitees par une tranche des emplois du temps.
+ */
+#define TAILLE_TRANCHE_EMPLOIS 256
+
+/*
+ * En dessous de ce nombre de personnes, les emplois du temps sont construits sans threads.
+ */
+#define SEUIL_EMPLOIS_PARALLELE 1024
+
+/*
+ * Nombre de tranches construites par ouvrier avant d'etre ecrites, la memoire occupee par les tampons ne depend
+ * donc pas du nombre de personnes.
+ */
+#define TRANCHES_PAR_OUVRIER 4
+
+/*
+ * Une seance de l'emploi du temps d'une personne: le jour (1 a 7), la seance et sa formation.
+ */
+typedef struct seance_emploi
+{
+    int jour;
+    seance s;
+    formation *f;
+} seance_emploi;
+
+/*
+ * Cette structure decrit une tranche des emplois du temps: les personnes de la position debut (incluse) a la
+ * position fin (exclue). Chaque tranche est construite par un ouvrier dans son propre tampon.
+ * db_formation *dbf : Les formations, seulement lues pendant la construction.
+ * personne **personnes : Les personnes, triees par identifiant.
+ * const char *dossier : Si non NULL, chaque emploi du temps est ecrit dans son propre fichier de ce dossier
+ * par l'ouvrier, et sortie reste vide.
+ * tampon sortie : Le texte produit par la tranche.
+ * int nb_erreurs : Le nombre de fichiers qui n'ont pas pu etre ecrits.
+ * unsigned long nb_seances : Le nombre de seances ecrites.
+ */
+typedef struct tranche_emplois
+{
+    db_formation *dbf;
+    personne **personnes;
+    int debut;
+    int fin;
+    const char *dossier;
+    tampon sortie;
+    int nb_erreurs;
+    unsigned long nb_seances;
+} tranche_emplois;
+
+/*
+ * Fonction de comparaison utilisee par qsort pour trier les seances d'un emploi du temps par jour, puis comme
+ * comparer_seances.
+ */
+int comparer_seances_emploi( const void *a, const void *b )
+{
+    const seance_emploi *sa = ( const seance_emploi * ) a;
+    const seance_emploi *sb = ( const seance_emploi * ) b;
+    if( sa->jour != sb->jour )
+    {
+        return sa->jour - sb->jour;
+    }
+    return comparer_seances( &sa->s, &sb->s );
+}
+
+/*
+ * Cette fonction sert a ecrire dans le tampon t l'emploi du temps de la semaine de la personne *p: ses seances
+ * jour par jour, triees par heure. Seules les formations de la personne sont lues (30 au plus), le cout ne
+ * depend pas de la taille de la base de donnees. On renvoie le nombre de seances ecrites.
+ */
+int rendre_emploi_du_temps( tampon *t, db_formation *dbf, personne *p )
+{
+    char nom_jour[7][9] = { "Lundi", "Mardi", "Mercredi", "Jeudi", "Vendredi", "Samedi", "Dimanche" };
+    seance_emploi seances[ 30 * 7 ];
+    int nb = 0, jour = 0, i, j;
+    for( i = 0; i < p->nb_formations && i < 30; i++ )
+    {
+        formation *f = get_formation_par_id( dbf, p->formations[i] );
+        if( f == NULL )
+        {
+            continue;
+        }
+        for( j = 0; j < f->nb_jours && j < 7; j++ )
+        {
+            if( f->jours[j] < 1 || f->jours[j] > 7 )
+            {
+                continue;
+            }
+            seances[ nb ].jour = f->jours[j];
+            seances[ nb ].s.formation = f->id;
+            seances[ nb ].s.creneau = j;
+            seances[ nb ].s.debut = f->heures[j];
+            seances[ nb ].s.fin = f->heures[j] + f->durees[j];
+            seances[ nb ].f = f;
+            nb += 1;
+        }
+    }
+    if( nb > 1 )
+    {
+        qsort( seances, nb, sizeof( seance_emploi ), comparer_seances_emploi );
+    }
+    tampon_printf( t, "********************************************************************************\n" );
+    tampon_printf( t, "Emploi du temps de: %d %s %s (%s)\n", p->id, p->nom, p->prenom,
+                   p->formateur ? "Formateur" : "Etudiant" );
+    tampon_printf( t, "********************************************************************************\n" );
+    for( i = 0; i < nb; i++ )
+    {
+        if( seances[i].jour != jour )
+        {
+            jour = seances[i].jour;
+            tampon_printf( t, "%s:\n", nom_jour[ jour - 1 ] );
+        }
+        tampon_printf( t, "De: %2d.%02d - A %2d.%02d  %2d %s\n", HORAIRE( seances[i].s.debut ),
+                       HORAIRE( seances[i].s.fin ), seances[i].f->id, seances[i].f->nom );
+    }
+    if( nb == 0 )
+    {
+        tampon_printf( t, "Aucune seance\n" );
+    }
+    tampon_printf( t, "\n" );
+    return nb;
+}
+
+/*
+ * Cette fonction sert a ecrire le contenu du tampon db dans le fichier fichier, elle peut etre passee a
+ * ecrire_fichier_atomique.
+ */
+void ecrire_tampon_fichier( void *db, FILE *fichier )
+{
+    tampon *t = ( tampon * ) db;
+    if( t->taille > 0 )
+    {
+        fwrite( t->donnees, 1, t->taille, fichier );
+    }
+}
+
+/*
+ * Cette fonction est la tache executee par le pool pour une tranche des emplois du temps. Les emplois du temps
+ * sont ajoutes a la sortie de la tranche, ou ecrits chacun dans le fichier EmploiDuTemps_<id>.txt du dossier de
+ * la tranche.
+ */
+void construire_tranche_emplois( void *arg )
+{
+    tranche_emplois *tr = ( tranche_emplois * ) arg;
+    char chemin[ 256 ];
     int i;
-    char nom[40];
-    float prix;
-    printf( "* Nom de la formation: " );
-    fgets( nom, 40, stdin );
-    if( strlen( nom ) > 0 && nom[ strlen( nom ) - 1 ] == '\n' )
+    for( i = tr->debut; i < tr->fin; i++ )
+    {
+        tr->nb_seances += rendre_emploi_du_temps( &tr->sortie, tr->dbf, tr->personnes[i] );
+        if( tr->dossier == NULL )
+        {
+            continue;
+        }
+        sprintf( chemin, "%.200s/EmploiDuTemps_%d.txt", tr->dossier, tr->personnes[i]->id );
+        if( !ecrire_fichier_atomique( chemin, ecrire_tampon_fichier, &tr->sortie ) )
+        {
+            tr->nb_erreurs += 1;
+        }
+        tr->sortie.taille = 0;
+    }
+}
+
+/*
+ * Cette fonction sert a ecrire l'emploi du temps de chaque personne de dbp, par identifiant croissant, dans le
+ * flux sortie, ou dans un fichier par personne du dossier dossier si dossier n'est pas NULL (sortie est alors
+ * ignore). Les personnes sont decoupees en tranches de TAILLE_TRANCHE_EMPLOIS construites en parallele par un pool
+ * d'ouvriers, puis ecrites dans l'ordre par vagues de TRANCHES_PAR_OUVRIER tranches par ouvrier.
+ * Chaque inscription n'est lue qu'une fois. On renvoie le nombre de fichiers qui n'ont pas pu etre ecrits.
+ */
+int ecrire_emplois_du_temps( db_formation *dbf, db_personne *dbp, FILE *sortie, const char *dossier,
+                             unsigned long *nb_seances )
+{
+    curseur_personne c;
+    personne *tmpp;
+    personne **personnes;
+    tranche_emplois *tranches;
+    pool_taches *pool;
+    chrono ch;
+    int nb_personnes = dbp->nb, nb_ouvriers, nb_vague, nb_erreurs = 0, i, t, premiere;
+    demarrer_compteur( &ch, CPT_EMPLOIS_DU_TEMPS );
+    personnes = ( personne ** ) ALLOUER( nb_personnes + 1, sizeof( personne * ), "emplois_du_temps" );
+    for( i = 0, tmpp = debut_curseur_personne( &c, dbp, ORDRE_ID ); tmpp != NULL && i < nb_personnes;
+         i++, tmpp = suivant_curseur_personne( &c ) )
+    {
+        personnes[i] = tmpp;
+    }
+    nb_personnes = i;
+    nb_ouvriers = nb_personnes < SEUIL_EMPLOIS_PARALLELE ? 0 : nombre_processeurs();
+    nb_vague = ( nb_ouvriers > 0 ? nb_ouvriers : 1 ) * TRANCHES_PAR_OUVRIER;
+    tranches = ( tranche_emplois * ) ALLOUER( nb_vague, sizeof( tranche_emplois ), "tranche_emplois" );
+    compter_octets( ( nb_personnes + 1 ) * sizeof( personne * ) + nb_vague * sizeof( tranche_emplois ) );
+    pool = creer_pool_taches( nb_ouvriers );
+    *nb_seances = 0;
+    for( premiere = 0; premiere < nb_personnes; premiere += nb_vague * TAILLE_TRANCHE_EMPLOIS )
+    {
+        int nb_tranches = 0;
+        for( t = 0; t < nb_vague && premiere + t * TAILLE_TRANCHE_EMPLOIS < nb_personnes; t++ )
+        {
+            tranches[t].dbf = dbf;
+            tranches[t].personnes = personnes;
+            tranches[t].debut = premiere + t * TAILLE_TRANCHE_EMPLOIS;
+            tranches[t].fin = tranches[t].debut + TAILLE_TRANCHE_EMPLOIS;
+            if( tranches[t].fin > nb_personnes )
+            {
+                tranches[t].fin = nb_personnes;
+            }
+            tranches[t].dossier = dossier;
+            tranches[t].nb_erreurs = 0;
+            tranches[t].nb_seances = 0;
+            initialiser_tampon( &tranches[t].sortie );
+            soumettre_tache( pool, construire_tranche_emplois, &tranches[t] );
+            nb_tranches += 1;
+        }
+        attendre_pool_taches( pool );
+        for( t = 0; t < nb_tranches; t++ )
+        {
+            if( dossier == NULL && tranches[t].sortie.taille > 0 )
+            {
+                fwrite( tranches[t].sortie.donnees, 1, tranches[t].sortie.taille, sortie );
+            }
+            nb_erreurs += tranches[t].nb_erreurs;
+            *nb_seances += tranches[t].nb_seances;
+            compter_octets( tranches[t].sortie.capacite );
+            liberer_tampon( &tranches[t].sortie );
+        }
+    }
+    detruire_pool_taches( pool );
+    compter_visites( ( unsigned long ) nb_personnes + *nb_seances );
+    LIBERER( tranches );
+    LIBERER( personnes );
+    arreter_compteur( &ch );
+    return nb_erreurs;
+}
+
+/*
+ * Menu permettant d'afficher l'emploi du temps d'une personne choisie par son identifiant.
+ */
+void menu_emploi_du_temps( db_formation *dbf, db_personne *dbp )
+{
+    personne *p;
+    tampon t;
+    int id;
+    printf( "* Identifiant de la personne (0 pour revenir) ? " );
+    while( scanf( "%d", &id ) != 1 || ( id != 0 && get_personne_par_id( dbp, id ) == NULL ) )
+    {
+        getchar();
+        printf( "* Option INVALIDE: aucune personne avec cet identifiant\n" );
+        printf( "* Identifiant de la personne (0 pour revenir) ? " );
+    }
+    getchar();
+    system( clear );
+    if( id == 0 )
+    {
+        return;
+    }
+    p = get_personne_par_id( dbp, id );
+    initialiser_tampon( &t );
+    rendre_emploi_du_temps( &t, dbf, p );
+    ecrire_tampon_fichier( &t, stdout );
+    liberer_tampon( &t );
+}
+
+/*
+ * Cette structure decrit une generation des emplois du temps dans un seul fichier, pour
+ * ecrire_emplois_du_temps_fichier.
+ */
+typedef struct demande_emplois
+{
+    paire_db bases;
+    int nb_erreurs;
+    unsigned long nb_seances;
+} demande_emplois;
+
+/*
+ * Cette fonction sert a ecrire les emplois du temps decrits par db dans le fichier fichier, elle peut etre
+ * passee a ecrire_fichier_atomique.
+ */
+void ecrire_emplois_du_temps_fichier( void *db, FILE *fichier )
+{
+    demande_emplois *d = ( demande_emplois * ) db;
+    d->nb_erreurs = ecrire_emplois_du_temps( d->bases.dbf, d->bases.dbp, fichier, NULL, &d->nb_seances );
+}
+
+/*
+ * Commande emplois: charge les fichiers .dat du dossier courant et ecrit l'emploi du temps de la semaine de
+ * chaque personne, a la suite sur la sortie standard ou dans un fichier (-o), ou dans un fichier
+ * EmploiDuTemps_<id>.txt par personne dans un dossier existant (-d).
+ */
+int commande_emplois( int argc, char *argv[] )
+{
+    demande_emplois d;
+    const char *fichier = NULL, *dossier = NULL;
+    int i, res = 1;
+    for( i = 0; i + 1 < argc; i += 2 )
+    {
+        if( strcmp( argv[i], "-o" ) == 0 )
+        {
+            fichier = argv[ i + 1 ];
+        }
+        else if( strcmp( argv[i], "-d" ) == 0 )
+        {
+            dossier = argv[ i + 1 ];
+        }
+        else
+        {
+            break;
+        }
+    }
+    if( i != argc || ( fichier != NULL && dossier != NULL ) )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski emplois [-o fichier | -d dossier]\n" );
+        return 1;
+    }
+    d.bases.dbp = creer_db_personne();
+    d.bases.dbf = creer_db_formation();
+    charger_db( d.bases.dbf, d.bases.dbp );
+    d.nb_erreurs = 0;
+    d.nb_seances = 0;
+    if( dossier != NULL )
+    {
+        d.nb_erreurs = ecrire_emplois_du_temps( d.bases.dbf, d.bases.dbp, NULL, dossier, &d.nb_seances );
+        res = d.nb_erreurs == 0;
+        if( !res )
+        {
+            fprintf( stderr, "%d fichier(s) n'ont pas pu etre ecrits dans %s\n", d.nb_erreurs, dossier );
+        }
+    }
+    else if( fichier != NULL )
+    {
+        res = ecrire_fichier_atomique( fichier, ecrire_emplois_du_temps_fichier, &d );
+        if( !res )
+        {
+            fprintf( stderr, "Impossible d'ecrire %s\n", fichier );
+        }
+    }
+    else
+    {
+        ecrire_emplois_du_temps_fichier( &d, stdout );
+        res = fflush( stdout ) == 0;
+    }
+    if( res && ( fichier != NULL || dossier != NULL ) )
+    {
+        fprintf( stderr, "%d emploi(s) du temps, %lu seance(s) ecrite(s)\n", d.bases.dbp->nb, d.nb_seances );
+    }
+    liberer_db_personne( d.bases.dbp );
+    liberer_db_formation( d.bases.dbf );
+    return res ? 0 : 1;
+}
+
+/*                           FIN EMPLOIS DU TEMPS                            */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                FORMATEURS                                 */
+
+/*
+ * Cette structure regroupe la disponibilite et la charge de tous les formateurs, pour chercher rapidement ceux
+ * qui sont libres a un moment donne.
+ * disponibilite_formateur *formateurs : Les formateurs, par identifiant croissant.
+ * int nb : Le nombre de formateurs.
+ * disponibilite_formateur **par_charge : Les formateurs, du moins charge au plus charge.
+ * int nb_mots : La taille de chaque vecteur disponibles.
+ * unsigned int *disponibles[7] : Vecteurs de bits, le bit i de disponibles[j] vaut 1 si le formateur
+ * par_charge[i] n'est pas indisponible le jour j + 1. Un mot entier de formateurs indisponibles est saute d'un
+ * coup, et les formateurs trouves sont deja dans l'ordre de leur charge.
+ */
+typedef struct index_formateurs
+{
+    disponibilite_formateur *formateurs;
+    int nb;
+    disponibilite_formateur **par_charge;
+    int nb_mots;
+    unsigned int *disponibles[7];
+} index_formateurs;
+
+/*
+ * Fonction de comparaison utilisee par qsort pour trier des formateurs du moins charge au plus charge, puis par
+ * identifiant.
+ */
+int comparer_charge_formateurs( const void *a, const void *b )
+{
+    const disponibilite_formateur *da = *( disponibilite_formateur * const * ) a;
+    const disponibilite_formateur *db = *( disponibilite_formateur * const * ) b;
+    if( da->minutes != db->minutes )
+    {
+        return da->minutes < db->minutes ? -1 : 1;
+    }
+    return da->p->id - db->p->id;
+}
+
+/*
+ * Cette fonction sert a construire l'index des formateurs de dbp en un seul parcours des personnes: pour chaque
+ * formateur, seules ses formations sont lues.
+ */
+void indexer_formateurs( index_formateurs *index, db_formation *dbf, db_personne *dbp )
+{
+    curseur_personne c;
+    personne *tmpp;
+    chrono ch;
+    int capacite = 64, i, j;
+    demarrer_compteur( &ch, CPT_INDEXER_FORMATEURS );
+    index->nb = 0;
+    index->formateurs = ( disponibilite_formateur * ) ALLOUER( capacite, sizeof( disponibilite_formateur ),
+                                                               "disponibilite_formateur" );
+    for( tmpp = debut_curseur_personne( &c, dbp, ORDRE_ID ); tmpp != NULL; tmpp = suivant_curseur_personne( &c ) )
+    {
+        compter_visites( 1 );
+        if( !tmpp->formateur )
+        {
+            continue;
+        }
+        if( index->nb == capacite )
+        {
+            capacite *= 2;
+            index->formateurs = ( disponibilite_formateur * ) REALLOUER( index->formateurs,
+                                                                         capacite * sizeof( disponibilite_formateur ),
+                                                                         "disponibilite_formateur" );
+        }
+        calculer_disponibilite( &index->formateurs[ index->nb ], dbf, tmpp );
+        index->nb += 1;
+    }
+    index->par_charge = ( disponibilite_formateur ** ) ALLOUER( index->nb + 1, sizeof( disponibilite_formateur * ),
+                                                                "formateurs_par_charge" );
+    for( i = 0; i < index->nb; i++ )
+    {
+        index->par_charge[i] = &index->formateurs[i];
+    }
+    qsort( index->par_charge, index->nb, sizeof( disponibilite_formateur * ), comparer_charge_formateurs );
+    index->nb_mots = ( index->nb + BITS_PAR_MOT - 1 ) / BITS_PAR_MOT;
+    for( j = 0; j < 7; j++ )
+    {
+        index->disponibles[j] = ( unsigned int * ) ALLOUER( index->nb_mots + 1, sizeof( unsigned int ),
+                                                           "formateurs_disponibles" );
+        for( i = 0; i < index->nb; i++ )
+        {
+            if( !( index->par_charge[i]->indisponible & ( 1u << j ) ) )
+            {
+                index->disponibles[j][ i / BITS_PAR_MOT ] |= 1u << ( i % BITS_PAR_MOT );
+            }
+        }
+    }
+    compter_octets( capacite * sizeof( disponibilite_formateur ) +
+                    ( index->nb + 1 ) * sizeof( disponibilite_formateur * ) +
+                    7 * ( index->nb_mots + 1 ) * sizeof( unsigned int ) );
+    arreter_compteur( &ch );
+}
+
+void liberer_index_formateurs( index_formateurs *index )
+{
+    int j;
+    for( j = 0; j < 7; j++ )
+    {
+        LIBERER( index->disponibles[j] );
+    }
+    LIBERER( index->par_charge );
+    LIBERER( index->formateurs );
+}
+
+/*
+ * Cette fonction sert a chercher les formateurs libres le jour jour (1 a 7) entre les minutes debut et fin, ou a
+ * la minute debut si fin <= debut: ils ne sont pas indisponibles ce jour-la et ne donnent aucun cours pendant ce
+ * creneau (au quart d'heure pres). Seuls les formateurs disponibles ce jour-la sont examines, chacun par
+ * quelques operations sur des mots, dans l'ordre de leur charge: rien n'est trie.
+ * Les formateurs sont mis dans *resultats (a liberer), du moins charge au plus charge. On renvoie leur nombre.
+ */
+int chercher_formateurs_libres( index_formateurs *index, int jour, int debut, int fin,
+                                disponibilite_formateur ***resultats )
+{
+    unsigned int creneau[ MOTS_QUARTS ];
+    chrono ch;
+    int m, b, nb = 0, d = debut, f = fin;
+    demarrer_compteur( &ch, CPT_FORMATEURS_LIBRES );
+    *resultats = ( disponibilite_formateur ** ) ALLOUER( index->nb + 1, sizeof( disponibilite_formateur * ),
+                                                         "formateurs_libres" );
+    memset( creneau, 0, sizeof( creneau ) );
+    marquer_quarts( creneau, d, f > d ? f : d + 1 );
+    for( m = 0; m < index->nb_mots; m++ )
+    {
+        unsigned int mot = index->disponibles[ jour - 1 ][m];
+        for( b = 0; mot != 0; b++, mot >>= 1 )
+        {
+            disponibilite_formateur *df;
+            if( !( mot & 1u ) )
+            {
+                continue;
+            }
+            df = index->par_charge[ m * BITS_PAR_MOT + b ];
+            if( !quarts_communs( creneau, df->occupe[ jour - 1 ] ) )
+            {
+                ( *resultats )[ nb++ ] = df;
+            }
+        }
+    }
+    compter_visites( ( unsigned long ) index->nb_mots + nb );
+    arreter_compteur( &ch );
+    return nb;
+}
+
+/*
+ * Les colonnes de la charge des formateurs, une ligne par formateur. heures_semaine est ecrit comme les horaires
+ * des formations (12.30 pour 12 heures 30).
+ */
+const char *colonnes_charge[] = { "id", "nom", "prenom", "heures_semaine", "seances", "jours_indisponibles",
+                                  "conflits" };
+
+void exporter_charge( exporteur *ex, disponibilite_formateur *d )
+{
+    exporter_debut( ex );
+    exporter_entier( ex, "id", d->p->id );
+    exporter_champ_texte( ex, "nom", d->p->nom );
+    exporter_champ_texte( ex, "prenom", d->p->prenom );
+    exporter_horaire( ex, "heures_semaine", d->minutes );
+    exporter_entier( ex, "seances", d->nb_seances );
+    exporter_liste( ex, "jours_indisponibles", d->p->jours_indisponible, d->p->nb_jours_indisponible );
+    exporter_entier( ex, "conflits", d->nb_conflits );
+    exporter_fin( ex );
+}
+
+/*
+ * Les colonnes des conflits, une ligne par seance d'un formateur qui tombe un jour ou il est indisponible.
+ */
+const char *colonnes_conflits[] = { "formateur_id", "nom", "prenom", "jour", "debut", "fin", "formation_id",
+                                    "formation" };
+
+/*
+ * Cette fonction sert a exporter les seances du formateur decrit par *d qui tombent un jour d'indisponibilite.
+ */
+void exporter_conflits( exporteur *ex, db_formation *dbf, disponibilite_formateur *d )
+{
+    personne *p = d->p;
+    int i, j;
+    for( i = 0; i < p->nb_formations && i < 30; i++ )
+    {
+        formation *f = get_formation_par_id( dbf, p->formations[i] );
+        for( j = 0; f != NULL && j < f->nb_jours && j < 7; j++ )
+        {
+            if( f->jours[j] < 1 || f->jours[j] > 7 || !( d->indisponible & ( 1u << ( f->jours[j] - 1 ) ) ) )
+            {
+                continue;
+            }
+            exporter_debut( ex );
+            exporter_entier( ex, "formateur_id", p->id );
+            exporter_champ_texte( ex, "nom", p->nom );
+            exporter_champ_texte( ex, "prenom", p->prenom );
+            exporter_entier( ex, "jour", f->jours[j] );
+            exporter_horaire( ex, "debut", f->heures[j] );
+            exporter_horaire( ex, "fin", f->heures[j] + f->durees[j] );
+            exporter_entier( ex, "formation_id", f->id );
+            exporter_champ_texte( ex, "formation", f->nom );
+            exporter_fin( ex );
+        }
+    }
+}
+
+/*
+ * Menu permettant de chercher les formateurs libres a un moment de la semaine. L'index des formateurs est
+ * construit une fois a l'entree du menu, chaque recherche ne lit ensuite que l'index.
+ */
+void menu_formateurs_libres( db_formation *dbf, db_personne *dbp )
+{
+    index_formateurs index;
+    disponibilite_formateur **libres;
+    int jour, nb, i, debut = 0, fin = 0;
+    char texte_debut[32], texte_fin[32];
+    indexer_formateurs( &index, dbf, dbp );
+    for( ;; )
+    {
+        printf( "* %d formateur(s). Quel jour ? (1 lundi ... 7 dimanche, 0 pour revenir) ", index.nb );
+        while( scanf( "%d", &jour ) != 1 || jour < 0 || jour > 7 )
+        {
+            getchar();
+            printf( "* Option INVALIDE: Max 7 Min 0\n" );
+            printf( "* Quel jour ? (1 lundi ... 7 dimanche, 0 pour revenir) " );
+        }
+        if( jour == 0 )
+        {
+            break;
+        }
+        printf( "* Entre quelles heures ? (ex. 8 12.30) " );
+        while( scanf( "%31s %31s", texte_debut, texte_fin ) == 2 &&
+               ( !lire_horaire( texte_debut, &debut ) || !lire_horaire( texte_fin, &fin ) || fin < debut ) )
+        {
+            printf( "* Option INVALIDE: debut puis fin, fin apres debut\n" );
+            printf( "* Entre quelles heures ? (ex. 8 12.30) " );
+        }
+        nb = chercher_formateurs_libres( &index, jour, debut, fin, &libres );
+        printf( "* %d formateur(s) libre(s), du moins charge au plus charge:\n", nb );
+        for( i = 0; i < nb; i++ )
+        {
+            printf( "* %2d %-25s %-25s %3d.%02d h/semaine\n", libres[i]->p->id, libres[i]->p->nom,
+                    libres[i]->p->prenom, HORAIRE( libres[i]->minutes ) );
+        }
+        LIBERER( libres );
+    }
+    getchar();
+    system( clear );
+    liberer_index_formateurs( &index );
+}
+
+/*
+ * Commande formateurs: charge les fichiers .dat du dossier courant et ecrit, en CSV ou en JSON Lines:
+ * charge : la charge de chaque formateur (heures de cours par semaine, seances, conflits);
+ * conflits : les seances des formateurs qui tombent un jour ou ils sont indisponibles;
+ * libres jour debut fin : les formateurs libres pendant ce creneau, du moins charge au plus charge.
+ */
+int commande_formateurs( int argc, char *argv[] )
+{
+    db_formation *dbf;
+    db_personne *dbp;
+    index_formateurs index;
+    exporteur ex;
+    int debut = 0, fin = 0, jour = 0, i = 1, res;
+    ex.format = EXPORT_CSV;
+    if( argc > 3 && strcmp( argv[0], "libres" ) == 0 )
+    {
+        jour = lire_jour( argv[1] );
+        if( !lire_horaire( argv[2], &debut ) || !lire_horaire( argv[3], &fin ) )
+        {
+            jour = 0;
+        }
+        i = 4;
+    }
+    if( i + 1 < argc && strcmp( argv[i], "-f" ) == 0 && strcmp( argv[ i + 1 ], "jsonl" ) == 0 )
+    {
+        ex.format = EXPORT_JSONL;
+        i += 2;
+    }
+    else if( i + 1 < argc && strcmp( argv[i], "-f" ) == 0 && strcmp( argv[ i + 1 ], "csv" ) == 0 )
+    {
+        i += 2;
+    }
+    if( argc == 0 || i < argc || ( strcmp( argv[0], "charge" ) != 0 && strcmp( argv[0], "conflits" ) != 0 &&
+                                   jour == 0 ) )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski formateurs charge | conflits | libres lundi..dimanche|1..7 "
+                         "debut fin [-f csv|jsonl]\n" );
+        return 1;
+    }
+    dbp = creer_db_personne();
+    dbf = creer_db_formation();
+    charger_db( dbf, dbp );
+    indexer_formateurs( &index, dbf, dbp );
+    ex.sortie = stdout;
+    ex.premier = 1;
+    ex.nb_lignes = 0;
+    ex.annee = NULL;
+    if( jour != 0 )
+    {
+        disponibilite_formateur **libres;
+        int nb = chercher_formateurs_libres( &index, jour, debut, fin, &libres );
+        exporter_entete( &ex, colonnes_charge, 7 );
+        for( i = 0; i < nb; i++ )
+        {
+            exporter_charge( &ex, libres[i] );
+        }
+        LIBERER( libres );
+    }
+    else if( strcmp( argv[0], "charge" ) == 0 )
+    {
+        exporter_entete( &ex, colonnes_charge, 7 );
+        for( i = 0; i < index.nb; i++ )
+        {
+            exporter_charge( &ex, &index.formateurs[i] );
+        }
+    }
+    else
+    {
+        exporter_entete( &ex, colonnes_conflits, 8 );
+        for( i = 0; i < index.nb; i++ )
+        {
+            if( index.formateurs[i].nb_conflits > 0 )
+            {
+                exporter_conflits( &ex, dbf, &index.formateurs[i] );
+            }
+        }
+    }
+    res = fflush( stdout ) == 0;
+    liberer_index_formateurs( &index );
+    liberer_db_personne( dbp );
+    liberer_db_formation( dbf );
+    return res ? 0 : 1;
+}
+
+/*                              FIN FORMATEURS                               */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                  SALLES                                   */
+
+/*
+ * Les colonnes des salles exportees, une ligne par salle.
+ */
+const char *colonnes_salles[] = { "id", "nom", "capacite", "seances" };
+
+/*
+ * Les colonnes de l'occupation des salles, une ligne par seance dans l'ordre du planning. salle_id vaut 0 pour une
+ * seance sans salle.
+ */
+const char *colonnes_occupation[] = { "jour", "nom_jour", "debut", "fin", "formation_id", "formation",
+                                      "participants", "salle_id", "salle", "capacite" };
+
+/*
+ * Cette fonction sert a exporter les salles de dbf avec le nombre de seances qui y ont lieu.
+ */
+void exporter_salles( exporteur *ex, db_formation *dbf )
+{
+    curseur_formation c;
+    formation *tmpf;
+    int *occupations = ( int * ) ALLOUER( dbf->nb_salles + 1, sizeof( int ), "occupations_salles" );
+    int i, j;
+    for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_ID ); tmpf != NULL; tmpf = suivant_curseur_formation( &c ) )
     {
-        nom[ strlen( nom ) - 1 ] = '\0';
+        for( j = 0; j < tmpf->nb_jours && j < 7; j++ )
+        {
+            salle *s = tmpf->salles[j] != 0 ? get_salle_par_id( dbf, tmpf->salles[j] ) : NULL;
+            if( s != NULL )
+            {
+                occupations[ s - dbf->salles ] += 1;
+            }
+        }
     }
-    formation *tmp = get_formation( f, nom );
-    if( tmp == NULL )
+    exporter_entete( ex, colonnes_salles, 4 );
+    for( i = 0; i < dbf->nb_salles; i++ )
     {
-        printf( "* Cout de la formation: " );
-        while( scanf( "%f", &prix ) != 1 )
+        exporter_debut( ex );
+        exporter_entier( ex, "id", dbf->salles[i].id );
+        exporter_champ_texte( ex, "nom", dbf->salles[i].nom );
+        exporter_entier( ex, "capacite", dbf->salles[i].capacite );
+        exporter_entier( ex, "seances", occupations[i] );
+        exporter_fin( ex );
+    }
+    LIBERER( occupations );
+}
+
+/*
+ * Cette fonction sert a exporter l'occupation des salles: chaque seance de la semaine, jour par jour dans l'ordre
+ * du planning, avec son nombre de participants et sa salle.
+ */
+void exporter_occupation( exporteur *ex, db_formation *dbf )
+{
+    char nom_jour[7][9] = { "Lundi", "Mardi", "Mercredi", "Jeudi", "Vendredi", "Samedi", "Dimanche" };
+    curseur_formation c;
+    formation *tmpf;
+    int i, j;
+    exporter_entete( ex, colonnes_occupation, 10 );
+    for( i = 1; i <= 7; i++ )
+    {
+        for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_RECENT ); tmpf != NULL;
+             tmpf = suivant_curseur_formation( &c ) )
         {
-            printf( "* Option %.2f - INVALIDE: Min 0\n", prix );
-            printf( "* Cout de la formation: " );
-            scanf( "%f", &prix );
-            getchar();
+            for( j = 0; j < tmpf->nb_jours && j < 7; j++ )
+            {
+                salle *s;
+                if( tmpf->jours[j] != i )
+                {
+                    continue;
+                }
+                s = tmpf->salles[j] != 0 ? get_salle_par_id( dbf, tmpf->salles[j] ) : NULL;
+                exporter_debut( ex );
+                exporter_entier( ex, "jour", i );
+                exporter_champ_texte( ex, "nom_jour", nom_jour[ i - 1 ] );
+                exporter_horaire( ex, "debut", tmpf->heures[j] );
+                exporter_horaire( ex, "fin", tmpf->heures[j] + tmpf->durees[j] );
+                exporter_entier( ex, "formation_id", tmpf->id );
+                exporter_champ_texte( ex, "formation", tmpf->nom );
+                exporter_entier( ex, "participants", nb_participants( tmpf ) );
+                exporter_entier( ex, "salle_id", s != NULL ? s->id : 0 );
+                exporter_champ_texte( ex, "salle", s != NULL ? s->nom : "" );
+                exporter_entier( ex, "capacite", s != NULL ? s->capacite : 0 );
+                exporter_fin( ex );
+            }
         }
-        while( prix < 0 )
+    }
+}
+
+/*
+ * Commande salles: charge les fichiers du dossier courant, puis
+ * liste : ecrit les salles et le nombre de seances de chacune;
+ * occupation : ecrit chaque seance de la semaine avec sa salle;
+ * ajouter capacite nom : ajoute une salle;
+ * supprimer id : supprime une salle, ses seances n'ont plus de salle;
+ * attribuer : attribue une salle a toutes les seances avec attribuer_salles (-n pour ne rien enregistrer).
+ * Les modifications sont enregistrees dans CaculliTyranowskiSalles.dat.
+ */
+int commande_salles( int argc, char *argv[] )
+{
+    db_formation *dbf;
+    db_personne *dbp;
+    exporteur ex;
+    char nom[40];
+    const char *action = argc > 0 ? argv[0] : "";
+    int i = 1, res = 1, modifie = 0, simulation = 0, capacite = 0, id = 0, valide;
+    ex.format = EXPORT_CSV;
+    nom[0] = '\0';
+    if( strcmp( action, "ajouter" ) == 0 && argc > 2 )
+    {
+        size_t n = 0;
+        capacite = atoi( argv[1] );
+        for( i = 2; i < argc && n + strlen( argv[i] ) + 1 < sizeof( nom ); i++ )
         {
-            printf( "* Option %.2f - INVALIDE: Min 0\n", prix );
-            printf( "* Cout de la formation: " );
-            scanf( "%f", &prix );
-            getchar();
+            n += sprintf( nom + n, "%s%s", n > 0 ? " " : "", argv[i] );
         }
-        formation *tmpf = creer_formation( nom, prix );
-        if( tmpdbf->head == NULL )
+    }
+    else if( strcmp( action, "supprimer" ) == 0 && argc > 1 )
+    {
+        id = atoi( argv[1] );
+        i = 2;
+    }
+    else if( strcmp( action, "attribuer" ) == 0 && argc > 1 && strcmp( argv[1], "-n" ) == 0 )
+    {
+        simulation = 1;
+        i = 2;
+    }
+    else if( ( strcmp( action, "liste" ) == 0 || strcmp( action, "occupation" ) == 0 ) && i + 1 < argc &&
+             strcmp( argv[i], "-f" ) == 0 )
+    {
+        ex.format = strcmp( argv[ i + 1 ], "jsonl" ) == 0 ? EXPORT_JSONL : EXPORT_CSV;
+        i += strcmp( argv[ i + 1 ], "jsonl" ) == 0 || strcmp( argv[ i + 1 ], "csv" ) == 0 ? 2 : 0;
+    }
+    valide = strcmp( action, "liste" ) == 0 || strcmp( action, "occupation" ) == 0 ||
+             strcmp( action, "attribuer" ) == 0 || ( strcmp( action, "ajouter" ) == 0 && capacite > 0 ) ||
+             ( strcmp( action, "supprimer" ) == 0 && id > 0 );
+    if( i < argc || !valide )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski salles liste | occupation [-f csv|jsonl] | ajouter capacite nom | "
+                         "supprimer id | attribuer [-n]\n" );
+        return 1;
+    }
+    dbp = creer_db_personne();
+    dbf = creer_db_formation();
+    charger_db( dbf, dbp );
+    ex.sortie = stdout;
+    ex.premier = 1;
+    ex.nb_lignes = 0;
+    ex.annee = NULL;
+    if( strcmp( action, "liste" ) == 0 )
+    {
+        exporter_salles( &ex, dbf );
+        res = fflush( stdout ) == 0;
+    }
+    else if( strcmp( action, "occupation" ) == 0 )
+    {
+        exporter_occupation( &ex, dbf );
+        res = fflush( stdout ) == 0;
+    }
+    else if( strcmp( action, "ajouter" ) == 0 )
+    {
+        salle *s = ajouter_salle( dbf, 0, nom, capacite );
+        res = s != NULL;
+        modifie = res;
+        if( !res )
         {
-            tmpf->id = 1;
+            fprintf( stderr, "Salle non ajoutee: plus aucun identifiant disponible\n" );
         }
         else
         {
-            tmpf->id = tmpdbf->head->f->id + 1;
+            fprintf( stderr, "Salle %d ajoutee: %s, %d places\n", s->id, s->nom, s->capacite );
         }
-        char choix_prerequis[4];
-        printf( "* Est-ce que la formation a des prerequis ? (o/n) " );
-        scanf( "%s", choix_prerequis );
-        getchar();
-        while( strcmp( choix_prerequis, "o" ) != 0 && strcmp( choix_prerequis, "oui" ) != 0 &&
-               strcmp( choix_prerequis, "n" ) != 0 && strcmp( choix_prerequis, "non" ) != 0 )
+    }
+    else if( strcmp( action, "supprimer" ) == 0 )
+    {
+        res = supprimer_salle( dbf, id );
+        modifie = res;
+        if( !res )
         {
-            printf( "* Options %s - INVALIDE: o pour oui et n pour non s'il vous plait\n", choix_prerequis );
-            printf( "* Est-ce que la formation a des prerequis ? (o/n) " );
-            scanf( "%s", choix_prerequis );
-            getchar();
+            fprintf( stderr, "Aucune salle %d\n", id );
         }
-        if( strcmp( choix_prerequis, "o" ) == 0 || strcmp( choix_prerequis, "oui" ) == 0 )
+    }
+    else
+    {
+        int nb_seances, sans_salle = attribuer_salles( dbf, &nb_seances );
+        fprintf( stderr, "%d seance(s) sur %d ont une salle, %d sans salle%s\n", nb_seances - sans_salle,
+                 nb_seances, sans_salle, simulation ? " (rien n'a ete enregistre)" : "" );
+        modifie = !simulation;
+    }
+    if( modifie && !ecrire_fichier_atomique( FICHIER_SALLES, ecrire_salles, dbf ) )
+    {
+        fprintf( stderr, "Impossible d'ecrire %s\n", FICHIER_SALLES );
+        res = 0;
+    }
+    liberer_db_personne( dbp );
+    liberer_db_formation( dbf );
+    return res ? 0 : 1;
+}
+
+/*                                FIN SALLES                                 */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                             LISTES D'ATTENTE                              */
+
+/*
+ * Les colonnes des listes d'attente, une ligne par demande dans l'ordre ou elles seront servies. ordre commence
+ * a 1 pour chaque formation.
+ */
+const char *colonnes_attente[] = { "formation_id", "formation", "ordre", "personne_id", "nom", "prenom", "rang",
+                                   "numero" };
+
+/*
+ * Cette fonction sert a exporter la liste d'attente de la formation idf, ou toutes les listes d'attente si idf
+ * vaut 0.
+ */
+void exporter_attente( exporteur *ex, db_formation *dbf, int idf )
+{
+    curseur_formation c;
+    formation *tmpf;
+    int i;
+    exporter_entete( ex, colonnes_attente, 8 );
+    for( tmpf = debut_curseur_formation( &c, dbf, ORDRE_ID ); tmpf != NULL; tmpf = suivant_curseur_formation( &c ) )
+    {
+        demande_attente **ordre;
+        int nb;
+        if( tmpf->attente == NULL || ( idf != 0 && tmpf->id != idf ) )
         {
-            noeud_db_formation *tmpndbf = tmpdbf->head;
-            printf( "* %2s %-40s                                  *\n", "ID", "Nom" );
-            printf( "* ---------------------------------------------------------------------------- *\n" );
-            while( tmpndbf != NULL )
-            {
-                printf( "* %2d %-40s                                  *\n", tmpndbf->f->id, tmpndbf->f->nom );
-                tmpndbf = tmpndbf->next;
-            }
-            tmpndbf = tmpdbf->head;
-            int nb_prerequis;
-            printf( "* Combien de prerequis faut-il ? " );
-            while( scanf( "%d", &nb_prerequis ) != 1 )
-            {
-                printf( "* Option %d - INVALIDE: Max %d prerequis Min 0\n", nb_prerequis, tmpndbf->f->id );
-                printf( "* Combien de prerequis faut-il ? " );
-                scanf( "%d", &nb_prerequis );
-                getchar();
-            }
-            getchar();
-            while( nb_prerequis > tmpndbf->f->id || nb_prerequis < 0 )
+            continue;
+        }
+        nb = trier_attente( tmpf, &ordre );
+        for( i = 0; i < nb; i++ )
+        {
+            exporter_debut( ex );
+            exporter_entier( ex, "formation_id", tmpf->id );
+            exporter_champ_texte( ex, "formation", tmpf->nom );
+            exporter_entier( ex, "ordre", i + 1 );
+            exporter_entier( ex, "personne_id", ordre[i]->p->id );
+            exporter_champ_texte( ex, "nom", ordre[i]->p->nom );
+            exporter_champ_texte( ex, "prenom", ordre[i]->p->prenom );
+            exporter_entier( ex, "rang", ordre[i]->rang );
+            exporter_entier( ex, "numero", ordre[i]->numero );
+            exporter_fin( ex );
+        }
+        LIBERER( ordre );
+    }
+}
+
+/*
+ * Cette fonction traite la sous-commande "attente":
+ *   CaculliTyranowski attente liste [formation] [-f csv|jsonl]
+ *   CaculliTyranowski attente inscrire formation personne
+ *   CaculliTyranowski attente retirer formation personne
+ *   CaculliTyranowski attente promouvoir
+ *   CaculliTyranowski attente politique prerequis|anciennete|reduction
+ * inscrire inscrit la personne s'il reste des places, sinon la met en liste d'attente. promouvoir inscrit les
+ * personnes en attente partout ou des places se sont liberees (par exemple apres "salles attribuer").
+ * Les modifications sont enregistrees dans les fichiers .dat.
+ */
+int commande_attente( int argc, char *argv[] )
+{
+    const char *politiques[] = { "prerequis", "anciennete", "reduction" };
+    db_formation *dbf;
+    db_personne *dbp;
+    exporteur ex;
+    const char *action = argc > 0 ? argv[0] : "";
+    int i = 1, res = 1, inscriptions = 0, modifie = 0, idf = 0, idp = 0, politique = -1, valide;
+    ex.format = EXPORT_CSV;
+    if( strcmp( action, "liste" ) == 0 && i < argc && strcmp( argv[i], "-f" ) != 0 )
+    {
+        idf = atoi( argv[i] );
+        i += 1;
+    }
+    if( strcmp( action, "liste" ) == 0 && i + 1 < argc && strcmp( argv[i], "-f" ) == 0 )
+    {
+        ex.format = strcmp( argv[ i + 1 ], "jsonl" ) == 0 ? EXPORT_JSONL : EXPORT_CSV;
+        i += strcmp( argv[ i + 1 ], "jsonl" ) == 0 || strcmp( argv[ i + 1 ], "csv" ) == 0 ? 2 : 0;
+    }
+    else if( ( strcmp( action, "inscrire" ) == 0 || strcmp( action, "retirer" ) == 0 ) && argc > 2 )
+    {
+        idf = atoi( argv[1] );
+        idp = atoi( argv[2] );
+        i = 3;
+    }
+    else if( strcmp( action, "politique" ) == 0 && argc > 1 )
+    {
+        for( politique = 2; politique >= 0 && strcmp( argv[1], politiques[ politique ] ) != 0; politique-- )
+        {
+        }
+        i = 2;
+    }
+    valide = ( strcmp( action, "liste" ) == 0 && idf >= 0 ) || strcmp( action, "promouvoir" ) == 0 ||
+             ( ( strcmp( action, "inscrire" ) == 0 || strcmp( action, "retirer" ) == 0 ) && idf > 0 && idp > 0 ) ||
+             ( strcmp( action, "politique" ) == 0 && politique >= 0 );
+    if( i < argc || !valide )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski attente liste [formation] [-f csv|jsonl] | inscrire formation "
+                         "personne | retirer formation personne | promouvoir | politique prerequis|anciennete|"
+                         "reduction\n" );
+        return 1;
+    }
+    dbp = creer_db_personne();
+    dbf = creer_db_formation();
+    charger_db( dbf, dbp );
+    ex.sortie = stdout;
+    ex.premier = 1;
+    ex.nb_lignes = 0;
+    ex.annee = NULL;
+    if( strcmp( action, "liste" ) == 0 )
+    {
+        exporter_attente( &ex, dbf, idf );
+        res = fflush( stdout ) == 0;
+    }
+    else if( strcmp( action, "inscrire" ) == 0 || strcmp( action, "retirer" ) == 0 )
+    {
+        formation *f = get_formation_par_id( dbf, idf );
+        personne *p = get_personne_par_id( dbp, idp );
+        if( f == NULL || p == NULL )
+        {
+            fprintf( stderr, "Formation %d ou personne %d introuvable\n", idf, idp );
+            res = 0;
+        }
+        else if( strcmp( action, "retirer" ) == 0 )
+        {
+            modifie = res = retirer_attente( dbf, f, idp );
+            fprintf( stderr, res ? "%s %s retire(e) de la liste d'attente de %s\n" :
+                     "%s %s n'est pas en liste d'attente de %s\n", p->nom, p->prenom, f->nom );
+        }
+        else
+        {
+            int demande = demander_inscription( dbf, f, p );
+            inscriptions = demande == INSCRIPTION_FAITE;
+            modifie = demande == INSCRIPTION_EN_ATTENTE;
+            res = demande != INSCRIPTION_IMPOSSIBLE;
+            if( demande == INSCRIPTION_EN_ATTENTE || demande == INSCRIPTION_DEJA_EN_ATTENTE )
             {
-                printf( "* Option %d - INVALIDE: Max %d prerequis Min 0\n", nb_prerequis, tmpndbf->f->id );
-                printf( "* Combien de prerequis faut-il ? " );
-                scanf( "%d", &nb_prerequis );
-                getchar();
+                fprintf( stderr, "%s est complete (%d places): %s %s %sen liste d'attente, %d personne(s) attendent\n",
+                         f->nom, capacite_formation( dbf, f ), p->nom, p->prenom,
+                         demande == INSCRIPTION_DEJA_EN_ATTENTE ? "deja " : "", f->attente->nb );
             }
-            tmpf->nb_prerequis = nb_prerequis;
-            for( i = 0; i < nb_prerequis; i++ )
+            else
             {
-                int id_prerequis;
-                printf( "* ID du prerequis N.%d a rajouter: ", i + 1 );
-                while( scanf( "%d", &id_prerequis ) != 1 || nb_prerequis > tmpndbf->f->id )
-                {
-                    printf( "* Option %d - INVALIDE: veullez choisir 1 dans la liste\n", id_prerequis );
-                    printf( "* ID du prerequis N.%d a rajouter: ", i + 1 );
-                    scanf( "%d", &id_prerequis );
-                    getchar();
-                }
-                tmpf->prerequis[i] = id_prerequis;
+                fprintf( stderr, demande == INSCRIPTION_FAITE ? "%s %s inscrit(e) a %s\n" : demande ==
+                         INSCRIPTION_DEJA_FAITE ? "%s %s participe deja a %s\n" :
+                         "%s %s participe deja a 30 formations\n", p->nom, p->prenom, f->nom );
             }
         }
-        int nb_jours;
-        printf( "* Combien de fois par semaine a la formation lieu ? " );
-        while( scanf( "%d", &nb_jours ) != 1 )
+    }
+    else if( strcmp( action, "promouvoir" ) == 0 )
+    {
+        curseur_formation c;
+        formation *f;
+        for( f = debut_curseur_formation( &c, dbf, ORDRE_ID ); f != NULL; f = suivant_curseur_formation( &c ) )
+        {
+            inscriptions += f->attente != NULL ? promouvoir_attente( dbf, f, stderr ) : 0;
+        }
+        fprintf( stderr, "%d personne(s) inscrite(s) depuis les listes d'attente\n", inscriptions );
+    }
+    else
+    {
+        dbf->politique_attente = politique;
+        reclasser_attentes( dbf );
+        modifie = 1;
+    }
+    if( inscriptions > 0 )
+    {
+        res = sauvegarder_db( dbf, dbp, 0, -1 ) && res;
+    }
+    else if( modifie && !ecrire_fichier_atomique( FICHIER_ATTENTE, ecrire_attente, dbf ) )
+    {
+        fprintf( stderr, "Impossible d'ecrire %s\n", FICHIER_ATTENTE );
+        res = 0;
+    }
+    liberer_db_personne( dbp );
+    liberer_db_formation( dbf );
+    return res ? 0 : 1;
+}
+
+/*                           FIN LISTES D'ATTENTE                            */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                            RECHERCHE APPROCHEE                            */
+
+/*
+ * Un resultat de la recherche approchee: une personne p ou une formation f.
+ * int distance : La distance d'edition entre la cle pliee de son nom et celle du nom cherche.
+ * int distance_prenom : Pour une personne, la meme distance sur le prenom, si un prenom est cherche (0 sinon).
+ */
+typedef struct enregistrement_proche
+{
+    personne *p;
+    formation *f;
+    int distance;
+    int distance_prenom;
+} enregistrement_proche;
+
+/*
+ * Cette fonction trie les resultats de la recherche approchee par distance, puis par distance du prenom, puis
+ * dans l'ordre des noms.
+ */
+int comparer_enregistrements_proches( const void *a, const void *b )
+{
+    const enregistrement_proche *ea = ( const enregistrement_proche * ) a;
+    const enregistrement_proche *eb = ( const enregistrement_proche * ) b;
+    if( ea->distance != eb->distance )
+    {
+        return ea->distance < eb->distance ? -1 : 1;
+    }
+    if( ea->distance_prenom != eb->distance_prenom )
+    {
+        return ea->distance_prenom < eb->distance_prenom ? -1 : 1;
+    }
+    return ea->p != NULL ? comparer_personne_nom( &ea->p, &eb->p ) : comparer_formation_nom( &ea->f, &eb->f );
+}
+
+/*
+ * Ces fonctions renvoient le nombre de personnes (de formations) de la base de donnees db dont le nom a la cle
+ * pliee cle, elles sont passees a chercher_cles_proches.
+ */
+int compter_cle_personnes( void *db, const char *cle )
+{
+    int nb;
+    plage_nom_personnes( ( db_personne * ) db, cle, NULL, &nb );
+    return nb;
+}
+
+int compter_cle_formations( void *db, const char *cle )
+{
+    int nb;
+    plage_nom_formations( ( db_formation * ) db, cle, NULL, &nb );
+    return nb;
+}
+
+/*
+ * Cette fonction sert a chercher les k personnes de db dont le nom est le plus proche de nom (voir
+ * chercher_cles_proches), puis, a distance egale, dont le prenom est le plus proche de prenom s'il n'est pas
+ * NULL. Un prenom de plus de LONGUEUR_NOM_MAX octets est ignore. Les resultats sont mis dans *resultats (a
+ * liberer par LIBERER), on renvoie leur nombre.
+ */
+int chercher_personnes_proches( db_personne *db, const char *nom, const char *prenom, int k,
+                                enregistrement_proche **resultats )
+{
+    cle_proche *cles;
+    int nb_cles = chercher_cles_proches( nom, k, compter_cle_personnes, db, &cles ), nb = 0, i, j;
+    char cle_prenom[ LONGUEUR_NOM_MAX + 1 ];
+    if( prenom != NULL && strlen( prenom ) > LONGUEUR_NOM_MAX )
+    {
+        prenom = NULL;
+    }
+    plier_nom( prenom != NULL ? prenom : "", cle_prenom );
+    for( i = 0; i < nb_cles; i++ )
+    {
+        nb += cles[i].nb;
+    }
+    *resultats = ( enregistrement_proche * ) ALLOUER( nb + 1, sizeof( enregistrement_proche ), "resultats_proches" );
+    for( i = 0, nb = 0; i < nb_cles; i++ )
+    {
+        int nb_plage;
+        personne **plage = plage_nom_personnes( db, cles[i].cle, NULL, &nb_plage );
+        for( j = 0; j < nb_plage; j++, nb++ )
+        {
+            ( *resultats )[ nb ].p = plage[j];
+            ( *resultats )[ nb ].distance = cles[i].distance;
+            ( *resultats )[ nb ].distance_prenom = prenom != NULL ?
+                                                   distance_edition( cle_pliee( plage[j]->prenom ), cle_prenom ) : 0;
+        }
+    }
+    qsort( *resultats, nb, sizeof( enregistrement_proche ), comparer_enregistrements_proches );
+    LIBERER( cles );
+    return nb < k ? nb : k;
+}
+
+/*
+ * Cette fonction suit la meme logique que chercher_personnes_proches pour les noms des formations.
+ */
+int chercher_formations_proches( db_formation *db, const char *nom, int k, enregistrement_proche **resultats )
+{
+    cle_proche *cles;
+    int nb_cles = chercher_cles_proches( nom, k, compter_cle_formations, db, &cles ), nb = 0, i, j;
+    for( i = 0; i < nb_cles; i++ )
+    {
+        nb += cles[i].nb;
+    }
+    *resultats = ( enregistrement_proche * ) ALLOUER( nb + 1, sizeof( enregistrement_proche ), "resultats_proches" );
+    for( i = 0, nb = 0; i < nb_cles; i++ )
+    {
+        int nb_plage;
+        formation **plage = plage_nom_formations( db, cles[i].cle, NULL, &nb_plage );
+        for( j = 0; j < nb_plage; j++, nb++ )
+        {
+            ( *resultats )[ nb ].f = plage[j];
+            ( *resultats )[ nb ].distance = cles[i].distance;
+        }
+    }
+    qsort( *resultats, nb, sizeof( enregistrement_proche ), comparer_enregistrements_proches );
+    LIBERER( cles );
+    return nb < k ? nb : k;
+}
+
+/*
+ * Menu permettant de retrouver une personne ou une formation dont on ne connait pas l'orthographe exacte, par
+ * exemple pour trouver son identifiant avant une inscription ou une suppression.
+ */
+void menu_recherche_approchee( db_formation *dbf, db_personne *dbp )
+{
+    enregistrement_proche *resultats;
+    char texte[ LONGUEUR_NOM_MAX + 1 ], *prenom;
+    int choix, nb, i;
+    size_t n;
+    printf( "* 1. Personne (nom et eventuellement prenom)\n* 2. Formation\n* Que cherchez-vous ? " );
+    if( scanf( "%d", &choix ) != 1 || ( choix != 1 && choix != 2 ) )
+    {
+        choix = 0;
+    }
+    getchar();
+    if( choix != 0 )
+    {
+        printf( "* Nom ? " );
+    }
+    if( choix == 0 || fgets( texte, sizeof( texte ), stdin ) == NULL )
+    {
+        system( clear );
+        printf( "* Recherche - INVALIDE *\n" );
+        return;
+    }
+    n = strlen( texte );
+    if( n > 0 && texte[ n - 1 ] == '\n' )
+    {
+        texte[ n - 1 ] = '\0';
+    }
+    couper_utf8( texte );
+    system( clear );
+    printf( "********************************************************************************\n" );
+    printf( "* Les plus proches de \"%s\"\n", texte );
+    printf( "* ---------------------------------------------------------------------------- *\n" );
+    if( choix == 1 )
+    {
+        prenom = strchr( texte, ' ' );
+        if( prenom != NULL )
+        {
+            *prenom++ = '\0';
+        }
+        nb = chercher_personnes_proches( dbp, texte, prenom, 10, &resultats );
+        for( i = 0; i < nb; i++ )
+        {
+            personne *p = resultats[i].p;
+            printf( "* %4d %-*s %-*s distance %d\n", p->id, largeur_utf8( p->nom, 25 ), p->nom,
+                    largeur_utf8( p->prenom, 25 ), p->prenom, resultats[i].distance + resultats[i].distance_prenom );
+        }
+    }
+    else
+    {
+        nb = chercher_formations_proches( dbf, texte, 10, &resultats );
+        for( i = 0; i < nb; i++ )
+        {
+            formation *f = resultats[i].f;
+            printf( "* %4d %-*s distance %d\n", f->id, largeur_utf8( f->nom, 51 ), f->nom, resultats[i].distance );
+        }
+    }
+    printf( "********************************************************************************\n" );
+    printf( "* %d resultat(s)\n", nb );
+    LIBERER( resultats );
+}
+
+/*
+ * Les colonnes des resultats de la recherche approchee, du plus proche au plus eloigne.
+ */
+const char *colonnes_proches_personnes[] = { "distance", "distance_prenom", "id", "nom", "prenom", "formateur" };
+const char *colonnes_proches_formations[] = { "distance", "id", "nom", "prix", "participants" };
+
+/*
+ * Cette fonction sert a exporter les nb resultats d'une recherche approchee.
+ */
+void exporter_proches( exporteur *ex, enregistrement_proche *resultats, int nb, int personnes )
+{
+    int i;
+    if( personnes )
+    {
+        exporter_entete( ex, colonnes_proches_personnes, 6 );
+    }
+    else
+    {
+        exporter_entete( ex, colonnes_proches_formations, 5 );
+    }
+    for( i = 0; i < nb; i++ )
+    {
+        exporter_debut( ex );
+        exporter_entier( ex, "distance", resultats[i].distance );
+        if( personnes )
+        {
+            personne *p = resultats[i].p;
+            exporter_entier( ex, "distance_prenom", resultats[i].distance_prenom );
+            exporter_entier( ex, "id", p->id );
+            exporter_champ_texte( ex, "nom", p->nom );
+            exporter_champ_texte( ex, "prenom", p->prenom );
+            exporter_booleen( ex, "formateur", p->formateur );
+        }
+        else
         {
-            printf( "Option %d - INVALIDE: Max 7 jours Min 1 jour\n", nb_jours );
-            printf( "* Combien de fois par semaine a la formation lieu ? " );
-            scanf( "%d", &nb_jours );
-            getchar();
+            formation *f = resultats[i].f;
+            exporter_entier( ex, "id", f->id );
+            exporter_champ_texte( ex, "nom", f->nom );
+            exporter_prix( ex, "prix", f->prix );
+            exporter_entier( ex, "participants", f->nb_inscrits - f->nb_desinscrits );
         }
-        getchar();
-        while( nb_jours > 7 || nb_jours <= 0 )
+        exporter_fin( ex );
+    }
+}
+
+/*
+ * Cette fonction traite la sous-commande "chercher":
+ *   CaculliTyranowski chercher personnes nom [prenom] [-k n] [-f csv|jsonl]
+ *   CaculliTyranowski chercher formations nom... [-k n] [-f csv|jsonl]
+ * Elle ecrit les n resultats (10 par defaut) les plus proches du nom cherche, sans tenir compte des majuscules
+ * ni des accents et en tolerant les fautes de frappe. Le nom d'une formation peut etre en plusieurs mots.
+ */
+int commande_chercher( int argc, char *argv[] )
+{
+    db_formation *dbf;
+    db_personne *dbp;
+    exporteur ex;
+    enregistrement_proche *resultats;
+    char texte[ LONGUEUR_NOM_MAX + 1 ] = "";
+    const char *prenom = NULL;
+    int personnes = argc > 0 && strcmp( argv[0], "personnes" ) == 0, k = 10, nb_mots = 0, nb, i, valide;
+    ex.format = EXPORT_CSV;
+    valide = personnes || ( argc > 0 && strcmp( argv[0], "formations" ) == 0 );
+    for( i = 1; valide && i < argc; i++ )
+    {
+        if( strcmp( argv[i], "-k" ) == 0 && i + 1 < argc )
         {
-            printf( "Option %d - INVALIDE: Max 7 jours Min 1 jour\n", nb_jours );
-            printf( "* Combien de fois par semaine a laformation lieu ? " );
-            scanf( "%d", &nb_jours );
-            getchar();
+            k = atoi( argv[ ++i ] );
+            valide = k > 0;
         }
-        tmpf->nb_jours = nb_jours;
-        printf( "* 1. lundi\n* 2. mardi\n* 3. mercredi\n* 4. jeudi\n* 5. vendredi\n* 6. samedi\n* 7. dimanche\n" );
-        for ( i = 0; i < tmpf->nb_jours; i++ )
+        else if( strcmp( argv[i], "-f" ) == 0 && i + 1 < argc )
         {
-            int jour;
-            printf( "* Quel jour de la semaine a la formation N. %d lieu ? ", i + 1 );
-            while( scanf( "%d", &jour ) != 1 || jour < 0 || jour > 7  )
-            {
-                printf( "* Option %d - INVALIDE: Max 7 Min 1\n", i );
-                printf( "* Quel jour de la semaine a la formation N. %d lieu ? ", i + 1 );
-                scanf( "%d", &jour );
-                getchar();
-            }
-            tmpf->jours[i] = jour;
-            float heure;
-            printf( "* A quelle heure debute la formation (ex. 08.15) ? " );
-            while( scanf( "%f", &heure ) != 1 || heure > 18 || heure < 6 )
-            {
-                printf( "* Option %.2f - INVALIDE: MIN 6 MAX 18\n", heure );
-                printf( "* A quelle heure debute la formation (ex. 08.15) ? " );
-                scanf( "%f", &heure);
-                getchar();
-            }
-            tmpf->heures[i] = heure;
-            float duree;
-            printf( "* Combien d'heures dure la formation ? " );
-            while( scanf( "%f", &duree ) != 1 || duree > 8 || duree < 1 )
-            {
-                printf( "* Option %.2f - INVALIDE: MIN 1 heures MAX 8 heures\n", duree );
-                printf( "* Combien d'heures dure la formation ? " );
-                scanf( "%f", &duree);
-                getchar();
-            }
-            tmpf->durees[i] = duree;
+            i += 1;
+            ex.format = strcmp( argv[i], "jsonl" ) == 0 ? EXPORT_JSONL : EXPORT_CSV;
+            valide = strcmp( argv[i], "jsonl" ) == 0 || strcmp( argv[i], "csv" ) == 0;
         }
-        char confirmation[4];
-        printf( "* Etes vous sur de vouloir ajouter la formation %s avec prix %.2f a la base de donnees ? (o/n) ",
-                tmpf->nom, tmpf->prix );
-        scanf( "%s", confirmation );
-        while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
-               strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
+        else if( personnes && nb_mots == 1 )
         {
-            printf( "Veuillez inserer o / oui - n / non : " );
-            scanf( "%s", confirmation );
+            prenom = argv[i];
+            valide = strlen( prenom ) <= LONGUEUR_NOM_MAX;
+            nb_mots += 1;
         }
-        if( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 )
+        else if( nb_mots == 0 || !personnes )
         {
-            ajouter_db_formation( tmpdbf, tmpf );
-            system( clear );
-            printf( "* %s a ete ajoutee a la base de donnees avec succes *\n", tmpf->nom );
+            valide = strlen( texte ) + strlen( argv[i] ) + 1 < sizeof( texte );
+            if( valide )
+            {
+                strcat( strcat( texte, nb_mots ? " " : "" ), argv[i] );
+            }
+            nb_mots += 1;
         }
         else
         {
-            system( clear );
-            printf( "* %s n'a PAS ete ajoutee a la base de donnees *\n", tmpf->nom );
+            valide = 0;
         }
     }
-    else
+    if( !valide || nb_mots == 0 )
     {
-        system( clear );
-        printf( "* Formation deja existente dans la base de donnees *\n" );
+        fprintf( stderr, "Usage: CaculliTyranowski chercher personnes nom [prenom] | formations nom... [-k n] "
+                         "[-f csv|jsonl]\n" );
+        return 1;
     }
+    dbp = creer_db_personne();
+    dbf = creer_db_formation();
+    charger_db( dbf, dbp );
+    nb = personnes ? chercher_personnes_proches( dbp, texte, prenom, k, &resultats ) :
+         chercher_formations_proches( dbf, texte, k, &resultats );
+    ex.sortie = stdout;
+    ex.premier = 1;
+    ex.nb_lignes = 0;
+    ex.annee = NULL;
+    exporter_proches( &ex, resultats, nb, personnes );
+    i = fflush( stdout ) == 0;
+    LIBERER( resultats );
+    liberer_db_personne( dbp );
+    liberer_db_formation( dbf );
+    return i ? 0 : 1;
 }
 
-void menu_creer_personne( db_personne *p )
+/*                          FIN RECHERCHE APPROCHEE                          */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                VERIFICATION                               */
+
+/*
+ * La verification d'une base de donnees chargee se fait en trois passes, chacune en temps lineaire:
+ * - le chargement ignore et signale les lignes mal formees, incompletes, hors limites ou en double (voir
+ *   bilan_chargement), aucune liste ne peut donc deborder;
+ * - verifier_references controle les references que le chargement garde telles quelles: les formations de chaque
+ *   personne et ses jours d'indisponibilite, les prerequis et les jours des seances de chaque formation, et cherche
+ *   les cycles de prerequis;
+ * - verifier_invariants controle les structures construites en memoire, quand les references sont correctes.
+ * En mode reparation, les lignes ignorees et les references invalides sont retirees, puis la base de donnees
+ * corrigee est sauvegardee. Un jour de seance hors limites n'est pas repare: il faut le corriger a la main.
+ */
+
+/*
+ * Cette fonction sert a retirer la case k du vecteur t de *nb cases, en gardant l'ordre des cases suivantes.
+ */
+void retirer_case( int t[], int *nb, int k )
 {
-    db_personne *tmpdbp = p;
-    char nom[25], prenom[25], choix_formateur[4];
-    int formateur, nb_jours_indisponible = 0, jours_indisponible[7], reduction = 0, pourcent_reduction;
-    printf( "* Nom de famille de la personne: " );
-    scanf( "%s", nom );
-    printf( "* Prenom de la personne: " );
-    scanf( "%s", prenom );
-    printf( "* Est-ce que cette personne est un formateur ou un etudiant ? (f/e) " );
-    scanf( "%s", choix_formateur );
-    int i;
-    for( i = 0; choix_formateur[i]; i++ )
-    {
-        choix_formateur[i] = tolower( choix_formateur[i] );
-    }
-    while( strcmp( choix_formateur, "f" ) != 0 && strcmp( choix_formateur, "formateur" ) != 0 &&
-           strcmp( choix_formateur, "e" ) != 0 && strcmp( choix_formateur, "etudiant" ) != 0 )
+    memmove( &t[k], &t[ k + 1 ], ( *nb - k - 1 ) * sizeof( int ) );
+    *nb -= 1;
+}
+
+/*
+ * Cette fonction sert a signaler une reference invalide dans le journal, en precisant si elle a ete retiree.
+ * On obtient toujours 1, pour compter les problemes.
+ */
+int signaler_reference( FILE *journal, int retiree, const char *format, ... )
+{
+    va_list args;
+    va_start( args, format );
+    vfprintf( journal, format, args );
+    va_end( args );
+    fprintf( journal, retiree ? " (retire)\n" : "\n" );
+    return 1;
+}
+
+/*
+ * Cette fonction sert a chercher les cycles de prerequis par un parcours en profondeur iteratif: une formation
+ * en cours de parcours qui est atteinte a nouveau ferme un cycle. Les prerequis invalides sont signales par
+ * verifier_references et sont sautes. Si reparer vaut 1, le prerequis qui ferme le
+ * cycle est retire, chaque retrait etant compte dans *repares.
+ * On obtient le nombre de cycles trouves.
+ */
+int verifier_cycles_prerequis( db_formation *dbf, FILE *journal, int reparer, int *repares )
+{
+    int nb_ids = dbf->nb_pages << DECALAGE_PAGE, nb = 0;
+    unsigned char *etat = ( unsigned char * ) ALLOUER( nb_ids + 1, 1, "verification" );
+    int *pile = ( int * ) ALLOUER( nb_ids + 1, sizeof( int ), "verification" );
+    int *suivant = ( int * ) ALLOUER( nb_ids + 1, sizeof( int ), "verification" );
+    curseur_formation c;
+    formation *f;
+    for( f = debut_curseur_formation( &c, dbf, ORDRE_ID ); f != NULL; f = suivant_curseur_formation( &c ) )
     {
-        printf( "* Option %s - INVALIDE: f ou e seulement sont acceptees                       *\n",
-                choix_formateur );
-        printf( "* Est-ce que cette personne est un formateur ou un etudiant ? (f/e) " );
-        scanf( "%s", choix_formateur );
-        for( i = 0; choix_formateur[i]; i++ )
+        int hauteur = 1;
+        if( etat[ f->id ] != 0 )
         {
-            choix_formateur[i] = tolower( choix_formateur[i] );
+            continue;
         }
-    }
-    if( strcmp( choix_formateur, "f" ) == 0 || strcmp( choix_formateur, "formateur" ) == 0 )
-    {
-        formateur = 1;
-        char choix_indisponible[4];
-        printf( "* Est-ce que ce formateur as des jours ou il/elle est indisponible ? (o/n) " );
-        scanf( "%s", choix_indisponible );
-        getchar();
-        while( strcmp( choix_indisponible, "o" ) != 0 && strcmp( choix_indisponible, "oui" ) != 0 &&
-               strcmp( choix_indisponible, "n" ) != 0 && strcmp( choix_indisponible, "non" ) != 0 )
+        pile[0] = f->id;
+        etat[ f->id ] = 1;
+        while( hauteur > 0 )
         {
-            printf( "* Option %s - INVALIDE: o ou n sont acceptees                                  *\n",
-                    choix_indisponible );
-            printf( "* Est-ce que ce formateur as des jours ou il/elle est indisponible ? (o/n) " );
-            scanf( "%s", choix_indisponible );
-            getchar();
+            formation *g = get_formation_par_id( dbf, pile[ hauteur - 1 ] );
+            int k = suivant[ g->id ], h;
+            if( k == g->nb_prerequis )
+            {
+                etat[ g->id ] = 2;
+                hauteur -= 1;
+                continue;
+            }
+            h = g->prerequis[k];
+            suivant[ g->id ] += 1;
+            if( h <= 0 || h > nb_ids || h == g->id || get_formation_par_id( dbf, h ) == NULL )
+            {
+                continue;
+            }
+            if( etat[h] == 1 )
+            {
+                nb += signaler_reference( journal, reparer, "Formation %d: le prerequis %d ferme un cycle", g->id, h );
+                if( reparer )
+                {
+                    retirer_case( g->prerequis, &g->nb_prerequis, k );
+                    suivant[ g->id ] -= 1;
+                    *repares += 1;
+                }
+            }
+            else if( etat[h] == 0 )
+            {
+                etat[h] = 1;
+                pile[ hauteur ] = h;
+                hauteur += 1;
+            }
         }
-        if( strcmp( choix_indisponible, "o" ) == 0 || strcmp( choix_indisponible, "oui" ) == 0 )
+    }
+    LIBERER( etat );
+    LIBERER( pile );
+    LIBERER( suivant );
+    return nb;
+}
+
+/*
+ * Cette fonction sert a verifier les references entre les enregistrements de la base de donnees, voir
+ * VERIFICATION. Chaque probleme est ecrit dans le journal. Si reparer vaut 1, les references invalides sont
+ * retirees, chaque retrait etant compte dans *repares.
+ * On obtient le nombre de problemes trouves.
+ */
+int verifier_references( db_formation *dbf, db_personne *dbp, FILE *journal, int reparer, int *repares )
+{
+    curseur_personne cp;
+    curseur_formation cf;
+    personne *p;
+    formation *f;
+    int nb = 0, j, k;
+    for( p = debut_curseur_personne( &cp, dbp, ORDRE_ID ); p != NULL; p = suivant_curseur_personne( &cp ) )
+    {
+        for( k = 0; k < p->nb_formations; k++ )
         {
-            printf( "* Combien de jours serait ce formateur indisponible ? " );
-            scanf( "%d", &nb_jours_indisponible );
-            getchar();
-            while( nb_jours_indisponible < 0 )
+            for( j = 0; j < k && p->formations[j] != p->formations[k]; j++ )
             {
-                printf( "* Option %d - INVALIDE: Max 7 jours - Min 0                                    *\n",
-                        nb_jours_indisponible );
-                printf( "* Combien de jours serait ce formateur indisponible ? " );
-                scanf( "%d", &nb_jours_indisponible );
-                getchar();
             }
-            if( nb_jours_indisponible > 0 )
+            if( get_formation_par_id( dbf, p->formations[k] ) == NULL || j < k )
             {
-                while ( nb_jours_indisponible > 7 || nb_jours_indisponible < 0)
+                nb += signaler_reference( journal, reparer, "Personne %d: la formation %d %s", p->id,
+                                          p->formations[k], j < k ? "est en double" : "n'existe pas" );
+                if( reparer )
                 {
-                    printf( "* Option %d - INVALIDE: Max 7 jours - Min 0                                    *\n",
-                            nb_jours_indisponible );
-                    printf( "* Combien de jours serait ce formateur indisponible ? " );
-                    scanf( "%d", &nb_jours_indisponible );
-                    getchar();
+                    retirer_case( p->formations, &p->nb_formations, k-- );
+                    *repares += 1;
                 }
-                printf( "* 1. lundi\n* 2. mardi\n* 3. mercredi\n* 4. jeudi\n* 5. vendredi\n* 6. samedi\n* 7. dimanche\n" );
-                for ( i = 0; i < nb_jours_indisponible; i++ )
+            }
+        }
+        for( k = 0; p->formateur == 1 && k < p->nb_jours_indisponible; k++ )
+        {
+            if( p->jours_indisponible[k] < 1 || p->jours_indisponible[k] > 7 )
+            {
+                nb += signaler_reference( journal, reparer, "Personne %d: le jour d'indisponibilite %d n'existe pas",
+                                          p->id, p->jours_indisponible[k] );
+                if( reparer )
                 {
-                    int jour;
-                    printf( "* Quel serait son jour d'indisponibilite N.%d ? ", i + 1 );
-                    scanf( "%d", &jour );
-                    jours_indisponible[ i ] = jour;
+                    retirer_case( p->jours_indisponible, &p->nb_jours_indisponible, k-- );
+                    *repares += 1;
                 }
             }
         }
     }
-    else
+    for( f = debut_curseur_formation( &cf, dbf, ORDRE_ID ); f != NULL; f = suivant_curseur_formation( &cf ) )
     {
-        formateur = 0;
-        printf( "* Est-ce que cet etudiant beneficie d'une reduction ? (o/n) " );
-        char choix_reduction[4];
-        scanf( "%s", choix_reduction );
-        getchar();
-        while( strcmp( choix_reduction, "o" ) != 0 && strcmp( choix_reduction, "oui" ) != 0 &&
-               strcmp( choix_reduction, "n" ) != 0 && strcmp( choix_reduction, "non" ) != 0 )
+        for( k = 0; k < f->nb_prerequis; k++ )
         {
-            printf( "* Option %s - INVALIDE: o ou n sont acceptees                                  *\n",
-                    choix_reduction );
-            printf( "* Est-ce que cet etudiant beneficie d'une reduction ? (o/n) " );
-            scanf( "%s", choix_reduction );
-            getchar();
+            for( j = 0; j < k && f->prerequis[j] != f->prerequis[k]; j++ )
+            {
+            }
+            if( get_formation_par_id( dbf, f->prerequis[k] ) == NULL || f->prerequis[k] == f->id || j < k )
+            {
+                nb += signaler_reference( journal, reparer, "Formation %d: le prerequis %d %s", f->id,
+                                          f->prerequis[k], j < k ? "est en double" : f->prerequis[k] == f->id ?
+                                          "est la formation elle-meme" : "n'existe pas" );
+                if( reparer )
+                {
+                    retirer_case( f->prerequis, &f->nb_prerequis, k-- );
+                    *repares += 1;
+                }
+            }
         }
-        if( strcmp( choix_reduction, "o" ) == 0 || strcmp( choix_reduction, "oui" ) == 0 )
+        for( k = 0; k < f->nb_jours; k++ )
         {
-            printf( "* Combien de pourcentage de reduction beneficie cet etudiant ? " );
-            scanf( "%d", &pourcent_reduction );
-            getchar();
-            while ( pourcent_reduction > 100 || pourcent_reduction < 0 )
+            if( f->jours[k] < 1 || f->jours[k] > 7 )
             {
-                printf( "* Option %d - INVALIDE: Max 100 pourcent - Min 0                               *\n",
-                        nb_jours_indisponible );
-                printf( "* Combien de pourcentage de reduction beneficie cet etudiant ? " );
-                scanf( "%d", &pourcent_reduction );
+                nb += signaler_reference( journal, 0, "Formation %d: la seance %d a lieu le jour %d, qui n'existe pas",
+                                          f->id, k, f->jours[k] );
             }
-            if( pourcent_reduction > 0 )
+        }
+    }
+    return nb + verifier_cycles_prerequis( dbf, journal, reparer, repares );
+}
+
+/*
+ * Commande verifier: verifie la base de donnees du dossier courant, voir VERIFICATION.
+ *   CaculliTyranowski verifier [-r] [-o rapport]
+ * -r repare la base de donnees: une copie de chaque fichier d'origine est gardee (voir garder_copie), puis la
+ * base de donnees corrigee est sauvegardee, fichier par fichier de facon atomique. Si une copie echoue, rien n'est
+ * remplace. -o ecrit le rapport dans le fichier rapport plutot que sur la sortie standard.
+ * La commande renvoie 0 si la base de donnees est correcte ou a ete entierement reparee, 1 sinon: elle peut etre
+ * lancee chaque nuit par cron, qui signale alors les erreurs.
+ */
+int commande_verifier( int argc, char *argv[] )
+{
+    const char *fichiers[] = { FICHIER_PERSONNE, FICHIER_FORMATION, FICHIER_ID, FICHIER_SALLES, FICHIER_ATTENTE };
+    db_formation *dbf;
+    db_personne *dbp;
+    FILE *rapport = stdout;
+    double debut = maintenant();
+    int i, reparer = 0, nb, repares = 0, res = 1;
+    for( i = 0; i < argc; i++ )
+    {
+        if( strcmp( argv[i], "-r" ) == 0 )
+        {
+            reparer = 1;
+        }
+        else if( strcmp( argv[i], "-o" ) == 0 && i + 1 < argc && rapport == stdout )
+        {
+            i += 1;
+            rapport = fopen( argv[i], "w" );
+            if( rapport == NULL )
             {
-                reduction = 1;
+                fprintf( stderr, "Impossible d'ecrire %s\n", argv[i] );
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf( stderr, "Usage: CaculliTyranowski verifier [-r] [-o rapport]\n" );
+            if( rapport != stdout )
+            {
+                fclose( rapport );
             }
+            return 1;
         }
     }
-    personne *tmpp = creer_personne( nom, prenom, formateur );
-    if( tmpdbp->head == NULL )
+    dbp = creer_db_personne();
+    dbf = creer_db_formation();
+    chargement.journal = rapport;
+    chargement.nb = 0;
+    charger_db( dbf, dbp );
+    chargement.journal = NULL;
+    nb = chargement.nb;
+    repares = reparer ? chargement.nb : 0;
+    nb += verifier_references( dbf, dbp, rapport, reparer, &repares );
+    if( nb == repares )
     {
-        tmpp->id = 1;
+        nb += verifier_invariants( dbf, dbp, rapport );
     }
-    else
+    fprintf( rapport, "%d personne(s) et %d formation(s) verifiees en %.3f s: %d probleme(s), %d repare(s)\n",
+             dbp->nb, dbf->nb, maintenant() - debut, nb, repares );
+    if( repares > 0 )
     {
-        tmpp->id = tmpdbp->head->p->id + 1;
+        for( i = 0; i < 5 && res; i++ )
+        {
+            char copie[ 256 ];
+            FILE *existe = fopen( fichiers[i], "r" );
+            if( existe == NULL )
+            {
+                continue;
+            }
+            fclose( existe );
+            res = garder_copie( fichiers[i], "_ORIGINAL", copie );
+            fprintf( rapport, res ? "Fichier d'origine %s garde dans %s\n" : "ERREUR: impossible de garder %s\n",
+                     fichiers[i], copie );
+        }
+        res = res && sauvegarder_db( dbf, dbp, 0, -1 );
+        fprintf( rapport, res ? "Base de donnees corrigee sauvegardee\n" :
+                 "ERREUR: la base de donnees corrigee n'a pas ete sauvegardee, les fichiers d'origine sont intacts\n" );
     }
-    if( tmpp->formateur == 0 )
+    if( rapport != stdout )
     {
-        tmpp->reduction = reduction;
-        if( reduction == 1 )
+        fclose( rapport );
+    }
+    liberer_db_personne( dbp );
+    liberer_db_formation( dbf );
+    return res && nb == repares ? 0 : 1;
+}
+
+/*                              FIN VERIFICATION                             */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                PARTITIONS                                 */
+
+/*
+ * La base de donnees peut etre partagee en partitions, une par annee academique et par campus. Une partition est
+ * un dossier annee/campus qui contient ses propres fichiers .dat, et le registre CaculliTyranowskiPartitions.dat
+ * du dossier courant les enumere, une ligne "annee campus" par partition.
+ * L'option -P choisit les partitions avant la commande (voir main). Avec une seule partition, le programme
+ * travaille dans son dossier comme il le ferait dans le dossier courant. Avec plusieurs, la commande requete est
+ * executee dans chacune d'elles en parallele, et chaque ligne commence par l'annee et le campus de sa partition.
+ * Une partition n'est chargee qu'au moment ou une commande en a besoin, et celles qui ont servi le moins
+ * recemment sont dechargees quand la memoire estimee des partitions chargees depasse le budget.
+ */
+#define FICHIER_PARTITIONS "CaculliTyranowskiPartitions.dat"
+
+/*
+ * Le budget memoire des partitions chargees, en megaoctets, si la variable d'environnement
+ * CACULLITYRANOWSKI_MEMOIRE ne le donne pas.
+ */
+#define MEMOIRE_PARTITIONS_DEFAUT 512
+
+/*
+ * Une partition de la base de donnees.
+ * char annee[16], campus[48] : L'annee academique (par exemple 2023-2024) et le campus.
+ * char dossier[64] : Le dossier de ses fichiers .dat, annee/campus.
+ * paire_db bases : Ses bases de donnees, dbf et dbp valent NULL tant qu'elle n'est pas chargee.
+ * unsigned long octets : La memoire estimee de ses bases de donnees quand elle est chargee.
+ * unsigned long acces : Le moment de son dernier acces, sur l'horloge du registre.
+ * int choisie : 1 si elle a ete choisie par l'option -P.
+ * int epinglee : 1 si elle ne peut pas etre dechargee, parce qu'une requete l'utilise.
+ */
+typedef struct partition
+{
+    char annee[16];
+    char campus[48];
+    char dossier[64];
+    paire_db bases;
+    unsigned long octets;
+    unsigned long acces;
+    int choisie;
+    int epinglee;
+} partition;
+
+/*
+ * Le registre des partitions.
+ * int ouvert : 1 si le registre a deja ete lu.
+ * int existe : 1 si le fichier du registre existait a l'ouverture.
+ * int nb_choisies : Le nombre de partitions choisies par l'option -P, 0 sans l'option.
+ * unsigned long budget : Le budget memoire, en octets. Il peut etre depasse d'une partition, car une partition
+ * est toujours chargee en entier, et par les partitions epinglees (voir ecrire_requete_partitions).
+ * unsigned long octets : La memoire estimee des bases de donnees des partitions chargees, sans leurs noms (voir
+ * memoire_partitions).
+ * unsigned long horloge : Augmente a chaque acces a une partition.
+ * int nb_chargements, nb_dechargements : Le nombre de partitions chargees et dechargees depuis l'ouverture.
+ */
+typedef struct registre_partitions
+{
+    partition *partitions;
+    int nb;
+    int capacite;
+    int ouvert;
+    int existe;
+    int nb_choisies;
+    unsigned long budget;
+    unsigned long octets;
+    unsigned long horloge;
+    int nb_chargements;
+    int nb_dechargements;
+} registre_partitions;
+
+registre_partitions registre;
+
+/*
+ * Cette fonction renvoie 1 si texte peut etre le nom d'une annee ou d'un campus (et donc d'un dossier) de moins
+ * de taille caracteres: des lettres, des chiffres, '-', '_' ou '.', sans commencer par un point.
+ */
+int nom_partition_valide( const char *texte, size_t taille )
+{
+    const char *c;
+    if( texte[0] == '\0' || texte[0] == '.' || strlen( texte ) >= taille )
+    {
+        return 0;
+    }
+    for( c = texte; *c; c++ )
+    {
+        if( !isalnum( ( unsigned char ) *c ) && *c != '-' && *c != '_' && *c != '.' )
         {
-            tmpp->val_reduction = pourcent_reduction;
+            return 0;
         }
     }
-    else
+    return 1;
+}
+
+/*
+ * Cette fonction renvoie la partition de l'annee annee et du campus campus, NULL si elle n'existe pas.
+ */
+partition *chercher_partition( const char *annee, const char *campus )
+{
+    int i;
+    for( i = 0; i < registre.nb; i++ )
     {
-        tmpp->nb_jours_indisponible = nb_jours_indisponible;
-        if( nb_jours_indisponible > 0 )
+        if( strcmp( registre.partitions[i].annee, annee ) == 0 && strcmp( registre.partitions[i].campus, campus ) == 0 )
         {
-            memcpy( tmpp->jours_indisponible, jours_indisponible, sizeof(tmpp->jours_indisponible) );
+            return &registre.partitions[i];
         }
     }
-    char confirmation[4];
-    printf( "* Etes vous sur de vouloir ajouter %s: %s %s a la base de donnees ? (o/n) ",
-            tmpp->formateur ? "formateur" : "etudiant", tmpp->prenom, tmpp->nom );
-    scanf( "%s", confirmation );
-    while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
-           strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
+    return NULL;
+}
+
+/*
+ * Cette fonction sert a ajouter au registre la partition de l'annee annee et du campus campus, qui doivent etre
+ * des noms valides. On renvoie la partition ajoutee.
+ */
+partition *ajouter_partition( const char *annee, const char *campus )
+{
+    partition *p;
+    if( registre.nb == registre.capacite )
     {
-        printf( "Veuillez inserer o / oui - n / non : " );
-        scanf( "%s", confirmation );
+        registre.capacite = registre.capacite ? registre.capacite * 2 : 8;
+        registre.partitions = ( partition * ) REALLOUER( registre.partitions,
+                                                          registre.capacite * sizeof( partition ), "partition" );
     }
-    if( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 )
+    p = &registre.partitions[ registre.nb++ ];
+    memset( p, 0, sizeof( partition ) );
+    strcpy( p->annee, annee );
+    strcpy( p->campus, campus );
+    sprintf( p->dossier, "%s/%s", annee, campus );
+    return p;
+}
+
+/*
+ * Cette fonction sert a decharger la partition p: ses bases de donnees sont liberees, et ses noms relaches.
+ */
+void decharger_partition( partition *p )
+{
+    if( p->bases.dbp == NULL )
     {
-        ajouter_db_personne( p, tmpp );
-        system( clear );
-        printf( "* %s %s a ete ajoute(e) a la base de donnees avec succes *\n", tmpp->nom, tmpp->prenom );
+        return;
     }
-    else
+    liberer_db_personne( p->bases.dbp );
+    liberer_db_formation( p->bases.dbf );
+    p->bases.dbp = NULL;
+    p->bases.dbf = NULL;
+    registre.octets -= p->octets;
+    registre.nb_dechargements += 1;
+}
+
+/*
+ * Cette fonction est enregistree avec atexit quand le registre est ouvert: elle decharge toutes les partitions et
+ * libere le registre.
+ */
+void fermer_registre_a_la_sortie()
+{
+    int i;
+    for( i = 0; i < registre.nb; i++ )
     {
-        system( clear );
-        printf( "* %s %s n'a PAS ete ajoute(e) a la base de donnees *\n", tmpp->nom, tmpp->prenom );
+        decharger_partition( &registre.partitions[i] );
     }
+    LIBERER( registre.partitions );
+    registre.partitions = NULL;
+    registre.nb = registre.capacite = 0;
 }
 
-int menu_creer( db_formation *f, db_personne *p )
+/*
+ * Cette fonction sert a lire le registre des partitions du dossier courant, s'il ne l'a pas deja ete, et a fixer le
+ * budget memoire. Une ligne mal formee ou en double est ignoree.
+ * On renvoie 1 si le registre existe, 0 s'il n'existe pas (le registre est alors vide).
+ */
+int ouvrir_registre()
 {
-    int choix;
-    do
+    FILE *freg;
+    char annee[64], campus[64];
+    const char *memoire = getenv( "CACULLITYRANOWSKI_MEMOIRE" );
+    long mo = memoire != NULL ? atol( memoire ) : MEMOIRE_PARTITIONS_DEFAUT;
+    if( registre.ouvert )
     {
-        db_formation *tmpdbf = f;
-        db_personne *tmpdbp = p;
-        printf( "********************************************************************************\n" );
-        printf( "* MENU AJOUT                                                                   *\n" );
-        printf( "********************************************************************************\n" );
-        printf( "* 1. Ajouter une nouvelle personne a la base de donnees                        *\n" );
-        printf( "* 2. Ajouter une nouvelle formation a la base de donneees                      *\n" );
-        printf( "* 0. Retour                                                                    *\n" );
-        printf( "********************************************************************************\n" );
-        printf( "* Que voudriez-vous ajouter a la base de donnees ? " );
-        scanf( "%d", &choix );
-        getchar();
-        switch( choix )
+        return registre.existe;
+    }
+    registre.ouvert = 1;
+    registre.budget = ( unsigned long ) ( mo > 0 ? mo : MEMOIRE_PARTITIONS_DEFAUT ) * 1024 * 1024;
+    atexit( fermer_registre_a_la_sortie );
+    freg = fopen( FICHIER_PARTITIONS, "r" );
+    if( freg == NULL )
+    {
+        return 0;
+    }
+    registre.existe = 1;
+    while( fscanf( freg, "%63s %63s", annee, campus ) == 2 )
+    {
+        if( !nom_partition_valide( annee, sizeof( registre.partitions->annee ) ) ||
+            !nom_partition_valide( campus, sizeof( registre.partitions->campus ) ) ||
+            chercher_partition( annee, campus ) != NULL )
         {
-            case 1:
-                menu_creer_personne( tmpdbp );
-                break;
-            case 2:
-                menu_creer_formation( tmpdbf );
-                break;
-            case 0:
-                system( clear );
-                break;
-            default:
-                system( clear );
-                printf( "/!\\ Option %d - INVALIDE /!\\\n", choix );
-                break;
+            fprintf( stderr, "Partition %s %s ignoree: nom invalide ou deja enregistre\n", annee, campus );
+            continue;
         }
-    } while( choix != 0 );
-    return 0;
+        ajouter_partition( annee, campus );
+    }
+    fclose( freg );
+    return 1;
 }
 
-void menu_ajouter_formation( db_formation *f, db_personne *p )
+/*
+ * Cette fonction sert a ecrire le registre des partitions dans le fichier freg, elle peut etre passee a
+ * ecrire_fichier_atomique.
+ */
+void ecrire_registre( void *db, FILE *freg )
 {
-    db_formation *tmpdbf =f;
-    noeud_db_formation *tmpndbf = tmpdbf->head;
-    db_personne *tmpdbp = p;
-    noeud_db_personne *tmpndbp = tmpdbp->head;
-    printf( "********************************************************************************\n" );
-    printf( "* MENU ATTRIBUTION                                                             *\n" );
-    printf( "********************************************************************************\n" );
-    printf( "********************************************************************************\n" );
-    printf( "* Liste des cours                                                              *\n" );
-    printf( "********************************************************************************\n" );
-    printf( "* %2s %-40s                                  *\n", "ID", "Nom" );
-    printf( "* ---------------------------------------------------------------------------- *\n" );
-    while( tmpndbf != NULL )
-    {
-        formation *tmpf = tmpndbf->f;
-        printf( "* %2d %-40s                                  *\n", tmpf->id, tmpf->nom );
-        tmpndbf = tmpndbf->next;
-    }
-    tmpndbf = tmpdbf->head;
-    printf( "*  0 Retour                                                                    *\n" );
-    printf( "********************************************************************************\n" );
-    int cours;
-    printf( "* A quelle formation voudriez vous attribuer une personne? " );
-    scanf( "%d", &cours );
-    getchar();
-    while( cours < 0 && cours > tmpndbf->f->id )
+    registre_partitions *reg = ( registre_partitions * ) db;
+    int i;
+    for( i = 0; i < reg->nb; i++ )
     {
-        printf( "* Valeur %d - INVALIDE! *\n", cours );
-        printf( "* A quelle formation voudriez vous attribuer une personne? " );
-        scanf( "%d", &cours );
-        getchar();
+        fprintf( freg, "%s %s\n", reg->partitions[i].annee, reg->partitions[i].campus );
     }
-    if( cours <= 0 )
+}
+
+/*
+ * Cette fonction renvoie 1 si la partition p correspond au motif motif: annee/campus, annee (tous ses campus),
+ * ou l'une des deux parties remplacee par * (toutes les annees ou tous les campus).
+ */
+int correspondre_partition( partition *p, const char *motif )
+{
+    const char *barre = strchr( motif, '/' );
+    size_t n = barre != NULL ? ( size_t ) ( barre - motif ) : strlen( motif );
+    int annee = ( n == 1 && motif[0] == '*' ) || ( n == strlen( p->annee ) && strncmp( motif, p->annee, n ) == 0 );
+    int campus = barre == NULL || strcmp( barre + 1, "*" ) == 0 || strcmp( barre + 1, p->campus ) == 0;
+    return annee && campus;
+}
+
+/*
+ * Cette fonction sert a choisir les partitions qui correspondent a l'un des motifs de selection, separes par des
+ * virgules (voir correspondre_partition). On renvoie le nombre de partitions choisies, 0 si un motif ne
+ * correspond a aucune partition.
+ */
+int choisir_partitions( const char *selection )
+{
+    char motifs[256];
+    char *motif;
+    int i;
+    if( strlen( selection ) >= sizeof( motifs ) )
     {
-        system( clear );
-        return;
+        fprintf( stderr, "Selection de partitions trop longue\n" );
+        return 0;
     }
-    while( tmpndbf != NULL )
+    strcpy( motifs, selection );
+    for( motif = strtok( motifs, "," ); motif != NULL; motif = strtok( NULL, "," ) )
     {
-        if( cours == tmpndbf->f->id )
+        int trouve = 0;
+        for( i = 0; i < registre.nb; i++ )
         {
-            printf( "********************************************************************************\n" );
-            printf( "* Liste des personnes                                                          *\n" );
-            printf( "********************************************************************************\n" );
-            printf( "* Formation choisie: %-40s                  *\n", tmpndbf->f->nom );
-            printf( "********************************************************************************\n" );
-            afficher_db_personne( tmpdbp );
-            printf( "*  0 Retour                                                                    *\n" );
-            printf( "********************************************************************************\n" );
-            int p;
-            printf( "* Qui voudriez vous attribuer a la formation : %s ? ", tmpndbf->f->nom );
-            scanf( "%d", &p );
-            getchar();
-            while( p < 0 && p > tmpndbp->p->id )
-            {
-                printf( "* Valeur %d - INVALIDE\n", p );
-                printf( "* Qui voudriez vous attribuer a la formation : %s ? ", tmpndbf->f->nom );
-                scanf( "%d", &p );
-                getchar();
-            }
-            if( p <= 0 )
+            if( correspondre_partition( &registre.partitions[i], motif ) )
             {
-                system( clear );
-                return;
-            }
-            while ( tmpndbp != NULL )
-            {
-                if ( p == tmpndbp->p->id )
-                {
-                    char confirmation[4];
-                    printf( "* Etes vous sur de vouloir attribuer %s %s a la formation %s ? (o/n) ",
-                            tmpndbp->p->nom, tmpndbp->p->prenom, tmpndbf->f->nom );
-                    scanf( "%s", confirmation );
-                    while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
-                           strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
-                    {
-                        printf( "Veuillez inserer o / oui - n / non : " );
-                        scanf( "%s", confirmation );
-                    }
-                    if( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 )
-                    {
-                        int res = ajouter_formation( tmpndbf->f, tmpndbp->p );
-                        if ( res == 1 )
-                        {
-                            tmpndbp->p->nb_formations += 1;
-                            tmpndbp->p->formations[ tmpndbp->p->nb_formations - 1 ] = tmpndbf->f->id;
-                            system( clear );
-                            printf( "* %s %s a ete attribue(e) a la formation %s avec succes *\n",
-                                    tmpndbp->p->nom, tmpndbp->p->prenom, tmpndbf->f->nom );
-                            break;
-                        }
-                        system( clear );
-                        printf( "* %s %s est deja present dans la formation %s *\n" ,
-                                tmpndbp->p->nom, tmpndbp->p->prenom, tmpndbf->f->nom );
-                        break;
-                    }
-                    else
-                    {
-                        system( clear );
-                        printf( "* %s %s n'a PAS ete attribue(e) a la formation %s *\n" ,
-                                tmpndbp->p->nom, tmpndbp->p->prenom, tmpndbf->f->nom );
-                    }
-                }
-                tmpndbp = tmpndbp->next;
+                registre.nb_choisies += !registre.partitions[i].choisie;
+                registre.partitions[i].choisie = 1;
+                trouve = 1;
             }
-            break;
         }
-        tmpndbf = tmpndbf->next;
+        if( !trouve )
+        {
+            fprintf( stderr, "Aucune partition ne correspond a %s\n", motif );
+            return 0;
+        }
     }
+    return registre.nb_choisies;
 }
 
-void menu_supprimer_personne( db_formation *dbf, db_personne *dbp )
+/*
+ * Cette fonction renvoie une estimation de la memoire occupee par les bases de donnees dbf et dbp: les pages, les
+ * vecteurs d'ordre et les index, les inscrits, l'index des seances, les salles et les listes d'attente.
+ * Les noms sont internes et partages entre les partitions, ils sont comptes a part par memoire_partitions.
+ */
+unsigned long estimer_octets_db( db_formation *dbf, db_personne *dbp )
 {
-    int idp;
-    db_formation *tmpdbf = dbf;
-    noeud_db_formation *tmpndbf = tmpdbf->head;
-    db_personne *tmpdbp = dbp;
-    noeud_db_personne *tmpndbp = tmpdbp->head;
-    afficher_db_personne( tmpdbp );
-    printf( "*  0 Retour                                                                    *\n" );
-    printf( "* Quelle personne voudriez vous supprimer entierement ? " );
-    scanf( "%d", &idp );
-    getchar();
-    while( idp < 0 && idp > tmpndbp->p->id )
+    curseur_formation c;
+    formation *f;
+    unsigned long octets = sizeof( db_personne ) + sizeof( db_formation );
+    int k, j;
+    for( k = 0; k < dbp->nb_pages; k++ )
     {
-        printf( "* Option %d - INVALIDE\n", idp );
-        printf( "* Quelle personne voudriez vous supprimer entierement ? " );
-        scanf( "%d", &idp );
-        getchar();
+        octets += sizeof( page_personne * ) + ( dbp->pages[k] != NULL ? sizeof( page_personne ) : 0 );
     }
-    if( idp <= 0 )
+    for( k = 0; k < dbf->nb_pages; k++ )
     {
-        system( clear );
-        return;
+        octets += sizeof( page_formation * ) + ( dbf->pages[k] != NULL ? sizeof( page_formation ) : 0 );
     }
-    while( tmpndbf != NULL )
+    octets += ( unsigned long ) ( dbp->capacite_ordre + dbf->capacite_ordre ) * sizeof( int );
+    octets += ( unsigned long ) dbp->capacite_index * sizeof( personne * );
+    octets += ( unsigned long ) dbf->capacite_index * sizeof( formation * );
+    octets += ( unsigned long ) ( dbp->ids.nb_mots + dbf->ids.nb_mots ) * sizeof( unsigned int );
+    for( f = debut_curseur_formation( &c, dbf, ORDRE_ID ); f != NULL; f = suivant_curseur_formation( &c ) )
     {
-        formation *tmpf = tmpndbf->f;
-        noeud_formation *tmpnf = tmpf->head;
-        while( tmpnf != NULL )
+        octets += ( unsigned long ) f->capacite_inscrits * sizeof( personne * );
+        if( f->attente != NULL )
         {
-            if( tmpnf->p->id == idp )
-            {
-                supprimer_personne_de_formation( tmpf, tmpnf->p->id );
-                break;
-            }
-            tmpnf = tmpnf->next;
+            octets += sizeof( file_attente ) + ( unsigned long ) f->attente->capacite * sizeof( demande_attente * );
         }
-        tmpndbf = tmpndbf->next;
     }
-    tmpndbf = tmpdbf->head;
-    tmpndbp = tmpdbp->head;
-    while( tmpndbp != NULL )
+    for( k = 0; k < 7; k++ )
     {
-        if( tmpndbp->p->id == idp )
+        for( j = 0; j < 24; j++ )
         {
-            char nom[40], prenom[40];
-            strcpy( nom, tmpndbp->p->nom );
-            strcpy( prenom, tmpndbp->p->prenom );
-            char confirmation[4];
-            printf( "* Etes vous sur de vouloir supprimer %s %s entierement de la base de donnees ? (o/n) ",
-                    nom, prenom );
-            scanf( "%s", confirmation );
-            while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
-                   strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
-            {
-                printf( "Veuillez inserer o / oui - n / non : " );
-                scanf( "%s", confirmation );
-            }
-            if( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 )
-            {
-                supprimer_db_personne( tmpdbp, idp );
-                system( clear );
-                printf( "* %s %s a ete supprime(e) entierement de la base de donnees *\n",
-                        nom, prenom );
-            }
-            else
+            octets += ( unsigned long ) dbf->horaire[k][j].capacite * sizeof( seance );
+        }
+    }
+    octets += ( unsigned long ) dbf->capacite_salles * sizeof( salle );
+    octets += ( unsigned long ) dbf->attentes.capacite * sizeof( demande_attente * );
+    octets += ( unsigned long ) dbf->attentes.nb * sizeof( demande_attente );
+    return octets;
+}
+
+/*
+ * Cette fonction renvoie la memoire estimee des partitions chargees: leurs bases de donnees, plus les noms
+ * internes qu'elles partagent et l'index des trigrammes de ces noms.
+ */
+unsigned long memoire_partitions()
+{
+    return registre.octets + estimer_octets_chaines();
+}
+
+/*
+ * Cette fonction sert a charger la partition p si elle ne l'est pas encore, et a noter son acces.
+ * Avant de la charger, les partitions non epinglees qui ont servi le moins recemment sont dechargees tant que la
+ * memoire des partitions chargees atteint le budget.
+ */
+void charger_partition( partition *p )
+{
+    p->acces = ++registre.horloge;
+    if( p->bases.dbp != NULL )
+    {
+        return;
+    }
+    while( memoire_partitions() >= registre.budget )
+    {
+        partition *ancienne = NULL;
+        int i;
+        for( i = 0; i < registre.nb; i++ )
+        {
+            partition *q = &registre.partitions[i];
+            if( q->bases.dbp != NULL && !q->epinglee && ( ancienne == NULL || q->acces < ancienne->acces ) )
             {
-                system( clear );
-                printf( "* %s %s n'a PAS ete supprimer de la base de donnees *\n",
-                        nom, prenom );
+                ancienne = q;
             }
+        }
+        if( ancienne == NULL )
+        {
             break;
         }
-        tmpndbp = tmpndbp->next;
+        decharger_partition( ancienne );
     }
-    tmpndbf = tmpdbf->head;
-    tmpndbp = tmpdbp->head;
+    p->bases.dbp = creer_db_personne();
+    p->bases.dbf = creer_db_formation();
+    charger_db_dossier( p->bases.dbf, p->bases.dbp, p->dossier );
+    p->octets = estimer_octets_db( p->bases.dbf, p->bases.dbp );
+    registre.octets += p->octets;
+    registre.nb_chargements += 1;
 }
 
-void menu_supprimer_formation( db_formation *dbf, db_personne *dbp )
+/*
+ * Cette fonction sert a se placer dans le dossier de la seule partition choisie, afin que la commande (ou le
+ * programme interactif) y travaille comme dans le dossier courant. On renvoie 1 si reussite, 0 si pas.
+ */
+int entrer_partition()
 {
-    int idf;
-    db_formation *tmpdbf = dbf;
-    noeud_db_formation *tmpndbf = tmpdbf->head;
-    db_personne *tmpdbp = dbp;
-    noeud_db_personne *tmpndbp = tmpdbp->head;
-    printf( "********************************************************************************\n" );
-    printf( "* MENU SUPPRESSION : Liste des formations                                      *\n" );
-    printf( "********************************************************************************\n" );
-    printf( "* %2s %-40s                                  *\n", "ID", "Nom" );
-    printf( "* ---------------------------------------------------------------------------- *\n" );
-    while( tmpndbf != NULL )
+    int i;
+    for( i = 0; i < registre.nb && !registre.partitions[i].choisie; i++ )
     {
-        formation *tmpf = tmpndbf->f;
-        printf( "* %2d %-40s                                  *\n", tmpf->id, tmpf->nom );
-        tmpndbf = tmpndbf->next;
     }
-    tmpndbf = tmpdbf->head;
-    printf( "*  0 Retour                                                                    *\n" );
-    printf( "********************************************************************************\n" );
-    printf( "* Quelle formation voudriez vous supprimer? " );
-    scanf( "%d", &idf );
-    getchar();
-    printf( "********************************************************************************\n" );
-    while( idf < 0 && idf > tmpndbf->f->id )
+#ifdef HAVE_UNISTD_H
+    if( i < registre.nb && chdir( registre.partitions[i].dossier ) == 0 )
+    {
+        return 1;
+    }
+#endif
+    fprintf( stderr, "Impossible d'entrer dans le dossier de la partition %s\n",
+             i < registre.nb ? registre.partitions[i].dossier : "?" );
+    return 0;
+}
+
+/*
+ * Cette fonction renvoie le nombre de partitions choisies par l'option -P, 0 sans l'option.
+ */
+int nb_partitions_choisies()
+{
+    return registre.nb_choisies;
+}
+
+/*
+ * Cette fonction sert a ecrire dans sortie le nombre de partitions chargees et dechargees et la memoire estimee
+ * des partitions encore chargees.
+ */
+void bilan_partitions( FILE *sortie )
+{
+    fprintf( sortie, "%d partition(s) choisie(s), %d chargement(s), %d dechargement(s), %lu kio sur %lu kio\n",
+             registre.nb_choisies, registre.nb_chargements, registre.nb_dechargements, memoire_partitions() / 1024,
+             registre.budget / 1024 );
+}
+
+/*
+ * Cette structure decrit l'execution d'une requete dans une partition par un ouvrier du pool.
+ * requete r : Une copie de la requete, executer_requete y note le plan et le nombre de candidats examines.
+ * resultat_requete *resultats : Les nb resultats, a liberer.
+ */
+typedef struct tache_partition
+{
+    partition *p;
+    requete r;
+    resultat_requete *resultats;
+    long nb;
+} tache_partition;
+
+/*
+ * Cette fonction sert a executer la requete de la tache arg dans sa partition, qui est deja chargee.
+ */
+void executer_requete_partition( void *arg )
+{
+    tache_partition *t = ( tache_partition * ) arg;
+    t->nb = executer_requete( &t->r, t->p->bases.dbf, t->p->bases.dbp, &t->resultats );
+}
+
+/*
+ * Une ligne retenue d'une requete executee dans plusieurs partitions, avec sa partition.
+ */
+typedef struct ligne_partition
+{
+    resultat_requete res;
+    partition *p;
+} ligne_partition;
+
+/*
+ * Les lignes retenues d'une requete executee dans plusieurs partitions.
+ * ligne_partition *lignes : Pour une requete triee, les nb meilleures lignes des partitions deja executees, dans
+ * l'ordre du tri et au plus autant que la limite. Une partition reste epinglee tant qu'elle a une ligne retenue.
+ * long restantes : Pour une requete sans tri, le nombre de lignes qui peuvent encore etre ecrites, -1 sans limite.
+ */
+typedef struct fusion_partitions
+{
+    ligne_partition *lignes;
+    long nb;
+    long restantes;
+} fusion_partitions;
+
+/*
+ * Cette fonction sert a fusionner les lignes retenues de fu avec les resultats des nb taches, deja tries et
+ * limites dans chaque partition, et a appliquer la limite de la requete r au resultat de la fusion. A chaque
+ * etape, la meilleure tete parmi les lignes retenues et les resultats de chaque tache est prise; a egalite, la
+ * premiere dans l'ordre du registre l'emporte. Seules les partitions qui gardent une ligne restent epinglees.
+ */
+void fusionner_lot_partitions( fusion_partitions *fu, requete *r, tache_partition *taches, int nb )
+{
+    ligne_partition *lignes;
+    long *positions, total = fu->nb, n;
+    int k, meilleure;
+    for( k = 0; k < nb; k++ )
     {
-        printf( "* Option %d - INVALIDE\n", idf );
-        printf( "* Quelle formation voudriez vous supprimer? " );
-        scanf( "%d", &idf );
-        getchar();
+        total += taches[k].nb;
     }
-    if( idf <= 0 )
+    if( r->limite >= 0 && total > r->limite )
     {
-        system( clear );
-        return;
+        total = r->limite;
     }
-    while( tmpndbf != NULL )
+    lignes = ( ligne_partition * ) ALLOUER( total + 1, sizeof( ligne_partition ), "lignes_partitions" );
+    positions = ( long * ) ALLOUER( nb + 1, sizeof( long ), "lignes_partitions" );
+    for( n = 0; n < total; n++ )
     {
-        formation *tmpf = tmpndbf->f;
-        if( idf == tmpf->id )
+        const resultat_requete *tete = NULL;
+        meilleure = -1;
+        if( positions[0] < fu->nb )
         {
-            char confirmation[4];
-            printf( "* Etes vous sur de vouloir supprimer %s entierement de la base de donnees ? (o/n) ",
-                    tmpf->nom );
-            scanf( "%s", confirmation );
-            while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
-                   strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
-            {
-                printf( "Veuillez inserer o / oui - n / non : " );
-                scanf( "%s", confirmation );
-            }
-            if( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 )
-            {
-                supprimer_db_formation( tmpdbf, idf );
-                while ( tmpndbp != NULL )
-                {
-                    personne *tmpp = tmpndbp->p;
-                    int k;
-                    for ( k = 0; k < tmpp->nb_formations - 1; k++ )
-                    {
-                        if ( tmpp->formations[ k ] == tmpf->id )
-                        {
-                            int l;
-                            for ( l = k; l < tmpp->nb_formations; l++ )
-                            {
-                                tmpp->formations[ l ] = tmpp->formations[ l + 1 ];
-                            }
-                            tmpp->nb_formations -= 1;
-                            break;
-                        }
-                    }
-                    tmpndbp = tmpndbp->next;
-                }
-                system( clear );
-                printf( "* %s a ete supprimee de la base de donnees *\n", tmpf->nom );
-            }
-            else
+            meilleure = 0;
+            tete = &fu->lignes[ positions[0] ].res;
+        }
+        for( k = 0; k < nb; k++ )
+        {
+            if( positions[ k + 1 ] < taches[k].nb &&
+                ( tete == NULL || comparer_resultats( &taches[k].resultats[ positions[ k + 1 ] ], tete ) < 0 ) )
             {
-                system( clear );
-                printf( "* %s n'a PAS ete supprimee de la base de donnees *\n", tmpf->nom );
+                meilleure = k + 1;
+                tete = &taches[k].resultats[ positions[ k + 1 ] ];
             }
-            break;
         }
-        tmpndbf = tmpndbf->next;
+        if( meilleure == 0 )
+        {
+            lignes[n] = fu->lignes[ positions[0]++ ];
+        }
+        else
+        {
+            lignes[n].res = *tete;
+            lignes[n].p = taches[ meilleure - 1 ].p;
+            positions[ meilleure ] += 1;
+        }
+    }
+    for( n = 0; n < fu->nb; n++ )
+    {
+        fu->lignes[n].p->epinglee = 0;
+    }
+    for( k = 0; k < nb; k++ )
+    {
+        taches[k].p->epinglee = 0;
     }
-    tmpndbf = tmpdbf->head;
+    for( n = 0; n < total; n++ )
+    {
+        lignes[n].p->epinglee = 1;
+    }
+    LIBERER( positions );
+    LIBERER( fu->lignes );
+    fu->lignes = lignes;
+    fu->nb = total;
 }
 
-int menu_supprimer_personne_de_formation( db_formation *dbf )
+/*
+ * Cette fonction sert a executer les nb taches de taches en parallele. Pour une requete sans tri, leurs resultats
+ * sont ensuite ecrits avec l'exporteur ex, partition par partition dans l'ordre du registre, jusqu'a la limite
+ * de la requete, et les partitions sont desepinglees. Pour une requete triee, ils sont fusionnes avec les lignes
+ * retenues de fu, qui seront ecrites a la fin.
+ * Le plan et le nombre de candidats examines sont reportes dans la requete r.
+ */
+void executer_lot_partitions( exporteur *ex, requete *r, tache_partition *taches, int nb, fusion_partitions *fu )
 {
-    int idf;
-    db_formation *tmpdbf = dbf;
-    noeud_db_formation *tmpndbf = tmpdbf->head;
-    printf( "********************************************************************************\n" );
-    printf( "* MENU SUPPRESSION : Liste des formations                                      *\n" );
-    printf( "********************************************************************************\n" );
-    while ( tmpndbf != NULL )
+    pool_taches *pool;
+    int i;
+    pool = creer_pool_taches( instrumentation || nb < 2 ? 0 : nombre_processeurs() );
+    for( i = 0; i < nb; i++ )
     {
-        formation *tmpf = tmpndbf->f;
-        printf( "* %2d %-40s                                  *\n", tmpf->id, tmpf->nom );
-        tmpndbf = tmpndbf->next;
+        soumettre_tache( pool, executer_requete_partition, &taches[i] );
     }
-    tmpndbf = tmpdbf->head;
-    printf( "*  0 Retour                                                                    *\n" );
-    printf( "* De quelle formation voudriez vous supprimer quelqu'un ? " );
-    scanf( "%d", &idf );
-    getchar();
-    while( idf < 0 && idf > tmpndbf->f->id )
+    attendre_pool_taches( pool );
+    detruire_pool_taches( pool );
+    for( i = 0; i < nb; i++ )
     {
-        printf( "* Option %d - INVALIDE\n", idf );
-        printf( "* De quelle formation voudriez vous supprimer quelqu'un ? " );
-        scanf( "%d", &idf );
-        getchar();
+        r->nb_examines += taches[i].r.nb_examines;
+        r->plan = r->plan == NULL || r->plan == taches[i].r.plan ? taches[i].r.plan : "plan propre a chaque partition";
     }
-    if ( idf <= 0 )
+    if( r->tri >= 0 )
     {
-        system( clear );
-        return 0;
+        fusionner_lot_partitions( fu, r, taches, nb );
     }
-    while( tmpndbf != NULL )
+    for( i = 0; i < nb; i++ )
     {
-        if( idf == tmpndbf->f->id )
+        if( r->tri < 0 )
         {
-            printf( "Cours choisi: %s\n", tmpndbf->f->nom );
-            formation *tmpf = tmpndbf->f;
-            noeud_formation *tmpnf = tmpf->head;
-            if( tmpnf == NULL )
-            {
-                system( clear );
-                printf( "* /!\\ La formation est vide /!\\                                        *\n" );
-                return 0;
-            }
-            while( tmpnf != NULL )
-            {
-                personne *tmpp = tmpnf->p;
-                printf( "* %2d %-25s %-25s %-10s            *\n",
-                        tmpp->id, tmpp->nom, tmpp->prenom, tmpp->formateur ? "Formateur" : "Etudiant" );
-                tmpnf = tmpnf->next;
-            }
-            tmpnf = tmpf->head;
-            printf( "*  0 Retour                                                                    *\n" );
-            int idp;
-            printf( "* Quelle personne voudriez vous supprimer de cette formation ? " );
-            scanf( "%d", &idp );
-            getchar();
-            while( idp < 0 && idp > tmpnf->p->id )
-            {
-                printf( "* Option %d - INVALIDE\n", idp );
-                printf( "* Quelle personne voudriez vous supprimer de cette formation ? " );
-                scanf( "%d", &idp );
-                getchar();
-            }
-            if( idp <= 0 )
-            {
-                system( clear );
-                return 0;
-            }
-            while( tmpnf != NULL )
-            {
-                personne *tmpp = tmpnf->p;
-                if( tmpp->id == idp )
-                {
-                    char confirmation[4];
-                    printf( "* Etes vous sur de vouloir supprimer %s %s de la formation %s ? (o/n) ",
-                            tmpp->nom, tmpp->prenom, tmpf->nom );
-                    scanf( "%s", confirmation );
-                    while( strcmp( confirmation, "o" ) != 0 && strcmp( confirmation, "oui" ) != 0 &&
-                           strcmp( confirmation, "n" ) != 0 && strcmp( confirmation, "non" ) != 0 )
-                    {
-                        printf( "Veuillez inserer o / oui - n / non : " );
-                        scanf( "%s", confirmation );
-                    }
-                    if( strcmp( confirmation, "o" ) == 0 || strcmp( confirmation, "oui" ) == 0 )
-                    {
-                        supprimer_personne_de_formation( tmpf, tmpp->id );
-                        int k;
-                        for ( k = 0; k < tmpp->nb_formations - 1; k++ )
-                        {
-                            if ( tmpp->formations[ k ] == tmpf->id )
-                            {
-                                int l;
-                                for ( l = k; l < tmpp->nb_formations; l++ )
-                                {
-                                    tmpp->formations[ l ] = tmpp->formations[ l + 1 ];
-                                }
-                                tmpp->nb_formations -= 1;
-                                break;
-                            }
-                        }
-                        system( clear );
-                        printf( "* %s %s a ete supprime de la formation %s avec succes *\n",
-                                tmpp->nom, tmpp->prenom, tmpf->nom );
-                        printf( "\n\n" );
-                        afficher_formation( tmpf );
-                        return 1;
-                    }
-                    else
-                    {
-                        system( clear );
-                        printf( "* %s %s n'a PAS ete supprime de la formation %s *\n",
-                                tmpp->nom, tmpp->prenom, tmpf->nom );
-                    }
-                }
-                tmpnf = tmpnf->next;
-            }
-            tmpnf = tmpf->head;
+            long n = fu->restantes >= 0 && taches[i].nb > fu->restantes ? fu->restantes : taches[i].nb;
+            ex->annee = taches[i].p->annee;
+            ex->campus = taches[i].p->campus;
+            exporter_lignes_requete( ex, &taches[i].r, taches[i].resultats, n );
+            fu->restantes -= fu->restantes >= 0 ? n : 0;
+            taches[i].p->epinglee = 0;
         }
-        tmpndbf = tmpndbf->next;
+        LIBERER( taches[i].resultats );
     }
-    tmpndbf = tmpdbf->head;
-    return 0;
 }
 
-int menu_supprimer( db_formation *dbf, db_personne *dbp )
+/*
+ * Cette fonction sert a executer la requete decrite par db dans chaque partition choisie et a ecrire les resultats
+ * dans fichier, elle peut etre passee a ecrire_fichier_atomique.
+ * Les partitions sont chargees une a une et epinglees, et des qu'elles atteignent le budget memoire, le lot de
+ * partitions chargees est execute en parallele puis desepingle, ce qui permet de decharger ses partitions pour
+ * charger les suivantes.
+ * Sans tri, les lignes sont ecrites partition par partition, et la limite porte sur l'ensemble: les partitions
+ * suivantes ne sont plus chargees des qu'elle est atteinte. Avec un tri, chaque partition garde ses meilleures
+ * lignes, dans la limite, et elles sont fusionnees avec celles des lots precedents: les partitions qui ont une
+ * ligne parmi les meilleures restent epinglees jusqu'a la fin, ce qui peut faire depasser le budget (sans limite,
+ * toutes celles qui ont une ligne).
+ */
+void ecrire_requete_partitions( void *db, FILE *fichier )
 {
-    int choix;
-    do
+    demande_requete *d = ( demande_requete * ) db;
+    tache_partition *taches = ( tache_partition * ) ALLOUER( registre.nb, sizeof( tache_partition ),
+                                                               "tache_partition" );
+    fusion_partitions fu;
+    exporteur ex;
+    long n;
+    int i, nb = 0;
+    ex.sortie = fichier;
+    ex.format = d->format;
+    ex.premier = 1;
+    ex.nb_lignes = 0;
+    ex.annee = "";
+    ex.campus = "";
+    exporter_entete_requete( &ex, d->r );
+    d->r->plan = NULL;
+    d->r->nb_examines = 0;
+    fu.lignes = NULL;
+    fu.nb = 0;
+    fu.restantes = d->r->tri < 0 || d->r->limite == 0 ? d->r->limite : -1;
+    for( i = 0; i < registre.nb && fu.restantes != 0; i++ )
     {
-        db_formation *tmpdbf = dbf;
-        db_personne *tmpdbp = dbp;
-        printf( "********************************************************************************\n" );
-        printf( "* MENU SUPPRESSION                                                             *\n" );
-        printf( "********************************************************************************\n" );
-        printf( "* 1. Supprimer une personne de la base de donnees                              *\n" );
-        printf( "* 2. Supprimer une formation de la base de donnes                              *\n" );
-        printf( "* 3. Supprimer une personne specifique d'une formation specifique              *\n" );
-        printf( "* 0. Retour                                                                    *\n" );
-        printf( "********************************************************************************\n" );
-        printf ("* Que voudriez vous supprimer ? " );
-        scanf( "%d", &choix );
-        getchar();
-        switch( choix )
+        partition *p = &registre.partitions[i];
+        if( !p->choisie )
         {
-            case 1:
-                menu_supprimer_personne( tmpdbf, tmpdbp );
-                break;
-            case 2:
-                menu_supprimer_formation( tmpdbf, tmpdbp );
-                break;
-            case 3:
-                menu_supprimer_personne_de_formation( tmpdbf );
-                break;
-            case 0:
-                system( clear );
-                break;
-            default:
-                system( clear );
-                break;
+            continue;
         }
-    } while( choix != 0 );
-    return 0;
+        charger_partition( p );
+        p->epinglee = 1;
+        taches[nb].p = p;
+        memcpy( &taches[nb].r, d->r, sizeof( requete ) );
+        if( d->r->tri < 0 )
+        {
+            taches[nb].r.limite = fu.restantes;
+        }
+        nb += 1;
+        if( memoire_partitions() >= registre.budget )
+        {
+            executer_lot_partitions( &ex, d->r, taches, nb, &fu );
+            nb = 0;
+        }
+    }
+    executer_lot_partitions( &ex, d->r, taches, nb, &fu );
+    for( n = 0; n < fu.nb; n++ )
+    {
+        ex.annee = fu.lignes[n].p->annee;
+        ex.campus = fu.lignes[n].p->campus;
+        exporter_lignes_requete( &ex, d->r, &fu.lignes[n].res, 1 );
+        fu.lignes[n].p->epinglee = 0;
+    }
+    if( d->r->plan == NULL )
+    {
+        d->r->plan = "aucune partition";
+    }
+    LIBERER( fu.lignes );
+    LIBERER( taches );
+    d->nb_lignes = ex.nb_lignes;
 }
 
-int menu_affichage( db_formation *f, db_personne *p )
+const char *colonnes_partitions[] = { "annee", "campus", "dossier", "personnes", "formations", "memoire_kio" };
+
+/*
+ * Commande partitions:
+ * - partitions liste [-f csv|jsonl] : charge chaque partition (celles choisies par -P, toutes sans l'option) et
+ *   ecrit son dossier, son nombre de personnes et de formations et sa memoire estimee, en kio;
+ * - partitions ajouter annee campus : cree le dossier de la partition et l'ajoute au registre.
+ */
+int commande_partitions( int argc, char *argv[] )
 {
-    int choix;
-    do
+    exporteur ex;
+    int i;
+    ouvrir_registre();
+    if( argc == 3 && strcmp( argv[0], "ajouter" ) == 0 )
     {
-        db_formation *tmpdbf = f;
-        db_personne *tmpdbp = p;
-        noeud_db_formation *tmpndbf = tmpdbf->head;
-        printf( "********************************************************************************\n" );
-        printf( "* MENU AFFICHAGE                                                               *\n" );
-        printf( "********************************************************************************\n" );
-        printf( "* 1. Liste des personnes                                                       *\n" );
-        printf( "* 2. Liste des formations                                                      *\n" );
-        printf( "* 3. Planning de la semaine                                                    *\n" );
-        printf( "* 0. Retour                                                                    *\n" );
-        printf( "********************************************************************************\n" );
-        printf( "* Que voudriez-vous afficher ? " );
-        scanf( "%d", &choix );
-        getchar();
-        switch( choix )
+        partition *p;
+#ifdef HAVE_SYS_STAT_H
+        struct stat st;
+#endif
+        if( !nom_partition_valide( argv[1], sizeof( p->annee ) ) ||
+            !nom_partition_valide( argv[2], sizeof( p->campus ) ) )
         {
-            case 1:
-                system( clear );
-                afficher_db_personne( tmpdbp );
-                break;
-            case 2:
-                system( clear );
-                printf( "* %2s %-40s %-6s                           *\n", "ID", "Nom", "Prix" );
-                printf( "* ---------------------------------------------------------------------------- *\n" );
-                while( tmpndbf != NULL )
-                {
-                    printf( "* %2d %-40s %6.2f                           *\n",
-                            tmpndbf->f->id, tmpndbf->f->nom, tmpndbf->f->prix );
-                    tmpndbf = tmpndbf->next;
-                }
-                tmpndbf = tmpdbf->head;
-                break;
-            case 3:
-                system( clear );
-                afficher_db_formation( tmpdbf );
-                break;
-            case 0:
-                system( clear );
-                break;
-            default:
-                system( clear );
-                printf( "/!\\ Option %d - INVALIDE /!\\\n", choix );
-                break;
+            fprintf( stderr, "Nom d'annee ou de campus invalide\n" );
+            return 1;
         }
-    } while( choix != 0 );
-    return 0;
+        if( chercher_partition( argv[1], argv[2] ) != NULL )
+        {
+            fprintf( stderr, "La partition %s/%s existe deja\n", argv[1], argv[2] );
+            return 1;
+        }
+        p = ajouter_partition( argv[1], argv[2] );
+#ifdef HAVE_SYS_STAT_H
+        mkdir( p->annee, 0777 );
+        mkdir( p->dossier, 0777 );
+        if( stat( p->dossier, &st ) != 0 || !S_ISDIR( st.st_mode ) )
+        {
+            fprintf( stderr, "Impossible de creer le dossier %s\n", p->dossier );
+            return 1;
+        }
+#else
+        printf( "Le dossier %s doit etre cree pour y placer les fichiers de la partition\n", p->dossier );
+#endif
+        if( !ecrire_fichier_atomique( FICHIER_PARTITIONS, ecrire_registre, &registre ) )
+        {
+            fprintf( stderr, "Impossible d'ecrire %s\n", FICHIER_PARTITIONS );
+            return 1;
+        }
+        return 0;
+    }
+    ex.sortie = stdout;
+    ex.format = EXPORT_CSV;
+    ex.premier = 1;
+    ex.nb_lignes = 0;
+    ex.annee = NULL;
+    if( argc == 3 && strcmp( argv[0], "liste" ) == 0 && strcmp( argv[1], "-f" ) == 0 &&
+        ( strcmp( argv[2], "csv" ) == 0 || strcmp( argv[2], "jsonl" ) == 0 ) )
+    {
+        ex.format = strcmp( argv[2], "jsonl" ) == 0 ? EXPORT_JSONL : EXPORT_CSV;
+    }
+    else if( argc != 1 || strcmp( argv[0], "liste" ) != 0 )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski [-P selection] partitions liste [-f csv|jsonl] | "
+                         "ajouter annee campus\n" );
+        return 1;
+    }
+    exporter_entete( &ex, colonnes_partitions, 6 );
+    for( i = 0; i < registre.nb; i++ )
+    {
+        partition *p = &registre.partitions[i];
+        if( registre.nb_choisies > 0 && !p->choisie )
+        {
+            continue;
+        }
+        charger_partition( p );
+        exporter_debut( &ex );
+        exporter_champ_texte( &ex, "annee", p->annee );
+        exporter_champ_texte( &ex, "campus", p->campus );
+        exporter_champ_texte( &ex, "dossier", p->dossier );
+        exporter_entier( &ex, "personnes", p->bases.dbp->nb );
+        exporter_entier( &ex, "formations", p->bases.dbf->nb );
+        exporter_entier( &ex, "memoire_kio", ( int ) ( p->octets / 1024 ) );
+        exporter_fin( &ex );
+    }
+    return fflush( stdout ) == 0 ? 0 : 1;
 }
 
-void ecrire_planning( db_formation *dbf )
+/*                              FIN PARTITIONS                               */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                               BANCS D'ESSAI                               */
+
+/*
+ * Cette structure regroupe les parametres du generateur de donnees et des bancs d'essai.
+ * int nb_personnes : Le nombre de personnes a generer (-p).
+ * int nb_formations : Le nombre de formations a generer (-f).
+ * int inscriptions : Le nombre moyen de formations par personne (-i).
+ * int prerequis : Le nombre maximum de prerequis par formation (-r).
+ * int jours : Le nombre maximum de jours de cours par semaine pour une formation (-j).
+ * unsigned long graine : La graine du generateur pseudo-aleatoire, les memes parametres donnent les memes
+ * fichiers (-g).
+ * int repetitions : Le nombre de fois que les bancs d'essai sont executes (-n).
+ * int operations : Le nombre d'operations mesurees par banc d'essai et par repetition (-o).
+ * const char *dossier : Le dossier dans lequel les fichiers sont ecrits (-d).
+ */
+typedef struct parametres_generation
 {
-    FILE *fres = fopen( "CaculliTyranowski.res", "w" );
-    int i;
-    db_formation *tmpdbf = dbf;
-    noeud_db_formation *tmpndbf = tmpdbf->head;
-    char jour[7][9] = { "Lundi", "Mardi", "Mercredi", "Jeudi", "Vendredi", "Samedi", "Dimanche" };
-    for( i = 1; i <= 7; i++ )
+    int nb_personnes;
+    int nb_formations;
+    int inscriptions;
+    int prerequis;
+    int jours;
+    unsigned long graine;
+    int repetitions;
+    int operations;
+    const char *dossier;
+} parametres_generation;
+
+/*
+ * Cette structure stocke les durees mesurees pour un banc d'essai.
+ * const char *nom : Le nom du banc d'essai.
+ * double *durees : Les durees de chaque operation, en secondes.
+ * int nb : Le nombre de durees mesurees.
+ * int capacite : La taille allouee pour durees.
+ */
+typedef struct mesure
+{
+    const char *nom;
+    double *durees;
+    int nb;
+    int capacite;
+} mesure;
+
+/*
+ * Generateur pseudo-aleatoire xorshift sur 32 bits. Il ne depend pas de rand(), les fichiers generes sont donc
+ * les memes sur toutes les plateformes pour une meme graine.
+ */
+unsigned long alea( unsigned long *etat )
+{
+    unsigned long x = *etat;
+    x ^= ( x << 13 ) & 0xFFFFFFFFUL;
+    x ^= x >> 17;
+    x ^= ( x << 5 ) & 0xFFFFFFFFUL;
+    *etat = x;
+    return x;
+}
+
+/*
+ * Cette fonction renvoie un entier pseudo-aleatoire entre min et max compris.
+ */
+int alea_entre( unsigned long *etat, int min, int max )
+{
+    if( max <= min )
     {
-        tmpndbf = tmpdbf->head;
-        fprintf( fres, "********************************************************************************\n" );
-        fprintf( fres, "Cours du: %s\n", jour[i - 1] );
-        fprintf( fres, "********************************************************************************\n" );
-        while( tmpndbf != NULL )
-        {
-            formation *tmp = tmpndbf->f;
-            int j;
-            for( j = 0; j < tmp->nb_jours; j++ )
-            {
-                if( tmp->jours[j] == i )
-                {
-                    formation *tmp = tmpndbf->f;
-                    noeud_formation *tmpnf = tmp->head;
-                    fprintf( fres, "ID: %d - Nom formation: %s\n", tmp->id, tmp->nom );
-                    fprintf( fres, "Participants dans la formation:\n" );
-                    fprintf( fres, "Formateurs:\n" );
-                    while( tmpnf != NULL )
-                    {
-                        if( tmpnf->p->formateur == 1 )
-                        {
-                            fprintf( fres, "%2d %s %s", tmpnf->p->id, tmpnf->p->nom, tmpnf->p->prenom );
-                            if( tmpnf != NULL ) fprintf( fres, "\n" );
-                        }
-                        tmpnf = tmpnf->next;
-                    }
-                    tmpnf = tmp->head;
-                    fprintf( fres, "Etudiants:\n" );
-                    while( tmpnf != NULL )
-                    {
-                        if( tmpnf->p->formateur == 0 )
-                        {
-                            fprintf( fres, "%2d %s %s", tmpnf->p->id, tmpnf->p->nom, tmpnf->p->prenom );
-                            if( tmpnf != NULL ) fprintf( fres, "\n" );
-                        }
-                        tmpnf = tmpnf->next;
-                    }
-                    fprintf( fres, "\n" );
-                    fprintf( fres, "De: %.2f - A %.2f\n", tmp->heures[j], tmp->heures[j] + tmp->durees[j] );
-                    fprintf( fres, "Prerequis: " );
-                    if( tmp->nb_prerequis > 0 )
-                    {
-                        db_formation *tmpdb = dbf;
-                        noeud_db_formation *tmp_prereq_ndbf = tmpdb->head;
-                        while( tmp_prereq_ndbf != NULL )
-                        {
-                            formation *tmp_prereq = tmp_prereq_ndbf->f;
-                            int k;
-                            for( k = 0; k < tmp->nb_prerequis; k++ )
-                            {
-                                if( tmp->prerequis[k] == tmp_prereq->id )
-                                {
-                                    fprintf( fres, "%s ", tmp_prereq->nom );
-                                }
-                            }
-                            tmp_prereq_ndbf = tmp_prereq_ndbf->next;
-                        }
-                        fprintf( fres, "\n\n" );
-                    }
-                    else
+        return min;
+    }
+    return min + ( int ) ( alea( etat ) % ( unsigned long ) ( max - min + 1 ) );
+}
+
+/*
+ * Cette fonction renvoie un reel pseudo-aleatoire dans [0, 1[.
+ */
+double alea_reel( unsigned long *etat )
+{
+    return ( double ) alea( etat ) / 4294967296.0;
+}
+
+/*
+ * Cette fonction renvoie l'identifiant d'une formation choisie avec une forte asymetrie: en elevant un reel
+ * uniforme au cube, quelques formations (les premieres) recoivent la plupart des inscriptions et la
+ * plupart des formations en recoivent peu.
+ */
+int alea_formation( unsigned long *etat, int nb_formations )
+{
+    double u = alea_reel( etat );
+    return 1 + ( int ) ( nb_formations * u * u * u );
+}
+
+/*
+ * Cette fonction sert a remplir dbf et dbp avec des donnees generees selon les parametres pg.
+ * Les formations sont creees d'abord (leurs prerequis sont choisis parmi les formations deja creees, il n'y a
+ * donc pas de cycle), puis les personnes, qui sont attribuees a leurs formations avec attribuer_formation.
+ * On renvoie le nombre d'inscriptions generees.
+ */
+int generer_db( db_formation *dbf, db_personne *dbp, parametres_generation *pg )
+{
+    char noms[16][16] = { "Mertens", "Kowal", "Berg", "Smith", "Brown", "Dupont", "Peeters", "Janssens",
+                          "Willems", "Goossens", "Martin", "Dubois", "Lambert", "Claes", "Jacobs", "Maes" };
+    char prenoms[16][16] = { "George", "Simon", "Adam", "John", "Donald", "Ghislain", "Nicolas", "Stephanie",
+                             "Jean", "Pierre", "Marie", "Sophie", "Julie", "Lucas", "Emma", "Louis" };
+    char sujets[16][16] = { "Anglais", "Latin", "Java", "Biologie", "Sociologie", "Jeux videos", "Microbiologie",
+                            "Medecine", "Chimie", "Physique", "Histoire", "Economie", "Droit", "Algebre",
+                            "Reseaux", "Philosophie" };
+    unsigned long etat = pg->graine ? pg->graine : 1;
+    int i, j, k, nb_inscriptions = 0;
+    for( i = 0; i < pg->nb_formations; i++ )
+    {
+        char nom[40];
+        int semaine[7] = { 1, 2, 3, 4, 5, 6, 7 };
+        int id = dbf->ids.haut + 1;
+        sprintf( nom, "%s %d", sujets[ alea( &etat ) % 16 ], id );
+        formation *tmpf = creer_formation( nom, alea_entre( &etat, 5000, 50000 ) );
+        tmpf->id = allouer_id( &dbf->ids );
+        tmpf->nb_jours = alea_entre( &etat, 1, pg->jours < 7 ? pg->jours : 7 );
+        for( j = 0; j < tmpf->nb_jours; j++ )
+        {
+            int l = alea_entre( &etat, j, 6 ), tmp = semaine[j];
+            semaine[j] = semaine[l];
+            semaine[l] = tmp;
+            tmpf->jours[j] = semaine[j];
+            tmpf->heures[j] = alea_entre( &etat, 6, 16 ) * 60 + alea_entre( &etat, 0, 3 ) * 15;
+            tmpf->durees[j] = alea_entre( &etat, 1, 4 ) * 60;
+        }
+        if( tmpf->id > 1 && alea( &etat ) % 3 == 0 )
+        {
+            int max = pg->prerequis < 10 ? pg->prerequis : 10;
+            tmpf->nb_prerequis = alea_entre( &etat, 1, max < tmpf->id - 1 ? max : tmpf->id - 1 );
+            for( j = 0; j < tmpf->nb_prerequis; j++ )
+            {
+                do
+                {
+                    tmpf->prerequis[j] = alea_entre( &etat, 1, tmpf->id - 1 );
+                    for( k = 0; k < j && tmpf->prerequis[k] != tmpf->prerequis[j]; k++ )
                     {
-                        fprintf( fres, "Aucun\n\n" );
                     }
-                }
+                } while( k < j );
             }
-            tmpndbf = tmpndbf->next;
         }
+        ranger_db_formation( dbf, tmpf );
     }
-    fclose( fres );
+    for( i = 0; i < pg->nb_personnes; i++ )
+    {
+        char nom[25];
+        int formateur = alea( &etat ) % 10 == 0, nb;
+        sprintf( nom, "%s%d", noms[ alea( &etat ) % 16 ], dbp->ids.haut + 1 );
+        personne *tmpp = creer_personne( nom, prenoms[ alea( &etat ) % 16 ], formateur );
+        tmpp->id = allouer_id( &dbp->ids );
+        if( formateur )
+        {
+            int semaine[7] = { 1, 2, 3, 4, 5, 6, 7 };
+            tmpp->nb_jours_indisponible = alea_entre( &etat, 0, 3 );
+            for( j = 0; j < tmpp->nb_jours_indisponible; j++ )
+            {
+                int l = alea_entre( &etat, j, 6 ), tmp = semaine[j];
+                semaine[j] = semaine[l];
+                semaine[l] = tmp;
+                tmpp->jours_indisponible[j] = semaine[j];
+            }
+        }
+        else if( alea( &etat ) % 10 < 3 )
+        {
+            tmpp->reduction = 1;
+            tmpp->val_reduction = alea_entre( &etat, 5, 50 );
+        }
+        tmpp = ranger_db_personne( dbp, tmpp );
+        if( tmpp == NULL )
+        {
+            break;
+        }
+        nb = alea_entre( &etat, 0, 2 * pg->inscriptions );
+        if( nb > pg->nb_formations )
+        {
+            nb = pg->nb_formations;
+        }
+        for( j = 0; j < nb; j++ )
+        {
+            formation *tmpf = get_formation_par_id( dbf, alea_formation( &etat, pg->nb_formations ) );
+            if( tmpf != NULL && attribuer_formation( tmpf, tmpp ) == 1 )
+            {
+                nb_inscriptions += 1;
+            }
+        }
+    }
+    return nb_inscriptions;
 }
 
 /*
- * Menu permettant a l'utilisateur d'interagir avec le programme
+ * Cette fonction sert a lire les options des commandes generer et bench dans pg.
+ * On renvoie 1 si reussite, 0 si une option est inconnue ou invalide.
  */
-int menu( db_formation *f, db_personne *p )
+int lire_parametres_generation( int argc, char *argv[], parametres_generation *pg )
 {
-    int choix;
-    do
+    int i;
+    for( i = 0; i < argc; i++ )
     {
-        printf( "********************************************************************************\n" );
-        printf( "* MENU PRINCIPALE                                                              *\n" );
-        printf( "********************************************************************************\n" );
-        db_formation *tmpdbf = f;
-        db_personne *tmpdbp = p;
-        printf( "* 1: Afficher la liste des etudiants/formateurs ou la liste des formations     *\n" );
-        printf( "* 2: Ajouter une nouvelle personne ou formation a la base de donnees           *\n" );
-        printf( "* 3: Attribuer une personne a une formation                                    *\n" );
-        printf( "* 4: Supprimer une formation, une personne ou une personne d'une formation     *\n" );
-        printf( "* 0: Quitter le programme                                                      *\n" );
-        printf( "********************************************************************************\n" );
-        printf( "* Que voudriez-vous faire ? " );
-        scanf( "%d", &choix );
-        getchar();
-        switch ( choix )
+        if( argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' || i + 1 >= argc )
         {
-            case 1:
-                system( clear );
-                menu_affichage( tmpdbf, tmpdbp );
+            fprintf( stderr, "Option %s - INVALIDE\n", argv[i] );
+            return 0;
+        }
+        switch( argv[i][1] )
+        {
+            case 'p':
+                pg->nb_personnes = atoi( argv[ i + 1 ] );
                 break;
-            case 2:
-                system( clear );
-                menu_creer( tmpdbf, tmpdbp );
+            case 'f':
+                pg->nb_formations = atoi( argv[ i + 1 ] );
                 break;
-            case 3:
-                system( clear );
-                menu_ajouter_formation( tmpdbf, tmpdbp );
+            case 'i':
+                pg->inscriptions = atoi( argv[ i + 1 ] );
                 break;
-            case 4:
-                system( clear );
-                menu_supprimer( tmpdbf, tmpdbp );
+            case 'r':
+                pg->prerequis = atoi( argv[ i + 1 ] );
                 break;
-            case 0:
-                printf( "Voulez vous sauvegarder les changements ? (o/n) " );
-                char choix_sauvegarde[4];
-                scanf( "%s", choix_sauvegarde );
-                if( strcmp( choix_sauvegarde, "o" ) == 0 || strcmp( choix_sauvegarde, "oui" ) == 0 )
-                {
-                    FILE *fdat_f = fopen( "CaculliTyranowskiFormation.dat", "w" );
-                    FILE *fdat_p = fopen( "CaculliTyranowskiPersonne.dat", "w" );
-                    noeud_db_formation *tmpndbf = tmpdbf->head;
-                    noeud_db_personne *tmpndbp = tmpdbp->head;
-                    db_formation *out_f = creer_db_formation();
-                    while ( tmpndbf != NULL )
-                    {
-                        ajouter_db_formation( out_f, tmpndbf->f );
-                        tmpndbf = tmpndbf->next;
-                    }
-                    tmpndbf = out_f->head;
-                    db_personne *out_p = creer_db_personne();
-                    while ( tmpndbp != NULL )
-                    {
-                        ajouter_db_personne( out_p, tmpndbp->p );
-                        tmpndbp = tmpndbp->next;
-                    }
-                    tmpndbp = out_p->head;
-                    while ( tmpndbp != NULL )
-                    {
-                        personne *tmpp = tmpndbp->p;
-                        fprintf( fdat_p, "%02d %-24s %-24s %d   %d   ",
-                                 tmpp->id, tmpp->nom, tmpp->prenom, tmpp->formateur, tmpp->nb_formations );
-                        int i;
-                        for ( i = 0; i < tmpp->nb_formations; i++ )
-                        {
-                            fprintf( fdat_p, "%d ", tmpp->formations[ i ] );
-                        }
-                        if ( tmpp->formateur == 0 )
-                        {
-                            fprintf( fdat_p, "   %d   ", tmpp->reduction );
-                            if ( tmpp->reduction > 0 )
-                            {
-                                fprintf( fdat_p, "%d", tmpp->val_reduction );
-                            }
-                        } else
-                        {
-                            fprintf( fdat_p, "  %d  ", tmpp->nb_jours_indisponible );
-                            for ( i = 0; i < tmpp->nb_jours_indisponible; i++ )
-                            {
-                                fprintf( fdat_p, "%d ", tmpp->jours_indisponible[ i ] );
-                            }
-                        }
-                        fprintf( fdat_p, "\n" );
-                        tmpndbp = tmpndbp->next;
-                    }
-                    tmpndbp = tmpdbp->head;
-                    while ( tmpndbf != NULL )
-                    {
-                        int i;
-                        formation *tmpf = tmpndbf->f;
-                        fprintf( fdat_f, "%02d %d ", tmpf->id, tmpf->nb_prerequis );
-                        if ( tmpf->nb_prerequis > 0 )
-                        {
-                            for ( i = 0; i < tmpf->nb_prerequis; i++ )
-                            {
-                                fprintf( fdat_f, "%d ", tmpf->prerequis[ i ] );
-                            }
-                            fprintf( fdat_f, "%d   ", tmpf->nb_jours );
-                        } else
-                        {
-                            fprintf( fdat_f, "  %d   ", tmpf->nb_jours );
-                        }
-                        for ( i = 0; i < tmpf->nb_jours; i++ )
-                        {
-                            fprintf( fdat_f, "%d   %.2f   %.2f   ",
-                                     tmpf->jours[ i ], tmpf->heures[ i ], tmpf->durees[ i ] );
-                        }
-                        fprintf( fdat_f, "%.2f %-s\n", tmpf->prix, tmpf->nom );
-                        tmpndbf = tmpndbf->next;
-                    }
-                    tmpndbf = tmpdbf->head;
-                    fclose( fdat_f );
-                    fclose( fdat_p );
-                    ecrire_planning( tmpdbf );
-                    printf( "Changements sauvegardes!\n" );
-                }
-                printf( "Fermeture du programme...\n" );
-                printf( "Au revoir!\n" );
+            case 'j':
+                pg->jours = atoi( argv[ i + 1 ] );
                 break;
-            default:
-                system( clear );
-                printf( "/!\\ Option %d - INVALIDE /!\\\n", choix );
+            case 'g':
+                pg->graine = strtoul( argv[ i + 1 ], NULL, 10 );
+                break;
+            case 'n':
+                pg->repetitions = atoi( argv[ i + 1 ] );
                 break;
+            case 'o':
+                pg->operations = atoi( argv[ i + 1 ] );
+                break;
+            case 'd':
+                pg->dossier = argv[ i + 1 ];
+                break;
+            default:
+                fprintf( stderr, "Option %s - INVALIDE\n", argv[i] );
+                return 0;
         }
-    } while ( choix != 0 );
-    return 0;
+        i += 1;
+    }
+    if( pg->nb_personnes < 0 || pg->nb_formations < 0 || pg->inscriptions < 0 || pg->prerequis < 0 ||
+        pg->jours < 1 || pg->repetitions < 1 || pg->operations < 1 ||
+        pg->nb_personnes > ID_MAX || pg->nb_formations > ID_MAX )
+    {
+        fprintf( stderr, "Parametres INVALIDES\n" );
+        return 0;
+    }
+    return 1;
 }
 
-int main( void )
+/*
+ * Cette fonction sert a initialiser pg avec les valeurs par defaut des commandes generer et bench.
+ */
+void initialiser_parametres_generation( parametres_generation *pg )
 {
-    system( clear );
-    printf( "Projet par Giorgio Caculli et Jedrzej Tyranowski\n" );
+    pg->nb_personnes = 10000;
+    pg->nb_formations = 500;
+    pg->inscriptions = 3;
+    pg->prerequis = 2;
+    pg->jours = 2;
+    pg->graine = 42;
+    pg->repetitions = 5;
+    pg->operations = 1000;
+    pg->dossier = ".";
+}
 
-    FILE *fdat_f = fopen( "CaculliTyranowskiFormation.dat", "r" );
-    FILE *fdat_p = fopen( "CaculliTyranowskiPersonne.dat", "r" );
+/*
+ * Commande generer: ecrit des fichiers .dat valides dans le dossier choisi, avec les noms utilises par le
+ * programme, on peut donc lancer le programme dans ce dossier pour utiliser les donnees generees.
+ */
+int commande_generer( int argc, char *argv[] )
+{
+    parametres_generation pg;
+    paire_db bases;
+    char chemin[ 256 ];
+    int nb_inscriptions, res;
+    initialiser_parametres_generation( &pg );
+    if( !lire_parametres_generation( argc, argv, &pg ) )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski generer [-p personnes] [-f formations] [-i inscriptions] "
+                         "[-r prerequis] [-j jours] [-g graine] [-d dossier]\n" );
+        return 1;
+    }
+    bases.dbf = creer_db_formation();
+    bases.dbp = creer_db_personne();
+    nb_inscriptions = generer_db( bases.dbf, bases.dbp, &pg );
+    chemin_fichier( chemin, pg.dossier, FICHIER_PERSONNE );
+    res = ecrire_fichier_atomique( chemin, ecrire_db_personne_fichier, bases.dbp );
+    if( res )
+    {
+        chemin_fichier( chemin, pg.dossier, FICHIER_FORMATION );
+        res = ecrire_fichier_atomique( chemin, ecrire_db_formation_fichier, bases.dbf );
+    }
+    if( res )
+    {
+        chemin_fichier( chemin, pg.dossier, FICHIER_ID );
+        res = ecrire_fichier_atomique( chemin, ecrire_ids, &bases );
+    }
+    if( res )
+    {
+        printf( "%d personnes, %d formations et %d inscriptions ecrites dans %s\n",
+                bases.dbp->nb, bases.dbf->nb, nb_inscriptions, pg.dossier );
+    }
+    else
+    {
+        fprintf( stderr, "Impossible d'ecrire %s\n", chemin );
+    }
+    liberer_db_personne( bases.dbp );
+    liberer_db_formation( bases.dbf );
+    return res ? 0 : 1;
+}
 
-    db_personne *dbp = creer_db_personne();
-    db_formation *dbf = creer_db_formation();
+/*
+ * Cette fonction sert a ajouter la duree d a la mesure m.
+ */
+void ajouter_duree( mesure *m, double d )
+{
+    if( m->nb == m->capacite )
+    {
+        m->capacite = m->capacite ? m->capacite * 2 : 64;
+        m->durees = ( double * ) REALLOUER( m->durees, m->capacite * sizeof( double ), "mesure" );
+    }
+    m->durees[ m->nb ] = d;
+    m->nb += 1;
+}
+
+int comparer_duree( const void *a, const void *b )
+{
+    double da = *( const double * ) a, db = *( const double * ) b;
+    return da < db ? -1 : da > db;
+}
 
-    int i = 1;
+/*
+ * Cette fonction renvoie la duree en dessous de laquelle se trouve la fraction p des durees triees de m.
+ */
+double centile_mesure( mesure *m, double p )
+{
+    return m->durees[ ( int ) ( p * ( m->nb - 1 ) + 0.5 ) ];
+}
+
+/*
+ * Cette fonction sert a afficher une ligne du rapport des bancs d'essai: le nombre d'operations, la duree
+ * totale, le debit et les centiles 50, 90 et 99 ainsi que le maximum des durees (en microsecondes).
+ * La memoire occupee par les durees est liberee.
+ */
+void afficher_mesure( mesure *m )
+{
+    double total = 0;
+    int i;
+    if( m->nb == 0 )
+    {
+        return;
+    }
+    for( i = 0; i < m->nb; i++ )
+    {
+        total += m->durees[i];
+    }
+    qsort( m->durees, m->nb, sizeof( double ), comparer_duree );
+    printf( "%-22s %8d %11.3f %13.0f %11.2f %11.2f %11.2f %11.2f\n", m->nom, m->nb, total * 1e3,
+            total > 0 ? m->nb / total : 0.0, centile_mesure( m, 0.50 ) * 1e6, centile_mesure( m, 0.90 ) * 1e6,
+            centile_mesure( m, 0.99 ) * 1e6, m->durees[ m->nb - 1 ] * 1e6 );
+    LIBERER( m->durees );
+    m->durees = NULL;
+    m->nb = m->capacite = 0;
+}
 
-    while( !feof( fdat_p ) )
+/*
+ * Cette fonction renvoie une personne vivante de dbp choisie au hasard, NULL si dbp est vide.
+ */
+personne *personne_au_hasard( db_personne *dbp, unsigned long *etat )
+{
+    personne *tmpp = NULL;
+    while( dbp->nb > 0 && tmpp == NULL )
     {
-        char nom[25], prenom[25];
-        int formateur;
-        int id;
-        fscanf( fdat_p, "%d %24s %24s %d", &id, nom, prenom, &formateur );
-        if( feof( fdat_p ) )
-        {
-            break;
-        }
-        personne *tmp = creer_personne( nom, prenom, formateur );
-        fscanf( fdat_p, "%d", &tmp->nb_formations );
-        tmp->id = id;
-        int j;
-        for( j = 0; j < tmp->nb_formations; j++ )
+        tmpp = get_personne_par_id( dbp, alea_entre( etat, 1, dbp->ids.haut ) );
+    }
+    return tmpp;
+}
+
+/*
+ * Les bancs d'essai mesures par la commande bench, dans l'ordre du rapport.
+ */
+#define BANC_CHARGEMENT_PERSONNES 0
+#define BANC_CHARGEMENT_FORMATIONS 1
+#define BANC_LIAISON 2
+#define BANC_GET_PERSONNE 3
+#define BANC_GET_FORMATION 4
+#define BANC_INSCRIPTION 5
+#define BANC_SAUVEGARDE 6
+#define BANC_PLANNING 7
+#define BANC_SUPPRESSION_PERSONNE 8
+#define BANC_SUPPRESSION_FORMATION 9
+#define NB_BANCS 10
+
+/*
+ * Commande bench: genere un jeu de donnees avec les parametres choisis, l'ecrit dans des fichiers de travail,
+ * puis mesure chaque chemin critique du programme sur ces donnees, repetitions fois:
+ * le chargement des fichiers, la liaison des personnes a leurs formations, get_personne, get_formation,
+ * l'inscription, la sauvegarde, l'ecriture du planning et les suppressions en cascade.
+ * Les operations rapides sont mesurees une par une, ce qui donne les centiles de leur latence.
+ */
+int commande_bench( int argc, char *argv[] )
+{
+    char noms_bancs[ NB_BANCS ][ 24 ] = { "chargement personnes", "chargement formations", "liaison",
+                                          "get_personne", "get_formation", "inscription", "sauvegarde",
+                                          "ecrire_planning", "suppression personne", "suppression formation" };
+    char fichier_p[ 256 ], fichier_f[ 256 ], fichier_id[ 256 ], sortie_p[ 256 ], sortie_f[ 256 ], sortie_res[ 256 ];
+    mesure mesures[ NB_BANCS ];
+    parametres_generation pg;
+    paire_db bases;
+    double debut;
+    int r, i;
+    initialiser_parametres_generation( &pg );
+    if( !lire_parametres_generation( argc, argv, &pg ) )
+    {
+        fprintf( stderr, "Usage: CaculliTyranowski bench [-p personnes] [-f formations] [-i inscriptions] "
+                         "[-r prerequis] [-j jours] [-g graine] [-n repetitions] [-o operations] [-d dossier]\n" );
+        return 1;
+    }
+    memset( mesures, 0, sizeof( mesures ) );
+    for( i = 0; i < NB_BANCS; i++ )
+    {
+        mesures[i].nom = noms_bancs[i];
+    }
+    chemin_fichier( fichier_p, pg.dossier, "CaculliTyranowskiBenchPersonne.dat" );
+    chemin_fichier( fichier_f, pg.dossier, "CaculliTyranowskiBenchFormation.dat" );
+    chemin_fichier( fichier_id, pg.dossier, "CaculliTyranowskiBenchId.dat" );
+    chemin_fichier( sortie_p, pg.dossier, "CaculliTyranowskiBenchSortiePersonne.dat" );
+    chemin_fichier( sortie_f, pg.dossier, "CaculliTyranowskiBenchSortieFormation.dat" );
+    chemin_fichier( sortie_res, pg.dossier, "CaculliTyranowskiBench.res" );
+
+    bases.dbf = creer_db_formation();
+    bases.dbp = creer_db_personne();
+    debut = maintenant();
+    i = generer_db( bases.dbf, bases.dbp, &pg );
+    printf( "Donnees: %d personnes, %d formations, %d inscriptions (generees en %.3f s)\n",
+            bases.dbp->nb, bases.dbf->nb, i, maintenant() - debut );
+    if( !ecrire_fichier_atomique( fichier_p, ecrire_db_personne_fichier, bases.dbp ) ||
+        !ecrire_fichier_atomique( fichier_f, ecrire_db_formation_fichier, bases.dbf ) ||
+        !ecrire_fichier_atomique( fichier_id, ecrire_ids, &bases ) )
+    {
+        fprintf( stderr, "Impossible d'ecrire les fichiers de travail dans %s\n", pg.dossier );
+        liberer_db_personne( bases.dbp );
+        liberer_db_formation( bases.dbf );
+        return 1;
+    }
+    liberer_db_personne( bases.dbp );
+    liberer_db_formation( bases.dbf );
+
+    for( r = 0; r < pg.repetitions; r++ )
+    {
+        unsigned long etat = pg.graine + 1 + r;
+        bases.dbp = creer_db_personne();
+        bases.dbf = creer_db_formation();
+
+        charger_ids( bases.dbf, bases.dbp, fichier_id );
+        debut = maintenant();
+        charger_db_personne( bases.dbp, fichier_p );
+        ajouter_duree( &mesures[ BANC_CHARGEMENT_PERSONNES ], maintenant() - debut );
+        debut = maintenant();
+        charger_db_formation( bases.dbf, fichier_f );
+        ajouter_duree( &mesures[ BANC_CHARGEMENT_FORMATIONS ], maintenant() - debut );
+        recalculer_ids_libres_personne( bases.dbp );
+        recalculer_ids_libres_formation( bases.dbf );
+        debut = maintenant();
+        relier_db( bases.dbf, bases.dbp );
+        ajouter_duree( &mesures[ BANC_LIAISON ], maintenant() - debut );
+
+        for( i = 0; i < pg.operations && bases.dbp->nb > 0; i++ )
         {
-            fscanf( fdat_p, "%d", &tmp->formations[j] );
+            personne *tmpp = personne_au_hasard( bases.dbp, &etat );
+            char nom[ LONGUEUR_NOM_MAX + 1 ], prenom[ LONGUEUR_NOM_MAX + 1 ];
+            strcpy( nom, tmpp->nom );
+            strcpy( prenom, tmpp->prenom );
+            debut = maintenant();
+            get_personne( bases.dbp, nom, prenom, tmpp->formateur );
+            ajouter_duree( &mesures[ BANC_GET_PERSONNE ], maintenant() - debut );
         }
-        if(  formateur == 0 )
+        for( i = 0; i < pg.operations && bases.dbf->nb > 0; i++ )
         {
-            fscanf( fdat_p, "%d", &tmp->reduction );
-            if( tmp->reduction == 1 )
+            formation *tmpf = get_formation_par_id( bases.dbf, alea_entre( &etat, 1, bases.dbf->ids.haut ) );
+            char nom[ LONGUEUR_NOM_MAX + 1 ];
+            if( tmpf == NULL )
             {
-                fscanf( fdat_p, "%d", &tmp->val_reduction );
+                continue;
             }
+            strcpy( nom, tmpf->nom );
+            debut = maintenant();
+            get_formation( bases.dbf, nom );
+            ajouter_duree( &mesures[ BANC_GET_FORMATION ], maintenant() - debut );
         }
-        else if( formateur == 1 )
+        for( i = 0; i < pg.operations && bases.dbp->nb > 0 && bases.dbf->nb > 0; i++ )
         {
-            fscanf( fdat_p, "%d", &tmp->nb_jours_indisponible );
-            for( j = 0; j < tmp->nb_jours_indisponible; j++ )
+            personne *tmpp = personne_au_hasard( bases.dbp, &etat );
+            formation *tmpf = get_formation_par_id( bases.dbf, alea_formation( &etat, bases.dbf->ids.haut ) );
+            if( tmpf == NULL )
             {
-                fscanf( fdat_p, "%d", &tmp->jours_indisponible[j] );
+                continue;
             }
+            debut = maintenant();
+            attribuer_formation( tmpf, tmpp );
+            ajouter_duree( &mesures[ BANC_INSCRIPTION ], maintenant() - debut );
         }
-        ajouter_db_personne( dbp, tmp );
-        i += 1;
-    }
 
-    i = 1;
+        debut = maintenant();
+        ecrire_fichier_atomique( sortie_p, ecrire_db_personne_fichier, bases.dbp );
+        ecrire_fichier_atomique( sortie_f, ecrire_db_formation_fichier, bases.dbf );
+        ajouter_duree( &mesures[ BANC_SAUVEGARDE ], maintenant() - debut );
+        debut = maintenant();
+        ecrire_fichier_atomique( sortie_res, ecrire_planning_fichier, bases.dbf );
+        ajouter_duree( &mesures[ BANC_PLANNING ], maintenant() - debut );
 
-    while( !feof( fdat_f ) )
-    {
-        int id;
-        int nb_prerequis, nb_jours;
-        float prix;
-        char nom_formation[40];
-        fscanf( fdat_f, "%d %d", &id, &nb_prerequis );
-        int prerequis[ nb_prerequis ];
-        int j;
-        for( j = 0; j < nb_prerequis; j++ )
+        for( i = 0; i < ( pg.operations + 9 ) / 10 && bases.dbp->nb > 0; i++ )
         {
-            fscanf( fdat_f, "%d", &prerequis[j] );
+            personne *tmpp = personne_au_hasard( bases.dbp, &etat );
+            int id = tmpp->id;
+            debut = maintenant();
+            supprimer_personne_partout( bases.dbf, bases.dbp, id );
+            ajouter_duree( &mesures[ BANC_SUPPRESSION_PERSONNE ], maintenant() - debut );
         }
-        fscanf( fdat_f, "%d", &nb_jours );
-        int jours[ nb_jours ];
-        float heures[ nb_jours ];
-        float durees[ nb_jours ];
-        for( j = 0; j < nb_jours; j++ )
+        for( i = 0; i < ( pg.operations + 99 ) / 100 && bases.dbf->nb > 0; i++ )
         {
-            fscanf( fdat_f, "%d %f %f", &jours[j], &heures[j], &durees[j] );
+            int id = alea_formation( &etat, bases.dbf->ids.haut );
+            if( get_formation_par_id( bases.dbf, id ) == NULL )
+            {
+                continue;
+            }
+            debut = maintenant();
+            supprimer_formation_partout( bases.dbf, bases.dbp, id );
+            ajouter_duree( &mesures[ BANC_SUPPRESSION_FORMATION ], maintenant() - debut );
         }
-        fscanf( fdat_f, "%f ", &prix );
-        fgets( nom_formation, 40, fdat_f );
-        if( feof( fdat_f ) )
+
+        liberer_db_personne( bases.dbp );
+        liberer_db_formation( bases.dbf );
+    }
+
+    printf( "%-22s %8s %11s %13s %11s %11s %11s %11s\n",
+            "banc", "ops", "total ms", "ops/s", "p50 us", "p90 us", "p99 us", "max us" );
+    for( i = 0; i < NB_BANCS; i++ )
+    {
+        afficher_mesure( &mesures[i] );
+    }
+    remove( fichier_p );
+    remove( fichier_f );
+    remove( fichier_id );
+    remove( sortie_p );
+    remove( sortie_f );
+    remove( sortie_res );
+    return 0;
+}
+
+/*                             FIN BANCS D'ESSAI                             */
+/*****************************************************************************/
+
+int main( int argc, char *argv[] )
+{
+    /*
+     * Le suivi des allocations doit etre choisi avant la premiere allocation.
+     */
+    char *allocations = getenv( "CACULLITYRANOWSKI_ALLOCATIONS" );
+    suivi.actif = allocations != NULL && strcmp( allocations, "0" ) != 0;
+    if( suivi.actif )
+    {
+        atexit( rapporter_allocations_a_la_sortie );
+    }
+    /*
+     * L'option -P choisit les partitions de la base de donnees (voir PARTITIONS). Avec une seule partition, on
+     * se place dans son dossier, sauf pour la commande partitions qui travaille sur le registre. Avec plusieurs,
+     * seules les commandes requete et partitions savent les parcourir.
+     */
+    if( argc > 2 && strcmp( argv[1], "-P" ) == 0 )
+    {
+        if( !ouvrir_registre() )
         {
-            break;
+            fprintf( stderr, "Pas de registre %s, voir la commande partitions ajouter\n", FICHIER_PARTITIONS );
+            return 1;
         }
-        if( strlen( nom_formation ) > 0 && nom_formation[ strlen( nom_formation ) - 1 ] == '\n' )
+        if( !choisir_partitions( argv[2] ) )
         {
-            nom_formation[ strlen( nom_formation ) - 1 ] = '\0';
+            return 1;
         }
-        formation *tmp = creer_formation( nom_formation, prix );
-        tmp->id = id;
-        tmp->nb_prerequis = nb_prerequis;
-        for( j = 0; j < tmp->nb_prerequis; j++ )
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+        if( registre.nb_choisies == 1 && ( argc <= 1 || strcmp( argv[1], "partitions" ) != 0 ) &&
+            !entrer_partition() )
         {
-            tmp->prerequis[j] = prerequis[j];
+            return 1;
         }
-        tmp->nb_jours = nb_jours;
-        for( j = 0; j < tmp->nb_jours; j++ )
+        if( registre.nb_choisies > 1 &&
+            ( argc <= 1 || ( strcmp( argv[1], "requete" ) != 0 && strcmp( argv[1], "partitions" ) != 0 ) ) )
         {
-            tmp->jours[j] = jours[j];
-            tmp->heures[j] = heures[j];
-            tmp->durees[j] = durees[j];
+            fprintf( stderr, "Seules les commandes requete et partitions acceptent plusieurs partitions\n" );
+            return 1;
         }
-        ajouter_db_formation( dbf, tmp );
-        i += 1;
     }
-
-    db_personne *tmpdbp = dbp;
-    noeud_db_personne *tmpndbp = tmpdbp->head;
-
-    while( tmpndbp != NULL )
+    /*
+     * L'instrumentation est active par defaut dans le programme interactif et desactivee pour les commandes,
+     * afin de ne pas fausser les bancs d'essai. La variable d'environnement CACULLITYRANOWSKI_STATS
+     * (0 ou 1) permet de choisir.
+     */
+    char *stats = getenv( "CACULLITYRANOWSKI_STATS" );
+    instrumentation = stats != NULL ? strcmp( stats, "0" ) != 0 : argc <= 1;
+    if( instrumentation )
     {
-        db_formation *tmpdbf = dbf;
-        noeud_db_formation *tmpndbf = tmpdbf->head;
-        while( tmpndbf != NULL )
-        {
-            int j;
-            for( j = 0; j < tmpndbp->p->nb_formations; j++ )
-            {
-                if( tmpndbp->p->formations[j] == tmpndbf->f->id )
-                {
-                    ajouter_formation( tmpndbf->f, tmpndbp->p );
-                }
-            }
-            tmpndbf = tmpndbf->next;
-        }
-        tmpndbp = tmpndbp->next;
+        atexit( ecrire_statistiques_a_la_sortie );
+    }
+    if( argc > 1 && strcmp( argv[1], "partitions" ) == 0 )
+    {
+        return commande_partitions( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "generer" ) == 0 )
+    {
+        return commande_generer( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "bench" ) == 0 )
+    {
+        return commande_bench( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "exporter" ) == 0 )
+    {
+        return commande_exporter( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "importer" ) == 0 )
+    {
+        return commande_importer( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "requete" ) == 0 )
+    {
+        return commande_requete( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "seances" ) == 0 )
+    {
+        return commande_seances( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "emplois" ) == 0 )
+    {
+        return commande_emplois( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "formateurs" ) == 0 )
+    {
+        return commande_formateurs( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "salles" ) == 0 )
+    {
+        return commande_salles( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "attente" ) == 0 )
+    {
+        return commande_attente( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "chercher" ) == 0 )
+    {
+        return commande_chercher( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "migrer" ) == 0 )
+    {
+        return commande_migrer( argc - 2, argv + 2 );
+    }
+    if( argc > 1 && strcmp( argv[1], "verifier" ) == 0 )
+    {
+        return commande_verifier( argc - 2, argv + 2 );
+    }
+    if( argc > 1 )
+    {
+        fprintf( stderr, "Usage: %s [-P selection] [generer | bench | exporter | importer | requete | seances | "
+                         "emplois | formateurs | salles | attente | chercher | migrer | verifier | partitions] "
+                         "[options]\n",
+                 argv[0] );
+        return 1;
     }
+    system( clear );
+    printf( "Projet par Giorgio Caculli et Jedrzej Tyranowski\n" );
 
-    fclose( fdat_p );
-    fclose( fdat_f );
+    db_personne *dbp = creer_db_personne();
+    db_formation *dbf = creer_db_formation();
+
+    charger_db( dbf, dbp );
 
     menu( dbf, dbp );
 
+    liberer_db_formation( dbf );
+    liberer_db_personne( dbp );
+
     return 0;
 }
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Verifie que la base synthetique de generer est coherente pour verifier, qu'elle a le nombre d'enregistrements et
+# d'inscriptions annonce et que la meme graine donne les memes fichiers. Lance par make check.
+programme="$PWD/CaculliTyranowski"
+dossier=$(mktemp -d) || exit 1
+trap 'rm -rf "$dossier"' 0
+mkdir "$dossier/a" "$dossier/b" && cd "$dossier" || exit 1
+
+"$programme" generer -p 2000 -f 150 -g 7 -d a > bilan.txt 2>/dev/null || { echo "generer: echec"; exit 1; }
+"$programme" generer -p 2000 -f 150 -g 7 -d b >/dev/null 2>&1 || { echo "generer: echec"; exit 1; }
+diff -r a b >/dev/null || { echo "generer: la meme graine donne des fichiers differents"; exit 1; }
+inscriptions=$(sed -n 's/^2000 personnes, 150 formations et \([0-9]*\) inscriptions ecrites dans a$/\1/p' bilan.txt)
+[ -n "$inscriptions" ] || { echo "generer: bilan inattendu"; cat bilan.txt; exit 1; }
+
+cd a || exit 1
+"$programme" verifier -o rapport.txt ||
+{ echo "verifier: la base generee est jugee incorrecte"; cat rapport.txt; exit 1; }
+grep -F "2000 personne(s) et 150 formation(s) verifiees" rapport.txt >/dev/null &&
+grep -F ": 0 probleme(s), 0 repare(s)" rapport.txt >/dev/null ||
+{ echo "verifier: bilan inattendu"; cat rapport.txt; exit 1; }
+lignes=$("$programme" exporter inscriptions 2>/dev/null | wc -l)
+[ "$lignes" -eq $(( inscriptions + 1 )) ] ||
+{ echo "exporter: $(( lignes - 1 )) inscriptions, $inscriptions attendues"; exit 1; }
+exit 0
@@ -0,0 +1,51 @@
+#!/bin/sh
+# Verifie qu'une base exportee puis importee dans un dossier vide est retrouvee a l'identique, noms non ASCII
+# compris: les sequences \uXXXX (et les paires de substitution) du JSON sont ecrites en UTF-8. Lance par make check.
+programme="$PWD/CaculliTyranowski"
+dossier=$(mktemp -d) || exit 1
+trap 'rm -rf "$dossier"' 0
+mkdir "$dossier/source" "$dossier/copie" && cd "$dossier/source" || exit 1
+
+cat > formations.jsonl <<'EOF'
+{"nom":"Français","prix":152.25,"jours":[1,3],"heures":[9.30,14.00],"durees":[1.30,2.00]}
+{"nom":"Littérature étrangère","prix":80,"prerequis":[1],"jours":[2],"heures":[10.00],"durees":[1.00]}
+EOF
+cat > personnes.jsonl <<'EOF'
+{"nom":"Lef\u00e8vre","prenom":"Zo\u00EB","formateur":0}
+{"nom":"\u0152uvray","prenom":"\ud83d\ude00","formateur":1,"jours_indisponibles":[2,5]}
+{"nom":"Straße","prenom":"Renée","formateur":0,"reduction":15}
+EOF
+"$programme" importer formations formations.jsonl >/dev/null 2>&1 &&
+"$programme" importer personnes personnes.jsonl >/dev/null 2>&1 ||
+{ echo "importation de la source impossible"; exit 1; }
+"$programme" exporter formations -o "$dossier/formations.csv" 2>/dev/null &&
+"$programme" exporter personnes -f jsonl -o "$dossier/personnes.jsonl" 2>/dev/null ||
+{ echo "exportation impossible"; exit 1; }
+for attendu in '"nom":"Lefèvre","prenom":"Zoë"' '"nom":"Œuvray","prenom":"😀"' \
+               '"nom":"Straße","prenom":"Renée"'
+do
+    grep -F "$attendu" "$dossier/personnes.jsonl" >/dev/null ||
+    { echo "exportation sans: $attendu"; cat "$dossier/personnes.jsonl"; exit 1; }
+done
+grep -F '1,Français,152.25,,1;3,9.30;14.00,1.30;2.00,0' "$dossier/formations.csv" >/dev/null ||
+{ echo "exportation sans Français"; cat "$dossier/formations.csv"; exit 1; }
+
+cd "$dossier/copie" || exit 1
+"$programme" importer formations "$dossier/formations.csv" >/dev/null 2>&1 &&
+"$programme" importer personnes "$dossier/personnes.jsonl" >/dev/null 2>&1 ||
+{ echo "reimportation impossible"; exit 1; }
+"$programme" exporter formations -o formations.csv 2>/dev/null &&
+"$programme" exporter personnes -f jsonl -o personnes.jsonl 2>/dev/null ||
+{ echo "reexportation impossible"; exit 1; }
+cmp formations.csv "$dossier/formations.csv" && cmp personnes.jsonl "$dossier/personnes.jsonl" ||
+{ echo "la base reimportee differe de la source"; exit 1; }
+
+cd "$dossier/source" || exit 1
+"$programme" importer personnes "$dossier/personnes.jsonl" -n 2>/dev/null |
+grep -F ' 0 mis a jour, 3 inchanges' >/dev/null ||
+{ echo "reimporter la meme base la modifie"; exit 1; }
+long=$(printf '%0300d' 0)
+printf 'id,nom,prenom,formateur\n0,%s,X,0\n' "$long" > long.csv
+"$programme" importer personnes long.csv -n 2>&1 | grep -F 'Ligne 2 rejetee: champ trop long' >/dev/null ||
+{ echo "un champ trop long n'est pas rejete"; exit 1; }
+exit 0
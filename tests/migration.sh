@@ -0,0 +1,36 @@
+#!/bin/sh
+# Verifie que migrer convertit un fichier de formations au format 1, ou les durees sont en heures decimales, puis
+# qu'un fichier dont une ligne est refusee n'est pas migre. Lance par make check.
+programme="$PWD/CaculliTyranowski"
+dossier=$(mktemp -d) || exit 1
+trap 'rm -rf "$dossier"' 0
+cd "$dossier" || exit 1
+
+cat > CaculliTyranowskiFormation.dat <<EOF
+01 0 1 1 14.00 1.75 360.00 Anglais
+02 0 1 2 9.00 1.50 100.00 Latin
+03 1 2 2 3 9.30 2.25 4 16.45 0.5 152.25 Grec ancien
+EOF
+"$programme" migrer 2>/dev/null || { echo "migrer: echec sur un fichier valide"; exit 1; }
+for attendu in "format 2" "01 0   1   1   840   105   36000 Anglais" "02 0   1   2   540   90   10000 Latin" \
+               "03 1 2 2   3   570   135   4   1005   30   15225 Grec ancien"
+do
+    grep -x -F "$attendu" CaculliTyranowskiFormation.dat >/dev/null ||
+    { echo "migration sans: $attendu"; cat CaculliTyranowskiFormation.dat; exit 1; }
+done
+ls CaculliTyranowskiFormation_V1_*.dat >/dev/null 2>&1 || { echo "migrer: ancien fichier non garde"; exit 1; }
+
+rm -f CaculliTyranowskiFormation*.dat
+cat > CaculliTyranowskiFormation.dat <<EOF
+01 0 1 1 14.00 1.75 360.00 Anglais
+02 0 1 2 9.75 1.50 100.00 Latin
+EOF
+cp CaculliTyranowskiFormation.dat attendu.dat
+"$programme" migrer 2>/dev/null && { echo "migrer: une ligne refusee n'empeche pas la migration"; exit 1; }
+cmp CaculliTyranowskiFormation.dat attendu.dat >/dev/null || { echo "migrer: fichier modifie malgre l'echec"; exit 1; }
+if ls CaculliTyranowskiFormation_V1_*.dat >/dev/null 2>&1
+then
+    echo "migrer: copie gardee malgre l'echec"
+    exit 1
+fi
+exit 0
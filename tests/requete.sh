@@ -0,0 +1,67 @@
+#!/bin/sh
+# Verifie les resultats de requetes sur une petite base connue: conditions, inscrit( ) et participant( ), ~ et ~=
+# sans majuscules ni accents, tri, limite et requetes sur les inscriptions. Lance par make check.
+programme="$PWD/CaculliTyranowski"
+dossier=$(mktemp -d) || exit 1
+trap 'rm -rf "$dossier"' 0
+cd "$dossier" || exit 1
+
+cat > formations.csv <<'EOF'
+id,nom,prix,prerequis,jours,heures,durees
+1,Français,152.25,,1;3,9.30;14.00,1.30;2.00
+2,Littérature étrangère,80,1,2,10.00,1.00
+3,Java,45.50,,2;5,8.00;13.15,3.00;1.00
+EOF
+cat > personnes.csv <<'EOF'
+id,nom,prenom,formateur,reduction,jours_indisponibles
+1,Lefèvre,Zoë,0,0,
+2,Œuvray,Paul,1,0,2;5
+3,Straße,Renée,0,15,
+4,LEFEVRE,Marc,0,30,
+EOF
+cat > inscriptions.csv <<'EOF'
+formation_id,personne_id
+1,1
+1,2
+2,3
+2,1
+3,4
+EOF
+for quoi in formations personnes inscriptions
+do
+    "$programme" importer $quoi $quoi.csv >/dev/null 2>&1 || { echo "importation de $quoi impossible"; exit 1; }
+done
+
+# verifier attendu requete...: compare la sortie de la requete au texte attendu.
+verifier()
+{
+    attendu="$1"
+    shift
+    "$programme" requete "$@" > obtenu.txt 2>/dev/null || { echo "requete $*: echec"; exit 1; }
+    printf '%s\n' "$attendu" | cmp -s - obtenu.txt ||
+    { echo "requete $*: resultat inattendu"; printf '%s\n' "$attendu" | diff - obtenu.txt; exit 1; }
+}
+
+verifier 'id,nom,prenom,formateur,reduction,jours_indisponibles
+1,Lefèvre,Zoë,0,0,
+4,LEFEVRE,Marc,0,30,' personnes si 'nom ~= lefevre'
+verifier 'id,nom,prenom,formateur,reduction,jours_indisponibles
+4,LEFEVRE,Marc,0,30,' personnes si 'nom = LEFEVRE'
+verifier 'id,nom,prenom,formateur,reduction,jours_indisponibles
+1,Lefèvre,Zoë,0,0,
+2,Œuvray,Paul,1,0,2;5' personnes si 'inscrit( nom ~ franc )' tri nom
+verifier 'id,nom,prix,prerequis,jours,heures,durees,participants
+2,Littérature étrangère,80.00,1,2,10.00,1.00,2
+3,Java,45.50,,2;5,8.00;13.15,3.00;1.00,1' \
+    formations si 'jours = mardi et non participant( formateur = 1 )' tri prix desc
+verifier 'id,nom,prix,prerequis,jours,heures,durees,participants
+3,Java,45.50,,2;5,8.00;13.15,3.00;1.00,1' formations si 'participant( reduction >= 20 ) ou prix < 50'
+verifier 'formation_id,personne_id,formateur
+2,3,0
+1,2,1
+1,1,0' \
+    inscriptions si 'formation.prix > 100 ou personne.reduction >= 15 et formation.id != 3' tri personne.nom desc
+verifier 'id,nom,prenom,formateur,reduction,jours_indisponibles
+4,LEFEVRE,Marc,0,30,' personnes si 'non formateur = 1' tri reduction desc limite 1
+verifier 'id,nom,prenom,formateur,reduction,jours_indisponibles' personnes si 'prenom = "Zoe"'
+exit 0
@@ -0,0 +1,22 @@
+#!/bin/sh
+# Verifie qu'un enregistrement incomplet est ignore sans emporter la ligne suivante, puis que la reparation
+# garde les enregistrements valides. Lance par make check.
+programme="$PWD/CaculliTyranowski"
+dossier=$(mktemp -d) || exit 1
+trap 'rm -rf "$dossier"' 0
+cp "${srcdir:-.}"/tests/corrompu/*.dat "$dossier" && cd "$dossier" || exit 1
+
+"$programme" verifier -o rapport.txt && { echo "verifier: la base corrompue est jugee correcte"; exit 1; }
+for attendu in "Ligne 2 de ./CaculliTyranowskiPersonne.dat" "Ligne 4 de ./CaculliTyranowskiPersonne.dat" \
+               "Ligne 3 de ./CaculliTyranowskiFormation.dat" "Ligne 5 de ./CaculliTyranowskiFormation.dat" \
+               "2 personne(s) et 2 formation(s)"
+do
+    grep -F "$attendu" rapport.txt >/dev/null || { echo "rapport sans: $attendu"; cat rapport.txt; exit 1; }
+done
+
+"$programme" verifier -r -o rapport.txt >/dev/null || { cat rapport.txt; exit 1; }
+grep '^01 Aubry .* 0   2   1 3 ' CaculliTyranowskiPersonne.dat >/dev/null &&
+grep '^03 Claes ' CaculliTyranowskiPersonne.dat >/dev/null &&
+grep '^03 0   1   4   600   60   3000 Gamma$' CaculliTyranowskiFormation.dat >/dev/null ||
+{ echo "reparation: enregistrement valide perdu"; cat CaculliTyranowski*.dat; exit 1; }
+"$programme" verifier >/dev/null